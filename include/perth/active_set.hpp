@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/eigen.hpp"
+#include "perth/inference.hpp"
+#include "perth/nodal_corrections.hpp"
+
+namespace perth {
+
+/// @brief Compact set of the constituents contributing to the tide.
+///
+/// Only the constituents provided by the tidal model or computed by the
+/// inference have a non-zero tide. They are gathered once, split by
+/// constituent type, and their nodal corrections, tidal arguments and tides
+/// are stored as structures of arrays so that the harmonic summation only
+/// covers them.
+class ActiveSet {
+ public:
+  /// @brief Build the active set.
+  /// @param[in] table The constituent table used for the evaluation. The
+  /// constituents not flagged as inferred are provided by the model.
+  /// @param[in] inference The inference used to compute the missing
+  /// constituents, or nullptr if no inference is done.
+  ActiveSet(const ConstituentTable& table, const Inference* inference);
+
+  /// @brief Update the nodal corrections and the tidal arguments of the
+  /// active constituents. Must be called each time the astronomical arguments
+  /// of the table are updated.
+  /// @param[in] table The constituent table holding the tidal arguments.
+  /// @param[in] nodal_corrections The nodal corrections of all the
+  /// constituents of the table.
+  auto update(const ConstituentTable& table,
+              const std::vector<NodalCorrections>& nodal_corrections) -> void;
+
+  /// @brief Sum the contributions of the active constituents.
+  /// @param[in] table The constituent table holding the tides.
+  /// @return A tuple containing the short-period and long-period tides.
+  auto evaluate(const ConstituentTable& table) -> std::tuple<double, double>;
+
+  /// @brief Prepare the phasor recurrence used by advance().
+  ///
+  /// Computes, for each active constituent, the complex rotation turning its
+  /// current phasor f·exp(i(V+u)) into the phasor described by the table and
+  /// the nodal corrections given, which must be those of the next time step.
+  /// The current phasors are left unchanged.
+  /// @param[in] table The constituent table holding the tidal arguments of the
+  /// next time step.
+  /// @param[in] nodal_corrections The nodal corrections of the next time
+  /// step.
+  auto prepare_recurrence(
+      const ConstituentTable& table,
+      const std::vector<NodalCorrections>& nodal_corrections) -> void;
+
+  /// @brief Advance the phasors of the active constituents by one time step,
+  /// using the rotations computed by prepare_recurrence(), without evaluating
+  /// any trigonometric function.
+  auto advance() noexcept -> void;
+
+  /// @brief Get the number of active constituents.
+  [[nodiscard]] auto size() const noexcept -> size_t {
+    return short_period_.index.size() + long_period_.index.size();
+  }
+
+ private:
+  /// @brief Properties of the active constituents of a given type.
+  struct Components {
+    std::vector<size_t> index;      ///< Index of the constituent in the table
+    std::vector<double> f;          ///< Nodal modulation factors
+    std::vector<double> u;          ///< Nodal phase corrections, in degrees
+    std::vector<double> argument;   ///< Tidal arguments, in degrees
+    std::vector<double> f_cos;      ///< f * cos(argument + u)
+    std::vector<double> f_sin;      ///< f * sin(argument + u)
+    std::vector<double> rotation_cos;  ///< Phasor rotation, real part
+    std::vector<double> rotation_sin;  ///< Phasor rotation, imaginary part
+    std::vector<double> phase;         ///< Scratch phases, in radians
+
+    /// @brief Add a constituent to the set.
+    auto push_back(const size_t ix) -> void;
+
+    /// @brief Update the nodal corrections and the tidal arguments.
+    auto update(const ConstituentTable& table,
+                const std::vector<NodalCorrections>& nodal_corrections)
+        -> void;
+
+    /// @brief Sum the contributions of the constituents.
+    auto evaluate(const ConstituentTable& table) -> double;
+
+    /// @brief Compute the rotations of the phasors to the next time step.
+    auto prepare_recurrence(
+        const ConstituentTable& table,
+        const std::vector<NodalCorrections>& nodal_corrections) -> void;
+
+    /// @brief Rotate the phasors by one time step.
+    auto advance() noexcept -> void;
+  };
+
+  Components short_period_;  ///< Active short-period constituents
+  Components long_period_;   ///< Active long-period constituents
+};
+
+}  // namespace perth
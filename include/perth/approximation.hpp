@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/inference.hpp"
+
+namespace perth {
+
+/// @brief Shortcuts taken by an approximate evaluation of the tide, and the
+/// error they cause at most.
+struct Approximation {
+  /// Upper bound of the difference between the tides evaluated with the
+  /// shortcuts and without, short-period or long-period, in the unit of the
+  /// model. It covers the time tolerance below, not a larger one given to
+  /// the evaluations.
+  double error_bound{0};
+  /// Time tolerance within which the nodal corrections are kept, in days,
+  /// the tidal arguments being extrapolated linearly (see
+  /// ArgumentMode::kExtrapolated).
+  double time_tolerance{0};
+  /// Inferred constituents no longer computed.
+  std::vector<Constituent> dropped;
+};
+
+/// @brief Largest time tolerance selected by select_approximation(), one
+/// day: over a day, the linear extrapolation of the tidal arguments remains
+/// exact to within 1e-6 degree.
+constexpr double kMaxApproximateTimeTolerance = 1.0;
+
+/// @brief Select the shortcuts of an evaluation whose error must not exceed
+/// a budget.
+///
+/// Half of the budget is spent on the inferred constituents whose bounded
+/// contribution, the bound of their admittance-scaled tide (see
+/// Inference::amplitude_bounds()) times the bound of their modulation
+/// factor, is the smallest: they are dropped. The rest is spent on the time
+/// tolerance, the error of the nodal corrections kept within it being
+/// bounded by the rates of change of the corrections (see
+/// nodal_correction_bounds()) times the duration.
+/// @param[in] table The constituent table of the evaluation, whose flags
+/// tell which constituents the model provides.
+/// @param[in] inference The inference of the evaluation, or nullptr.
+/// @param[in] identifiers The constituents provided by the model.
+/// @param[in] amplitudes Bounds of the moduli of the constituents provided,
+/// in the order of `identifiers` (see TidalModel::max_amplitudes()).
+/// @param[in] group_modulations Whether the group modulations are applied.
+/// @param[in] max_error The budget, in the unit of the model.
+/// @return The shortcuts selected and the error bound they guarantee, at
+/// most `max_error`.
+/// @throw std::invalid_argument If the budget is negative, or if the
+/// amplitudes do not match the constituents.
+auto select_approximation(const ConstituentTable& table,
+                          const Inference* inference,
+                          const std::vector<Constituent>& identifiers,
+                          const std::vector<double>& amplitudes,
+                          bool group_modulations, double max_error)
+    -> Approximation;
+
+}  // namespace perth
@@ -172,8 +172,32 @@ class Axis {
   /// @param[in] coordinate position in this coordinate system
   /// @return None if coordinate is outside the axis definition domain otherwise
   /// the tuple (i0, i1)
-  auto find_indices(double coordinate) const
-      -> std::optional<std::tuple<int64_t, int64_t>>;
+  auto find_indices(const double coordinate) const
+      -> std::optional<std::tuple<int64_t, int64_t>> {
+    if (!is_ascending_) {
+      return search_indices(coordinate);
+    }
+    auto i0 = locate(wrap_coordinate(coordinate));
+    if (i0 == -1) {
+      return std::nullopt;
+    }
+    return std::make_tuple(i0, i0 == size_ - 1 ? int64_t(0) : i0 + 1);
+  }
+
+  /// @brief Find the grid elements around each coordinate of a vector, and
+  /// the position of the coordinate between them.
+  ///
+  /// The position is the fraction of the distance from `(*this)(i0)` to
+  /// `(*this)(i1)` covered by the coordinate, measured across the 360 degree
+  /// circle for a periodic axis, i.e. the weight of the element `i1` in a
+  /// linear interpolation.
+  ///
+  /// @param[in] coordinates positions in this coordinate system
+  /// @return The tuple (i0, i1, fraction). The indices are -1 and the
+  /// fraction NaN for the coordinates outside the axis definition domain.
+  auto find_indices(const Eigen::Ref<const Eigen::VectorXd> &coordinates) const
+      -> std::tuple<Eigen::Vector<int64_t, -1>, Eigen::Vector<int64_t, -1>,
+                    Eigen::VectorXd>;
 
   /// @brief Given a coordinate position, find grids elements around it.
   /// This mean that
@@ -212,6 +236,8 @@ class Axis {
   double start_{};
   /// The step between two values of the axis.
   double step_{};
+  /// The reciprocal of the step.
+  double inv_step_{};
 
   /// Put longitude into the range [0, circle_] degrees.
   static auto normalize_longitude(const Eigen::VectorXd &points)
@@ -221,6 +247,50 @@ class Axis {
   auto initialize(const Eigen::Ref<const Eigen::VectorXd> &values,
                   const double epsilon = 1e-6) -> void;
 
+  /// Returns the value at the given index, without checking the bounds.
+  constexpr auto value(const int64_t index) const noexcept -> double {
+    return start_ + static_cast<double>(index) * step_;
+  }
+
+  /// Returns the index of the first element of the cell of an ascending axis
+  /// containing the normalized coordinate, or -1 if the coordinate is outside
+  /// the axis definition domain. The cell starting on the last element wraps
+  /// around the circle.
+  constexpr auto locate(const double coordinate) const noexcept -> int64_t {
+    const auto last = size_ - 1;
+    // NaN coordinates are rejected by these comparisons too.
+    if (!(coordinate >= start_ &&
+          (is_periodic_ || coordinate <= value(last)))) {
+      return -1;
+    }
+    auto index = std::min(
+        static_cast<int64_t>((coordinate - start_) * inv_step_), last);
+    // The product by the reciprocal of the step may round the position into
+    // a neighboring cell: the exact bounds of the cell decide.
+    if (coordinate < value(index)) {
+      --index;
+    } else if (index < last && coordinate >= value(index + 1)) {
+      ++index;
+    }
+    // A coordinate located on the last element belongs to the last cell.
+    if (index == last && (!is_periodic_ || coordinate == value(last))) {
+      --index;
+    }
+    return index;
+  }
+
+  /// Returns the normalized value of the coordinate, within [min, min + 360)
+  /// for a periodic axis: the normalization can round a value just below
+  /// the minimum to min + 360, which is normalized again.
+  constexpr auto wrap_coordinate(const double coordinate) const -> double {
+    return normalize_coordinate(normalize_coordinate(coordinate));
+  }
+
+  /// Search the elements around the coordinate, whatever the direction of
+  /// the axis.
+  auto search_indices(double coordinate) const
+      -> std::optional<std::tuple<int64_t, int64_t>>;
+
   /// Returns the normalized value of the coordinate with the respect to the
   /// axis definition.
   ///
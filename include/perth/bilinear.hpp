@@ -0,0 +1,125 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "perth/storage.hpp"
+
+namespace perth {
+
+/// @brief Bilinear interpolation of a block of values sharing the same
+/// stencil.
+///
+/// The four corners point to `n` contiguous complex values (one per tidal
+/// constituent), encoded in a storage type of the waves (see WaveStorage).
+/// The values are decoded in double precision inside the kernel, the
+/// weights are applied to the whole block in one pass and the validity of
+/// each corner is checked in bulk. The kernel is compiled for several
+/// instruction sets (AVX-512, AVX2, baseline SSE2/NEON) and the best one
+/// available is selected at runtime.
+///
+/// @param[in] wxy The weights returned by bilinear_weights.
+/// @param[in] z11 Values of the first corner (x1, y1).
+/// @param[in] z12 Values of the second corner (x1, y2).
+/// @param[in] z21 Values of the third corner (x2, y1).
+/// @param[in] z22 Values of the fourth corner (x2, y2).
+/// @param[in] n The number of values stored at each corner.
+/// @param[out] result The interpolated values (n elements).
+/// @return The number of corners used for the interpolation (1 to 4), 0 if
+/// all corners are undefined, or -1 if a corner holds both defined and
+/// undefined values. In the latter case, `result` is not set and the caller
+/// must interpolate each value independently.
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const std::complex<float>* z11,
+                         const std::complex<float>* z12,
+                         const std::complex<float>* z21,
+                         const std::complex<float>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @copydoc interpolate_stencil
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const std::complex<double>* z11,
+                         const std::complex<double>* z12,
+                         const std::complex<double>* z21,
+                         const std::complex<double>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @copydoc interpolate_stencil
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const Complex16<uint16_t>* z11,
+                         const Complex16<uint16_t>* z12,
+                         const Complex16<uint16_t>* z21,
+                         const Complex16<uint16_t>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @brief Bilinear interpolation of a block of values stored as scaled
+/// 16-bit integers (see WaveStorage<Int16>).
+///
+/// The arguments are those of the other overloads, followed by the `n`
+/// scale factors of the values before the result.
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const Complex16<int16_t>* z11,
+                         const Complex16<int16_t>* z12,
+                         const Complex16<int16_t>* z21,
+                         const Complex16<int16_t>* z22, size_t n,
+                         const double* scales,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @brief Bilinear interpolation of a block of values sharing the same
+/// stencil, whose defined corners are already known.
+///
+/// The values are not inspected: the NaN checks of interpolate_stencil()
+/// are replaced by the mask of the defined corners, e.g. precomputed for
+/// the cells of a model.
+///
+/// @param[in] wxy The weights returned by bilinear_weights.
+/// @param[in] defined Bit `k` (0 to 3) is set if the k-th corner, in the
+/// order z11, z12, z21, z22, holds only defined values. The other corners
+/// must hold only undefined values.
+/// @param[in] z11 Values of the first corner (x1, y1).
+/// @param[in] z12 Values of the second corner (x1, y2).
+/// @param[in] z21 Values of the third corner (x2, y1).
+/// @param[in] z22 Values of the fourth corner (x2, y2).
+/// @param[in] n The number of values stored at each corner.
+/// @param[out] result The interpolated values (n elements).
+/// @return The number of corners used for the interpolation (1 to 4), or 0
+/// if no corner is defined or if the defined corners have a zero weight.
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         uint8_t defined, const std::complex<float>* z11,
+                         const std::complex<float>* z12,
+                         const std::complex<float>* z21,
+                         const std::complex<float>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @copydoc interpolate_stencil
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         uint8_t defined, const std::complex<double>* z11,
+                         const std::complex<double>* z12,
+                         const std::complex<double>* z21,
+                         const std::complex<double>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @copydoc interpolate_stencil
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         uint8_t defined, const Complex16<uint16_t>* z11,
+                         const Complex16<uint16_t>* z12,
+                         const Complex16<uint16_t>* z21,
+                         const Complex16<uint16_t>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+/// @brief Bilinear interpolation of a block of values stored as scaled
+/// 16-bit integers, whose defined corners are already known.
+///
+/// The arguments are those of the other overloads, followed by the `n`
+/// scale factors of the values before the result.
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         uint8_t defined, const Complex16<int16_t>* z11,
+                         const Complex16<int16_t>* z12,
+                         const Complex16<int16_t>* z21,
+                         const Complex16<int16_t>* z22, size_t n,
+                         const double* scales,
+                         std::complex<double>* result) noexcept -> int64_t;
+
+}  // namespace perth
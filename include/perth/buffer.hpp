@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace perth {
+
+/// @brief Read-only array of values owned by the buffer or by an external
+/// object.
+///
+/// The values are either moved into the buffer or borrowed from memory owned
+/// by the caller, e.g. a memory-mapped file or a NumPy array. In the latter
+/// case, the buffer holds a reference on an object keeping the memory alive
+/// for as long as the values are used.
+///
+/// @tparam T The type of the values.
+template <typename T>
+class Buffer {
+ public:
+  /// @brief Default constructor: empty buffer.
+  Buffer() = default;
+
+  /// @brief Take ownership of the given values.
+  /// @param[in] values The values to store.
+  explicit Buffer(Eigen::Vector<T, -1> values)
+      : Buffer(std::make_shared<const Eigen::Vector<T, -1>>(std::move(values))) {
+  }
+
+  /// @brief Borrow values owned by an external object.
+  /// @param[in] data Pointer to the first value.
+  /// @param[in] size Number of values.
+  /// @param[in] keeper Object keeping the memory pointed to by `data` alive.
+  /// If nullptr, the caller guarantees that the memory outlives the buffer.
+  Buffer(const T* data, const size_t size, std::shared_ptr<const void> keeper)
+      : data_(data), size_(size), keeper_(std::move(keeper)), borrowed_(true) {}
+
+  /// @brief Get a pointer to the first value.
+  [[nodiscard]] constexpr auto data() const noexcept -> const T* {
+    return data_;
+  }
+
+  /// @brief Get the number of values.
+  [[nodiscard]] constexpr auto size() const noexcept -> size_t {
+    return size_;
+  }
+
+  /// @brief True if the buffer holds no value.
+  [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+    return size_ == 0;
+  }
+
+  /// @brief Get the value at the given index.
+  constexpr auto operator()(const size_t ix) const noexcept -> const T& {
+    return data_[ix];
+  }
+
+  /// @brief True if the values are owned by an external object.
+  [[nodiscard]] auto borrowed() const noexcept -> bool { return borrowed_; }
+
+ private:
+  /// Pointer to the first value.
+  const T* data_{nullptr};
+  /// Number of values.
+  size_t size_{0};
+  /// Object keeping the values alive.
+  std::shared_ptr<const void> keeper_{};
+  /// True if the values are owned by an external object.
+  bool borrowed_{false};
+
+  explicit Buffer(std::shared_ptr<const Eigen::Vector<T, -1>> values)
+      : data_(values->data()),
+        size_(static_cast<size_t>(values->size())),
+        keeper_(std::move(values)),
+        borrowed_(false) {}
+};
+
+}  // namespace perth
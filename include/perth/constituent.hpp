@@ -181,6 +181,16 @@ class ConstituentSet {
 
 using ConstituentTable = ConstituentSet<TideComponent>;
 
+/// @brief Matrix of the Doodson numbers of all the constituents, one row per
+/// constituent, ordered by Constituent value.
+using DoodsonMatrix =
+    Eigen::Matrix<double, kNumConstituentItems, 7, Eigen::RowMajor>;
+
+/// @brief Get the Doodson numbers of all the constituents handled.
+/// @return A matrix whose row `i` is the Doodson number of the constituent
+/// `static_cast<Constituent>(i)`.
+auto doodson_matrix() -> const DoodsonMatrix &;
+
 auto assemble_constituent_table(
     const std::vector<Constituent> &constituents = {}) -> ConstituentTable;
 
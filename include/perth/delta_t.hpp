@@ -1,30 +1,30 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "perth/datetime.hpp"
 #include "perth/math.hpp"
 
 namespace perth {
 
-/// @brief Computes the difference between Universal Time (UT) and Terrestrial
-/// Dynamical Time (TT), also known as the old Ephemeris Time (ET).
-/// @param[in] tj Julian date in days (e.g., 2010 Jan 1 noon = 2455198).
-/// @return The difference ET - UT in seconds.
-/// @note The output is an approximation based on polynomial tables from work by
-/// Espenak and Meeus. It is starting to get slightly off as it was based
-/// on observed data only through ~2010.
-PERTH_MATH_CONSTEXPR auto calculate_delta_time(double tj) -> double {
-  auto y = std::round((tj - 2415020.0) / 365.25) + 1900;  // Year
+/// First year covered by the Delta T model.
+constexpr int kDeltaTimeFirstYear = 1700;
 
-  // Ensure the year is within the valid range for the Delta_T routine.
-  if (y < 1700 || y > 2150) {
-    throw std::out_of_range(
-        "Time out of range in Delta_T routine; revise for year " +
-        std::to_string(y));
-  }
+/// Last year covered by the Delta T model.
+constexpr int kDeltaTimeLastYear = 2150;
 
+/// @brief Evaluates the polynomials of Espenak and Meeus giving TT - UT.
+/// @param[in] y The year, between kDeltaTimeFirstYear and kDeltaTimeLastYear.
+/// @return The difference ET - UT in seconds.
+constexpr auto delta_time_polynomial(const double y) noexcept -> double {
   if (y >= 2050) {
     return -20.0 + 32.0 * pow<2, double>((y - 1820) / 100.0) -
            0.5628 * (2150 - y);
@@ -95,4 +95,119 @@ PERTH_MATH_CONSTEXPR auto calculate_delta_time(double tj) -> double {
          1.3336e-4 * pow<3, double>(t) - 8.518e-7 * pow<4, double>(t);
 }
 
+/// Delta T, in seconds, for each year covered by the model, tabulated at
+/// compile time: the polynomials are constant within a year.
+inline constexpr auto kDeltaTimeTable = [] {
+  auto table =
+      std::array<double, kDeltaTimeLastYear - kDeltaTimeFirstYear + 1>{};
+  for (size_t ix = 0; ix < table.size(); ++ix) {
+    table[ix] = delta_time_polynomial(static_cast<double>(ix) +
+                                      kDeltaTimeFirstYear);
+  }
+  return table;
+}();
+
+/// @brief Throws the error reported for a year outside the Delta T model.
+/// Kept out of line so that the lookup of the table stays small.
+[[noreturn]] inline auto throw_delta_time_out_of_range(const double year)
+    -> void {
+  throw std::out_of_range(
+      "Time out of range in Delta_T routine; revise for year " +
+      std::to_string(year));
+}
+
+/// @brief Computes the difference between Universal Time (UT) and Terrestrial
+/// Dynamical Time (TT), also known as the old Ephemeris Time (ET).
+/// @param[in] tj Julian date in days (e.g., 2010 Jan 1 noon = 2455198).
+/// @return The difference ET - UT in seconds.
+/// @throw std::out_of_range If the year is outside the years covered by the
+/// model, 1700 to 2150.
+/// @note The output is an approximation based on polynomial tables from work by
+/// Espenak and Meeus. It is starting to get slightly off as it was based
+/// on observed data only through ~2010. The polynomials are evaluated for the
+/// nearest year, read in kDeltaTimeTable.
+PERTH_MATH_CONSTEXPR auto calculate_delta_time(double tj) -> double {
+  auto y = std::round((tj - 2415020.0) / 365.25) + 1900;  // Year
+
+  // Ensure the year is within the valid range for the Delta_T routine.
+  if (!(y >= kDeltaTimeFirstYear && y <= kDeltaTimeLastYear)) {
+    if (std::isnan(y)) {
+      return y;
+    }
+    throw_delta_time_out_of_range(y);
+  }
+  return kDeltaTimeTable[static_cast<size_t>(y) - kDeltaTimeFirstYear];
+}
+
+/// @brief Series of Delta T (TT - UT) values, e.g. published by the IERS,
+/// used instead of the model of calculate_delta_time() within its span.
+class DeltaTimeSeries {
+ public:
+  /// @brief Build the series.
+  /// @param[in] time Times of the values, in Modified Julian Days, strictly
+  /// increasing.
+  /// @param[in] delta Delta T at each time, in seconds.
+  /// @throw std::invalid_argument If the vectors have different sizes, hold
+  /// less than two values, or if the times are not strictly increasing.
+  DeltaTimeSeries(std::vector<double> time, std::vector<double> delta)
+      : time_(std::move(time)), delta_(std::move(delta)) {
+    if (time_.size() != delta_.size()) {
+      throw std::invalid_argument("Input vectors must have the same size");
+    }
+    if (time_.size() < 2) {
+      throw std::invalid_argument("The series must hold at least two values");
+    }
+    for (size_t ix = 1; ix < time_.size(); ++ix) {
+      if (!(time_[ix] > time_[ix - 1])) {
+        throw std::invalid_argument(
+            "The times of the series must be strictly increasing");
+      }
+    }
+  }
+
+  /// @brief Get the times of the values, in Modified Julian Days.
+  [[nodiscard]] auto time() const noexcept -> const std::vector<double>& {
+    return time_;
+  }
+
+  /// @brief Get the values of Delta T, in seconds.
+  [[nodiscard]] auto delta() const noexcept -> const std::vector<double>& {
+    return delta_;
+  }
+
+  /// @brief Check if a time is within the span of the series.
+  /// @param[in] time Modified Julian Day.
+  [[nodiscard]] auto contains(const double time) const noexcept -> bool {
+    return time >= time_.front() && time <= time_.back();
+  }
+
+  /// @brief Get Delta T at a given time.
+  ///
+  /// Within the span of the series, the values are interpolated linearly;
+  /// outside, calculate_delta_time() is used.
+  /// @param[in] time Modified Julian Day.
+  /// @return Delta T in seconds.
+  /// @throw std::out_of_range If the time is outside the span of the series
+  /// and of the model.
+  [[nodiscard]] auto operator()(const double time) const -> double {
+    if (!contains(time)) {
+      return calculate_delta_time(time + kModifiedJulianEpoch);
+    }
+    // First value after the time, the last value framing the last time.
+    auto it = std::upper_bound(time_.begin(), time_.end(), time);
+    if (it == time_.end()) {
+      --it;
+    }
+    const auto ix = static_cast<size_t>(std::distance(time_.begin(), it));
+    const auto t = (time - time_[ix - 1]) / (time_[ix] - time_[ix - 1]);
+    return delta_[ix - 1] + t * (delta_[ix] - delta_[ix - 1]);
+  }
+
+ private:
+  /// Times of the values, in Modified Julian Days.
+  std::vector<double> time_;
+  /// Values of Delta T, in seconds.
+  std::vector<double> delta_;
+};
+
 }  // namespace perth
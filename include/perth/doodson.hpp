@@ -14,6 +14,35 @@ namespace perth {
 /// @param[in] delta Delta T, in seconds.
 auto calculate_celestial_vector(double time, double delta) noexcept -> Vector6d;
 
+/// @brief Evaluate Doodson's 6 astronomical variables at several times.
+///
+/// The variables are evaluated for all the times in one vectorized pass.
+/// They match those of calculate_celestial_vector() within rounding errors.
+/// @param[in] time Universal Time in decimal Modified Julian Days.
+/// @param[in] delta Delta T, in seconds, for each time.
+/// @return A matrix whose row `i` holds the variables at `time(i)`, in the
+/// order of calculate_celestial_vector().
+/// @throw std::invalid_argument If the vectors have different sizes.
+auto calculate_celestial_vectors(const Eigen::Ref<const Eigen::VectorXd>& time,
+                                 const Eigen::Ref<const Eigen::VectorXd>& delta)
+    -> Eigen::Matrix<double, -1, 6>;
+
+/// @brief Evaluate Doodson's tidal argument from the astronomical variables.
+/// @param[in] celestial_vector Doodson's 6 astronomical variables, as
+/// returned by calculate_celestial_vector.
+/// @param[in] doodson_number Doodson number of the tide component.
+/// @return Doodson's tidal argument
+inline auto calculate_doodson_argument(
+    const Vector6d& celestial_vector,
+    const Eigen::Ref<const Vector7d>& doodson_number) -> double {
+  Eigen::Vector<double, 7> beta;
+  beta << celestial_vector, 90.0;
+
+  // Compute argument as dot product with Doodson number
+  double arg = doodson_number.dot(beta);
+  return normalize_angle(arg);
+}
+
 /// @brief Evaluate Doodson's tidal argument at a given time.
 /// @param[in] time Universal Time in decimal Modified Julian Days.
 /// @param[in] delta Delta T, in seconds.
@@ -22,12 +51,26 @@ auto calculate_celestial_vector(double time, double delta) noexcept -> Vector6d;
 inline auto calculate_doodson_argument(
     double time, double delta, const Eigen::Ref<const Vector7d>& doodson_number)
     -> double {
-  Eigen::Vector<double, 7> beta;
-  beta << calculate_celestial_vector(time, delta), 90.0;
+  return calculate_doodson_argument(calculate_celestial_vector(time, delta),
+                                    doodson_number);
+}
 
-  // Compute argument as dot product with Doodson number
-  double arg = doodson_number.dot(beta);
-  return normalize_angle(arg);
+/// @brief Evaluate the tidal arguments of several components at once.
+/// @param[in] celestial_vector Doodson's 6 astronomical variables, as
+/// returned by calculate_celestial_vector.
+/// @param[in] doodson_numbers Matrix whose rows are the Doodson numbers of
+/// the tide components.
+/// @return Doodson's tidal arguments, one per row of `doodson_numbers`.
+template <int N>
+inline auto calculate_doodson_arguments(
+    const Vector6d& celestial_vector,
+    const Eigen::Matrix<double, N, 7, Eigen::RowMajor>& doodson_numbers)
+    -> Eigen::Vector<double, N> {
+  Eigen::Vector<double, 7> beta;
+  beta << celestial_vector, 90.0;
+  return (doodson_numbers * beta).unaryExpr([](double x) {
+    return normalize_angle(x);
+  });
 }
 
 }  // namespace perth
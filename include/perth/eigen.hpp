@@ -25,6 +25,10 @@ using Complex = std::complex<double>;
 /// library.
 using Vector3c = Eigen::Vector3<Complex>;
 
+/// @brief Type alias for a 3-dimensional vector using Eigen library, storing
+/// double precision values.
+using Vector3d = Eigen::Vector3d;
+
 /// @brief Type alias for a 3-dimensional vector using Eigen library.
 using Matrix3d = Eigen::Matrix3d;
 
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "perth/active_set.hpp"
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/inference.hpp"
+#include "perth/nodal_corrections.hpp"
+#include "perth/parallel_for.hpp"
+#include "perth/thread_pool.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+/// @brief Evaluate several tidal models at the same points, in one pass.
+///
+/// The astronomical arguments and the nodal corrections do not depend on the
+/// model: they are computed once per time for all the models. If the models
+/// share the same axes, the cell framing each point and its bilinear weights
+/// are also computed once. The result holds one column per model, equal to
+/// the result of Perth::evaluate() for this model.
+/// @tparam T The type of the real values of the models.
+template <typename T>
+class Ensemble {
+ public:
+  /// @brief Build an ensemble of models.
+  ///
+  /// The models, which may be shared with other predictors, are not
+  /// modified, see Perth::Perth().
+  /// @param[in] tidal_models The models evaluated, in the order of the
+  /// columns of the results.
+  /// @param[in] group_modulations Whether to apply the group modulations,
+  /// see Perth.
+  /// @throw std::invalid_argument If no model is given or if a model is
+  /// null.
+  explicit Ensemble(std::vector<std::shared_ptr<TidalModel<T>>> tidal_models,
+                    const bool group_modulations = false)
+      : tidal_models_(std::move(tidal_models)),
+        group_modulations_(group_modulations) {
+    if (tidal_models_.empty()) {
+      throw std::invalid_argument("The ensemble must contain a model");
+    }
+    for (const auto& item : tidal_models_) {
+      if (item == nullptr) {
+        throw std::invalid_argument("The models must not be null");
+      }
+      shared_axes_ = shared_axes_ && item->lon() == tidal_models_[0]->lon() &&
+                     item->lat() == tidal_models_[0]->lat();
+    }
+  }
+
+  /// @brief Evaluate the tide of each model at the given longitude, latitude,
+  /// and time.
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] time_tolerance Time difference, in days, within which the
+  /// astronomical arguments and the nodal corrections are not recomputed.
+  /// @param[in] interpolation_type Type of interpolation to use to compute
+  /// inferred constituents. If equal to std::nullopt, no inference is done.
+  /// @param[in] num_threads Number of threads to use for parallel computation.
+  /// If equal to 0, the number of threads is determined automatically.
+  /// @return A tuple containing the short-period tides, the long-period tides
+  /// and the quality flags, as matrices of shape (lon.size(), size()): the
+  /// k-th column holds the results of the k-th model.
+  /// @throw std::invalid_argument If the input vectors have different sizes,
+  /// are empty, or if the time tolerance is negative.
+  auto evaluate(
+      const Eigen::Ref<const Eigen::VectorXd>& lon,
+      const Eigen::Ref<const Eigen::VectorXd>& lat,
+      const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+      const double time_tolerance = 0,
+      const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+      const size_t num_threads = 0) const
+      -> std::tuple<Eigen::MatrixXd, Eigen::MatrixXd,
+                    Eigen::Matrix<int8_t, -1, -1>>;
+
+  /// @brief Tabulate the nodal corrections over a time span, see
+  /// Perth::tabulate_nodal_corrections().
+  auto tabulate_nodal_corrections(
+      const int64_t start, const int64_t end,
+      const std::optional<double>& step = std::nullopt) -> void {
+    nodal_correction_table_ = std::make_shared<const NodalCorrectionTable>(
+        epoch_to_modified_julian_date(start),
+        epoch_to_modified_julian_date(end),
+        step.value_or(group_modulations_ ? 0.125 : 1.0), group_modulations_,
+        assemble_constituent_table(tidal_models_[0]->identifiers())
+            .keys_vector());
+  }
+
+  /// @brief Use a series of Delta T (TT - UT) instead of the model of
+  /// calculate_delta_time(), see Perth::set_delta_time_series().
+  auto set_delta_time_series(
+      const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+      const Eigen::Ref<const Eigen::VectorXd>& delta) -> void {
+    auto days = std::vector<double>(static_cast<size_t>(time.size()));
+    for (size_t ix = 0; ix < days.size(); ++ix) {
+      days[ix] = epoch_to_modified_julian_date(time(static_cast<int64_t>(ix)));
+    }
+    delta_time_series_ = std::make_shared<const DeltaTimeSeries>(
+        std::move(days), std::vector<double>(delta.begin(), delta.end()));
+  }
+
+  /// @brief Select how the astronomical arguments are provided within the
+  /// time tolerance, see Perth::set_argument_mode().
+  auto set_argument_mode(const ArgumentMode mode) noexcept -> void {
+    argument_mode_ = mode;
+  }
+
+  /// @brief Get how the astronomical arguments are provided within the time
+  /// tolerance.
+  [[nodiscard]] constexpr auto argument_mode() const noexcept
+      -> ArgumentMode {
+    return argument_mode_;
+  }
+
+  /// @brief Get the number of models of the ensemble.
+  [[nodiscard]] auto size() const noexcept -> size_t {
+    return tidal_models_.size();
+  }
+
+  /// @brief True if all the models share the same axes, the cell framing
+  /// each point being then located once for all the models.
+  [[nodiscard]] constexpr auto shared_axes() const noexcept -> bool {
+    return shared_axes_;
+  }
+
+  /// @brief Get the models of the ensemble.
+  [[nodiscard]] constexpr auto tidal_models() const noexcept
+      -> const std::vector<std::shared_ptr<TidalModel<T>>>& {
+    return tidal_models_;
+  }
+
+ private:
+  /// @brief State of the evaluation of one model of the ensemble.
+  struct Member {
+    Member(const TidalModel<T>& tidal_model,
+           const std::optional<InterpolationType>& interpolation_type)
+        : tide_table(assemble_constituent_table(tidal_model.identifiers())),
+          acc(0, tide_table.size()),
+          inference(interpolation_type.has_value()
+                        ? new Inference(tide_table, *interpolation_type)
+                        : nullptr),
+          active_set(tide_table, inference.get()) {}
+
+    ConstituentTable tide_table;           ///< Tide table of the model
+    Accelerator acc;                       ///< Cache of the cells of the model
+    std::unique_ptr<Inference> inference;  ///< Inference, if any
+    ActiveSet active_set;                  ///< Constituents contributing
+  };
+
+  /// @brief State reused by the threads to evaluate the ensemble.
+  struct Context {
+    Context(const std::vector<std::shared_ptr<TidalModel<T>>>& tidal_models,
+            const double time_tolerance,
+            const std::optional<InterpolationType>& interpolation_type)
+        : arguments_table(
+              assemble_constituent_table(tidal_models[0]->identifiers())),
+          acc(time_tolerance, arguments_table.size()),
+          interpolation_type(interpolation_type) {
+      for (const auto& item : tidal_models) {
+        members.emplace_back(
+            std::make_unique<Member>(*item, interpolation_type));
+        num_constituents.push_back(item->size());
+      }
+    }
+
+    /// Table holding the tidal arguments shared by the models. The tables
+    /// of all the models have the same layout: only the tides and the
+    /// inferred flags differ.
+    ConstituentTable arguments_table;
+    /// Accelerator computing the astronomical arguments.
+    Accelerator acc;
+    /// State of each model.
+    std::vector<std::unique_ptr<Member>> members;
+    /// Interpolation type used by the inference.
+    std::optional<InterpolationType> interpolation_type;
+    /// Number of constituents of the models when the context was created.
+    std::vector<size_t> num_constituents;
+  };
+
+  std::vector<std::shared_ptr<TidalModel<T>>> tidal_models_;
+  bool group_modulations_{false};  ///< Whether to apply group modulations.
+  bool shared_axes_{true};         ///< Whether the models share their axes.
+  /// How the arguments are provided within the time tolerance.
+  ArgumentMode argument_mode_{ArgumentMode::kFrozen};
+  /// Nodal corrections tabulated over a time span, if any.
+  std::shared_ptr<const NodalCorrectionTable> nodal_correction_table_;
+  /// Series of Delta T used instead of the model, if any.
+  std::shared_ptr<const DeltaTimeSeries> delta_time_series_;
+
+  /// Contexts not in use, ready to be reused by the next evaluations.
+  mutable std::vector<std::unique_ptr<Context>> contexts_;
+  /// Protects the contexts.
+  mutable std::mutex mutex_;
+
+  /// @brief Get a context set up for the given parameters, reusing an idle
+  /// one if possible.
+  auto acquire_context(const double time_tolerance,
+                       const std::optional<InterpolationType>&
+                           interpolation_type) const
+      -> std::unique_ptr<Context>;
+
+  /// @brief Return a context to the set of idle contexts.
+  auto release_context(std::unique_ptr<Context> context) const -> void;
+};
+
+template <typename T>
+auto Ensemble<T>::acquire_context(
+    const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type) const
+    -> std::unique_ptr<Context> {
+  auto num_constituents = std::vector<size_t>();
+  for (const auto& item : tidal_models_) {
+    num_constituents.push_back(item->size());
+  }
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    for (auto it = contexts_.rbegin(); it != contexts_.rend(); ++it) {
+      auto& item = *it;
+      if (item->acc.time_tolerance() == time_tolerance &&
+          item->interpolation_type == interpolation_type &&
+          item->num_constituents == num_constituents) {
+        auto context = std::move(item);
+        contexts_.erase(std::next(it).base());
+        context->acc.nodal_correction_table(nodal_correction_table_);
+        context->acc.delta_time_series(delta_time_series_);
+        context->acc.argument_mode(argument_mode_);
+        return context;
+      }
+    }
+  }
+  auto context = std::make_unique<Context>(tidal_models_, time_tolerance,
+                                           interpolation_type);
+  context->acc.nodal_correction_table(nodal_correction_table_);
+  context->acc.delta_time_series(delta_time_series_);
+  context->acc.argument_mode(argument_mode_);
+  return context;
+}
+
+template <typename T>
+auto Ensemble<T>::release_context(std::unique_ptr<Context> context) const
+    -> void {
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  auto capacity = 2 * ThreadPool::num_threads();
+  if (contexts_.size() >= capacity) {
+    contexts_.erase(contexts_.begin(),
+                    contexts_.begin() + (contexts_.size() - capacity + 1));
+  }
+  contexts_.emplace_back(std::move(context));
+}
+
+template <typename T>
+auto Ensemble<T>::evaluate(
+    const Eigen::Ref<const Eigen::VectorXd>& lon,
+    const Eigen::Ref<const Eigen::VectorXd>& lat,
+    const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+    const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads) const
+    -> std::tuple<Eigen::MatrixXd, Eigen::MatrixXd,
+                  Eigen::Matrix<int8_t, -1, -1>> {
+  auto size = lon.size();
+  // Check that the input vectors have the same size.
+  if (size != lat.size() || size != time.size()) {
+    throw std::invalid_argument("Input vectors must have the same size");
+  }
+  // Check for empty input
+  if (size == 0) {
+    throw std::invalid_argument("Input vectors cannot be empty");
+  }
+  // Check for negative time tolerance
+  if (time_tolerance < 0) {
+    throw std::invalid_argument("Time tolerance must be non-negative");
+  }
+  const auto n_models = static_cast<Eigen::Index>(tidal_models_.size());
+  Eigen::MatrixXd tide = Eigen::MatrixXd::Zero(size, n_models);
+  Eigen::MatrixXd tide_lp = Eigen::MatrixXd::Zero(size, n_models);
+  Eigen::Matrix<int8_t, -1, -1> quality =
+      Eigen::Matrix<int8_t, -1, -1>::Zero(size, n_models);
+
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    auto context = acquire_context(time_tolerance, interpolation_type);
+    auto& members = context->members;
+
+    for (auto ix = static_cast<int64_t>(start);
+         ix < static_cast<int64_t>(end); ++ix) {
+      const auto x = lon(ix);
+      const auto y = lat(ix);
+      // The cell framing the point is located once if the axes are shared.
+      const auto stencil = shared_axes_ ? tidal_models_[0]->stencil(x, y)
+                                        : std::optional<Stencil>{};
+      auto defined = false;
+      for (Eigen::Index kx = 0; kx < n_models; ++kx) {
+        const auto& model = *tidal_models_[static_cast<size_t>(kx)];
+        auto& member = *members[static_cast<size_t>(kx)];
+        auto quality_value = Quality::kUndefined;
+        if (!shared_axes_) {
+          quality_value = model.interpolate(x, y, member.tide_table,
+                                            &member.acc);
+        } else if (stencil) {
+          quality_value = model.interpolate(*stencil, member.tide_table,
+                                            &member.acc);
+        }
+        quality(ix, kx) = static_cast<int8_t>(quality_value);
+        if (quality_value != Quality::kUndefined && member.inference) {
+          (*member.inference)(member.tide_table, y);
+        }
+        defined = defined || quality_value != Quality::kUndefined;
+      }
+      if (!defined) {
+        tide.row(ix).setConstant(std::numeric_limits<double>::quiet_NaN());
+        tide_lp.row(ix).setConstant(std::numeric_limits<double>::quiet_NaN());
+        continue;
+      }
+
+      // The astronomical arguments and the nodal corrections are shared by
+      // the models.
+      if (context->acc.update_args(epoch_to_modified_julian_date(time(ix)),
+                                   group_modulations_,
+                                   context->arguments_table)) {
+        for (auto& member : members) {
+          member->active_set.update(context->arguments_table,
+                                    context->acc.nodal_corrections());
+        }
+      }
+
+      for (Eigen::Index kx = 0; kx < n_models; ++kx) {
+        if (quality(ix, kx) == static_cast<int8_t>(Quality::kUndefined)) {
+          tide(ix, kx) = std::numeric_limits<double>::quiet_NaN();
+          tide_lp(ix, kx) = std::numeric_limits<double>::quiet_NaN();
+          continue;
+        }
+        auto& member = *members[static_cast<size_t>(kx)];
+        std::tie(tide(ix, kx), tide_lp(ix, kx)) =
+            member.active_set.evaluate(member.tide_table);
+      }
+    }
+    release_context(std::move(context));
+  };
+  parallel_for(worker, static_cast<size_t>(size), num_threads, 128);
+  return {tide, tide_lp, quality};
+}
+
+}  // namespace perth
@@ -5,23 +5,29 @@
 
 namespace perth {
 
+/// @brief Memory order of the elements of a grid.
+enum class GridOrder : uint8_t {
+  kRowMajor,     //!< The elements of a row are contiguous (x-major).
+  kColumnMajor,  //!< The elements of a column are contiguous (y-major).
+};
+
 /// @brief Handle a grid (2D array) stored in a 1D array.
 ///
+/// The memory order is known at compile time: the index of an element is
+/// computed from strides without any indirection, which lets the compiler
+/// inline and vectorize the accesses.
+///
 /// @tparam T The type of the grid values.
-template <typename T>
+/// @tparam Order The memory order of the grid.
+template <typename T, GridOrder Order = GridOrder::kRowMajor>
 class Grid {
  public:
   /// @brief Default constructor.
   /// @param[in] data The data of the grid.
   /// @param[in] nx The number of rows in the grid.
   /// @param[in] ny The number of columns in the grid.
-  /// @param[in] row_major Whether the data is stored in row-major order.
-  constexpr Grid(const T* data, size_t nx, size_t ny,
-                 bool row_major = true) noexcept
-      : nx_(nx),
-        ny_(ny),
-        data_(data),
-        get_index_(row_major ? &Grid::index_xy : &Grid::index_yx) {}
+  constexpr Grid(const T* data, size_t nx, size_t ny) noexcept
+      : nx_(nx), ny_(ny), data_(data) {}
 
   /// Get the value at the given coordinates.
   /// @param[in] x The x coordinate.
@@ -29,7 +35,49 @@ class Grid {
   /// @return The value at the given coordinates.
   constexpr auto operator()(const int64_t x, const int64_t y) const noexcept
       -> T {
-    return data_[(this->*get_index_)(x, y)];
+    return data_[index(x, y)];
+  }
+
+  /// Get the linear index of the element at the given coordinates.
+  /// @param[in] x The x coordinate.
+  /// @param[in] y The y coordinate.
+  /// @return The position of the element in the underlying 1D array.
+  constexpr auto index(const int64_t x, const int64_t y) const noexcept
+      -> int64_t {
+    return x * x_stride() + y * y_stride();
+  }
+
+  /// Get the distance between two consecutive rows in the underlying 1D
+  /// array.
+  /// @return The stride along the x axis.
+  constexpr auto x_stride() const noexcept -> int64_t {
+    if constexpr (Order == GridOrder::kRowMajor) {
+      return static_cast<int64_t>(ny_);
+    } else {
+      return 1;
+    }
+  }
+
+  /// Get the distance between two consecutive columns in the underlying 1D
+  /// array.
+  /// @return The stride along the y axis.
+  constexpr auto y_stride() const noexcept -> int64_t {
+    if constexpr (Order == GridOrder::kRowMajor) {
+      return 1;
+    } else {
+      return static_cast<int64_t>(nx_);
+    }
+  }
+
+  /// Get the y coordinate of the element at the given linear index.
+  /// @param[in] index The position of the element in the 1D array.
+  /// @return The y coordinate of the element.
+  constexpr auto y(const int64_t index) const noexcept -> int64_t {
+    if constexpr (Order == GridOrder::kRowMajor) {
+      return index % static_cast<int64_t>(ny_);
+    } else {
+      return index / static_cast<int64_t>(nx_);
+    }
   }
 
   /// Get the number of rows in the grid.
@@ -53,28 +101,12 @@ class Grid {
   constexpr auto data(const T* data) noexcept -> void { data_ = data; }
 
  private:
-  /// Typename to a function pointer for accessing an element of the grid.
-  using GetIndex = int64_t (Grid::*)(const int64_t, const int64_t) const;
   /// The number of rows in the grid.
   size_t nx_;
   /// The number of columns in the grid.
   size_t ny_;
   /// The data stored in the grid.
   const T* data_;
-  /// Pointer to the function for accessing an element of the grid.
-  GetIndex get_index_;
-
-  /// The index of the element at the given row and column if the grid is
-  /// stored in row-major order.
-  constexpr auto index_xy(const int64_t x, const int64_t y) const -> int64_t {
-    return x * ny_ + y;
-  }
-
-  /// The index of the element at the given row and column if the grid is
-  /// stored in column-major order.
-  constexpr auto index_yx(const int64_t x, const int64_t y) const -> int64_t {
-    return y * nx_ + x;
-  }
 };
 
 }  // namespace perth
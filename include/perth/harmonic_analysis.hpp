@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+/// @brief Result of a harmonic analysis.
+struct HarmonicAnalysisResult {
+  /// Complex constituents, in the order of the constituents analyzed and in
+  /// the unit of the samples. The real and imaginary parts are those of the
+  /// waves of a tidal model: a grid filled with the constituents analyzed at
+  /// each node can be given to TidalModel::add_constituent().
+  Eigen::VectorXcd constituents;
+  /// Mean of the samples not explained by the constituents, 0 if not
+  /// estimated.
+  double mean{0};
+  /// Root mean square of the residuals of the fit.
+  double residual_rms{0};
+  /// Number of samples used.
+  int64_t samples{0};
+};
+
+/// @brief Least-squares harmonic analysis of a time series, consistent with
+/// the prediction of the tide.
+///
+/// The samples are fitted by the sum, over the constituents analyzed, of
+/// `f * (Re(H) cos(V + u) + Im(H) sin(V + u))`, where V is the tidal argument
+/// and f, u the nodal corrections, computed as for the prediction (see
+/// Accelerator::update_args()), optionally with the group modulations. The
+/// normal equations are formed incrementally: the series can be given by
+/// chunks, in any order, and the memory used does not depend on its length.
+/// Each chunk is processed in parallel, and the analyses of disjoint parts of
+/// a series can be merged.
+class HarmonicAnalysis {
+ public:
+  /// @brief Prepare the analysis of a series.
+  /// @param[in] constituents The constituents to estimate.
+  /// @param[in] group_modulations Whether to apply the group modulations to
+  /// the nodal corrections, as Perth does.
+  /// @param[in] fit_mean Whether to estimate the mean of the samples along
+  /// with the constituents.
+  /// @param[in] time_tolerance Time tolerance of the astronomical arguments,
+  /// in days. The arguments of the samples within the tolerance are
+  /// extrapolated linearly (see ArgumentMode::kExtrapolated).
+  /// @throw std::invalid_argument If no constituent is given, if a
+  /// constituent is given twice, or if the tolerance is negative.
+  explicit HarmonicAnalysis(std::vector<Constituent> constituents,
+                            bool group_modulations = false,
+                            bool fit_mean = true, double time_tolerance = 0);
+
+  /// @brief Add samples of the series to the normal equations.
+  ///
+  /// The undefined samples, given as NaN, are ignored.
+  /// @param[in] time Times of the samples, in microseconds since the epoch.
+  /// @param[in] values Values of the samples.
+  /// @param[in] num_threads Number of threads to use. If 0, all the threads
+  /// of the pool may be used.
+  /// @throw std::invalid_argument If the vectors have different sizes.
+  auto accumulate(const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+                  const Eigen::Ref<const Eigen::VectorXd>& values,
+                  size_t num_threads = 0) -> void;
+
+  /// @brief Add the normal equations of another analysis, e.g. of another
+  /// part of the series.
+  /// @param[in] other The other analysis.
+  /// @throw std::invalid_argument If the analyses do not estimate the same
+  /// parameters, or differ by their corrections.
+  auto merge(const HarmonicAnalysis& other) -> void;
+
+  /// @brief Solve the normal equations formed.
+  /// @return The constituents estimated.
+  /// @throw std::runtime_error If the samples do not determine the
+  /// constituents, e.g. if the series is too short to separate them.
+  [[nodiscard]] auto solve() const -> HarmonicAnalysisResult;
+
+  /// @brief Use a series of Delta T instead of the model of
+  /// calculate_delta_time(), as Perth::set_delta_time_series() does.
+  /// @param[in] time Times of the series, in microseconds since the epoch,
+  /// strictly increasing.
+  /// @param[in] delta Delta T (TT - UT) at each time, in seconds.
+  /// @throw std::invalid_argument If the series is invalid.
+  auto set_delta_time_series(
+      const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+      const Eigen::Ref<const Eigen::VectorXd>& delta) -> void {
+    auto days = std::vector<double>(static_cast<size_t>(time.size()));
+    for (size_t ix = 0; ix < days.size(); ++ix) {
+      days[ix] = epoch_to_modified_julian_date(time(static_cast<int64_t>(ix)));
+    }
+    delta_time_series_ = std::make_shared<const DeltaTimeSeries>(
+        std::move(days), std::vector<double>(delta.begin(), delta.end()));
+  }
+
+  /// @brief Get the constituents estimated.
+  [[nodiscard]] auto constituents() const noexcept
+      -> const std::vector<Constituent>& {
+    return constituents_;
+  }
+
+  /// @brief Get the number of samples added.
+  [[nodiscard]] auto samples() const noexcept -> int64_t { return samples_; }
+
+  /// @brief Get the normal matrix formed, whose lower triangle is set. The
+  /// unknowns are the real and imaginary parts of the constituents, in this
+  /// order, followed by the mean if estimated.
+  [[nodiscard]] auto normal_matrix() const noexcept -> const Eigen::MatrixXd& {
+    return normal_matrix_;
+  }
+
+  /// @brief Get the right-hand side of the normal equations.
+  [[nodiscard]] auto normal_vector() const noexcept -> const Eigen::VectorXd& {
+    return normal_vector_;
+  }
+
+ private:
+  /// The constituents estimated.
+  std::vector<Constituent> constituents_;
+  /// Whether the group modulations are applied.
+  bool group_modulations_;
+  /// Whether the mean is estimated.
+  bool fit_mean_;
+  /// Time tolerance of the astronomical arguments.
+  double time_tolerance_;
+  /// Series of Delta T used instead of the model, if any.
+  std::shared_ptr<const DeltaTimeSeries> delta_time_series_;
+  /// Lower triangle of the normal matrix.
+  Eigen::MatrixXd normal_matrix_;
+  /// Right-hand side of the normal equations.
+  Eigen::VectorXd normal_vector_;
+  /// Sum of the squares of the samples.
+  double sum_squares_{0};
+  /// Number of samples added.
+  int64_t samples_{0};
+
+  /// Number of unknowns.
+  [[nodiscard]] auto unknowns() const noexcept -> Eigen::Index {
+    return static_cast<Eigen::Index>(2 * constituents_.size()) +
+           (fit_mean_ ? 1 : 0);
+  }
+};
+
+}  // namespace perth
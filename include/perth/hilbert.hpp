@@ -0,0 +1,47 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+namespace perth {
+
+/// @brief Get the number of bits of the coordinates of the Hilbert curve
+/// covering a grid.
+/// @param[in] size The largest dimension of the grid.
+/// @return The order of the smallest curve whose side is at least `size`.
+constexpr auto hilbert_order(const uint64_t size) noexcept -> uint32_t {
+  return size <= 1 ? 1 : static_cast<uint32_t>(std::bit_width(size - 1));
+}
+
+/// @brief Get the position of a cell along a Hilbert curve.
+///
+/// Consecutive positions along the curve are always neighboring cells, and
+/// the cells of a block of the grid have close positions: processing the
+/// points in the order of the curve keeps the cells they use in cache.
+/// @param[in] order The number of bits of the coordinates, see
+/// hilbert_order().
+/// @param[in] x The first coordinate of the cell, less than `2^order`.
+/// @param[in] y The second coordinate of the cell, less than `2^order`.
+/// @return The position of the cell along the curve.
+constexpr auto hilbert_index(const uint32_t order, uint32_t x,
+                             uint32_t y) noexcept -> uint64_t {
+  const auto side = uint64_t{1} << order;
+  auto index = uint64_t{0};
+  for (auto s = side >> 1; s > 0; s >>= 1) {
+    const auto rx = static_cast<uint32_t>((x & s) != 0);
+    const auto ry = static_cast<uint32_t>((y & s) != 0);
+    index += s * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant so that the curve is continuous.
+    if (ry == 0) {
+      if (rx == 1) {
+        x = static_cast<uint32_t>(side - 1 - x);
+        y = static_cast<uint32_t>(side - 1 - y);
+      }
+      std::swap(x, y);
+    }
+  }
+  return index;
+}
+
+}  // namespace perth
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include "perth/constituent.hpp"
 #include "perth/eigen.hpp"
@@ -23,12 +23,45 @@ class Inference {
   auto operator()(ConstituentTable& constituent_table,
                   const double lat = 0) const -> void;
 
+  /// @brief Get the constituents that can be computed by inference.
+  /// @return The constituents for which the inference writes the tide if they
+  /// are flagged as inferred in the constituent table.
+  [[nodiscard]] auto constituents() const -> std::vector<Constituent>;
+
+  /// @brief Get upper bounds of the moduli of the tides inferred.
+  ///
+  /// The tide of an inferred constituent is a linear combination of the
+  /// tides of the references: its modulus is bounded by the sum of the
+  /// bounds of the references weighted by the moduli of the admittance
+  /// coefficients. The equilibrium node tide, used if the node is inferred,
+  /// is bounded over all the latitudes.
+  /// @param[in] constituent_table The constituent table of the evaluation,
+  /// whose flags tell which references are inferred.
+  /// @param[in] bounds Bounds of the moduli of the tides provided by the
+  /// model, indexed by constituent; 0 for the constituents not provided.
+  /// @return The bounds of the tides of constituents(), in the same order.
+  [[nodiscard]] auto amplitude_bounds(const ConstituentTable& constituent_table,
+                                      const std::vector<double>& bounds) const
+      -> std::vector<double>;
+
+  /// @brief Stop computing the tides of the given constituents.
+  ///
+  /// The constituents are no longer returned by constituents(), and the
+  /// active sets built afterwards ignore them. The references dropped remain
+  /// used to infer the others.
+  /// @param[in] constituents The constituents to drop. The others are
+  /// ignored.
+  auto drop(const std::vector<Constituent>& constituents) -> void;
+
  private:
-  /// @brief Type for interpolation functions.
-  /// The function takes in the frequencies and amplitudes of three components
-  /// and returns a complex number representing the interpolated value.
-  using Interpolator = std::function<Complex(double, double, double, double,
-                                             double, double, double)>;
+  /// @brief Number of reference constituents from which the others are
+  /// inferred: Q1, O1, K1, N2, M2, S2, Node, Mm and Mf.
+  static constexpr Eigen::Index kNumReferences = 9;
+
+  /// @brief Factor 1 + k - h of the 18.6-year equilibrium node tide.
+  static constexpr double kNodeGamma2 = 0.682;
+  /// @brief Amplitude of the 18.6-year equilibrium node tide, in meters.
+  static constexpr double kNodeAmplitude = 0.0279;
 
   static std::unordered_map<Constituent, double>
       kInferredDiurnalConstituents_;  ///< Array of inferred diurnal
@@ -44,52 +77,22 @@ class Inference {
                                          ///< constituents with their
                                          ///< frequencies.
 
-  std::unordered_map<Constituent, std::pair<double, double>>
-      inferred_diurnal_;  ///< Inferred diurnal constituents with their
-                          ///< frequencies.
-  std::unordered_map<Constituent, std::pair<double, double>>
-      inferred_semidiurnal_;  ///< Inferred semidiurnal constituents with their
-                              ///< frequencies.
-  std::unordered_map<Constituent, std::pair<double, double>>
-      inferred_long_period_;  ///< Inferred long-period constituents with their
-                              ///< frequencies.
-
-  std::vector<Constituent> diurnal_keys_;  ///< Keys for diurnal constituents
-                                           ///< ordered by frequency.
-  std::vector<Constituent> semidiurnal_keys_;  ///< Keys for semidiurnal
-                                               ///< constituents ordered by
-                                               ///< frequency.
-  std::vector<Constituent> long_period_keys_;  ///< Keys for long-period
-                                               ///< constituents ordered by
-                                               ///< frequency.
-
-  double x1_;    ///< Frequency for the first component.
-  double x2_;    ///< Frequency for the second component.
-  double x3_;    ///< Frequency for the third component.
-  double x4_;    ///< Frequency for the first component (semidurnal).
-  double x5_;    ///< Frequency for the second component (semidurnal).
-  double x6_;    ///< Frequency for the third component (semidurnal).
-  double x7_;    ///< Frequency for the first component (long-period).
-  double x8_;    ///< Frequency for the second component (long-period).
-  double x9_;    ///< Frequency for the third component (long-period).
-  double amp1_;  ///< Amplitude for the first component.
-  double amp2_;  ///< Amplitude for the second component.
-  double amp3_;  ///< Amplitude for the third component.
-  double amp4_;  ///< Amplitude for the first component (semidurnal).
-  double amp5_;  ///< Amplitude for the second component (semidurnal).
-  double amp6_;  ///< Amplitude for the third component (semidurnal).
-  double amp7_;  ///< Amplitude for the first component (long-period).
-  double amp8_;  ///< Amplitude for the second component (long-period).
-  double amp9_;  ///< Amplitude for the third component (long-period).
-
-  std::function<Complex(double, const Complex&, double, const Complex&, double,
-                        const Complex&,
-                        double)>
-      interpolation_1_;  ///< Interpolation function to use.
-  std::function<Complex(double, const Complex&, double, const Complex&, double,
-                        const Complex&,
-                        double)>
-      interpolation_2_;  ///< Interpolation function to use for semidurnal
+  std::vector<Constituent> keys_;  ///< Inferred constituents: diurnal,
+                                   ///< semidiurnal, then long-period, each
+                                   ///< species ordered by frequency.
+  std::vector<ConstituentType> types_;  ///< Type of each inferred
+                                        ///< constituent.
+
+  /// Coefficients mapping the tides of the reference constituents to the
+  /// tide of each inferred constituent, one row per inferred constituent.
+  /// The admittance interpolation, the Love numbers and the amplitude ratios
+  /// only depend on the frequencies, and are folded into these coefficients
+  /// at construction.
+  Eigen::Matrix<double, -1, kNumReferences, Eigen::RowMajor> coefficients_;
+
+  /// @brief Build the coefficients of the interpolation type given.
+  template <InterpolationType Type>
+  auto build(const ConstituentTable& components) -> void;
 
   /// @brief Returns inphase/quad components of the 18.6-y equilibrium node
   /// tide. This is used only if inference is requested but the node tide is
@@ -99,11 +102,9 @@ class Inference {
   auto evaluate_node_tide(TideComponent& node, const double lat) const
       -> const Complex& {
     if (node.is_inferred) {
-      constexpr auto gamma2 = 0.682;
-      constexpr auto amplitude = 0.0279;  // m
       auto p20 = 0.5 - 1.5 * pow<2>(std::sin(radians(lat)));
-      auto xi = gamma2 * p20 * std::sqrt(1.25 / pi<double>());
-      node.tide = std::move(Complex(xi * amplitude, 0.0));
+      auto xi = kNodeGamma2 * p20 * std::sqrt(1.25 / pi<double>());
+      node.tide = std::move(Complex(xi * kNodeAmplitude, 0.0));
     }
     return node.tide;
   }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace perth {
+
+/// @brief Read-only view of the content of a file.
+///
+/// On POSIX systems, the file is memory-mapped: the pages are loaded on
+/// demand and shared by all the processes mapping the same file. On the other
+/// systems, the content of the file is read into memory.
+class MappedFile {
+ public:
+  /// @brief Map the given file.
+  /// @param[in] path Path to the file.
+  /// @throw std::runtime_error If the file cannot be opened or mapped.
+  explicit MappedFile(const std::string& path);
+
+  /// @brief Unmap the file.
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+  auto operator=(MappedFile&&) -> MappedFile& = delete;
+
+  /// @brief Get a pointer to the first byte of the file.
+  [[nodiscard]] auto data() const noexcept -> const std::byte* {
+    return data_;
+  }
+
+  /// @brief Get the size of the file in bytes.
+  [[nodiscard]] auto size() const noexcept -> size_t { return size_; }
+
+ private:
+  /// Pointer to the first byte of the file.
+  const std::byte* data_{nullptr};
+  /// Size of the file in bytes.
+  size_t size_{0};
+  /// Content of the file if it is not memory-mapped.
+  std::vector<std::byte> content_;
+};
+
+}  // namespace perth
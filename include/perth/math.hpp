@@ -3,6 +3,7 @@
 #include <cmath>
 #include <complex>
 #include <numbers>
+#include <tuple>
 
 #if defined(__GNUC__) && (__GNUC__ >= 11) || \
     defined(__clang__) && (__cplusplus >= 202303L)
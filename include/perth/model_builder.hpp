@@ -0,0 +1,222 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+/// @brief Fill the waves of an empty tidal model from the amplitudes and
+/// phases of its constituents, decoded block by block directly into the
+/// final storage of the model.
+///
+/// The waves are given as grids of `rows()` by `cols()` values, in the order
+/// given by the `row_major` flag of the model, e.g. as read from the files
+/// of the model. Each call to decode() converts a block of consecutive rows
+/// of one constituent: only the block read, and not the whole grid, is held
+/// in memory besides the model. The blocks of different constituents, or of
+/// different rows of a constituent, can be decoded concurrently by several
+/// threads. Once all the rows are decoded, build() hands the waves to the
+/// model, interleaved by grid node if the model uses the packed layout.
+/// @tparam T The type of the real values of the model: float or double.
+template <typename T>
+class ModelBuilder {
+ public:
+  /// Type of the values stored.
+  using value_type = typename TidalModel<T>::value_type;
+
+  static_assert(
+      std::is_same_v<value_type, typename TidalModel<T>::input_type>,
+      "The waves of a model storing scaled values are encoded from the whole "
+      "grid: build a float model, then convert it");
+
+  /// @brief Prepare the loading of a tidal model.
+  /// @param[in] model The model to fill, without constituents.
+  /// @param[in] identifiers The constituents to load.
+  /// @param[in] amplitude_factor Factor converting the amplitudes to the
+  /// unit of the model, e.g. 0.01 for amplitudes in centimeters and a model
+  /// in meters.
+  /// @param[in] phase_factor Factor converting the phases to radians, e.g.
+  /// pi / 180 for phases in degrees.
+  /// @throw std::invalid_argument If the model is null, already handles
+  /// constituents or is tiled, or if `identifiers` is empty or contains
+  /// duplicates.
+  ModelBuilder(std::shared_ptr<TidalModel<T>> model,
+               std::vector<Constituent> identifiers,
+               const double amplitude_factor = 1,
+               const double phase_factor = 1)
+      : model_(std::move(model)),
+        identifiers_(std::move(identifiers)),
+        amplitude_factor_(amplitude_factor),
+        phase_factor_(phase_factor) {
+    if (model_ == nullptr) {
+      throw std::invalid_argument("The model must not be null");
+    }
+    if (!model_->empty() || model_->tiled()) {
+      throw std::invalid_argument(
+          "The model must be an in-memory model without constituents");
+    }
+    if (identifiers_.empty()) {
+      throw std::invalid_argument("No constituent to load");
+    }
+    for (auto it = identifiers_.begin(); it != identifiers_.end(); ++it) {
+      if (std::find(std::next(it), identifiers_.end(), *it) !=
+          identifiers_.end()) {
+        throw std::invalid_argument("Duplicate constituent: " +
+                                    constituent_to_name(*it));
+      }
+    }
+    const auto row_major = model_->row_major();
+    rows_ = row_major ? model_->lon().size() : model_->lat().size();
+    cols_ = row_major ? model_->lat().size() : model_->lon().size();
+    waves_ = std::make_shared<Eigen::Vector<value_type, -1>>(
+        rows_ * cols_ * static_cast<int64_t>(identifiers_.size()));
+    rows_decoded_.resize(identifiers_.size());
+  }
+
+  /// @brief Get the number of rows of the grids of the waves.
+  [[nodiscard]] constexpr auto rows() const noexcept -> int64_t {
+    return rows_;
+  }
+
+  /// @brief Get the number of columns of the grids of the waves.
+  [[nodiscard]] constexpr auto cols() const noexcept -> int64_t {
+    return cols_;
+  }
+
+  /// @brief Get the constituents loaded.
+  [[nodiscard]] constexpr auto identifiers() const noexcept
+      -> const std::vector<Constituent>& {
+    return identifiers_;
+  }
+
+  /// @brief Decode a block of rows of the wave of a constituent.
+  ///
+  /// The values undefined are given as NaN. Two calls must not decode the
+  /// same rows of a constituent.
+  /// @param[in] index Index of the constituent in identifiers().
+  /// @param[in] first_row Index of the first row of the block.
+  /// @param[in] amplitude Amplitudes of the block, of shape (n, cols()).
+  /// @param[in] phase Phases of the block, of the same shape.
+  /// @throw std::invalid_argument If the index is out of range, if the
+  /// shapes of the blocks differ or if the block does not fit in the grid.
+  /// @throw std::runtime_error If the model is already built.
+  /// @tparam U The type of the values read.
+  template <typename U>
+  auto decode(
+      const size_t index, const int64_t first_row,
+      const Eigen::Ref<const Eigen::Matrix<U, -1, -1, Eigen::RowMajor>>&
+          amplitude,
+      const Eigen::Ref<const Eigen::Matrix<U, -1, -1, Eigen::RowMajor>>&
+          phase) -> void {
+    if (waves_ == nullptr) {
+      throw std::runtime_error("The model is already built");
+    }
+    if (index >= identifiers_.size()) {
+      throw std::invalid_argument("Constituent index out of range: " +
+                                  std::to_string(index));
+    }
+    if (amplitude.rows() != phase.rows() || amplitude.cols() != phase.cols()) {
+      throw std::invalid_argument(
+          "Amplitude and phase blocks must have the same shape");
+    }
+    if (amplitude.cols() != cols_ || first_row < 0 ||
+        first_row + amplitude.rows() > rows_) {
+      throw std::invalid_argument(
+          "The block does not fit in the grid: expected at most (" +
+          std::to_string(rows_ - std::max<int64_t>(first_row, 0)) + "x" +
+          std::to_string(cols_) + "), got (" +
+          std::to_string(amplitude.rows()) + "x" +
+          std::to_string(amplitude.cols()) + ")");
+    }
+    // Position of the first value of the block and step between two values
+    // of the wave.
+    const auto n = static_cast<int64_t>(identifiers_.size());
+    const auto ix = static_cast<int64_t>(index);
+    const auto first_node = first_row * cols_;
+    auto* target = waves_->data() + (model_->packed()
+                                         ? first_node * n + ix
+                                         : ix * rows_ * cols_ + first_node);
+    const auto stride = model_->packed() ? n : int64_t{1};
+    for (int64_t jx = 0; jx < amplitude.rows(); ++jx) {
+      for (int64_t kx = 0; kx < cols_; ++kx) {
+        // NaN propagates to both parts of the value.
+        const auto a = static_cast<double>(amplitude(jx, kx)) *
+                       amplitude_factor_;
+        const auto p = static_cast<double>(phase(jx, kx)) * phase_factor_;
+        *target = value_type(static_cast<T>(a * std::cos(p)),
+                             static_cast<T>(a * std::sin(p)));
+        target += stride;
+      }
+    }
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    rows_decoded_[index] += amplitude.rows();
+  }
+
+  /// @brief Hand the waves decoded to the model.
+  ///
+  /// Must not be called while blocks are being decoded.
+  /// @return The model filled.
+  /// @throw std::runtime_error If the waves are not entirely decoded, or if
+  /// the model is already built.
+  auto build() -> std::shared_ptr<TidalModel<T>> {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    if (waves_ == nullptr) {
+      throw std::runtime_error("The model is already built");
+    }
+    for (size_t ix = 0; ix < identifiers_.size(); ++ix) {
+      if (rows_decoded_[ix] != rows_) {
+        throw std::runtime_error(
+            "The wave of " + constituent_to_name(identifiers_[ix]) +
+            " is not entirely decoded: " + std::to_string(rows_decoded_[ix]) +
+            " rows out of " + std::to_string(rows_));
+      }
+    }
+    const auto* data = waves_->data();
+    auto keeper = std::shared_ptr<const void>(std::move(waves_));
+    if (model_->packed()) {
+      model_->assign_packed(identifiers_, data, std::move(keeper));
+    } else {
+      for (size_t ix = 0; ix < identifiers_.size(); ++ix) {
+        model_->add_constituent(identifiers_[ix],
+                                data + static_cast<int64_t>(ix) * rows_ * cols_,
+                                keeper);
+      }
+    }
+    return model_;
+  }
+
+ private:
+  /// The model filled.
+  std::shared_ptr<TidalModel<T>> model_;
+  /// The constituents loaded.
+  std::vector<Constituent> identifiers_;
+  /// Factor converting the amplitudes to the unit of the model.
+  double amplitude_factor_;
+  /// Factor converting the phases to radians.
+  double phase_factor_;
+  /// Shape of the grids of the waves.
+  int64_t rows_{0};
+  int64_t cols_{0};
+  /// The waves, in the layout of the model, until build() is called.
+  std::shared_ptr<Eigen::Vector<value_type, -1>> waves_;
+  /// Number of rows decoded of each constituent.
+  std::vector<int64_t> rows_decoded_;
+  /// Protects the counters of the rows decoded.
+  std::mutex mutex_;
+};
+
+}  // namespace perth
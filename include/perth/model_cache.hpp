@@ -0,0 +1,332 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/mapped_file.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+/// @brief Header of the binary files caching a tidal model.
+///
+/// The header is followed by the identifiers of the constituents, one byte
+/// each, then, if the values are scaled integers, by the scale factors of the
+/// constituents, one double each, and by the waves starting at
+/// `data_offset`. In the packed layout,
+/// the values of all the constituents of a grid node are contiguous. In the
+/// planar layout, the wave of the constituent `k` starts at
+/// `data_offset + k * wave_stride`. All the values are stored in the native
+/// byte order and aligned on kModelCacheAlignment bytes, so that the file
+/// can be memory-mapped and used in place.
+struct ModelCacheHeader {
+  char magic[8];            ///< "PERTHTM" followed by a null character
+  uint32_t version;         ///< Version of the format
+  uint32_t byte_order;      ///< 0x01020304 in the byte order of the writer
+  uint32_t value_size;      ///< Size of the real values: 2, 4 or 8 bytes
+  uint32_t n_constituents;  ///< Number of constituents
+  uint8_t row_major;        ///< Whether the waves are longitude-major
+  uint8_t packed;           ///< Whether the constituents are interleaved
+  uint8_t lon_periodic;     ///< Whether the longitude axis is periodic
+  uint8_t lat_periodic;     ///< Whether the latitude axis is periodic
+  uint32_t scaled;          ///< Whether the values are scaled integers
+  int64_t lon_size;         ///< Number of longitudes
+  double lon_start;         ///< First longitude
+  double lon_step;          ///< Step between two longitudes
+  int64_t lat_size;         ///< Number of latitudes
+  double lat_start;         ///< First latitude
+  double lat_step;          ///< Step between two latitudes
+  uint64_t data_offset;     ///< Offset of the first wave, in bytes
+  uint64_t wave_stride;     ///< Offset between two planar waves, in bytes
+};
+
+/// Alignment, in bytes, of the waves stored in a model cache.
+constexpr size_t kModelCacheAlignment = 64;
+
+/// @brief Build the header of a model cache.
+/// @param[in] lon Longitude axis.
+/// @param[in] lat Latitude axis.
+/// @param[in] row_major Whether the waves are longitude-major.
+/// @param[in] packed Whether the constituents are interleaved.
+/// @param[in] value_size Size of the real values.
+/// @param[in] n_constituents Number of constituents.
+/// @param[in] scaled Whether the values are integers scaled by a factor per
+/// constituent.
+auto make_model_cache_header(const Axis& lon, const Axis& lat,
+                             bool row_major, bool packed, size_t value_size,
+                             size_t n_constituents, bool scaled = false)
+    -> ModelCacheHeader;
+
+/// @brief Get the size of a model cache, in bytes.
+/// @param[in] header The header of the model cache.
+auto model_cache_size(const ModelCacheHeader& header) -> uint64_t;
+
+/// @brief Read and check the header of a model cache held in memory.
+/// @param[in] data Pointer to the first byte of the model cache.
+/// @param[in] size Number of bytes available.
+/// @throw std::runtime_error If the memory does not hold a valid model
+/// cache.
+auto read_model_cache_header(const std::byte* data, size_t size)
+    -> ModelCacheHeader;
+
+/// @brief Read and check the header of a model cache.
+/// @param[in] file The mapped model cache.
+/// @throw std::runtime_error If the file is not a valid model cache.
+auto read_model_cache_header(const MappedFile& file) -> ModelCacheHeader;
+
+/// @brief Get the size of the real values stored in a model cache.
+/// @param[in] path Path to the model cache.
+/// @return 2 for a model stored on 16 bits, 4 for a model in single
+/// precision, 8 for double precision.
+/// @throw std::runtime_error If the file is not a valid model cache.
+auto model_cache_value_size(const std::string& path) -> size_t;
+
+/// @brief Read the scale factors of the constituents of a model cache.
+/// @param[in] file The mapped model cache.
+/// @param[in] header The header of the model cache.
+/// @return The scale factors, or an empty vector if the values are not
+/// scaled.
+auto read_model_cache_scales(const MappedFile& file,
+                             const ModelCacheHeader& header)
+    -> std::vector<double>;
+
+/// @brief Read the scale factors of the constituents of a model cache held
+/// in memory.
+/// @param[in] data Pointer to the first byte of the model cache.
+/// @param[in] header The header of the model cache.
+/// @return The scale factors, or an empty vector if the values are not
+/// scaled.
+auto read_model_cache_scales(const std::byte* data,
+                             const ModelCacheHeader& header)
+    -> std::vector<double>;
+
+/// @brief Write a model cache.
+/// @param[in] path Path to the model cache. The file is written under a
+/// temporary name and renamed once complete.
+/// @param[in] header Header of the model cache.
+/// @param[in] identifiers Constituents stored in the model cache.
+/// @param[in] scales Scale factors of the constituents, written if the values
+/// are scaled.
+/// @param[in] write_wave Function writing the values of a wave at the current
+/// position of the stream. Called with the index of the constituent in the
+/// planar layout, or once with the index 0 in the packed layout to write all
+/// the values.
+auto write_model_cache(
+    const std::string& path, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void;
+
+/// @brief Write a model cache at the current position of a stream.
+/// @param[in,out] stream Stream receiving the model cache. The offsets of
+/// the header are relative to its current position, which must be 0.
+/// @param[in] header See write_model_cache().
+/// @param[in] identifiers See write_model_cache().
+/// @param[in] scales See write_model_cache().
+/// @param[in] write_wave See write_model_cache().
+auto write_model_cache(
+    std::ostream& stream, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void;
+
+/// @brief Write a model cache into a block of memory.
+/// @param[out] data Pointer to the first byte of the block.
+/// @param[in] size Size of the block, at least model_cache_size(header).
+/// @param[in] header See write_model_cache().
+/// @param[in] identifiers See write_model_cache().
+/// @param[in] scales See write_model_cache().
+/// @param[in] write_wave See write_model_cache().
+/// @throw std::runtime_error If the block is too small.
+auto write_model_cache(
+    std::byte* data, size_t size, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void;
+
+/// @brief Build the header of the model cache of a tidal model.
+/// @param[in] model The tidal model.
+/// @param[in] packed Whether the constituents are stored interleaved by grid
+/// node. If not given, the layout of the model is used.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto make_model_cache_header(const TidalModel<T>& model,
+                             const std::optional<bool>& packed = std::nullopt)
+    -> ModelCacheHeader {
+  return make_model_cache_header(
+      model.lon(), model.lat(), model.row_major(),
+      packed.value_or(model.packed()), WaveStorage<T>::kValueSize,
+      model.size(), WaveStorage<T>::kScaled);
+}
+
+/// @brief Write the model cache of a tidal model with a writer of model
+/// caches, e.g. into a file or a block of memory.
+/// @param[in] model The tidal model.
+/// @param[in] header The header of the model cache, see
+/// make_model_cache_header().
+/// @param[in] writer Function called with the arguments of
+/// write_model_cache() following the destination.
+/// @tparam T The type of the real values of the model.
+template <typename T, typename Writer>
+auto write_model_cache(const TidalModel<T>& model,
+                       const ModelCacheHeader& header, const Writer& writer)
+    -> void {
+  using value_type = typename TidalModel<T>::value_type;
+  const auto identifiers = model.identifiers();
+  const auto n_nodes = model.lon().size() * model.lat().size();
+  // Number of values gathered before being written.
+  constexpr auto kBlockSize = int64_t{1} << 16;
+  auto block = std::vector<value_type>();
+  auto waves = std::vector<decltype(model.wave(0))>();
+  auto scales = std::vector<double>();
+  for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+    waves.emplace_back(model.wave(ix));
+    scales.push_back(model.scale(ix));
+  }
+
+  auto write = [&](std::ostream& stream) {
+    stream.write(
+        reinterpret_cast<const char*>(block.data()),
+        static_cast<std::streamsize>(block.size() * sizeof(value_type)));
+    block.clear();
+  };
+
+  writer(header, identifiers, scales,
+         [&](std::ostream& stream, const size_t ix) {
+           if (header.packed != 0) {
+             for (int64_t node = 0; node < n_nodes; ++node) {
+               for (const auto& wave : waves) {
+                 block.push_back(wave(node));
+               }
+               if (static_cast<int64_t>(block.size()) >= kBlockSize) {
+                 write(stream);
+               }
+             }
+           } else {
+             for (int64_t node = 0; node < n_nodes; ++node) {
+               block.push_back(waves[ix](node));
+               if (static_cast<int64_t>(block.size()) >= kBlockSize) {
+                 write(stream);
+               }
+             }
+           }
+           write(stream);
+         });
+}
+
+/// @brief Save a tidal model in the binary model cache format.
+/// @param[in] model The tidal model to save.
+/// @param[in] path Path to the model cache.
+/// @param[in] packed Whether the constituents are stored interleaved by grid
+/// node. If not given, the layout of the model is used.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto save_model_cache(const TidalModel<T>& model, const std::string& path,
+                      const std::optional<bool>& packed = std::nullopt)
+    -> void {
+  write_model_cache(
+      model, make_model_cache_header(model, packed),
+      [&path](const ModelCacheHeader& header,
+              const std::vector<Constituent>& identifiers,
+              const std::vector<double>& scales,
+              const std::function<void(std::ostream&, size_t)>& write_wave) {
+        write_model_cache(path, header, identifiers, scales, write_wave);
+      });
+}
+
+/// @brief Build a tidal model using in place the waves of a model cache held
+/// in memory.
+/// @param[in] data Pointer to the first byte of the model cache, aligned on
+/// kModelCacheAlignment bytes.
+/// @param[in] size Number of bytes available.
+/// @param[in] keeper Object keeping the memory alive. The model holds a
+/// reference on it as long as it uses the waves.
+/// @return The tidal model.
+/// @throw std::runtime_error If the memory does not hold a valid model
+/// cache.
+/// @throw std::invalid_argument If the model cache does not store values of
+/// type T.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto read_model_cache(const std::byte* data, const size_t size,
+                      std::shared_ptr<const void> keeper)
+    -> std::shared_ptr<TidalModel<T>> {
+  using value_type = typename TidalModel<T>::value_type;
+  const auto header = read_model_cache_header(data, size);
+  if (header.value_size != WaveStorage<T>::kValueSize ||
+      (header.scaled != 0) != WaveStorage<T>::kScaled) {
+    throw std::invalid_argument(
+        "The model cache stores " +
+        std::string(header.scaled != 0 ? "scaled values" : "values") +
+        " of " + std::to_string(header.value_size) +
+        " bytes, which do not match the type of the model");
+  }
+  auto scales = read_model_cache_scales(data, header);
+  auto identifiers = std::vector<Constituent>(header.n_constituents);
+  const auto* ids = data + sizeof(ModelCacheHeader);
+  std::transform(ids, ids + header.n_constituents, identifiers.begin(),
+                 [](const std::byte item) {
+                   return static_cast<Constituent>(item);
+                 });
+
+  auto axis = [](const int64_t size, const double start, const double step,
+                 const bool is_periodic) -> Axis {
+    return Axis(Eigen::VectorXd::LinSpaced(
+                    size, start, start + static_cast<double>(size - 1) * step),
+                1e-6, is_periodic);
+  };
+  auto model = std::make_shared<TidalModel<T>>(
+      axis(header.lon_size, header.lon_start, header.lon_step,
+           header.lon_periodic != 0),
+      axis(header.lat_size, header.lat_start, header.lat_step,
+           header.lat_periodic != 0),
+      header.row_major != 0, header.packed != 0);
+
+  const auto* waves = data + header.data_offset;
+  if (header.packed != 0) {
+    model->assign_packed(identifiers,
+                         reinterpret_cast<const value_type*>(waves),
+                         std::move(keeper), std::move(scales));
+  } else {
+    for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+      model->add_constituent(
+          identifiers[ix],
+          reinterpret_cast<const value_type*>(waves + ix * header.wave_stride),
+          keeper, scales.empty() ? 1.0 : scales[ix]);
+    }
+  }
+  return model;
+}
+
+/// @brief Load a tidal model from a binary model cache.
+///
+/// The file is memory-mapped and the model uses the waves in place: loading
+/// does not depend on the size of the model, and the pages of the file are
+/// shared by all the processes loading it. The mapping is released with the
+/// model.
+/// @param[in] path Path to the model cache.
+/// @return The tidal model.
+/// @throw std::runtime_error If the file is not a valid model cache.
+/// @throw std::invalid_argument If the model cache does not store values of
+/// type T.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto load_model_cache(const std::string& path)
+    -> std::shared_ptr<TidalModel<T>> {
+  auto file = std::make_shared<const MappedFile>(path);
+  return read_model_cache<T>(file->data(), file->size(), file);
+}
+
+}  // namespace perth
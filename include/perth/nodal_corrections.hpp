@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "perth/constituent.hpp"
+#include "perth/eigen.hpp"
 
 namespace perth {
 
@@ -64,4 +66,129 @@ auto compute_nodal_corrections(double perihelion, double omega, double perigee,
                                const std::vector<Constituent> &constituents)
     -> std::vector<NodalCorrections>;
 
+/// @brief Computes the nodal corrections from the astronomical variables.
+/// @param celestial_vector Doodson's 6 astronomical variables, as returned by
+/// calculate_celestial_vector.
+/// @param group_modulations If true, the corrections account for the
+/// sidelines within the tidal groups.
+/// @param constituents A vector of constituents for which to compute
+/// corrections.
+/// @return A vector of NodalCorrections containing the computed corrections for
+/// each constituent.
+inline auto compute_nodal_corrections(
+    const Vector6d &celestial_vector, const bool group_modulations,
+    const std::vector<Constituent> &constituents)
+    -> std::vector<NodalCorrections> {
+  const auto perigee = celestial_vector(3);
+  const auto omega = -celestial_vector(4);
+  if (group_modulations) {
+    return compute_nodal_corrections(celestial_vector(5), omega, perigee,
+                                     celestial_vector(2), constituents);
+  }
+  return compute_nodal_corrections(omega, perigee, constituents);
+}
+
+/// @brief Bounds of the nodal corrections of the constituents and of their
+/// rates of change, over the cycles of the lunar node and perigee.
+struct NodalCorrectionBounds {
+  /// Largest modulation factor of each constituent, indexed by constituent.
+  std::vector<double> f;
+  /// Largest rate of change of the modulation factor, per day.
+  std::vector<double> f_rate;
+  /// Largest rate of change of the phase correction, in radians per day.
+  std::vector<double> u_rate;
+};
+
+/// @brief Get the bounds of the nodal corrections of all the constituents.
+///
+/// The corrections are sampled daily over twenty years around J2000, more
+/// than a cycle of the lunar node, and the rates are estimated by the
+/// differences between consecutive samples: the corrections vary over
+/// months at least, the samples resolve their extrema. The bounds are
+/// widened by a margin covering the combinations of the cycles not sampled.
+/// They are computed the first time they are requested.
+/// @param group_modulations If true, the bounds of the corrections
+/// accounting for the sidelines within the tidal groups.
+/// @return The bounds, indexed by constituent.
+auto nodal_correction_bounds(bool group_modulations)
+    -> const NodalCorrectionBounds &;
+
+/// @brief Nodal corrections tabulated over a time span.
+///
+/// The standard nodal corrections vary with the 8.85-year and 18.6-year
+/// cycles of the lunar perigee and node: they are smooth enough to be
+/// computed once on a regular time grid, with a step of one day, and
+/// interpolated in between by cubic (Catmull-Rom) interpolation. The group
+/// modulations also depend on the longitude of the sun and vary within a
+/// day: they require a step of a few hours.
+class NodalCorrectionTable {
+ public:
+  /// @brief Tabulate the nodal corrections.
+  /// @param start First time of the span, in decimal Modified Julian Days.
+  /// @param end Last time of the span, in decimal Modified Julian Days.
+  /// @param step Step between two tabulated times, in days.
+  /// @param group_modulations If true, the corrections account for the
+  /// sidelines within the tidal groups.
+  /// @param constituents The constituents for which to compute corrections.
+  /// @throw std::invalid_argument If the span is empty or the step is not
+  /// positive.
+  NodalCorrectionTable(double start, double end, double step,
+                       bool group_modulations,
+                       std::vector<Constituent> constituents);
+
+  /// @brief True if the time lies within the tabulated span.
+  [[nodiscard]] constexpr auto contains(const double time) const noexcept
+      -> bool {
+    return time >= start_ && time <= end_;
+  }
+
+  /// @brief Interpolate the nodal corrections at the given time.
+  /// @param time Time in decimal Modified Julian Days, within the tabulated
+  /// span.
+  /// @param corrections The corrections of the tabulated constituents,
+  /// resized if needed.
+  auto interpolate(double time, std::vector<NodalCorrections> &corrections)
+      const -> void;
+
+  /// @brief Get the first time of the span.
+  [[nodiscard]] constexpr auto start() const noexcept -> double {
+    return start_;
+  }
+
+  /// @brief Get the last time of the span.
+  [[nodiscard]] constexpr auto end() const noexcept -> double { return end_; }
+
+  /// @brief Get the step between two tabulated times.
+  [[nodiscard]] constexpr auto step() const noexcept -> double {
+    return step_;
+  }
+
+  /// @brief True if the corrections account for the group modulations.
+  [[nodiscard]] constexpr auto group_modulations() const noexcept -> bool {
+    return group_modulations_;
+  }
+
+  /// @brief Get the tabulated constituents.
+  [[nodiscard]] auto constituents() const noexcept
+      -> const std::vector<Constituent> & {
+    return constituents_;
+  }
+
+ private:
+  /// First time of the span.
+  double start_;
+  /// Last time of the span.
+  double end_;
+  /// Step between two tabulated times.
+  double step_;
+  /// Number of tabulated times.
+  int64_t size_;
+  /// Whether the corrections account for the group modulations.
+  bool group_modulations_;
+  /// Tabulated constituents.
+  std::vector<Constituent> constituents_;
+  /// Corrections of all the constituents at each tabulated time.
+  std::vector<NodalCorrections> values_;
+};
+
 }  // namespace perth
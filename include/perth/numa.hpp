@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace perth {
+
+/// @brief Parse a list of CPUs in the format of the Linux kernel, e.g.
+/// "0-3,8,10-11".
+/// @param[in] list The list to parse.
+/// @return The CPUs of the list, in increasing order.
+/// @throw std::invalid_argument If the list is malformed.
+auto parse_cpu_list(const std::string& list) -> std::vector<size_t>;
+
+/// @brief Get the CPUs of each NUMA node of the machine.
+///
+/// The topology is read once, from `/sys/devices/system/node`. If it is not
+/// available, e.g. on another system than Linux, the machine is described as
+/// a single node holding all the CPUs.
+/// @return The CPUs of the nodes, indexed by the number of the node. The
+/// nodes without CPU are omitted.
+auto numa_nodes() -> const std::vector<std::vector<size_t>>&;
+
+/// @brief Get the NUMA node on which the calling thread runs.
+///
+/// A thread pinned by pin_thread_to_numa_node() returns the node it is
+/// pinned to, without querying the system.
+/// @return The index of the node in numa_nodes(), 0 if unknown.
+auto current_numa_node() -> size_t;
+
+/// @brief Restrict the calling thread to the CPUs of a NUMA node.
+///
+/// The memory first written by the thread is then allocated on this node by
+/// the default policy of the system.
+/// @param[in] node Index of the node in numa_nodes().
+/// @return True if the thread was pinned, false if the system does not
+/// support it.
+/// @throw std::out_of_range If the node does not exist.
+auto pin_thread_to_numa_node(size_t node) -> bool;
+
+/// @brief Run a function in a thread pinned to a NUMA node, and wait for it.
+///
+/// The memory allocated and initialized by the function is local to the
+/// node.
+/// @param[in] node Index of the node in numa_nodes().
+/// @param[in] function Function to run.
+/// @throw The exception thrown by the function, if any.
+template <typename Function>
+auto run_on_numa_node(const size_t node, Function&& function) -> void {
+  auto exception = std::exception_ptr{};
+  auto thread = std::thread([&]() -> void {
+    try {
+      pin_thread_to_numa_node(node);
+      function();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+  });
+  thread.join();
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace perth
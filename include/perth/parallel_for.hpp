@@ -1,32 +1,116 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
-#include <exception>
-#include <thread>
-#include <vector>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "perth/thread_pool.hpp"
 
 namespace perth {
 
+/// @brief Cost of the items of a parallel loop, measured over its previous
+/// runs.
+///
+/// The cost sizes the blocks of the next runs: large enough for the time
+/// spent claiming a block to be negligible, small enough for the threads to
+/// balance uneven loads, and only as many threads as the work deserves.
+class LoopCost {
+ public:
+  /// Duration of the work of a block aimed at, in nanoseconds.
+  static constexpr double kTargetBlockTime = 50'000;
+
+  /// @brief Get the mean time spent per item, in nanoseconds, or 0 if the
+  /// loop has never been measured.
+  [[nodiscard]] auto get() const noexcept -> double {
+    return ns_per_item_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief Account for a run of the loop.
+  /// @param[in] elapsed Time spent in the worker, summed over the threads,
+  /// in nanoseconds.
+  /// @param[in] size Number of items processed.
+  auto update(const double elapsed, const size_t size) noexcept -> void {
+    if (size == 0) {
+      return;
+    }
+    const auto measured = elapsed / static_cast<double>(size);
+    const auto previous = get();
+    // The mean is smoothed to absorb the noise of small runs.
+    ns_per_item_.store(
+        previous == 0 ? measured : 0.75 * previous + 0.25 * measured,
+        std::memory_order_relaxed);
+  }
+
+  /// @brief Choose the number of lanes and the grain of a run of the loop.
+  /// @param[in] size Number of items to process.
+  /// @param[in] num_threads Maximum number of threads.
+  /// @param[in] min_size Minimum number of items of a block.
+  /// @return The number of lanes and the minimum number of items of a block.
+  [[nodiscard]] auto schedule(const size_t size, const size_t num_threads,
+                              const size_t min_size) const noexcept
+      -> std::pair<size_t, size_t> {
+    const auto cost = get();
+    auto grain = min_size;
+    if (cost > 0) {
+      grain = std::max(grain,
+                       static_cast<size_t>(std::ceil(kTargetBlockTime / cost)));
+    }
+    // A thread is only worth it if it has at least one block to process.
+    const auto num_lanes =
+        std::clamp<size_t>((size + grain - 1) / grain, 1, num_threads);
+    if (cost == 0) {
+      // Not measured yet: over-decompose so that idle threads have blocks
+      // to claim.
+      grain = std::max(min_size, size / (num_lanes * 8));
+    }
+    return {num_lanes, grain};
+  }
+
+ private:
+  /// Mean time spent per item, in nanoseconds.
+  std::atomic<double> ns_per_item_{0};
+};
+
 /// Automates the cutting of vectors to be processed in thread.
 ///
-/// @param[in] worker Lambda function called in each thread launched. Lambda
-/// function must have the following signature:
+/// The computation is distributed over the threads of the pool shared by the
+/// process (see ThreadPool::instance()), the calling thread taking part in it.
+/// The threads claim contiguous blocks of the vectors whose size decreases as
+/// the vectors are consumed (see ThreadPool::parallel_for()): the worker may
+/// therefore be called several times by the same thread. The time spent in
+/// the worker is measured at each call, per type of worker, i.e. per call
+/// site: the next calls size the blocks from the mean cost of an item (see
+/// LoopCost) and use fewer threads if the work is too small to be shared.
+///
+/// @param[in] worker Lambda function called to process a block of the vectors.
+/// Lambda function must have the following signature:
 /// @code
 /// void worker(size_t start, size_t stop);
 /// @endcode
 /// @param[in] size Size of all vectors to be processed
-/// @param[in] num_threads The number of threads to use for the computation. If
-/// 0 all CPUs are used. If 1 is given, no parallel computing code is used at
-/// all, which is useful for debugging.
+/// @param[in] num_threads The maximum number of threads to use for the
+/// computation. If 0 all the threads of the pool may be used. If 1 is given,
+/// no parallel computing code is used at all, which is useful for debugging.
 /// @param[in] min_size The minimum size of the vector to be processed in
 /// parallel. If the size is less than this value, the vector is processed
-/// sequentially. Default is 1.
+/// sequentially. It is also the minimum size of the blocks processed by the
+/// worker. Default is 1.
 /// @tparam Lambda Lambda function
 template <typename Lambda>
 void parallel_for(Lambda worker, size_t size, size_t num_threads,
                   size_t min_size = 1) {
+  using Clock = std::chrono::steady_clock;
+  // Cost of the items of the loops running this worker.
+  static auto cost = LoopCost{};
+
+  auto pool = ThreadPool::instance();
   if (num_threads == 0) {
-    num_threads = std::thread::hardware_concurrency();
+    num_threads = pool->size() + 1;
   }
 
   // If only one thread is requested or size is small, execute directly
@@ -35,48 +119,24 @@ void parallel_for(Lambda worker, size_t size, size_t num_threads,
     return;
   }
 
-  // List of threads responsible for parallelizing the calculation
-  std::vector<std::thread> threads;
-  std::exception_ptr exception = nullptr;
-
-  // Access index to the vectors required for calculation
-  size_t shift = size / num_threads;
-  size_t remainder = size % num_threads;
-
-  threads.reserve(num_threads);
-
-  size_t start = 0;
-
-  // Launch threads
-  for (size_t ix = 0; ix < num_threads; ++ix) {
-    size_t end = start + shift + (ix < remainder ? 1 : 0);
-
-    // Capture worker by value or move if necessary.
-    threads.emplace_back([worker, start, end, &exception]() mutable {
-      try {
-        worker(start, end);
-      } catch (...) {
-        // Capture the last exception encountered and store it.
-        // This avoids handling concurrency issues between threads.
-        // The exception will be rethrown after all threads have completed.
-        exception = std::current_exception();
-      }
-    });
-
-    start = end;
-  }
-
-  // Join threads
-  for (auto& thread : threads) {
-    if (thread.joinable()) {
-      thread.join();
-    }
-  }
-
-  // Rethrow the last exception caught
-  if (exception) {
-    std::rethrow_exception(exception);
+  const auto [num_lanes, grain] = cost.schedule(size, num_threads, min_size);
+  auto elapsed = std::atomic<int64_t>{0};
+  auto timed_worker = [&worker, &elapsed](const size_t start,
+                                          const size_t end) -> void {
+    const auto begin = Clock::now();
+    worker(start, end);
+    elapsed.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          Clock::now() - begin)
+                          .count(),
+                      std::memory_order_relaxed);
+  };
+  if (num_lanes == 1) {
+    timed_worker(0, size);
+  } else {
+    pool->parallel_for(std::function<void(size_t, size_t)>(timed_worker), size,
+                       num_lanes, grain);
   }
+  cost.update(static_cast<double>(elapsed.load()), size);
 }
 
 }  // namespace perth
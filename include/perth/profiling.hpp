@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace perth {
+
+/// True if the library is built with the profiling counters, i.e. with the
+/// PERTH_ENABLE_PROFILING definition. Otherwise, the code updating the
+/// counters is discarded at compile time.
+#ifdef PERTH_ENABLE_PROFILING
+constexpr bool kProfiling = true;
+#else
+constexpr bool kProfiling = false;
+#endif
+
+/// @brief Stages of the evaluation of the tide at a point.
+enum Stage : uint8_t {
+  kInterpolationStage,  //!< Interpolation of the model
+  kInferenceStage,      //!< Inference of the minor constituents
+  kArgumentsStage,      //!< Astronomical arguments and nodal corrections
+  kSummationStage,      //!< Harmonic summation
+  kNumStages,           //!< Number of stages
+};
+
+/// @brief Counters describing an evaluation of the tide.
+///
+/// The counters are only updated if the library is built with profiling
+/// enabled (see kProfiling); otherwise they remain zero.
+struct EvaluationStats {
+  /// Number of points evaluated.
+  int64_t points{};
+  /// Number of points per quality flag, indexed by the value of the flag.
+  std::array<int64_t, 5> quality{};
+  /// Number of interpolations whose grid cell was found in the accelerator.
+  int64_t cell_hits{};
+  /// Number of interpolations whose grid cell was read from the model.
+  int64_t cell_misses{};
+  /// Number of updates of the astronomical arguments.
+  int64_t argument_updates{};
+  /// Time spent in each stage, in nanoseconds, summed over the threads.
+  std::array<int64_t, kNumStages> elapsed{};
+
+  /// @brief Add the counters of another evaluation.
+  constexpr auto operator+=(const EvaluationStats& other) noexcept
+      -> EvaluationStats& {
+    points += other.points;
+    for (size_t ix = 0; ix < quality.size(); ++ix) {
+      quality[ix] += other.quality[ix];
+    }
+    cell_hits += other.cell_hits;
+    cell_misses += other.cell_misses;
+    argument_updates += other.argument_updates;
+    for (size_t ix = 0; ix < elapsed.size(); ++ix) {
+      elapsed[ix] += other.elapsed[ix];
+    }
+    return *this;
+  }
+};
+
+/// @brief Measure the time spent in a stage, from its construction to its
+/// destruction. Does nothing if the profiling is disabled.
+class StageTimer {
+ public:
+  /// @brief Start the measurement.
+  /// @param stats Counters receiving the time measured.
+  /// @param stage Stage measured.
+  StageTimer(EvaluationStats& stats, const Stage stage) noexcept {
+    if constexpr (kProfiling) {
+      elapsed_ = &stats.elapsed[stage];
+      start_ = Clock::now();
+    }
+  }
+
+  /// @brief Add the time elapsed to the counters of the stage.
+  ~StageTimer() {
+    if constexpr (kProfiling) {
+      *elapsed_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now() - start_)
+                       .count();
+    }
+  }
+
+  StageTimer(const StageTimer&) = delete;
+  auto operator=(const StageTimer&) -> StageTimer& = delete;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  /// Counter of the stage.
+  int64_t* elapsed_{nullptr};
+  /// Time of the start of the measurement.
+  Clock::time_point start_{};
+};
+
+}  // namespace perth
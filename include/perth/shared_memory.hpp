@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/model_cache.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+/// @brief Segment of POSIX shared memory mapped in the address space of the
+/// process.
+///
+/// A segment is created under a name by one process, then attached by name
+/// by the other processes, e.g. the workers of a multiprocessing pool, which
+/// map the same physical pages. The name is removed from the system when the
+/// object that created the segment is destroyed: the processes attached keep
+/// their mapping, but the segment can no longer be attached.
+class SharedMemory {
+ public:
+  /// @brief Create a segment, mapped for writing.
+  /// @param[in] name Name of the segment. A leading slash is added if
+  /// missing; the name must not contain any other slash.
+  /// @param[in] size Size of the segment in bytes.
+  /// @throw std::invalid_argument If the name is invalid.
+  /// @throw std::runtime_error If the segment exists already or cannot be
+  /// created, or if the system does not support shared memory.
+  SharedMemory(const std::string& name, size_t size);
+
+  /// @brief Attach an existing segment, mapped read-only.
+  /// @param[in] name Name of the segment, see above.
+  /// @throw std::invalid_argument If the name is invalid.
+  /// @throw std::runtime_error If the segment does not exist or cannot be
+  /// mapped, or if the system does not support shared memory.
+  explicit SharedMemory(const std::string& name);
+
+  /// @brief Unmap the segment, and remove it if it was created by this
+  /// object.
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory(SharedMemory&&) = delete;
+  auto operator=(const SharedMemory&) -> SharedMemory& = delete;
+  auto operator=(SharedMemory&&) -> SharedMemory& = delete;
+
+  /// @brief Get a pointer to the first byte of the segment.
+  [[nodiscard]] auto data() const noexcept -> const std::byte* {
+    return data_;
+  }
+
+  /// @brief Get a pointer to the first byte of the segment, to write it.
+  /// @throw std::logic_error If the segment is attached read-only.
+  [[nodiscard]] auto mutable_data() -> std::byte*;
+
+  /// @brief Get the size of the segment in bytes.
+  [[nodiscard]] auto size() const noexcept -> size_t { return size_; }
+
+  /// @brief Get the name of the segment, starting with a slash.
+  [[nodiscard]] auto name() const noexcept -> const std::string& {
+    return name_;
+  }
+
+  /// @brief True if the segment was created by this object.
+  [[nodiscard]] auto owner() const noexcept -> bool { return owner_; }
+
+  /// @brief Remove a segment from the system, e.g. left behind by a process
+  /// that crashed.
+  /// @param[in] name Name of the segment, see above.
+  /// @return True if the segment existed.
+  static auto remove(const std::string& name) -> bool;
+
+ private:
+  /// Name of the segment.
+  std::string name_;
+  /// Pointer to the first byte of the segment.
+  std::byte* data_{nullptr};
+  /// Size of the segment in bytes.
+  size_t size_{0};
+  /// True if the segment was created by this object.
+  bool owner_{false};
+};
+
+/// @brief Copy the waves of a tidal model into a new segment of shared
+/// memory, in the format of the model caches.
+///
+/// The model returned uses the waves of the segment in place. Other
+/// processes build the same model, without copy, with attach_model(): all
+/// the processes share one physical copy of the waves. The segment is
+/// removed from the system once the model returned, and its copies, are
+/// released.
+/// @param[in] model The tidal model to share.
+/// @param[in] name Name of the segment, see SharedMemory.
+/// @param[in] packed Whether the constituents are stored interleaved by grid
+/// node. If not given, the layout of the model is used.
+/// @return The model using the waves of the segment.
+/// @throw std::runtime_error If the segment cannot be created.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto share_model(const TidalModel<T>& model, const std::string& name,
+                 const std::optional<bool>& packed = std::nullopt)
+    -> std::shared_ptr<TidalModel<T>> {
+  const auto header = make_model_cache_header(model, packed);
+  auto segment = std::make_shared<SharedMemory>(
+      name, static_cast<size_t>(model_cache_size(header)));
+  write_model_cache(
+      model, header,
+      [&segment](const ModelCacheHeader& header,
+                 const std::vector<Constituent>& identifiers,
+                 const std::vector<double>& scales,
+                 const std::function<void(std::ostream&, size_t)>& write_wave) {
+        write_model_cache(segment->mutable_data(), segment->size(), header,
+                          identifiers, scales, write_wave);
+      });
+  auto result = read_model_cache<T>(segment->data(), segment->size(), segment);
+  result->set_shared_memory(segment->name());
+  return result;
+}
+
+/// @brief Build a tidal model from the waves of a segment of shared memory
+/// created by share_model(), without copying them.
+/// @param[in] segment The segment attached.
+/// @return The model using the waves of the segment.
+/// @throw std::runtime_error If the segment does not hold a model.
+/// @throw std::invalid_argument If the segment does not store values of
+/// type T.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto attach_model(std::shared_ptr<const SharedMemory> segment)
+    -> std::shared_ptr<TidalModel<T>> {
+  const auto* data = segment->data();
+  const auto size = segment->size();
+  const auto name = segment->name();
+  auto result = read_model_cache<T>(data, size, std::move(segment));
+  result->set_shared_memory(name);
+  return result;
+}
+
+/// @brief Build a tidal model from the waves of a segment of shared memory
+/// created by share_model(), without copying them.
+/// @param[in] name Name of the segment.
+/// @return The model using the waves of the segment.
+/// @throw std::runtime_error If the segment does not exist or does not hold
+/// a model.
+/// @throw std::invalid_argument If the segment does not store values of
+/// type T.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+auto attach_model(const std::string& name) -> std::shared_ptr<TidalModel<T>> {
+  return attach_model<T>(std::make_shared<const SharedMemory>(name));
+}
+
+}  // namespace perth
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace perth {
+
+/// @brief Compute the sine and cosine of an array of angles.
+///
+/// The angles are reduced to [-π/4, π/4] by a three-part Cody-Waite
+/// reduction and the sine and cosine are evaluated by minimax polynomials,
+/// without branches, so that the loop is vectorized. The kernel is compiled
+/// for several instruction sets (AVX-512, AVX2, baseline SSE2/NEON) and the
+/// best one available is selected at runtime.
+///
+/// The error is within a few ulp of std::sin and std::cos for angles whose
+/// magnitude is less than 10^6 radians, e.g. the phases of the harmonic
+/// summation. Beyond, the accuracy of the reduction degrades.
+///
+/// @param[in] x The angles, in radians.
+/// @param[in] n The number of angles.
+/// @param[out] sin The sines of the angles (n elements).
+/// @param[out] cos The cosines of the angles (n elements).
+auto sincos(const double* x, size_t n, double* sin, double* cos) noexcept
+    -> void;
+
+}  // namespace perth
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace perth {
+
+/// @brief Storage of the waves of a tidal model in IEEE 754 half precision.
+///
+/// The relative resolution of the values is 2^-11, i.e. 0.5 mm for a one
+/// meter amplitude.
+struct Float16 {};
+
+/// @brief Storage of the waves of a tidal model as 16-bit integers, scaled
+/// by a factor per constituent.
+///
+/// The resolution of the values is the largest absolute value of the wave
+/// divided by 32767, i.e. 0.15 mm for a five meter wave.
+struct Int16 {};
+
+/// @brief Complex value stored as two 16-bit words.
+/// @tparam W The type of the words.
+template <typename W>
+struct Complex16 {
+  W real;  ///< Real part
+  W imag;  ///< Imaginary part
+};
+
+/// @brief Convert a single precision value to its half precision binary
+/// representation, rounding to the nearest even value.
+/// @param[in] value The value to convert.
+/// @return The binary16 representation of the value.
+constexpr auto float_to_half(const float value) noexcept -> uint16_t {
+  const auto bits = std::bit_cast<uint32_t>(value);
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000U);
+  const auto magnitude = bits & 0x7fffffffU;
+  // NaN and infinity
+  if (magnitude >= 0x7f800000U) {
+    return static_cast<uint16_t>(sign | 0x7c00U |
+                                 (magnitude > 0x7f800000U ? 0x0200U : 0U));
+  }
+  // Overflow: rounded to infinity
+  if (magnitude >= 0x477ff000U) {
+    return static_cast<uint16_t>(sign | 0x7c00U);
+  }
+  // Normal values
+  if (magnitude >= 0x38800000U) {
+    const auto rounded = magnitude + 0x00000fffU + ((magnitude >> 13) & 1U);
+    return static_cast<uint16_t>(sign | ((rounded - 0x38000000U) >> 13));
+  }
+  // Subnormal values, or zero
+  if (magnitude < 0x33000000U) {
+    return sign;
+  }
+  const auto exponent = magnitude >> 23;
+  const auto mantissa = (magnitude & 0x007fffffU) | 0x00800000U;
+  const auto shift = 126U - exponent;
+  const auto half = mantissa >> shift;
+  const auto remainder = mantissa & ((1U << shift) - 1U);
+  const auto midpoint = 1U << (shift - 1U);
+  const auto round_up =
+      remainder > midpoint || (remainder == midpoint && (half & 1U) != 0);
+  return static_cast<uint16_t>(sign | (half + (round_up ? 1U : 0U)));
+}
+
+/// @brief Convert a half precision binary representation to a single
+/// precision value.
+///
+/// The conversion has no branch, so that the loops decoding the waves are
+/// vectorized: the exponent is rebiased and the mantissa shifted in place,
+/// the subnormal values being normalized by an exact subtraction.
+/// @param[in] bits The binary16 representation of the value.
+/// @return The value.
+constexpr auto half_to_float(const uint16_t bits) noexcept -> float {
+  // 2^-14, the smallest normal half precision value.
+  constexpr auto kSmallestNormal = std::bit_cast<float>(113U << 23);
+  const auto sign = static_cast<uint32_t>(bits & 0x8000U) << 16;
+  const auto magnitude = static_cast<uint32_t>(bits & 0x7fffU) << 13;
+  const auto exponent = magnitude & 0x0f800000U;
+  // Masks selecting the infinity and NaN, and the subnormal values. The
+  // selections are computed with bitwise operations, which the compilers
+  // vectorize where they would not convert conditional expressions.
+  const auto special = 0U - static_cast<uint32_t>(exponent == 0x0f800000U);
+  const auto tiny = 0U - static_cast<uint32_t>(exponent == 0);
+  // Rebias the exponent from 15 to 127; infinity and NaN keep the largest
+  // one.
+  const auto normal = magnitude + (112U << 23) + (special & (112U << 23));
+  // A subnormal value m 2^-24 is 2^-14 (1 + m 2^-10) - 2^-14.
+  const auto subnormal = std::bit_cast<uint32_t>(
+      std::bit_cast<float>(magnitude + (113U << 23)) - kSmallestNormal);
+  return std::bit_cast<float>(sign | (tiny & subnormal) | (~tiny & normal));
+}
+
+/// @brief Describe how the waves of a tidal model are stored.
+///
+/// The waves are given to the model as values of type `input_type`, stored
+/// as values of type `value_type` and decoded in double precision by the
+/// interpolation.
+/// @tparam T The type of the real values of the model: float, double,
+/// Float16 or Int16.
+template <typename T>
+struct WaveStorage {
+  /// Type of the values stored.
+  using value_type = std::complex<T>;
+  /// Type of the values given to the model.
+  using input_type = std::complex<T>;
+  /// Size of the real and imaginary parts stored, in bytes.
+  static constexpr size_t kValueSize = sizeof(T);
+  /// Whether the values are scaled by a factor per constituent.
+  static constexpr bool kScaled = false;
+
+  /// @brief Get the scale factor suitable to encode the given values.
+  static auto scale(const input_type* /*values*/, const size_t /*size*/)
+      -> double {
+    return 1;
+  }
+
+  /// @brief Encode a value.
+  static constexpr auto encode(const input_type& value,
+                               const double /*scale*/) noexcept
+      -> value_type {
+    return value;
+  }
+
+  /// @brief Decode a value.
+  static constexpr auto decode(const value_type& value,
+                               const double /*scale*/) noexcept
+      -> std::complex<double> {
+    return {static_cast<double>(value.real()),
+            static_cast<double>(value.imag())};
+  }
+};
+
+/// @brief Half precision storage.
+template <>
+struct WaveStorage<Float16> {
+  using value_type = Complex16<uint16_t>;
+  using input_type = std::complex<float>;
+  static constexpr size_t kValueSize = sizeof(uint16_t);
+  static constexpr bool kScaled = false;
+
+  static auto scale(const input_type* /*values*/, const size_t /*size*/)
+      -> double {
+    return 1;
+  }
+
+  static constexpr auto encode(const input_type& value,
+                               const double /*scale*/) noexcept
+      -> value_type {
+    return {float_to_half(value.real()), float_to_half(value.imag())};
+  }
+
+  static constexpr auto decode(const value_type& value,
+                               const double /*scale*/) noexcept
+      -> std::complex<double> {
+    return {static_cast<double>(half_to_float(value.real)),
+            static_cast<double>(half_to_float(value.imag))};
+  }
+};
+
+/// @brief Scaled 16-bit integer storage. The undefined values are stored as
+/// the smallest integer.
+template <>
+struct WaveStorage<Int16> {
+  using value_type = Complex16<int16_t>;
+  using input_type = std::complex<float>;
+  static constexpr size_t kValueSize = sizeof(int16_t);
+  static constexpr bool kScaled = true;
+
+  /// Integer representing an undefined value.
+  static constexpr int16_t kUndefined = std::numeric_limits<int16_t>::min();
+  /// Largest integer representing a defined value.
+  static constexpr double kMaximum = std::numeric_limits<int16_t>::max();
+
+  /// @brief Get the scale factor mapping the largest absolute value of the
+  /// real and imaginary parts to the largest integer.
+  static auto scale(const input_type* values, const size_t size) -> double {
+    auto maximum = 0.0;
+    for (size_t ix = 0; ix < size; ++ix) {
+      const auto& value = values[ix];
+      if (std::isfinite(value.real()) && std::isfinite(value.imag())) {
+        maximum = std::max({maximum, std::abs(static_cast<double>(value.real())),
+                            std::abs(static_cast<double>(value.imag()))});
+      }
+    }
+    return maximum == 0 ? 1 : maximum / kMaximum;
+  }
+
+  static auto encode(const input_type& value, const double scale) noexcept
+      -> value_type {
+    if (!std::isfinite(value.real()) || !std::isfinite(value.imag())) {
+      return {kUndefined, kUndefined};
+    }
+    auto quantize = [scale](const float item) -> int16_t {
+      return static_cast<int16_t>(std::clamp(
+          std::round(static_cast<double>(item) / scale), -kMaximum, kMaximum));
+    };
+    return {quantize(value.real()), quantize(value.imag())};
+  }
+
+  static constexpr auto decode(const value_type& value,
+                               const double scale) noexcept
+      -> std::complex<double> {
+    if (value.real == kUndefined) {
+      return {std::numeric_limits<double>::quiet_NaN(),
+              std::numeric_limits<double>::quiet_NaN()};
+    }
+    return {value.real * scale, value.imag * scale};
+  }
+};
+
+}  // namespace perth
+
+namespace Eigen {
+
+/// Allow the storage of the 16-bit complex values in Eigen containers.
+template <typename W>
+struct NumTraits<perth::Complex16<W>>
+    : GenericNumTraits<perth::Complex16<W>> {
+  using Real = perth::Complex16<W>;
+  using NonInteger = perth::Complex16<W>;
+  using Literal = perth::Complex16<W>;
+  using Nested = perth::Complex16<W>;
+  enum {
+    IsComplex = 0,
+    IsInteger = 0,
+    IsSigned = 1,
+    RequireInitialization = 0,
+    ReadCost = 1,
+    AddCost = 1,
+    MulCost = 1
+  };
+};
+
+}  // namespace Eigen
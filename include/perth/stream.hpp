@@ -0,0 +1,227 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "perth/inference.hpp"
+#include "perth/tide.hpp"
+
+namespace perth {
+
+/// @brief Queue of bounded capacity, shared by producers and consumers
+/// running in different threads.
+///
+/// A producer pushing into a full queue waits until a consumer pops an item:
+/// the memory held by the queue is bounded by its capacity.
+/// @tparam Item The type of the items queued.
+template <typename Item>
+class BoundedQueue {
+ public:
+  /// @brief Build an empty queue.
+  /// @param[in] capacity Maximum number of items queued.
+  /// @throw std::invalid_argument If the capacity is zero.
+  explicit BoundedQueue(const size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("The capacity of the queue must be positive");
+    }
+  }
+
+  /// @brief Queue an item, waiting while the queue is full.
+  /// @param[in] item The item to queue.
+  /// @return False if the queue is closed, in which case the item is
+  /// dropped.
+  auto push(Item item) -> bool {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    not_full_.wait(lock,
+                   [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    items_.emplace_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// @brief Dequeue the oldest item, waiting while the queue is empty.
+  /// @return The item, or std::nullopt if the queue is closed and drained.
+  auto pop() -> std::optional<Item> {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+    auto item = std::optional<Item>(std::move(items_.front()));
+    items_.pop_front();
+    not_full_.notify_one();
+    return item;
+  }
+
+  /// @brief Close the queue: the next pushes fail, the items queued remain
+  /// to be popped.
+  auto close() -> void {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    closed_ = true;
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  /// @brief Close the queue and drop the items queued.
+  auto cancel() -> void {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    closed_ = true;
+    items_.clear();
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  /// @brief Get the number of items queued.
+  [[nodiscard]] auto size() const -> size_t {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return items_.size();
+  }
+
+ private:
+  size_t capacity_;                    ///< Maximum number of items queued
+  std::deque<Item> items_;             ///< Items queued, oldest first
+  bool closed_{false};                 ///< True if the queue is closed
+  mutable std::mutex mutex_;           ///< Protects the state of the queue
+  std::condition_variable not_full_;   ///< Signaled when an item is popped
+  std::condition_variable not_empty_;  ///< Signaled when an item is pushed
+};
+
+/// @brief Chunk of points read from a granule.
+struct Chunk {
+  Eigen::VectorXd lon;              ///< Longitudes in degrees
+  Eigen::VectorXd lat;              ///< Latitudes in degrees
+  Eigen::Vector<int64_t, -1> time;  ///< Times in microseconds since the epoch
+};
+
+/// @brief Tides evaluated at the points of a chunk.
+struct ChunkTides {
+  Eigen::VectorXd tide;               ///< Short-period tides
+  Eigen::VectorXd tide_lp;            ///< Long-period tides
+  Eigen::Vector<int8_t, -1> quality;  ///< Quality flags
+};
+
+/// @brief Function returning the next chunk to evaluate, or std::nullopt
+/// once all the chunks have been read.
+using ChunkSource = std::function<std::optional<Chunk>()>;
+
+/// @brief Function receiving the index of a chunk, in the order of the
+/// source, the chunk and the tides evaluated at its points.
+using ChunkSink = std::function<void(size_t, Chunk&&, ChunkTides&&)>;
+
+/// @brief Evaluate the tide over a stream of chunks, overlapping the reading
+/// of the chunks, their evaluation and the writing of the results.
+///
+/// The chunks are read from the source in a dedicated thread, evaluated in
+/// the calling thread by Perth::evaluate(), on the thread pool, and handed
+/// to the sink, in the order of the source, in another dedicated thread.
+/// While a chunk is evaluated, the next ones are read and the previous ones
+/// written. The reader waits when `max_pending` chunks are waiting to be
+/// evaluated, and the evaluation when `max_pending` results are waiting to
+/// be written: at most `2 * max_pending + 3` chunks are held in memory.
+///
+/// If the source, the evaluation or the sink throws an exception, the
+/// pipeline stops: the chunks pending are dropped, and the exception is
+/// rethrown once the two threads have finished.
+/// @param[in] perth The tidal predictor used.
+/// @param[in] source Source of the chunks, called from the reader thread.
+/// @param[in] sink Sink of the results, called from the writer thread.
+/// @param[in] max_pending Maximum number of chunks waiting, between two
+/// stages of the pipeline.
+/// @param[in] time_tolerance See Perth::evaluate().
+/// @param[in] interpolation_type See Perth::evaluate().
+/// @param[in] num_threads See Perth::evaluate().
+/// @return The number of chunks evaluated.
+/// @throw std::invalid_argument If `max_pending` is zero, or for any chunk
+/// rejected by Perth::evaluate().
+template <typename T>
+auto evaluate_stream(
+    const Perth<T>& perth, const ChunkSource& source, const ChunkSink& sink,
+    const size_t max_pending = 2, const double time_tolerance = 0,
+    const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+    const size_t num_threads = 0) -> size_t {
+  auto chunks = BoundedQueue<std::pair<size_t, Chunk>>(max_pending);
+  auto results =
+      BoundedQueue<std::tuple<size_t, Chunk, ChunkTides>>(max_pending);
+
+  // First exception thrown by a stage of the pipeline.
+  auto error = std::exception_ptr{};
+  auto error_mutex = std::mutex{};
+  auto fail = [&]() -> void {
+    {
+      auto lock = std::lock_guard<std::mutex>(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    chunks.cancel();
+    results.cancel();
+  };
+
+  auto reader = std::thread([&]() -> void {
+    try {
+      for (size_t index = 0;; ++index) {
+        auto chunk = source();
+        if (!chunk || !chunks.push({index, std::move(*chunk)})) {
+          break;
+        }
+      }
+    } catch (...) {
+      fail();
+    }
+    chunks.close();
+  });
+  auto writer = std::thread([&]() -> void {
+    try {
+      while (auto item = results.pop()) {
+        auto& [index, chunk, tides] = *item;
+        sink(index, std::move(chunk), std::move(tides));
+      }
+    } catch (...) {
+      fail();
+    }
+  });
+
+  auto count = size_t{0};
+  try {
+    while (auto item = chunks.pop()) {
+      auto& [index, chunk] = *item;
+      auto [tide, tide_lp, quality] =
+          perth.evaluate(chunk.lon, chunk.lat, chunk.time, time_tolerance,
+                         interpolation_type, num_threads);
+      if (!results.push({index, std::move(chunk),
+                         ChunkTides{std::move(tide), std::move(tide_lp),
+                                    std::move(quality)}})) {
+        break;
+      }
+      ++count;
+    }
+  } catch (...) {
+    fail();
+  }
+  // Stop the reader if the evaluation ended early, and let the writer drain
+  // the results.
+  chunks.cancel();
+  results.close();
+  reader.join();
+  writer.join();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return count;
+}
+
+}  // namespace perth
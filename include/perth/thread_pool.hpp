@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace perth {
+
+/// @brief Persistent pool of worker threads with work stealing.
+///
+/// Each worker owns a queue of tasks. A worker takes tasks from the back of
+/// its own queue and, when it is empty, steals tasks from the front of the
+/// queues of the other workers. A process-wide instance is shared by all the
+/// parallel computations of the library, so that the threads are created
+/// once instead of on every call.
+class ThreadPool {
+ public:
+  /// @brief Task executed by the pool.
+  using Task = std::function<void()>;
+
+  /// @brief Create a pool.
+  /// @param[in] num_workers Number of worker threads.
+  /// @param[in] pin_threads If true, the workers are pinned to the NUMA
+  /// nodes of the machine, spread evenly over them (see numa_nodes()), so
+  /// that they keep on reading the memory local to their node.
+  explicit ThreadPool(size_t num_workers, bool pin_threads = false);
+
+  /// @brief Wait for the queued tasks to complete and stop the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+  auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+  /// @brief Get the number of worker threads.
+  [[nodiscard]] auto size() const noexcept -> size_t {
+    return threads_.size();
+  }
+
+  /// @brief True if the workers are pinned to the NUMA nodes.
+  [[nodiscard]] constexpr auto pinned() const noexcept -> bool {
+    return pinned_;
+  }
+
+  /// @brief Queue a task for execution.
+  /// @param[in] task The task to execute.
+  auto submit(Task task) -> void;
+
+  /// @brief Execute a function in the pool without waiting for it.
+  ///
+  /// The function runs in a worker: the parallel loops it starts share the
+  /// pool with the other computations instead of creating threads. If the
+  /// pool has no worker, the function is executed before returning.
+  /// @param[in] function The function to execute.
+  /// @return The future holding the result of the function, or the
+  /// exception it has thrown.
+  template <typename Function>
+  auto async(Function function)
+      -> std::future<std::invoke_result_t<Function&>> {
+    using Result = std::invoke_result_t<Function&>;
+    // A task must be copyable, a packaged task is not.
+    auto task =
+        std::make_shared<std::packaged_task<Result()>>(std::move(function));
+    auto future = task->get_future();
+    submit([task]() -> void { (*task)(); });
+    return future;
+  }
+
+  /// @brief Execute a function in the pool, then hand its result to a
+  /// continuation.
+  ///
+  /// As async(), the continuation being called by the worker with the
+  /// future, ready, of the function. It must not throw.
+  /// @param[in] function The function to execute.
+  /// @param[in] then The continuation called with the result.
+  template <typename Function, typename Continuation>
+  auto async(Function function, Continuation then) -> void {
+    using Result = std::invoke_result_t<Function&>;
+    struct State {
+      std::packaged_task<Result()> task;
+      Continuation then;
+    };
+    auto state = std::make_shared<State>(
+        State{std::packaged_task<Result()>(std::move(function)),
+              std::move(then)});
+    submit([state]() -> void {
+      auto future = state->task.get_future();
+      state->task();
+      state->then(std::move(future));
+    });
+  }
+
+  /// @brief Process the range [0, size) in parallel.
+  ///
+  /// The range is processed by `num_lanes` lanes: the calling thread runs
+  /// the first one while the others are queued in the pool. The lanes claim
+  /// contiguous blocks of items from a shared atomic counter, each block
+  /// holding half of the remaining items divided by the number of lanes,
+  /// but at least `grain` items: the blocks shrink as the range is consumed,
+  /// so that the lanes finish together even if the items have uneven costs.
+  /// The function returns when the whole range has been processed.
+  ///
+  /// @param[in] worker Function called with the bounds [start, end) of each
+  /// block processed.
+  /// @param[in] size Number of items to process.
+  /// @param[in] num_lanes Number of lanes processing the range concurrently.
+  /// @param[in] grain Minimum number of items of a block, except for the
+  /// last one.
+  /// @throw The last exception thrown by the worker, after the whole range
+  /// has been processed.
+  auto parallel_for(const std::function<void(size_t, size_t)>& worker,
+                    size_t size, size_t num_lanes, size_t grain) -> void;
+
+  /// @brief Get the pool shared by the process.
+  ///
+  /// The pool is created on first use with `hardware_concurrency() - 1`
+  /// workers, the calling thread taking part in the computations.
+  static auto instance() -> std::shared_ptr<ThreadPool>;
+
+  /// @brief Set the number of threads used by the pool shared by the
+  /// process.
+  ///
+  /// The computations in progress complete on the previous pool, which is
+  /// released once they are done.
+  /// @param[in] num_threads Number of threads taking part in the
+  /// computations, including the calling thread. If 0, all CPUs are used.
+  /// @param[in] pin_threads If true, the workers are pinned to the NUMA
+  /// nodes of the machine.
+  static auto set_num_threads(size_t num_threads, bool pin_threads = false)
+      -> void;
+
+  /// @brief Get the number of threads taking part in the computations of
+  /// the pool shared by the process, including the calling thread.
+  static auto num_threads() -> size_t;
+
+ private:
+  /// @brief Queue of tasks owned by a worker.
+  struct Queue {
+    std::mutex mutex;        ///< Protects the tasks.
+    std::deque<Task> tasks;  ///< Queued tasks.
+  };
+
+  /// Queues of the workers.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  /// Worker threads.
+  std::vector<std::thread> threads_;
+  /// Protects the sleeping state of the workers.
+  std::mutex mutex_;
+  /// Signaled when a task is queued or the pool stops.
+  std::condition_variable condition_;
+  /// Number of tasks queued and not yet started.
+  std::atomic<size_t> pending_{0};
+  /// Index of the next queue used to submit a task from outside the pool.
+  std::atomic<size_t> next_{0};
+  /// True if the workers must stop.
+  bool stop_{false};
+  /// True if the workers are pinned to the NUMA nodes.
+  bool pinned_{false};
+
+  /// @brief Take a task from the queue `ix` or steal one from another queue.
+  auto pop(size_t ix, Task& task) -> bool;
+
+  /// @brief Main loop of the worker `ix`.
+  auto run(size_t ix) -> void;
+};
+
+}  // namespace perth
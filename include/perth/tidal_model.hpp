@@ -1,21 +1,35 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <complex>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "perth/axis.hpp"
+#include "perth/bilinear.hpp"
+#include "perth/buffer.hpp"
 #include "perth/constituent.hpp"
+#include "perth/delta_t.hpp"
 #include "perth/grid.hpp"
+#include "perth/inference.hpp"
 #include "perth/math.hpp"
 #include "perth/nodal_corrections.hpp"
+#include "perth/numa.hpp"
+#include "perth/parallel_for.hpp"
+#include "perth/profiling.hpp"
+#include "perth/storage.hpp"
+#include "perth/tiles.hpp"
 
 namespace perth {
 
@@ -28,15 +42,51 @@ enum Quality : uint8_t {
   kUndefined = 0,      //!< Value undefined
 };
 
-/// @brief Constituent values type
-using ConstituentValues =
-    std::vector<std::pair<Constituent, std::complex<double>>>;
+/// @brief Cell of a grid framing a point, with the bilinear weights of the
+/// point in this cell.
+///
+/// The stencil depends only on the axes of the grid: the models sharing the
+/// same axes are interpolated with the same stencil.
+struct Stencil {
+  /// Indices of the cell along the longitude axis.
+  int64_t i1, i2;
+  /// Indices of the cell along the latitude axis.
+  int64_t j1, j2;
+  /// Coordinates of the corners of the cell.
+  double x1, x2, y1, y2;
+  /// Weights of the corners, see bilinear_weights().
+  std::tuple<double, double, double, double> wxy;
+};
+
+/// @brief How the accelerator provides the tidal arguments at a time within
+/// the time tolerance of the last arguments computed.
+enum class ArgumentMode : uint8_t {
+  /// The arguments of the reference time are used as they are.
+  kFrozen,
+  /// The arguments of the reference time are extrapolated linearly with the
+  /// rates of the constituents. The error, due to the change of the rates
+  /// over the window, remains far below a microdegree for windows of hours.
+  kExtrapolated,
+};
 
 class Accelerator {
  public:
-  Accelerator(const double time_tolerance, const size_t n_constituents)
-      : time_tolerance_(time_tolerance) {
-    values_.reserve(n_constituents);
+  /// @brief Default number of grid cells cached by an accelerator.
+  static constexpr size_t kDefaultCellCacheSize = 4;
+
+  /// @brief Construct an accelerator.
+  /// @param time_tolerance Time difference, in days, within which the
+  /// astronomical angles are not recomputed by update_args().
+  /// @param n_constituents Number of constituents handled by the model.
+  /// @param cell_cache_size Number of grid cells whose corner values are
+  /// kept, to interpolate the next points falling in one of them without
+  /// reading the model again. At least one cell is cached.
+  Accelerator(const double time_tolerance, const size_t n_constituents,
+              const size_t cell_cache_size = kDefaultCellCacheSize)
+      : time_tolerance_(time_tolerance),
+        n_constituents_(n_constituents),
+        cell_cache_size_(std::max<size_t>(cell_cache_size, 1)) {
+    cells_.reserve(cell_cache_size_);
   }
 
   /// @brief Casts the object to a pointer of type T.
@@ -53,88 +103,254 @@ class Accelerator {
     return reinterpret_cast<T*>(this);
   }
 
-  constexpr auto x1() const noexcept -> double { return x1_; }
-  constexpr auto x2() const noexcept -> double { return x2_; }
-  constexpr auto y1() const noexcept -> double { return y1_; }
-  constexpr auto y2() const noexcept -> double { return y2_; }
+  /// @brief Coordinates of the corners of the last grid cell used.
+  auto x1() const noexcept -> double { return last_cell().x1; }
+  auto x2() const noexcept -> double { return last_cell().x2; }
+  auto y1() const noexcept -> double { return last_cell().y1; }
+  auto y2() const noexcept -> double { return last_cell().y2; }
 
   constexpr auto time_tolerance() const noexcept -> double {
     return time_tolerance_;
   }
 
-  constexpr auto size() const noexcept -> size_t { return values_.capacity(); }
-
-  /// @brief Returns the tidal constituent values interpolated at the given
-  /// point.
-  /// @return the tidal constituent values interpolated at the given point.
-  constexpr auto values() const noexcept -> const ConstituentValues& {
-    return values_;
-  }
+  constexpr auto size() const noexcept -> size_t { return n_constituents_; }
 
   constexpr auto nodal_corrections() const noexcept
       -> const std::vector<NodalCorrections>& {
     return nodal_corrections_;
   }
 
-  /// @brief Clears the cached interpolated values.
-  inline auto clear() noexcept -> void { values_.clear(); }
+  /// @brief Returns a scratch buffer able to hold at least `n` values.
+  auto buffer(const size_t n) -> std::complex<double>* {
+    if (buffer_.size() < n) {
+      buffer_.resize(n);
+    }
+    return buffer_.data();
+  }
+
+  /// @brief Returns the corner values of a cached grid cell.
+  ///
+  /// The cell found becomes the most recently used one.
+  /// @tparam V The type of the values, encoded in the storage type of the
+  /// model.
+  /// @param i1 Index of the first longitude of the cell.
+  /// @param i2 Index of the second longitude of the cell.
+  /// @param j1 Index of the first latitude of the cell.
+  /// @param j2 Index of the second latitude of the cell.
+  /// @param n Number of values stored at each corner.
+  /// @return A pointer to the `4 * n` values of the corners (i1, j1),
+  /// (i1, j2), (i2, j1) and (i2, j2), in this order, or nullptr if the cell
+  /// is not cached.
+  template <typename V>
+  auto find_cell(const int64_t i1, const int64_t i2, const int64_t j1,
+                 const int64_t j2, const size_t n) noexcept -> const V* {
+    return reinterpret_cast<const V*>(
+        find_block(i1, i2, j1, j2, 4 * n * sizeof(V)));
+  }
+
+  /// @brief Allocates the cache entry of a grid cell, evicting the least
+  /// recently used one if the cache is full.
+  ///
+  /// The arguments are those of find_cell(), followed by the coordinates of
+  /// the cell.
+  /// @return A pointer to the `4 * n` corner values to fill, in the order
+  /// described by find_cell().
+  template <typename V>
+  auto insert_cell(const int64_t i1, const int64_t i2, const int64_t j1,
+                   const int64_t j2, const size_t n, const double x1,
+                   const double x2, const double y1, const double y2) -> V* {
+    return reinterpret_cast<V*>(
+        insert_block(i1, i2, j1, j2, 4 * n * sizeof(V), x1, x2, y1, y2));
+  }
+
+  /// @brief Number of cells found by find_cell() in the cache. Only counted
+  /// if the profiling is enabled (see kProfiling).
+  constexpr auto cell_hits() const noexcept -> int64_t { return cell_hits_; }
+
+  /// @brief Number of cells not found by find_cell() in the cache. Only
+  /// counted if the profiling is enabled (see kProfiling).
+  constexpr auto cell_misses() const noexcept -> int64_t {
+    return cell_misses_;
+  }
+
+  /// @brief Set the table used to interpolate the nodal corrections.
+  ///
+  /// The table must tabulate the constituents of the table passed to
+  /// update_args(), in the same order. Outside the tabulated span, or if the
+  /// table does not match these constituents or the group modulations
+  /// requested, the nodal corrections are computed.
+  /// @param table The table, or nullptr to always compute the corrections.
+  auto nodal_correction_table(
+      std::shared_ptr<const NodalCorrectionTable> table) noexcept -> void {
+    nodal_correction_table_ = std::move(table);
+  }
+
+  /// @brief Set the series of Delta T used to compute the astronomical
+  /// arguments.
+  ///
+  /// Within the span of the series, Delta T is interpolated in it; outside,
+  /// or without series, it is given by calculate_delta_time().
+  /// @param series The series, or nullptr to always use the model.
+  auto delta_time_series(std::shared_ptr<const DeltaTimeSeries> series) noexcept
+      -> void {
+    delta_time_series_ = std::move(series);
+  }
 
-  /// @brief Appends a tidal constituent value to the cached interpolated
-  /// values.
-  auto emplace_back(const Constituent& constituent,
-                    const std::complex<double>& value) noexcept -> void {
-    values_.emplace_back(constituent, value);
+  /// @brief Set how the tidal arguments are provided within the time
+  /// tolerance. The next call to update_args() computes the arguments if the
+  /// mode changes.
+  /// @param mode The mode to use.
+  auto argument_mode(const ArgumentMode mode) noexcept -> void {
+    if (mode != argument_mode_) {
+      argument_mode_ = mode;
+      time_ = std::numeric_limits<double>::max();
+      reference_time_ = std::numeric_limits<double>::max();
+    }
   }
 
+  /// @brief Get how the tidal arguments are provided within the time
+  /// tolerance.
+  constexpr auto argument_mode() const noexcept -> ArgumentMode {
+    return argument_mode_;
+  }
+
+  /// @brief Update the astronomical arguments, the nodal corrections and the
+  /// tidal arguments of the constituents if the time has changed and by more
+  /// than the time tolerance.
+  ///
+  /// With ArgumentMode::kExtrapolated, the tidal arguments are extrapolated
+  /// from the reference time, i.e. the last time for which they were
+  /// computed, as long as the time remains within the tolerance of the
+  /// reference time. The nodal corrections of the reference time are kept.
+  /// @return True if the arguments were updated.
   auto update_args(const double time, const double group_modulations,
-                   ConstituentTable& constituent_table) -> void;
+                   ConstituentTable& constituent_table) -> bool;
 
  private:
-  /// @brief Time in seconds for which astronomical angles are considered
-  /// constant
+  /// @brief Time difference, in days, within which the astronomical angles
+  /// are not recomputed
   double time_tolerance_;
 
-  /// @brief The time used to compute the celestial vector.
+  /// @brief The time of the tidal arguments of the table.
   double time_{std::numeric_limits<double>::max()};
 
+  /// @brief How the tidal arguments are provided within the time tolerance.
+  ArgumentMode argument_mode_{ArgumentMode::kFrozen};
+
+  /// @brief The time used to compute the celestial vector, used as reference
+  /// to extrapolate the tidal arguments.
+  double reference_time_{std::numeric_limits<double>::max()};
+
+  /// @brief The tidal arguments computed at the reference time.
+  Eigen::VectorXd reference_arguments_;
+
   /// @brief Latest delta time (TT - UT) used for celestial calculations.
   double delta_{std::numeric_limits<double>::max()};
 
-  /// @brief The tidal constituent values interpolated at the last point.
-  ConstituentValues values_;
+  /// @brief Number of constituents handled by the model.
+  size_t n_constituents_;
 
   /// @brief The latest nodal corrections computed.
   std::vector<NodalCorrections> nodal_corrections_;
 
-  double x1_{std::numeric_limits<double>::max()};
-  double x2_{std::numeric_limits<double>::max()};
-  double y1_{std::numeric_limits<double>::max()};
-  double y2_{std::numeric_limits<double>::max()};
+  /// @brief Scratch buffer used by the interpolation kernels.
+  std::vector<std::complex<double>> buffer_;
+
+  /// @brief Table used to interpolate the nodal corrections, if any.
+  std::shared_ptr<const NodalCorrectionTable> nodal_correction_table_;
+
+  /// @brief Series of Delta T used instead of the model, if any.
+  std::shared_ptr<const DeltaTimeSeries> delta_time_series_;
+
+  /// @brief A grid cell whose corner values are cached.
+  struct Cell {
+    int64_t i1{-1};
+    int64_t i2{-1};
+    int64_t j1{-1};
+    int64_t j2{-1};
+    double x1{std::numeric_limits<double>::max()};
+    double x2{std::numeric_limits<double>::max()};
+    double y1{std::numeric_limits<double>::max()};
+    double y2{std::numeric_limits<double>::max()};
+    /// The values of the four corners, one block per corner, encoded in
+    /// the storage type of the model.
+    std::vector<std::byte> corners;
+  };
+
+  /// @brief Maximum number of cells cached.
+  size_t cell_cache_size_;
+
+  /// @brief The cells cached, from the most to the least recently used.
+  std::vector<Cell> cells_;
+
+  /// @brief Number of cells found in the cache, and not found.
+  int64_t cell_hits_{};
+  int64_t cell_misses_{};
+
+  /// @brief Returns the storage of a cached cell, whose corners take
+  /// `size` bytes, or nullptr. See find_cell().
+  auto find_block(int64_t i1, int64_t i2, int64_t j1, int64_t j2,
+                  size_t size) noexcept -> const std::byte*;
+
+  /// @brief Allocates the storage of a cell whose corners take `size`
+  /// bytes. See insert_cell().
+  auto insert_block(int64_t i1, int64_t i2, int64_t j1, int64_t j2,
+                    size_t size, double x1, double x2, double y1, double y2)
+      -> std::byte*;
+
+  /// @brief Returns the most recently used cell.
+  auto last_cell() const noexcept -> const Cell& {
+    static const auto kNone = Cell{};
+    return cells_.empty() ? kNone : cells_.front();
+  }
 };
 
+/// @brief Tidal model defined on a regular grid.
+/// @tparam T The type of the real values stored: float, double, or Float16
+/// and Int16 to store the waves on 16 bits (see WaveStorage).
 template <typename T>
 class TidalModel : public std::enable_shared_from_this<TidalModel<T>> {
  public:
+  /// Type of the values stored.
+  using value_type = typename WaveStorage<T>::value_type;
+  /// Type of the values given to add_constituent().
+  using input_type = typename WaveStorage<T>::input_type;
+
   /// @brief Construct a tidal model with longitude and latitude axes.
   /// @param lon Longitude axis (will be moved).
   /// @param lat Latitude axis (will be moved).
   /// @param row_major Whether the data is stored in longitude-major order.
+  /// @param packed Whether the constituents are stored interleaved, i.e. all
+  /// the constituents of a grid node are contiguous in memory. This layout
+  /// turns the bilinear stencil into four contiguous reads instead of four
+  /// scattered reads per constituent.
   /// @throw std::exception Strong exception safety guarantee.
-  TidalModel(Axis lon, Axis lat, const bool row_major = true)
-      : data_(),
-        lon_(std::move(lon)),
+  TidalModel(Axis lon, Axis lat, const bool row_major = true,
+             const bool packed = false)
+      : lon_(std::move(lon)),
         lat_(std::move(lat)),
-        row_major_(row_major) {}
+        row_major_(row_major),
+        packed_(packed),
+        validity_(static_cast<size_t>(lon_.size() * lat_.size())) {}
 
   [[nodiscard]] auto accelerator(const double time_tolerance) const
       -> std::unique_ptr<Accelerator> {
-    return std::make_unique<Accelerator>(time_tolerance, this->data_.size());
+    return std::make_unique<Accelerator>(time_tolerance, this->size());
   }
 
+  /// @brief Add a tidal constituent to the model.
+  ///
+  /// If the model uses the packed layout, the wave is staged until the next
+  /// call to pack(). Staged constituents remain usable for interpolation.
+  /// If the constituent is already handled by the model, the call is
+  /// ignored.
+  /// The values are encoded in the storage type of the model.
+  /// @param ident The constituent identifier.
+  /// @param wave The complex wave values on the grid.
   inline auto add_constituent(
       const Constituent ident,
       const Eigen::Ref<
-          const Eigen::Matrix<std::complex<T>, -1, -1, Eigen::RowMajor>>& wave)
+          const Eigen::Matrix<input_type, -1, -1, Eigen::RowMajor>>& wave)
       -> void {
     auto row_major = wave.rows() == lon_.size() && wave.cols() == lat_.size();
     if (row_major != row_major_) {
@@ -160,78 +376,710 @@ class TidalModel : public std::enable_shared_from_this<TidalModel<T>> {
             std::to_string(wave.cols()) + ")");
       }
     }
-    this->data_.emplace(ident,
-                        Eigen::Map<const Eigen::Vector<std::complex<T>, -1>>(
-                            wave.data(), wave.size()));
+    if (contains(ident)) {
+      return;
+    }
+    append(ident, wave.data());
+  }
+
+  /// @brief Add a tidal constituent whose wave is owned by an external
+  /// object, without copying it.
+  ///
+  /// The wave must hold `lon.size() * lat.size()` values, already encoded
+  /// in the storage type of the model, stored in the order given by the
+  /// `row_major` flag of the model. It must not be modified while the model
+  /// uses it. If the model uses the packed layout, the wave is copied by the
+  /// next call to pack().
+  /// @param ident The constituent identifier.
+  /// @param wave Pointer to the first value of the wave.
+  /// @param keeper Object keeping the memory pointed to by `wave` alive. The
+  /// model holds a reference on it as long as it uses the wave.
+  /// @param scale Scale factor of the values, if the storage type is scaled.
+  /// @throw std::invalid_argument If the model is tiled.
+  auto add_constituent(const Constituent ident, const value_type* wave,
+                       std::shared_ptr<const void> keeper,
+                       const double scale = 1) -> void {
+    check_not_tiled();
+    if (contains(ident)) {
+      return;
+    }
+    identifiers_.push_back(ident);
+    scales_.push_back(scale);
+    data_.emplace_back(wave, static_cast<size_t>(lon_.size() * lat_.size()),
+                       std::move(keeper));
+    replicas_.clear();
+    shared_memory_.clear();
+    update_validity(wave, 1, scale);
   }
 
+  /// @brief Use constituents already interleaved by grid node and owned by
+  /// an external object, without copying them.
+  ///
+  /// The values of the constituents of the grid node `i`, in the order given
+  /// by `idents`, start at `data + i * idents.size()`. The grid nodes are
+  /// ordered according to the `row_major` flag of the model. The values must
+  /// not be modified while the model uses them.
+  /// @param idents The constituent identifiers.
+  /// @param data Pointer to the first value.
+  /// @param keeper Object keeping the memory pointed to by `data` alive. The
+  /// model holds a reference on it as long as it uses the values.
+  /// @param scales Scale factors of the constituents, if the storage type is
+  /// scaled. If empty, the factors are 1.
+  /// @throw std::invalid_argument If the model does not use the packed
+  /// layout, already handles constituents, if `idents` contains duplicates
+  /// or if the number of scale factors does not match.
+  auto assign_packed(const std::vector<Constituent>& idents,
+                     const value_type* data, std::shared_ptr<const void> keeper,
+                     std::vector<double> scales = {}) -> void {
+    if (!packed_) {
+      throw std::invalid_argument("The model does not use the packed layout");
+    }
+    if (!empty()) {
+      throw std::invalid_argument("The model already handles constituents");
+    }
+    assign_identifiers(idents, std::move(scales));
+    n_packed_ = idents.size();
+    packed_data_ = Buffer<value_type>(
+        data, static_cast<size_t>(lon_.size() * lat_.size()) * n_packed_,
+        std::move(keeper));
+    replicas_.clear();
+    shared_memory_.clear();
+    for (size_t ix = 0; ix < n_packed_; ++ix) {
+      update_validity(data + ix, n_packed_, scales_[ix]);
+    }
+  }
+
+  /// @brief Read the waves of the model by tiles, on demand, instead of
+  /// holding them in memory.
+  ///
+  /// The grid is split into tiles of `tile_size` by `tile_size` nodes, read
+  /// from the loader the first time a point falls in them: the memory used,
+  /// and the time spent reading the model, depend on the region processed
+  /// rather than on the size of the grid. The inference cannot be baked in a
+  /// tiled model and its waves cannot be read by wave().
+  /// @param loader Source of the values of the tiles.
+  /// @param tile_size Number of nodes of a tile along each axis.
+  /// @param memory_budget Maximum memory used by the tiles, in bytes: beyond
+  /// it, the least recently used tiles are released. If 0, the tiles read
+  /// are kept.
+  /// @throw std::invalid_argument If the model already handles
+  /// constituents, if the loader is null, provides duplicate constituents or
+  /// a number of scale factors that does not match, or if the tile size is
+  /// zero.
+  auto use_tiles(std::shared_ptr<const TileLoader<T>> loader,
+                 const size_t tile_size = 256, const size_t memory_budget = 0)
+      -> void {
+    if (!empty()) {
+      throw std::invalid_argument("The model already handles constituents");
+    }
+    auto tiles = std::make_unique<TileCache<T>>(
+        loader, lon_.size(), lat_.size(), tile_size, memory_budget);
+    assign_identifiers(loader->identifiers(), loader->scales());
+    tiles_ = std::move(tiles);
+    // The state of the nodes is known from the values of the tiles.
+    validity_.clear();
+    validity_.shrink_to_fit();
+  }
+
+  /// True if the waves of the model are read by tiles, see use_tiles().
+  [[nodiscard]] auto tiled() const noexcept -> bool {
+    return tiles_ != nullptr;
+  }
+
+  /// @brief Get the tiles of the model, or nullptr if the model is not
+  /// tiled.
+  [[nodiscard]] auto tiles() const noexcept -> const TileCache<T>* {
+    return tiles_.get();
+  }
+
+  /// @brief Keep a copy of the waves on each NUMA node of the machine.
+  ///
+  /// On a machine with several NUMA nodes, the waves live on the node of the
+  /// thread that first wrote them, and the threads running on the other
+  /// nodes read them through the interconnect. Once replicated, the model is
+  /// interpolated from the copy local to the node of the calling thread (see
+  /// current_numa_node()): pin the threads of the pool to the nodes with
+  /// ThreadPool::set_num_threads() so that they do not migrate. Each copy is
+  /// written by a thread pinned to its node, which allocates it there. The
+  /// copies are released when a constituent is added or when the model is
+  /// packed.
+  /// @param num_replicas Number of copies, the copy `k` being placed on the
+  /// node `k % numa_nodes().size()`. If 0, one copy per node of the machine,
+  /// none if it has a single node.
+  /// @throw std::invalid_argument If the model is tiled.
+  auto replicate(size_t num_replicas = 0) -> void;
+
+  /// @brief Get the number of copies of the waves, see replicate().
+  [[nodiscard]] auto replicas() const noexcept -> size_t {
+    return replicas_.size();
+  }
+
+  /// @brief Get the name of the segment of shared memory holding the waves
+  /// of the model (see share_model()), or an empty string if the waves are
+  /// not shared.
+  [[nodiscard]] auto shared_memory() const noexcept -> const std::string& {
+    return shared_memory_;
+  }
+
+  /// @brief Record the name of the segment of shared memory holding the
+  /// waves of the model. The name is forgotten when a constituent is added.
+  /// @param name Name of the segment.
+  auto set_shared_memory(std::string name) -> void {
+    shared_memory_ = std::move(name);
+  }
+
+  /// @brief Interleave the staged constituents into the packed buffer.
+  ///
+  /// Does nothing if the model does not use the packed layout or if no
+  /// constituent has been added since the last call.
+  auto pack() -> void;
+
+  /// @brief Evaluate the inference at every grid node and store the
+  /// inferred constituents as constituents of the model.
+  ///
+  /// The inference being linear in the waves of the model, interpolating the
+  /// inferred waves gives the same result as inferring the interpolated
+  /// waves; the 18.6-year node tide, if it is not provided, is evaluated at
+  /// the latitude of the grid nodes. The model is then evaluated without
+  /// inference, at the cost of the memory used by the new waves. If the
+  /// model uses the packed layout, the new waves are interleaved by pack().
+  /// @param interpolation_type Type of interpolation of the admittances.
+  /// @param num_threads Number of threads to use. If 0, all the threads of
+  /// the pool are used.
+  /// @return The constituents added to the model.
+  auto bake_inference(const InterpolationType interpolation_type,
+                      const size_t num_threads = 0)
+      -> std::vector<Constituent>;
+
+  /// @brief Get the largest modulus of the wave of each constituent.
+  ///
+  /// The bilinear interpolation being a weighted mean of the nodes of a
+  /// cell, the moduli of the interpolated constituents never exceed these
+  /// bounds.
+  /// @param num_threads Number of threads to use. If 0, all the threads of
+  /// the pool are used.
+  /// @return The largest modulus of each constituent, in the order of
+  /// identifiers(), the undefined values being ignored.
+  /// @throw std::invalid_argument If the model is tiled.
+  [[nodiscard]] auto max_amplitudes(const size_t num_threads = 0) const
+      -> std::vector<double>;
+
+  /// @brief Interpolate the constituents of the model at a point, into the
+  /// tides of a constituent table.
+  /// @param lon Longitude of the point, in degrees.
+  /// @param lat Latitude of the point, in degrees.
+  /// @param constituent_table Table receiving the tides of the constituents
+  /// of the model. The other constituents are left unchanged.
+  /// @param acc Accelerator caching the cells of the model.
+  /// @return The quality of the interpolation.
   inline auto interpolate(const double lon, const double lat,
                           ConstituentTable& constituent_table,
                           Accelerator* acc) const -> Quality {
-    Quality quality;
-    for (const auto& item : this->interpolate(lon, lat, quality, acc)) {
-      constituent_table[item.first].tide = std::move(item.second);
-    }
+    auto* values = acc->buffer(identifiers_.size());
+    const auto quality = interpolate(lon, lat, values, acc);
+    scatter(values, constituent_table);
+    return quality;
+  }
+
+  /// @brief Interpolate the constituents of the model in a stencil, into the
+  /// tides of a constituent table.
+  /// @param stencil Stencil of the point, see stencil().
+  /// @param constituent_table Table receiving the tides of the constituents
+  /// of the model. The other constituents are left unchanged.
+  /// @param acc Accelerator caching the cells of the model.
+  /// @return The quality of the interpolation.
+  inline auto interpolate(const Stencil& stencil,
+                          ConstituentTable& constituent_table,
+                          Accelerator* acc) const -> Quality {
+    auto* values = acc->buffer(identifiers_.size());
+    const auto quality = interpolate(stencil, values, acc);
+    scatter(values, constituent_table);
     return quality;
   }
 
+  /// @brief Interpolate the constituents of the model at a point, into a
+  /// dense array.
+  /// @param lon Longitude of the point, in degrees.
+  /// @param lat Latitude of the point, in degrees.
+  /// @param values Array receiving the `size()` values, in the order of
+  /// identifiers(). The values are NaN if the quality is undefined.
+  /// @param acc Accelerator caching the cells of the model.
+  /// @return The quality of the interpolation.
+  auto interpolate(const double lon, const double lat,
+                   std::complex<double>* values, Accelerator* acc) const
+      -> Quality;
+
+  /// @brief Interpolate the constituents of the model in a stencil, into a
+  /// dense array.
+  /// @param stencil Stencil of the point, see stencil(). The axes of the
+  /// grid used to build it must be equal to the axes of the model.
+  /// @param values Array receiving the `size()` values, in the order of
+  /// identifiers(). The values are NaN if the quality is undefined.
+  /// @param acc Accelerator caching the cells of the model.
+  /// @return The quality of the interpolation.
+  auto interpolate(const Stencil& stencil, std::complex<double>* values,
+                   Accelerator* acc) const -> Quality;
+
+  /// @brief Interpolate the constituents of the model at a set of points.
+  ///
+  /// The points are distributed over the threads of the pool, each thread
+  /// using its own accelerator, and interpolated directly into the rows of
+  /// the result.
+  /// @param lon Longitudes of the points, in degrees.
+  /// @param lat Latitudes of the points, in degrees.
+  /// @param num_threads Number of threads to use. If 0, all the threads of
+  /// the pool are used.
+  /// @return The values of the constituents, one row per point, in the
+  /// order of identifiers(), NaN if the quality of the point is undefined,
+  /// and the quality of the interpolation of each point.
+  /// @throw std::invalid_argument If the vectors do not have the same size.
+  auto interpolate_many(const Eigen::Ref<const Eigen::VectorXd>& lon,
+                        const Eigen::Ref<const Eigen::VectorXd>& lat,
+                        size_t num_threads = 0) const
+      -> std::tuple<
+          Eigen::Matrix<std::complex<double>, -1, -1, Eigen::RowMajor>,
+          Eigen::Vector<int8_t, -1>>;
+
+  /// @brief Find the cell of the grid framing a point and the bilinear
+  /// weights of the point in this cell.
+  /// @param lon Longitude of the point, in degrees.
+  /// @param lat Latitude of the point, in degrees.
+  /// @return The stencil of the point, or nothing if the point is outside
+  /// the grid.
+  auto stencil(const double lon, const double lat) const
+      -> std::optional<Stencil>;
+
   /// True if no tidal constituent is handled by the model.
-  [[nodiscard]] auto empty() const -> bool { return data_.empty(); }
+  [[nodiscard]] auto empty() const -> bool { return identifiers_.empty(); }
 
   /// Get the number of tidal constituents handled by the model.
-  [[nodiscard]] auto size() const -> size_t { return data_.size(); }
+  [[nodiscard]] auto size() const -> size_t { return identifiers_.size(); }
+
+  /// True if the constituents are stored interleaved by grid node.
+  [[nodiscard]] constexpr auto packed() const noexcept -> bool {
+    return packed_;
+  }
+
+  /// Get the longitude axis.
+  [[nodiscard]] constexpr auto lon() const noexcept -> const Axis& {
+    return lon_;
+  }
+
+  /// Get the latitude axis.
+  [[nodiscard]] constexpr auto lat() const noexcept -> const Axis& {
+    return lat_;
+  }
+
+  /// True if the data is stored in longitude-major order.
+  [[nodiscard]] constexpr auto row_major() const noexcept -> bool {
+    return row_major_;
+  }
 
   /// Get the tidal constituent identifiers handled by the model.
   [[nodiscard]] inline auto identifiers() const -> std::vector<Constituent> {
-    auto result = std::vector<Constituent>();
-    result.reserve(data_.size());
-    for (const auto& item : data_) {
-      result.push_back(item.first);
+    return identifiers_;
+  }
+
+  /// @brief Get the scale factor of the values of a constituent, 1 if the
+  /// storage type is not scaled.
+  /// @param ix Index of the constituent in identifiers().
+  [[nodiscard]] auto scale(const size_t ix) const -> double {
+    return scales_.at(ix);
+  }
+
+  /// @brief Get the wave of a constituent.
+  /// @param ix Index of the constituent in identifiers().
+  /// @return A view of the `lon.size() * lat.size()` values of the wave,
+  /// encoded in the storage type of the model and ordered according to the
+  /// `row_major` flag of the model.
+  /// @throw std::invalid_argument If the model is tiled.
+  [[nodiscard]] auto wave(const size_t ix) const
+      -> Eigen::Map<const Eigen::Vector<value_type, -1>, Eigen::Unaligned,
+                    Eigen::InnerStride<>> {
+    check_not_tiled();
+    const auto n_nodes = lon_.size() * lat_.size();
+    if (ix < n_packed_) {
+      return {packed_data_.data() + ix, n_nodes,
+              Eigen::InnerStride<>(static_cast<Eigen::Index>(n_packed_))};
     }
-    return result;
+    return {data_.at(ix - n_packed_).data(), n_nodes, Eigen::InnerStride<>(1)};
   }
 
  private:
-  /// The constituents of the tidal model.
-  std::unordered_map<Constituent, Eigen::Vector<std::complex<T>, -1>> data_;
+  /// @brief Throw if the model is tiled: its waves are only available by
+  /// tiles.
+  auto check_not_tiled() const -> void {
+    if (tiles_ != nullptr) {
+      throw std::invalid_argument(
+          "The waves of a tiled model are read from its tile loader");
+    }
+  }
+
+  /// @brief Set the constituents handled by a model without constituents.
+  /// @param idents The constituent identifiers.
+  /// @param scales Scale factors of the constituents. If empty, the factors
+  /// are 1.
+  /// @throw std::invalid_argument If `idents` contains duplicates or if the
+  /// number of scale factors does not match.
+  auto assign_identifiers(const std::vector<Constituent>& idents,
+                          std::vector<double> scales) -> void {
+    for (auto it = idents.begin(); it != idents.end(); ++it) {
+      if (std::find(std::next(it), idents.end(), *it) != idents.end()) {
+        throw std::invalid_argument("Duplicate constituent: " +
+                                    constituent_to_name(*it));
+      }
+    }
+    if (scales.empty()) {
+      scales.resize(idents.size(), 1);
+    }
+    if (scales.size() != idents.size()) {
+      throw std::invalid_argument(
+          "The number of scale factors does not match the number of "
+          "constituents");
+    }
+    identifiers_ = idents;
+    scales_ = std::move(scales);
+  }
+
+  /// @brief Store the values interpolated, in the order of identifiers(),
+  /// into the tides of a constituent table.
+  inline auto scatter(const std::complex<double>* values,
+                      ConstituentTable& constituent_table) const -> void {
+    auto& items = constituent_table.items();
+    for (size_t ix = 0; ix < identifiers_.size(); ++ix) {
+      items[static_cast<size_t>(identifiers_[ix])].tide = values[ix];
+    }
+  }
+
+  /// The constituents handled by the model, in insertion order. The first
+  /// `n_packed_` entries are stored in `packed_data_`, the others in `data_`.
+  std::vector<Constituent> identifiers_;
+  /// The scale factors of the constituents, in the order of `identifiers_`.
+  std::vector<double> scales_;
+  /// The constituents stored one grid per constituent.
+  std::vector<Buffer<value_type>> data_;
+  /// The constituents stored interleaved: the values of the constituents for
+  /// grid node `i` start at `i * n_packed_`.
+  Buffer<value_type> packed_data_;
+  /// Number of constituents stored in `packed_data_`.
+  size_t n_packed_{0};
   /// Longitude axis.
   const Axis lon_;
   /// Latitude axis.
   const Axis lat_;
   /// Whether the data is stored in longitude-major order.
   const bool row_major_;
+  /// Whether the constituents are interleaved by grid node.
+  const bool packed_;
+  /// State of each grid node, in the order of the waves: a combination of
+  /// kDefinedNode, if a value of the node is defined, and kUndefinedNode, if
+  /// a value is undefined. Updated each time a wave is added. Empty if the
+  /// model is tiled.
+  std::vector<uint8_t> validity_;
+  /// Tiles holding the waves, if the model is tiled.
+  std::unique_ptr<TileCache<T>> tiles_;
+
+  /// @brief Copy of the waves of the model, local to a NUMA node.
+  struct Replica {
+    std::vector<Buffer<value_type>> data;  ///< Copy of `data_`.
+    Buffer<value_type> packed_data;        ///< Copy of `packed_data_`.
+  };
+  /// Copies of the waves, see replicate().
+  std::vector<Replica> replicas_;
+  /// Name of the segment of shared memory holding the waves, if any.
+  std::string shared_memory_;
+
+  /// Flags of `validity_`.
+  static constexpr uint8_t kDefinedNode = 1;
+  static constexpr uint8_t kUndefinedNode = 2;
+
+  /// Merge the state of the nodes of a new wave into `validity_`. The real
+  /// and imaginary parts are checked separately, as by
+  /// interpolate_stencil().
+  auto update_validity(const value_type* wave, const size_t stride,
+                       const double scale) -> void {
+    for (size_t ix = 0; ix < validity_.size(); ++ix) {
+      const auto value = WaveStorage<T>::decode(wave[ix * stride], scale);
+      const auto nan = static_cast<int>(std::isnan(value.real())) +
+                       static_cast<int>(std::isnan(value.imag()));
+      validity_[ix] |= nan == 0   ? kDefinedNode
+                       : nan == 2 ? kUndefinedNode
+                                  : kDefinedNode | kUndefinedNode;
+    }
+  }
+
+  /// True if the constituent is handled by the model.
+  auto contains(const Constituent ident) const -> bool {
+    return std::find(identifiers_.begin(), identifiers_.end(), ident) !=
+           identifiers_.end();
+  }
+
+  /// Encode and store the wave of a constituent not handled by the model.
+  auto append(const Constituent ident, const input_type* wave) -> void {
+    check_not_tiled();
+    const auto n_nodes = lon_.size() * lat_.size();
+    const auto scale =
+        WaveStorage<T>::scale(wave, static_cast<size_t>(n_nodes));
+    auto values = Eigen::Vector<value_type, -1>(n_nodes);
+    for (int64_t ix = 0; ix < n_nodes; ++ix) {
+      values(ix) = WaveStorage<T>::encode(wave[ix], scale);
+    }
+    identifiers_.push_back(ident);
+    scales_.push_back(scale);
+    data_.emplace_back(std::move(values));
+    replicas_.clear();
+    shared_memory_.clear();
+    update_validity(data_.back().data(), 1, scale);
+  }
+
+  /// Call a function with the grid describing the layout of the nodes of
+  /// the model. The memory order is resolved here once, so that the
+  /// function is compiled for each order with constant strides.
+  template <typename Function>
+  auto visit_grid(Function&& function) const -> decltype(auto) {
+    const auto nx = static_cast<size_t>(lon_.size());
+    const auto ny = static_cast<size_t>(lat_.size());
+    if (row_major_) {
+      return function(Grid<value_type, GridOrder::kRowMajor>(nullptr, nx, ny));
+    }
+    return function(Grid<value_type, GridOrder::kColumnMajor>(nullptr, nx, ny));
+  }
 
-  auto interpolate(const double lon, const double lat, Quality& quality,
-                   Accelerator* acc) const -> const ConstituentValues&;
+  /// Read the values of the constituents at the four corners of a grid
+  /// cell, in the order described by Accelerator::find_cell(). The values
+  /// are copied as stored: the interpolation kernel decodes them.
+  template <GridOrder Order>
+  auto load_cell(const Grid<value_type, Order>& grid, const int64_t i1,
+                 const int64_t i2, const int64_t j1, const int64_t j2,
+                 value_type* corners) const -> void;
+
+  /// Read the values of the constituents at the four corners of a grid
+  /// cell from the tiles of the model, in the order described by
+  /// Accelerator::find_cell().
+  auto load_tiled_cell(const int64_t i1, const int64_t i2, const int64_t j1,
+                       const int64_t j2, value_type* corners) const -> void;
+
+  /// Interpolate the four corners of a cell with the kernel decoding the
+  /// storage type of the model. See interpolate_stencil().
+  template <typename... Defined>
+  auto interpolate_corners(
+      const std::tuple<double, double, double, double>& wxy,
+      const value_type* corners, std::complex<double>* values,
+      const Defined... defined) const -> int64_t;
 };
 
 template <typename T>
-inline auto TidalModel<T>::interpolate(const double lon, const double lat,
-                                       Quality& quality, Accelerator* acc) const
-    -> const ConstituentValues& {
-  // Undefined value for the interpolation. This value is used to indicate
-  // that the interpolation failed or that the value is not defined.
-  constexpr auto undefined_value =
-      std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
-                           std::numeric_limits<double>::quiet_NaN());
+auto TidalModel<T>::pack() -> void {
+  if (!packed_ || data_.empty()) {
+    return;
+  }
+  const auto n_nodes = lon_.size() * lat_.size();
+  const auto n_constituents = identifiers_.size();
+  auto buffer = Eigen::Vector<value_type, -1>(
+      n_nodes * static_cast<int64_t>(n_constituents));
+
+  for (int64_t ix = 0; ix < n_nodes; ++ix) {
+    auto* node = buffer.data() + ix * n_constituents;
+    const auto* previous = packed_data_.data() + ix * n_packed_;
+    for (size_t jx = 0; jx < n_packed_; ++jx) {
+      node[jx] = previous[jx];
+    }
+    for (size_t jx = 0; jx < data_.size(); ++jx) {
+      node[n_packed_ + jx] = data_[jx](ix);
+    }
+  }
+  packed_data_ = Buffer<value_type>(std::move(buffer));
+  n_packed_ = n_constituents;
+  data_.clear();
+  data_.shrink_to_fit();
+  replicas_.clear();
+  shared_memory_.clear();
+}
+
+template <typename T>
+auto TidalModel<T>::replicate(const size_t num_replicas) -> void {
+  check_not_tiled();
+  const auto num_nodes = numa_nodes().size();
+  const auto count =
+      num_replicas != 0 ? num_replicas : (num_nodes > 1 ? num_nodes : 0);
+  auto copy = [](const Buffer<value_type>& buffer) -> Buffer<value_type> {
+    return Buffer<value_type>(Eigen::Vector<value_type, -1>(
+        Eigen::Map<const Eigen::Vector<value_type, -1>>(
+            buffer.data(), static_cast<Eigen::Index>(buffer.size()))));
+  };
+  auto replicas = std::vector<Replica>(count);
+  for (size_t ix = 0; ix < count; ++ix) {
+    run_on_numa_node(ix % num_nodes, [&]() -> void {
+      auto& replica = replicas[ix];
+      for (const auto& item : data_) {
+        replica.data.emplace_back(copy(item));
+      }
+      replica.packed_data = copy(packed_data_);
+    });
+  }
+  replicas_ = std::move(replicas);
+}
+
+template <typename T>
+auto TidalModel<T>::bake_inference(const InterpolationType interpolation_type,
+                                   const size_t num_threads)
+    -> std::vector<Constituent> {
+  const auto table = assemble_constituent_table(identifiers_);
+  const auto inference = Inference(table, interpolation_type);
+
+  // Constituents computed by the inference and not provided by the model.
+  auto inferred = std::vector<Constituent>();
+  for (const auto ident : inference.constituents()) {
+    if (table[ident].is_inferred) {
+      inferred.push_back(ident);
+    }
+  }
+  if (inferred.empty()) {
+    return inferred;
+  }
+
+  const auto n_nodes = lon_.size() * lat_.size();
+  auto waves = std::vector<Eigen::Vector<input_type, -1>>(
+      inferred.size(), Eigen::Vector<input_type, -1>(n_nodes));
+  visit_grid([&](const auto& grid) -> void {
+    auto worker = [&](const size_t start, const size_t end) -> void {
+      auto node_table = table;
+      for (auto ix = static_cast<int64_t>(start);
+           ix < static_cast<int64_t>(end); ++ix) {
+        for (size_t jx = 0; jx < identifiers_.size(); ++jx) {
+          node_table[identifiers_[jx]].tide =
+              WaveStorage<T>::decode(wave(jx)(ix), scales_[jx]);
+        }
+        inference(node_table, lat_(grid.y(ix)));
+        for (size_t jx = 0; jx < inferred.size(); ++jx) {
+          waves[jx](ix) = input_type(node_table[inferred[jx]].tide);
+        }
+      }
+    };
+    parallel_for(worker, static_cast<size_t>(n_nodes), num_threads, 1024);
+  });
+
+  for (size_t jx = 0; jx < inferred.size(); ++jx) {
+    append(inferred[jx], waves[jx].data());
+  }
+  pack();
+  return inferred;
+}
 
-  // Reset the values to undefined if the point is not within the grid or if
-  // the model is undefined for the given point.
-  auto reset_values_to_undefined = [&]() -> const ConstituentValues& {
-    for (const auto& item : this->data_) {
-      acc->emplace_back(item.first, undefined_value);
+template <typename T>
+auto TidalModel<T>::max_amplitudes(const size_t num_threads) const
+    -> std::vector<double> {
+  check_not_tiled();
+  const auto n = identifiers_.size();
+  const auto n_nodes = lon_.size() * lat_.size();
+  auto result = std::vector<double>(n, 0.0);
+  auto mutex = std::mutex();
+  // The nodes are scanned once, all the constituents of a node together, so
+  // that the packed layout is read sequentially.
+  auto waves = std::vector<decltype(wave(0))>();
+  waves.reserve(n);
+  for (size_t jx = 0; jx < n; ++jx) {
+    waves.emplace_back(wave(jx));
+  }
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    auto bounds = std::vector<double>(n, 0.0);
+    for (auto ix = static_cast<int64_t>(start);
+         ix < static_cast<int64_t>(end); ++ix) {
+      for (size_t jx = 0; jx < n; ++jx) {
+        const auto modulus =
+            std::abs(WaveStorage<T>::decode(waves[jx](ix), scales_[jx]));
+        // The comparison is false for the undefined values.
+        if (modulus > bounds[jx]) {
+          bounds[jx] = modulus;
+        }
+      }
+    }
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    for (size_t jx = 0; jx < n; ++jx) {
+      result[jx] = std::max(result[jx], bounds[jx]);
     }
-    quality = Quality::kUndefined;
-    return acc->values();
   };
+  parallel_for(worker, static_cast<size_t>(n_nodes), num_threads, 4096);
+  return result;
+}
 
+template <typename T>
+template <GridOrder Order>
+auto TidalModel<T>::load_cell(const Grid<value_type, Order>& grid,
+                              const int64_t i1, const int64_t i2,
+                              const int64_t j1, const int64_t j2,
+                              value_type* corners) const -> void {
+  const auto n_constituents = identifiers_.size();
+  const auto nodes = std::array<int64_t, 4>{
+      grid.index(i1, j1), grid.index(i1, j2), grid.index(i2, j1),
+      grid.index(i2, j2)};
+  // Read the copy of the waves local to the node of the thread, if any.
+  const auto* data = &data_;
+  const auto* packed_data = &packed_data_;
+  if (!replicas_.empty()) {
+    const auto& replica = replicas_[current_numa_node() % replicas_.size()];
+    data = &replica.data;
+    packed_data = &replica.packed_data;
+  }
+  for (const auto node : nodes) {
+    // Constituents stored interleaved: the corner is a contiguous block.
+    const auto* packed = packed_data->data() + node * n_packed_;
+    std::copy(packed, packed + n_packed_, corners);
+    // Constituents stored in their own grid.
+    for (size_t ix = 0; ix < data->size(); ++ix) {
+      corners[n_packed_ + ix] = (*data)[ix](node);
+    }
+    corners += n_constituents;
+  }
+}
+
+template <typename T>
+auto TidalModel<T>::load_tiled_cell(const int64_t i1, const int64_t i2,
+                                    const int64_t j1, const int64_t j2,
+                                    value_type* corners) const -> void {
+  const auto n_constituents = identifiers_.size();
+  // The corners of a cell are usually in the same tile.
+  auto tile = std::shared_ptr<const typename TileCache<T>::Tile>{};
+  for (const auto& [i, j] : {std::pair{i1, j1}, std::pair{i1, j2},
+                             std::pair{i2, j1}, std::pair{i2, j2}}) {
+    if (tile == nullptr || !tile->contains(i, j)) {
+      tile = tiles_->get(i, j);
+    }
+    const auto* node = tile->node(i, j);
+    std::copy(node, node + n_constituents, corners);
+    corners += n_constituents;
+  }
+}
+
+template <typename T>
+template <typename... Defined>
+auto TidalModel<T>::interpolate_corners(
+    const std::tuple<double, double, double, double>& wxy,
+    const value_type* corners, std::complex<double>* values,
+    const Defined... defined) const -> int64_t {
+  const auto n = identifiers_.size();
+  const auto* z11 = corners;
+  const auto* z12 = z11 + n;
+  const auto* z21 = z12 + n;
+  const auto* z22 = z21 + n;
+  if constexpr (WaveStorage<T>::kScaled) {
+    return interpolate_stencil(wxy, defined..., z11, z12, z21, z22, n,
+                               scales_.data(), values);
+  } else {
+    return interpolate_stencil(wxy, defined..., z11, z12, z21, z22, n,
+                               values);
+  }
+}
+
+template <typename T>
+inline auto TidalModel<T>::stencil(const double lon, const double lat) const
+    -> std::optional<Stencil> {
   // Find the nearest point in the grid
   auto lon_index = lon_.find_indices(lon);
   auto lat_index = lat_.find_indices(lat);
 
   if (!lon_index || !lat_index) {
-    acc->clear();
-    return reset_values_to_undefined();
+    return std::nullopt;
   }
 
   // Retrieve the indices of the nearest points in the grid
@@ -242,52 +1090,202 @@ inline auto TidalModel<T>::interpolate(const double lon, const double lat,
   const auto y1 = lat_(j1);
   const auto y2 = lat_(j2);
 
-  if (x1 == acc->x1() && x2 == acc->x2() && y1 == acc->y1() &&
-      y2 == acc->y2()) {
-    // If the point is already cached, return the cached values.
-    return acc->values();
+  // Compute the weights for the bilinear interpolation
+  return Stencil{i1,
+                 i2,
+                 j1,
+                 j2,
+                 x1,
+                 x2,
+                 y1,
+                 y2,
+                 bilinear_weights(normalize_angle(lon, x1), lat, x1, y1,
+                                  normalize_angle(x2, x1), y2)};
+}
+
+template <typename T>
+auto TidalModel<T>::interpolate_many(
+    const Eigen::Ref<const Eigen::VectorXd>& lon,
+    const Eigen::Ref<const Eigen::VectorXd>& lat,
+    const size_t num_threads) const
+    -> std::tuple<Eigen::Matrix<std::complex<double>, -1, -1, Eigen::RowMajor>,
+                  Eigen::Vector<int8_t, -1>> {
+  if (lon.size() != lat.size()) {
+    throw std::invalid_argument("Input vectors must have the same size");
   }
-  // Remove all previous values interpolated.
-  acc->clear();
+  const auto n_constituents = static_cast<Eigen::Index>(identifiers_.size());
+  auto values = Eigen::Matrix<std::complex<double>, -1, -1, Eigen::RowMajor>(
+      lon.size(), n_constituents);
+  auto quality = Eigen::Vector<int8_t, -1>(lon.size());
 
-  auto n = int64_t{0};
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    auto acc = accelerator(0);
+    for (auto ix = static_cast<Eigen::Index>(start);
+         ix < static_cast<Eigen::Index>(end); ++ix) {
+      quality(ix) = static_cast<int8_t>(
+          interpolate(lon(ix), lat(ix), values.row(ix).data(), acc.get()));
+    }
+  };
+  parallel_for(worker, static_cast<size_t>(lon.size()), num_threads, 128);
+  return {std::move(values), std::move(quality)};
+}
 
-  // Compute the weights for the bilinear interpolation
-  auto wxy = bilinear_weights(normalize_angle(lon, x1), lat, x1, y1,
-                              normalize_angle(x2, x1), y2);
-
-  // Create the object that handles the grid data.
-  auto grid =
-      Grid<std::complex<T>>(nullptr, static_cast<size_t>(lon_.size()),
-                            static_cast<size_t>(lat_.size()), row_major_);
-
-  // For each constituent, handled by this model, compute the
-  // bilinear interpolation of the value at the given point.
-  for (const auto& item : this->data_) {
-    grid.data(item.second.data());
-    auto value = bilinear_interpolation<std::complex<double>>(
-        std::get<0>(wxy), std::get<1>(wxy), std::get<2>(wxy), std::get<3>(wxy),
-        grid(i1, j1), grid(i1, j2), grid(i2, j1), grid(i2, j2), n);
-    // The computed value lies within the grid boundaries, but it is NaN (not a
-    // number).
-    if (std::isnan(value.real()) || std::isnan(value.imag())) {
+template <typename T>
+inline auto TidalModel<T>::interpolate(const double lon, const double lat,
+                                       std::complex<double>* values,
+                                       Accelerator* acc) const -> Quality {
+  const auto cell = stencil(lon, lat);
+  if (!cell) {
+    std::fill(values, values + identifiers_.size(),
+              std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
+                                   std::numeric_limits<double>::quiet_NaN()));
+    return Quality::kUndefined;
+  }
+  return interpolate(*cell, values, acc);
+}
+
+template <typename T>
+inline auto TidalModel<T>::interpolate(const Stencil& stencil,
+                                       std::complex<double>* values,
+                                       Accelerator* acc) const -> Quality {
+  // Undefined value for the interpolation. This value is used to indicate
+  // that the interpolation failed or that the value is not defined.
+  constexpr auto undefined_value =
+      std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
+                           std::numeric_limits<double>::quiet_NaN());
+
+  // Reset the values to undefined if the model is undefined for the given
+  // point.
+  auto reset_values_to_undefined = [&]() -> Quality {
+    std::fill(values, values + identifiers_.size(), undefined_value);
+    return Quality::kUndefined;
+  };
+
+  const auto i1 = stencil.i1;
+  const auto i2 = stencil.i2;
+  const auto j1 = stencil.j1;
+  const auto j2 = stencil.j2;
+  const auto& wxy = stencil.wxy;
+
+  // The defined corners of the cell are known from the state of the nodes,
+  // before reading the waves: the cells over land are rejected at once. The
+  // state of the nodes of a tiled model is only known from their values.
+  auto defined = uint8_t{0};
+  auto mixed = false;
+  if (!tiles_) {
+    const auto nodes =
+        visit_grid([&](const auto& grid) -> std::array<int64_t, 4> {
+          return {grid.index(i1, j1), grid.index(i1, j2), grid.index(i2, j1),
+                  grid.index(i2, j2)};
+        });
+    for (size_t ix = 0; ix < nodes.size(); ++ix) {
+      const auto state = validity_[static_cast<size_t>(nodes[ix])];
+      defined |= static_cast<uint8_t>(
+          (state & kUndefinedNode) == 0 ? 1U << ix : 0U);
+      mixed |= state == (kDefinedNode | kUndefinedNode);
+    }
+    if (!mixed && defined == 0) {
       return reset_values_to_undefined();
     }
-    acc->emplace_back(item.first, value);
   }
 
+  // The values of the four corners of the cell, for all the constituents,
+  // are read from the model only if the cell is not already cached: only
+  // the weights depend on the point.
+  const auto n_constituents = identifiers_.size();
+  const auto* corners =
+      acc->find_cell<value_type>(i1, i2, j1, j2, n_constituents);
+  if (corners == nullptr) {
+    auto* cell = acc->insert_cell<value_type>(i1, i2, j1, j2, n_constituents,
+                                              stencil.x1, stencil.x2,
+                                              stencil.y1, stencil.y2);
+    if (tiles_) {
+      load_tiled_cell(i1, i2, j1, j2, cell);
+    } else {
+      visit_grid([&](const auto& grid) -> void {
+        load_cell(grid, i1, i2, j1, j2, cell);
+      });
+    }
+    corners = cell;
+  }
+  const auto* z11 = corners;
+  const auto* z12 = z11 + n_constituents;
+  const auto* z21 = z12 + n_constituents;
+  const auto* z22 = z21 + n_constituents;
+
+  // The four corners are contiguous blocks of values, decoded and
+  // interpolated in one pass, directly into the output array.
+  auto n = int64_t{0};
+  if (tiles_) {
+    n = interpolate_corners(wxy, corners, values);
+    mixed = n < 0;
+  } else if (!mixed) {
+    n = interpolate_corners(wxy, corners, values, defined);
+  }
+  if (!mixed && n == 0) {
+    return reset_values_to_undefined();
+  }
+  if (mixed) {
+    // Some corners mix defined and undefined values: each constituent must
+    // be interpolated with its own set of valid corners.
+    for (size_t ix = 0; ix < n_constituents; ++ix) {
+      const auto scale = scales_[ix];
+      values[ix] = bilinear_interpolation<std::complex<double>>(
+          std::get<0>(wxy), std::get<1>(wxy), std::get<2>(wxy),
+          std::get<3>(wxy), WaveStorage<T>::decode(z11[ix], scale),
+          WaveStorage<T>::decode(z12[ix], scale),
+          WaveStorage<T>::decode(z21[ix], scale),
+          WaveStorage<T>::decode(z22[ix], scale), n);
+      // The computed value lies within the grid boundaries, but it is NaN
+      // (not a number).
+      if (std::isnan(values[ix].real()) || std::isnan(values[ix].imag())) {
+        return reset_values_to_undefined();
+      }
+    }
+  }
   // Set the quality of the interpolation based on the number of
   // surrounding points used for the interpolation.
-  quality = (n == static_cast<int64_t>(Quality::kInterpolated))
-                ? Quality::kInterpolated
-            : (n == static_cast<int64_t>(Quality::kExtrapolated3))
-                ? Quality::kExtrapolated3
-            : (n == static_cast<int64_t>(Quality::kExtrapolated2))
-                ? Quality::kExtrapolated2
-            : (n == static_cast<int64_t>(Quality::kExtrapolated1))
-                ? Quality::kExtrapolated1
-                : Quality::kUndefined;
-  return acc->values();
+  auto quality = (n == static_cast<int64_t>(Quality::kInterpolated))
+                     ? Quality::kInterpolated
+                 : (n == static_cast<int64_t>(Quality::kExtrapolated3))
+                     ? Quality::kExtrapolated3
+                 : (n == static_cast<int64_t>(Quality::kExtrapolated2))
+                     ? Quality::kExtrapolated2
+                 : (n == static_cast<int64_t>(Quality::kExtrapolated1))
+                     ? Quality::kExtrapolated1
+                     : Quality::kUndefined;
+  return quality;
+}
+
+/// @brief Convert a tidal model to another storage type.
+///
+/// The waves are decoded and encoded again in the storage type requested,
+/// e.g. to store a model on 16 bits (see Float16 and Int16).
+/// @param model The tidal model to convert.
+/// @return The model converted, with the same axes and layout.
+/// @tparam U The type of the real values of the model returned.
+/// @tparam T The type of the real values of the model converted.
+template <typename U, typename T>
+auto convert_tidal_model(const TidalModel<T>& model)
+    -> std::shared_ptr<TidalModel<U>> {
+  using input_type = typename TidalModel<U>::input_type;
+  auto result = std::make_shared<TidalModel<U>>(
+      model.lon(), model.lat(), model.row_major(), model.packed());
+  const auto identifiers = model.identifiers();
+  auto wave = Eigen::Matrix<input_type, -1, -1, Eigen::RowMajor>(
+      model.row_major() ? model.lon().size() : model.lat().size(),
+      model.row_major() ? model.lat().size() : model.lon().size());
+  for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+    const auto values = model.wave(ix);
+    const auto scale = model.scale(ix);
+    for (int64_t jx = 0; jx < values.size(); ++jx) {
+      wave.data()[jx] =
+          input_type(WaveStorage<T>::decode(values(jx), scale));
+    }
+    result->add_constituent(identifiers[ix], wave);
+  }
+  result->pack();
+  return result;
 }
 
 }  // namespace perth
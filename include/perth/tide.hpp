@@ -1,42 +1,107 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <stdexcept>
 #include <tuple>
+#include <utility>
+#include <vector>
 
+#include "perth/active_set.hpp"
+#include "perth/approximation.hpp"
 #include "perth/constituent.hpp"
 #include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/hilbert.hpp"
 #include "perth/inference.hpp"
 #include "perth/math.hpp"
 #include "perth/nodal_corrections.hpp"
 #include "perth/parallel_for.hpp"
+#include "perth/profiling.hpp"
+#include "perth/thread_pool.hpp"
 #include "perth/tidal_model.hpp"
 
 namespace perth {
 
+/// @brief Row-major matrix type.
+template <typename T>
+using RowMajorMatrix = Eigen::Matrix<T, -1, -1, Eigen::RowMajor>;
+
+/// @brief Vector, possibly strided, written in place.
+template <typename T>
+using VectorRef = Eigen::Ref<Eigen::Vector<T, -1>, 0, Eigen::InnerStride<>>;
+
+/// @brief Vector, possibly strided, read in place.
+template <typename T>
+using ConstVectorRef =
+    Eigen::Ref<const Eigen::Vector<T, -1>, 0, Eigen::InnerStride<>>;
+
+/// @brief Strategy used to evaluate the tide at a set of points.
+enum class Backend : uint8_t {
+  /// The constituents are interpolated, inferred and summed at each point.
+  kPointwise,
+  /// The points are grouped by time bucket. Within a bucket, the inference,
+  /// the nodal corrections and the harmonic sum, linear in the interpolated
+  /// constituents, are folded once into a vector of coefficients: the tide
+  /// at a point reduces to the interpolation of the constituents followed by
+  /// a dot product with this vector.
+  kBatched,
+};
+
 template <typename T>
 class Perth {
  public:
+  /// @brief Construct the predictor of a tidal model.
+  ///
+  /// The model, which may be shared with other predictors, is not modified:
+  /// the constituents still staged in a packed model are interpolated from
+  /// their own arrays until TidalModel::pack() is called, as load_model()
+  /// does.
+  /// @param[in] tidal_model The tidal model.
+  /// @param[in] group_modulations Whether to apply the group modulations to
+  /// the nodal corrections.
   Perth(std::shared_ptr<TidalModel<T>> tidal_model,
         const bool group_modulations = false)
       : tidal_model_(std::move(tidal_model)),
         group_modulations_(group_modulations) {}
 
+  /// Results of evaluate(): the short-period tide, the long-period tide and
+  /// the quality flags.
+  using EvaluationResult = std::tuple<Eigen::VectorXd, Eigen::VectorXd,
+                                      Eigen::Vector<int8_t, -1>>;
+
   /// @brief Evaluate the tide at the given longitude, latitude, and time.
   /// @param[in] lon Longitudes in degrees.
   /// @param[in] lat Latitudes in degrees.
-  /// @param[in] time Time in seconds since the epoch.
-  /// @param[in] time_tolerance Tolerance for time matching in seconds.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] time_tolerance Time difference, in days, within which the
+  /// astronomical arguments and the nodal corrections are not recomputed.
   /// @param[in] interpolation_type Type of interpolation to use to compute
   /// inferred constituents. If equal to std::nullopt, no inference is done.
   /// @param[in] num_threads Number of threads to use for parallel computation.
   /// If equal to 0, the number of threads is determined automatically.
+  /// @param[in] sort_by_time If true, the points are processed in ascending
+  /// time order so that the astronomical arguments and the nodal corrections
+  /// are computed once per distinct time (or per time bucket of width
+  /// `time_tolerance`), whatever the order of the input. The results are
+  /// returned in the order of the input.
+  /// @param[in] sort_by_cell If true, the points are processed in the order
+  /// of a Hilbert curve over the cells of the model, so that consecutive
+  /// points share their cells, in the cache of the accelerator, or their
+  /// grid lines, in the cache of the processor. Combined with
+  /// `sort_by_time`, the points are sorted by time, or time bucket, first,
+  /// then along the curve. The results are returned in the order of the
+  /// input.
   /// @return A tuple containing:
   ///   - tide: Short-period tidal elevation values
   ///   - tide_lp: Long-period tidal elevation values
@@ -47,32 +112,532 @@ class Perth {
       const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
       const double time_tolerance = 0,
       const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+      const size_t num_threads = 0, const bool sort_by_time = false,
+      const bool sort_by_cell = false) const
+      -> std::tuple<Eigen::VectorXd, Eigen::VectorXd,
+                    Eigen::Vector<int8_t, -1>>;
+
+  /// @brief Evaluate the tide in the thread pool, without waiting for the
+  /// result.
+  ///
+  /// The evaluation runs in a worker of the pool shared by the process (see
+  /// ThreadPool::async()): concurrent evaluations share its threads instead
+  /// of each starting its own. The object must outlive the evaluation.
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] time_tolerance See evaluate().
+  /// @param[in] interpolation_type See evaluate().
+  /// @param[in] num_threads See evaluate().
+  /// @param[in] sort_by_time See evaluate().
+  /// @param[in] sort_by_cell See evaluate().
+  /// @return The future holding the result of evaluate(), or the exception
+  /// it has thrown.
+  auto evaluate_async(
+      Eigen::VectorXd lon, Eigen::VectorXd lat,
+      Eigen::Vector<int64_t, -1> time, double time_tolerance = 0,
+      std::optional<InterpolationType> interpolation_type = std::nullopt,
+      size_t num_threads = 0, bool sort_by_time = false,
+      bool sort_by_cell = false) const -> std::future<EvaluationResult>;
+
+  /// @brief Evaluate the tide in the thread pool, then hand the result to a
+  /// continuation.
+  ///
+  /// As evaluate_async(), the continuation being called by the worker with
+  /// the future, ready, of the evaluation. It must not throw.
+  /// @param[in] then The continuation called with the result.
+  auto evaluate_async(
+      std::function<void(std::future<EvaluationResult>)> then,
+      Eigen::VectorXd lon, Eigen::VectorXd lat,
+      Eigen::Vector<int64_t, -1> time, double time_tolerance = 0,
+      std::optional<InterpolationType> interpolation_type = std::nullopt,
+      size_t num_threads = 0, bool sort_by_time = false,
+      bool sort_by_cell = false) const -> void;
+
+  /// @brief Evaluate the tide at the given longitude, latitude, and time,
+  /// into buffers provided by the caller.
+  ///
+  /// As evaluate(), without allocating the results: the vectors, inputs and
+  /// outputs, may be strided views of larger arrays.
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[out] tide Short-period tidal elevation values.
+  /// @param[out] tide_lp Long-period tidal elevation values.
+  /// @param[out] quality Quality flags.
+  /// @param[in] time_tolerance See evaluate().
+  /// @param[in] interpolation_type See evaluate().
+  /// @param[in] num_threads See evaluate().
+  /// @param[in] sort_by_time See evaluate().
+  /// @param[in] sort_by_cell See evaluate().
+  /// @tparam Coordinate Type of the coordinates: float or double.
+  /// @throw std::invalid_argument If the vectors do not have the same size,
+  /// are empty, or if the time tolerance is negative.
+  template <typename Coordinate>
+  auto evaluate_into(
+      const ConstVectorRef<Coordinate>& lon,
+      const ConstVectorRef<Coordinate>& lat,
+      const ConstVectorRef<int64_t>& time, VectorRef<double> tide,
+      VectorRef<double> tide_lp, VectorRef<int8_t> quality,
+      const double time_tolerance = 0,
+      const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+      const size_t num_threads = 0, const bool sort_by_time = false,
+      const bool sort_by_cell = false) const -> void;
+
+  /// @brief Evaluate the tide at the given positions, at a single time.
+  ///
+  /// The astronomical arguments and nodal corrections are computed once for
+  /// all the positions: the tide at each position reduces to the product of
+  /// the interpolated constituents by the time-dependent factors.
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] interpolation_type Type of interpolation to use to compute
+  /// inferred constituents. If equal to std::nullopt, no inference is done.
+  /// @param[in] num_threads Number of threads to use for parallel computation.
+  /// If equal to 0, the number of threads is determined automatically.
+  /// @return A tuple containing the short-period tides, the long-period tides
+  /// and the quality flags.
+  auto evaluate_at_time(
+      const Eigen::Ref<const Eigen::VectorXd>& lon,
+      const Eigen::Ref<const Eigen::VectorXd>& lat, const int64_t time,
+      const std::optional<InterpolationType>& interpolation_type = std::nullopt,
       const size_t num_threads = 0) const
       -> std::tuple<Eigen::VectorXd, Eigen::VectorXd,
                     Eigen::Vector<int8_t, -1>>;
 
+  /// @brief Evaluate the tide on a grid, at a single time.
+  ///
+  /// As evaluate_at_time(), for all the nodes of the grid defined by the
+  /// given coordinates.
+  /// @param[in] lon Longitudes of the grid in degrees.
+  /// @param[in] lat Latitudes of the grid in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] interpolation_type Type of interpolation to use to compute
+  /// inferred constituents. If equal to std::nullopt, no inference is done.
+  /// @param[in] num_threads Number of threads to use for parallel computation.
+  /// If equal to 0, the number of threads is determined automatically.
+  /// @return A tuple containing the short-period tides, the long-period tides
+  /// and the quality flags, as matrices of shape (lon.size(), lat.size()).
+  auto evaluate_grid(
+      const Eigen::Ref<const Eigen::VectorXd>& lon,
+      const Eigen::Ref<const Eigen::VectorXd>& lat, const int64_t time,
+      const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+      const size_t num_threads = 0) const
+      -> std::tuple<RowMajorMatrix<double>, RowMajorMatrix<double>,
+                    RowMajorMatrix<int8_t>>;
+
+  /// @brief Predict the tide at a fixed position over evenly spaced times.
+  ///
+  /// The constituents are interpolated, and inferred, once. The phasor
+  /// f·exp(i(V+u)) of each constituent is then advanced from one sample to
+  /// the next by a constant complex rotation, and computed exactly again at
+  /// every refresh interval, where the nodal corrections are also updated.
+  /// @param[in] lon Longitude in degrees.
+  /// @param[in] lat Latitude in degrees.
+  /// @param[in] start Time of the first sample, in microseconds since the
+  /// epoch.
+  /// @param[in] step Time step between two samples, in microseconds.
+  /// @param[in] size Number of samples.
+  /// @param[in] interpolation_type Type of interpolation to use to compute
+  /// inferred constituents. If equal to std::nullopt, no inference is done.
+  /// @param[in] refresh_interval Interval, in microseconds, at which the
+  /// phasors are computed exactly. If not given, one day, or three hours if
+  /// the group modulations, which vary faster, are applied.
+  /// @param[in] num_threads Number of threads to use for parallel computation.
+  /// If equal to 0, the number of threads is determined automatically.
+  /// @return A tuple containing the short-period tides, the long-period tides
+  /// and the quality of the interpolation at the position.
+  /// @throw std::invalid_argument If the number of samples or the refresh
+  /// interval is not positive.
+  auto predict_time_series(
+      const double lon, const double lat, const int64_t start,
+      const int64_t step, const int64_t size,
+      const std::optional<InterpolationType>& interpolation_type = std::nullopt,
+      const std::optional<int64_t>& refresh_interval = std::nullopt,
+      const size_t num_threads = 0) const
+      -> std::tuple<Eigen::VectorXd, Eigen::VectorXd, Quality>;
+
+  /// @brief Tabulate the nodal corrections over a time span.
+  ///
+  /// The next evaluations interpolate the nodal corrections in the table
+  /// for the times within the span instead of computing them. This method
+  /// must not be called while an evaluation is in progress.
+  /// @param[in] start First time of the span, in microseconds since the
+  /// epoch.
+  /// @param[in] end Last time of the span, in microseconds since the epoch.
+  /// @param[in] step Step between two tabulated times, in days. If not
+  /// given, one day, or three hours if the group modulations are applied.
+  /// @throw std::invalid_argument If the span is empty or the step is not
+  /// positive.
+  auto tabulate_nodal_corrections(
+      const int64_t start, const int64_t end,
+      const std::optional<double>& step = std::nullopt) -> void {
+    nodal_correction_table_ = std::make_shared<const NodalCorrectionTable>(
+        epoch_to_modified_julian_date(start),
+        epoch_to_modified_julian_date(end),
+        step.value_or(group_modulations_ ? 0.125 : 1.0), group_modulations_,
+        assemble_constituent_table(tidal_model_->identifiers()).keys_vector());
+  }
+
+  /// @brief Get the table of the nodal corrections, or nullptr if they are
+  /// not tabulated.
+  [[nodiscard]] auto nodal_correction_table() const noexcept
+      -> const std::shared_ptr<const NodalCorrectionTable>& {
+    return nodal_correction_table_;
+  }
+
+  /// @brief Use a series of Delta T (TT - UT), e.g. published by the IERS,
+  /// instead of the model of calculate_delta_time().
+  ///
+  /// Within the span of the series, the next evaluations interpolate Delta T
+  /// in it; outside, the model is used. This method must not be called while
+  /// an evaluation is in progress.
+  /// @param[in] time Times of the values, in microseconds since the epoch,
+  /// strictly increasing.
+  /// @param[in] delta Delta T at each time, in seconds.
+  /// @throw std::invalid_argument If the vectors have different sizes, hold
+  /// less than two values, or if the times are not strictly increasing.
+  auto set_delta_time_series(
+      const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+      const Eigen::Ref<const Eigen::VectorXd>& delta) -> void {
+    auto days = std::vector<double>(static_cast<size_t>(time.size()));
+    for (size_t ix = 0; ix < days.size(); ++ix) {
+      days[ix] = epoch_to_modified_julian_date(time(static_cast<int64_t>(ix)));
+    }
+    delta_time_series_ = std::make_shared<const DeltaTimeSeries>(
+        std::move(days), std::vector<double>(delta.begin(), delta.end()));
+  }
+
+  /// @brief Get the series of Delta T used, or nullptr if Delta T is given by
+  /// the model.
+  [[nodiscard]] auto delta_time_series() const noexcept
+      -> const std::shared_ptr<const DeltaTimeSeries>& {
+    return delta_time_series_;
+  }
+
+  /// @brief Select the strategy used by evaluate() and evaluate_into().
+  ///
+  /// The batched backend is faster when many points share a time bucket,
+  /// e.g. for swaths, grids or a positive time tolerance. It processes the
+  /// points in ascending time order, whatever the value of `sort_by_time`,
+  /// and ignores `sort_by_cell`. Its results match those of the pointwise
+  /// backend processing the points in the same order to within a few ulps
+  /// of the tide: the sums are only computed in another order, an absolute
+  /// tolerance of 1e-9 in the unit of the model covers them. This method
+  /// must not be called while an evaluation is in progress.
+  /// @param[in] backend The backend to use.
+  auto set_backend(const Backend backend) noexcept -> void {
+    backend_ = backend;
+  }
+
+  /// @brief Get the strategy used by evaluate() and evaluate_into().
+  [[nodiscard]] constexpr auto backend() const noexcept -> Backend {
+    return backend_;
+  }
+
+  /// @brief Select how the astronomical arguments are provided within the
+  /// time tolerance given to the evaluations.
+  ///
+  /// By default, the arguments are frozen within the tolerance: a larger
+  /// tolerance trades the accuracy of the phases, e.g. 0.48 degree of M2 per
+  /// minute, for speed. With ArgumentMode::kExtrapolated, they are computed
+  /// at the start of each window and extrapolated linearly with the rates of
+  /// the constituents inside it, allowing tolerances of hours (e.g. 1/24
+  /// day) without loss of accuracy; only the nodal corrections, slowly
+  /// varying, are frozen. The batched backend folds its coefficients at the
+  /// first time of each bucket. This method must not be called while an
+  /// evaluation is in progress.
+  /// @param[in] mode The mode to use.
+  auto set_argument_mode(const ArgumentMode mode) noexcept -> void {
+    argument_mode_ = mode;
+  }
+
+  /// @brief Get how the astronomical arguments are provided within the time
+  /// tolerance.
+  [[nodiscard]] constexpr auto argument_mode() const noexcept
+      -> ArgumentMode {
+    return argument_mode_;
+  }
+
+  /// @brief Allow the evaluations to take shortcuts, as long as their error
+  /// does not exceed a budget.
+  ///
+  /// With a positive budget, the inferred constituents whose contribution is
+  /// bounded by the smallest values are no longer computed, and evaluate()
+  /// and evaluate_into() keep the nodal corrections within a time tolerance,
+  /// the tidal arguments being extrapolated, as with
+  /// ArgumentMode::kExtrapolated. The shortcuts are selected from the
+  /// largest amplitudes of the waves of the model (see
+  /// select_approximation()); approximation() returns them, with the error
+  /// bound they guarantee. A time tolerance larger than the one selected can
+  /// still be given to the evaluations: the error it causes is not covered
+  /// by the bound. The batched backend, which folds the arguments at the
+  /// first time of each bucket, only drops the constituents. This method
+  /// must not be called while an evaluation is in progress.
+  /// @param[in] max_error The budget, in the unit of the model. If 0, the
+  /// evaluations are exact.
+  /// @throw std::invalid_argument If the budget is negative, or positive for
+  /// a tiled model, whose waves are not all in memory.
+  auto set_error_budget(const double max_error) -> void {
+    if (!(max_error >= 0)) {
+      throw std::invalid_argument("The error budget must be non-negative");
+    }
+    if (max_error > 0 && tidal_model_->tiled()) {
+      throw std::invalid_argument(
+          "The error budget requires the waves of the model in memory");
+    }
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    error_budget_ = max_error;
+    // The plans and the contexts copied from them take the shortcuts of the
+    // previous budget.
+    plans_.clear();
+    contexts_.clear();
+  }
+
+  /// @brief Get the error budget of the evaluations, 0 if they are exact.
+  [[nodiscard]] constexpr auto error_budget() const noexcept -> double {
+    return error_budget_;
+  }
+
+  /// @brief Get the shortcuts taken by the evaluations within the error
+  /// budget.
+  /// @param[in] interpolation_type Type of interpolation used to compute
+  /// inferred constituents, std::nullopt if no inference is done.
+  /// @return The shortcuts and the error bound they guarantee; none if the
+  /// budget is 0. The evaluations keep the nodal corrections within the
+  /// larger of the time tolerance selected, in days, and the one they are
+  /// given: the bound only covers the former.
+  [[nodiscard]] auto approximation(
+      const std::optional<InterpolationType>& interpolation_type =
+          std::nullopt) const -> Approximation {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return plan(interpolation_type)->approximation;
+  }
+
+  /// @brief Get the counters of the last evaluation completed by evaluate(),
+  /// evaluate_at_time() or evaluate_grid().
+  ///
+  /// The counters are only updated if the library is built with profiling
+  /// enabled (see kProfiling); otherwise they remain zero.
+  [[nodiscard]] auto last_stats() const -> EvaluationStats {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return last_stats_;
+  }
+
   constexpr auto tidal_model() const -> const std::shared_ptr<TidalModel<T>>& {
     return tidal_model_;
   }
 
  private:
+  /// @brief Immutable state shared by the contexts using the same inference.
+  ///
+  /// Assembling the constituent table and building the inference and the
+  /// active set cost more than evaluating a small batch of points: they are
+  /// done once, and the contexts copy the result.
+  struct Plan {
+    Plan(const TidalModel<T>& tidal_model,
+         const std::optional<InterpolationType>& interpolation_type,
+         const bool group_modulations, const double error_budget)
+        : identifiers(tidal_model.identifiers()),
+          tide_table(assemble_constituent_table(identifiers)),
+          inference(interpolation_type.has_value()
+                        ? std::make_unique<Inference>(tide_table,
+                                                      *interpolation_type)
+                        : nullptr),
+          approximation(error_budget > 0
+                            ? select_approximation(
+                                  tide_table, inference.get(), identifiers,
+                                  tidal_model.max_amplitudes(),
+                                  group_modulations, error_budget)
+                            : Approximation{}),
+          active_set(tide_table, drop(inference.get(), approximation)),
+          interpolation_type(interpolation_type) {}
+
+    /// Constituents of the model when the plan was created.
+    std::vector<Constituent> identifiers;
+    ConstituentTable tide_table;  ///< Tide table of the model
+    std::unique_ptr<Inference> inference;  ///< Inference, if any
+    Approximation approximation;  ///< Shortcuts within the error budget
+    ActiveSet active_set;  ///< Constituents contributing
+    /// Interpolation type used by the inference.
+    std::optional<InterpolationType> interpolation_type;
+
+    /// @brief Drop the constituents of the approximation from the
+    /// inference, before the active set is built.
+    static auto drop(Inference* inference, const Approximation& approximation)
+        -> const Inference* {
+      if (inference != nullptr) {
+        inference->drop(approximation.dropped);
+      }
+      return inference;
+    }
+  };
+
+  /// @brief State reused by the threads to evaluate the tide.
+  struct Context {
+    Context(std::shared_ptr<const Plan> plan, const double time_tolerance)
+        : tide_table(plan->tide_table),
+          acc(time_tolerance, tide_table.size()),
+          inference(plan->inference.get()),
+          active_set(plan->active_set),
+          plan(std::move(plan)) {}
+
+    ConstituentTable tide_table;  ///< Tide table of the model
+    Accelerator acc;              ///< Accelerator of the thread
+    const Inference* inference;   ///< Inference of the plan, if any
+    ActiveSet active_set;         ///< Constituents contributing
+    std::shared_ptr<const Plan> plan;  ///< Plan the context is copied from
+  };
+
   std::shared_ptr<TidalModel<T>> tidal_model_;
   bool group_modulations_{false};  ///< Whether to apply group modulations.
+  /// Strategy used to evaluate a set of points.
+  Backend backend_{Backend::kPointwise};
+  /// How the arguments are provided within the time tolerance.
+  ArgumentMode argument_mode_{ArgumentMode::kFrozen};
+  /// Error allowed to the evaluations, 0 if they are exact.
+  double error_budget_{0};
+  /// Nodal corrections tabulated over a time span, if any.
+  std::shared_ptr<const NodalCorrectionTable> nodal_correction_table_;
+  /// Series of Delta T used instead of the model, if any.
+  std::shared_ptr<const DeltaTimeSeries> delta_time_series_;
+
+  /// Plans of the contexts, one per interpolation type used.
+  mutable std::vector<std::shared_ptr<const Plan>> plans_;
+  /// Contexts not in use, ready to be reused by the next evaluations.
+  mutable std::vector<std::unique_ptr<Context>> contexts_;
+  /// Counters of the last evaluation completed.
+  mutable EvaluationStats last_stats_;
+  /// Protects the plans, the contexts and the counters.
+  mutable std::mutex mutex_;
+
+  /// @brief Get the plan of the contexts using the given inference, built
+  /// the first time it is requested. Must be called with the mutex locked.
+  auto plan(const std::optional<InterpolationType>& interpolation_type) const
+      -> std::shared_ptr<const Plan>;
+
+  /// @brief Get a context set up for the given parameters, reusing an idle
+  /// one if possible.
+  auto acquire_context(const double time_tolerance,
+                       const std::optional<InterpolationType>&
+                           interpolation_type) const
+      -> std::unique_ptr<Context>;
+
+  /// @brief Return a context to the set of idle contexts.
+  auto release_context(std::unique_ptr<Context> context) const -> void;
+
+  /// @brief Get the order in which the points are processed when they are
+  /// sorted by cell of the model, see evaluate().
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] time_tolerance Width of the time buckets, in days. If zero,
+  /// each distinct time is a bucket.
+  /// @param[in] sort_by_time Whether the points are sorted by time bucket
+  /// first.
+  /// @param[in] num_threads See evaluate().
+  /// @return The indices of the points, in the order of processing.
+  template <typename Coordinate>
+  auto cell_order(const ConstVectorRef<Coordinate>& lon,
+                  const ConstVectorRef<Coordinate>& lat,
+                  const ConstVectorRef<int64_t>& time,
+                  const double time_tolerance, const bool sort_by_time,
+                  const size_t num_threads) const -> std::vector<int64_t>;
+
+  /// @brief Evaluate the tide at a set of points.
+  /// @param[in] size Number of points.
+  /// @param[in] point Function returning, for the k-th point processed, the
+  /// index where its results are stored, its longitude, latitude and time in
+  /// decimal Modified Julian Days.
+  /// @param[in] time_tolerance See evaluate().
+  /// @param[in] interpolation_type See evaluate().
+  /// @param[in] num_threads See evaluate().
+  /// @param[out] tide Short-period tides.
+  /// @param[out] tide_lp Long-period tides.
+  /// @param[out] quality Quality flags.
+  template <typename Point>
+  auto evaluate_points(
+      const int64_t size, const Point& point, const double time_tolerance,
+      const std::optional<InterpolationType>& interpolation_type,
+      const size_t num_threads, VectorRef<double> tide,
+      VectorRef<double> tide_lp, VectorRef<int8_t> quality) const -> void;
+
+  /// @brief Evaluate the tide at a set of points with the batched backend.
+  /// @param[in] lon Longitudes in degrees.
+  /// @param[in] lat Latitudes in degrees.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[out] tide Short-period tides.
+  /// @param[out] tide_lp Long-period tides.
+  /// @param[out] quality Quality flags.
+  /// @param[in] time_tolerance See evaluate().
+  /// @param[in] interpolation_type See evaluate().
+  /// @param[in] num_threads See evaluate().
+  template <typename Coordinate>
+  auto evaluate_batched(
+      const ConstVectorRef<Coordinate>& lon,
+      const ConstVectorRef<Coordinate>& lat,
+      const ConstVectorRef<int64_t>& time, VectorRef<double> tide,
+      VectorRef<double> tide_lp, VectorRef<int8_t> quality,
+      const double time_tolerance,
+      const std::optional<InterpolationType>& interpolation_type,
+      const size_t num_threads) const -> void;
+
+  /// @brief Points of an evaluation grouped by time bucket, with the
+  /// coefficients of each bucket.
+  struct TimeBuckets {
+    /// Indices of the points, in ascending time order.
+    std::vector<int64_t> order;
+    /// First position of each bucket in `order`, followed by the number of
+    /// points.
+    std::vector<size_t> first;
+    /// Coefficients of the buckets, see fold_coefficients().
+    std::vector<double> coefficients;
+  };
+
+  /// @brief Group the points by time bucket in ascending time order and fold
+  /// the coefficients of each bucket.
+  /// @param[in] time Time in microseconds since the epoch.
+  /// @param[in] time_tolerance See evaluate().
+  /// @param[in] interpolation_type See evaluate().
+  /// @param[in] num_threads See evaluate().
+  auto time_buckets(const ConstVectorRef<int64_t>& time,
+                    const double time_tolerance,
+                    const std::optional<InterpolationType>& interpolation_type,
+                    const size_t num_threads) const -> TimeBuckets;
+
+  /// @brief Fold the inference, the nodal corrections and the harmonic sum
+  /// at a time into coefficients applied to the interpolated constituents.
+  /// @param[in] time Time in decimal Modified Julian Days.
+  /// @param[in,out] context Context used to compute the coefficients.
+  /// @param[out] coefficients The `4 * n + 2` coefficients, where n is the
+  /// number of constituents of the model: the factors of the real and
+  /// imaginary parts of the constituents for the short-period tide, then
+  /// for the long-period tide, then the factors of P20(lat) for the
+  /// short-period and long-period tides.
+  auto fold_coefficients(const double time, Context& context,
+                         double* coefficients) const -> void;
 
   auto evaluate_tide(const double lon, const double lat, const double time,
-                     ConstituentTable& tide_table, Inference* inference,
-                     Accelerator* acc) const
+                     ConstituentTable& tide_table, const Inference* inference,
+                     ActiveSet& active_set, Accelerator* acc,
+                     EvaluationStats& stats) const
       -> std::tuple<double, double, Quality>;
 };
 
 template <typename T>
 auto Perth<T>::evaluate_tide(const double lon, const double lat,
                              const double time, ConstituentTable& tide_table,
-                             Inference* inference, Accelerator* acc) const
+                             const Inference* inference, ActiveSet& active_set,
+                             Accelerator* acc, EvaluationStats& stats) const
     -> std::tuple<double, double, Quality> {
   // Interpolation, at the requested position, of the waves provided by the
   // model used.
-  auto quality = tidal_model_->interpolate(lon, lat, tide_table, acc);
+  auto quality = Quality::kUndefined;
+  {
+    auto timer = StageTimer(stats, kInterpolationStage);
+    quality = tidal_model_->interpolate(lon, lat, tide_table, acc);
+  }
   if (quality == Quality::kUndefined) {
     // If the interpolation failed, return undefined values.
     return {std::numeric_limits<double>::quiet_NaN(),
@@ -81,32 +646,93 @@ auto Perth<T>::evaluate_tide(const double lon, const double lat,
 
   if (inference) {
     // If an inference is provided, use it to fill the tide table.
+    auto timer = StageTimer(stats, kInferenceStage);
     (*inference)(tide_table, lat);
   }
 
   // Update astronomical arguments, nodal corrections, and Doodson arguments
   // for tidal constituents if the time has changed significantly.
-  acc->update_args(time, group_modulations_, tide_table);
-
-  double tide = 0.0;
-  double tide_lp = 0.0;
-  // Sum over all constituents to compute the final tide.
-  for (size_t ix = 0; ix < tide_table.size(); ++ix) {
-    const auto& nodal_correction = acc->nodal_corrections()[ix];
-    const auto& component = tide_table.at(ix).second;
-    const auto& constituent_tide = component.tide;
-    auto x = radians(component.tidal_argument + nodal_correction.u);
-    auto h = constituent_tide.real() * nodal_correction.f * std::cos(x) +
-             constituent_tide.imag() * nodal_correction.f * std::sin(x);
-    if (component.type == ConstituentType::kLongPeriod) {
-      tide_lp += h;
-    } else {
-      tide += h;
+  {
+    auto timer = StageTimer(stats, kArgumentsStage);
+    if (acc->update_args(time, group_modulations_, tide_table)) {
+      active_set.update(tide_table, acc->nodal_corrections());
+      if constexpr (kProfiling) {
+        ++stats.argument_updates;
+      }
     }
   }
+
+  // Sum over the constituents contributing to the tide.
+  auto timer = StageTimer(stats, kSummationStage);
+  auto [tide, tide_lp] = active_set.evaluate(tide_table);
   return {tide, tide_lp, quality};
 }
 
+template <typename T>
+auto Perth<T>::plan(
+    const std::optional<InterpolationType>& interpolation_type) const
+    -> std::shared_ptr<const Plan> {
+  // The plans built before constituents were added to the model are stale.
+  std::erase_if(plans_, [&](const auto& item) -> bool {
+    return item->identifiers.size() != tidal_model_->size();
+  });
+  for (const auto& item : plans_) {
+    if (item->interpolation_type == interpolation_type) {
+      return item;
+    }
+  }
+  return plans_.emplace_back(std::make_shared<const Plan>(
+      *tidal_model_, interpolation_type, group_modulations_, error_budget_));
+}
+
+template <typename T>
+auto Perth<T>::acquire_context(
+    const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type) const
+    -> std::unique_ptr<Context> {
+  auto context = std::unique_ptr<Context>{};
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    // Start from the most recently released contexts, which are the most
+    // likely to be set up for the current evaluation.
+    for (auto it = contexts_.rbegin(); it != contexts_.rend(); ++it) {
+      auto& item = *it;
+      if (item->acc.time_tolerance() == time_tolerance &&
+          item->plan->interpolation_type == interpolation_type &&
+          item->plan->identifiers.size() == tidal_model_->size()) {
+        context = std::move(item);
+        contexts_.erase(std::next(it).base());
+        break;
+      }
+    }
+    if (context == nullptr) {
+      context =
+          std::make_unique<Context>(plan(interpolation_type), time_tolerance);
+    }
+  }
+  context->acc.nodal_correction_table(nodal_correction_table_);
+  context->acc.delta_time_series(delta_time_series_);
+  // Within the error budget, the nodal corrections are kept within the time
+  // tolerance, not the arguments.
+  context->acc.argument_mode(error_budget_ > 0 ? ArgumentMode::kExtrapolated
+                                               : argument_mode_);
+  return context;
+}
+
+template <typename T>
+auto Perth<T>::release_context(std::unique_ptr<Context> context) const
+    -> void {
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  // Keep at most two contexts per thread of the pool: the oldest ones were
+  // set up for evaluations that are no longer performed.
+  auto capacity = 2 * ThreadPool::num_threads();
+  if (contexts_.size() >= capacity) {
+    contexts_.erase(contexts_.begin(),
+                    contexts_.begin() + (contexts_.size() - capacity + 1));
+  }
+  contexts_.emplace_back(std::move(context));
+}
+
 template <typename T>
 auto Perth<T>::evaluate(
     const Eigen::Ref<const Eigen::VectorXd>& lon,
@@ -114,11 +740,67 @@ auto Perth<T>::evaluate(
     const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
     const double time_tolerance,
     const std::optional<InterpolationType>& interpolation_type,
-    const size_t num_threads) const
+    const size_t num_threads, const bool sort_by_time,
+    const bool sort_by_cell) const
     -> std::tuple<Eigen::VectorXd, Eigen::VectorXd, Eigen::Vector<int8_t, -1>> {
+  // Create the output vectors.
+  Eigen::VectorXd tide(lon.size());
+  Eigen::VectorXd tide_lp(lon.size());
+  Eigen::Vector<int8_t, -1> quality(lon.size());
+  evaluate_into<double>(lon, lat, time, tide, tide_lp, quality,
+                        time_tolerance, interpolation_type, num_threads,
+                        sort_by_time, sort_by_cell);
+  return {tide, tide_lp, quality};
+}
+
+template <typename T>
+auto Perth<T>::evaluate_async(
+    Eigen::VectorXd lon, Eigen::VectorXd lat, Eigen::Vector<int64_t, -1> time,
+    const double time_tolerance,
+    std::optional<InterpolationType> interpolation_type,
+    const size_t num_threads, const bool sort_by_time,
+    const bool sort_by_cell) const -> std::future<EvaluationResult> {
+  return ThreadPool::instance()->async(
+      [this, lon = std::move(lon), lat = std::move(lat),
+       time = std::move(time), time_tolerance, interpolation_type,
+       num_threads, sort_by_time, sort_by_cell]() -> EvaluationResult {
+        return evaluate(lon, lat, time, time_tolerance, interpolation_type,
+                        num_threads, sort_by_time, sort_by_cell);
+      });
+}
+
+template <typename T>
+auto Perth<T>::evaluate_async(
+    std::function<void(std::future<EvaluationResult>)> then,
+    Eigen::VectorXd lon, Eigen::VectorXd lat, Eigen::Vector<int64_t, -1> time,
+    const double time_tolerance,
+    std::optional<InterpolationType> interpolation_type,
+    const size_t num_threads, const bool sort_by_time,
+    const bool sort_by_cell) const -> void {
+  ThreadPool::instance()->async(
+      [this, lon = std::move(lon), lat = std::move(lat),
+       time = std::move(time), time_tolerance, interpolation_type,
+       num_threads, sort_by_time, sort_by_cell]() -> EvaluationResult {
+        return evaluate(lon, lat, time, time_tolerance, interpolation_type,
+                        num_threads, sort_by_time, sort_by_cell);
+      },
+      std::move(then));
+}
+
+template <typename T>
+template <typename Coordinate>
+auto Perth<T>::evaluate_into(
+    const ConstVectorRef<Coordinate>& lon,
+    const ConstVectorRef<Coordinate>& lat, const ConstVectorRef<int64_t>& time,
+    VectorRef<double> tide, VectorRef<double> tide_lp,
+    VectorRef<int8_t> quality, const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads, const bool sort_by_time,
+    const bool sort_by_cell) const -> void {
   auto size = lon.size();
-  // Check that the input vectors have the same size.
-  if (size != lat.size() || size != time.size()) {
+  // Check that the input and output vectors have the same size.
+  if (size != lat.size() || size != time.size() || size != tide.size() ||
+      size != tide_lp.size() || size != quality.size()) {
     throw std::invalid_argument("Input vectors must have the same size");
   }
   // Check for empty input
@@ -129,36 +811,454 @@ auto Perth<T>::evaluate(
   if (time_tolerance < 0) {
     throw std::invalid_argument("Time tolerance must be non-negative");
   }
-  // Create the output vectors.
-  Eigen::VectorXd tide = Eigen::VectorXd::Zero(size);
-  Eigen::VectorXd tide_lp = Eigen::VectorXd::Zero(size);
-  Eigen::Vector<int8_t, -1> quality = Eigen::Vector<int8_t, -1>::Zero(size);
+  if (backend_ == Backend::kBatched) {
+    evaluate_batched<Coordinate>(lon, lat, time, tide, tide_lp, quality,
+                                 time_tolerance, interpolation_type,
+                                 num_threads);
+    return;
+  }
+  // Within the error budget, the points share the nodal corrections over
+  // wider time buckets.
+  const auto tolerance =
+      error_budget_ > 0
+          ? std::max(time_tolerance,
+                     approximation(interpolation_type).time_tolerance)
+          : time_tolerance;
 
-  auto worker = [&](const size_t start, const size_t end) -> void {
-    // Create the tide table and accelerator.
-    ConstituentTable tide_table =
-        assemble_constituent_table(tidal_model_->identifiers());
-    Accelerator acc(time_tolerance, tide_table.size());
+  // Order in which the points are processed. Empty if they are processed in
+  // the order of the input.
+  auto order = std::vector<int64_t>();
+  if (sort_by_cell) {
+    order = cell_order<Coordinate>(lon, lat, time, tolerance, sort_by_time,
+                                   num_threads);
+  } else if (sort_by_time &&
+             !std::is_sorted(time.data(), time.data() + time.size())) {
+    order.resize(static_cast<size_t>(size));
+    std::iota(order.begin(), order.end(), int64_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&time](const int64_t lhs, const int64_t rhs) {
+                       return time(lhs) < time(rhs);
+                     });
+  }
 
-    auto inference = std::unique_ptr<Inference>(
-        interpolation_type.has_value()
-            ? new Inference(tide_table, *interpolation_type)
-            : nullptr);
-    auto inference_ptr = inference.get();
+  evaluate_points(
+      size,
+      [&](const int64_t jx) -> std::tuple<int64_t, double, double, double> {
+        auto ix = order.empty() ? jx : order[jx];
+        return {ix, static_cast<double>(lon(ix)), static_cast<double>(lat(ix)),
+                epoch_to_modified_julian_date(time(ix))};
+      },
+      tolerance, interpolation_type, num_threads, tide, tide_lp, quality);
+}
+
+template <typename T>
+template <typename Coordinate>
+auto Perth<T>::cell_order(
+    const ConstVectorRef<Coordinate>& lon,
+    const ConstVectorRef<Coordinate>& lat, const ConstVectorRef<int64_t>& time,
+    const double time_tolerance, const bool sort_by_time,
+    const size_t num_threads) const -> std::vector<int64_t> {
+  /// Sort key of a point.
+  struct Key {
+    int64_t bucket;  ///< Time bucket, or zero if not sorted by time
+    uint64_t cell;   ///< Position of the cell along the Hilbert curve
+    int64_t index;   ///< Index of the point in the input
+  };
+  const auto& lon_axis = tidal_model_->lon();
+  const auto& lat_axis = tidal_model_->lat();
+  const auto curve = hilbert_order(static_cast<uint64_t>(
+      std::max(lon_axis.size(), lat_axis.size())));
 
+  auto keys = std::vector<Key>(static_cast<size_t>(lon.size()));
+  auto worker = [&](const size_t start, const size_t end) -> void {
     for (auto ix = start; ix < end; ++ix) {
+      auto& key = keys[ix];
+      key.index = static_cast<int64_t>(ix);
+      key.bucket = 0;
+      if (sort_by_time) {
+        const auto t = time(key.index);
+        key.bucket =
+            time_tolerance > 0
+                ? static_cast<int64_t>(std::floor(
+                      epoch_to_modified_julian_date(t) / time_tolerance))
+                : t;
+      }
+      // The points outside the model are processed last.
+      const auto i = lon_axis.find_indices(lon(key.index));
+      const auto j = lat_axis.find_indices(lat(key.index));
+      key.cell = i && j ? hilbert_index(
+                              curve, static_cast<uint32_t>(std::get<0>(*i)),
+                              static_cast<uint32_t>(std::get<0>(*j)))
+                        : std::numeric_limits<uint64_t>::max();
+    }
+  };
+  parallel_for(worker, keys.size(), num_threads, 4096);
+
+  std::sort(keys.begin(), keys.end(), [](const Key& lhs, const Key& rhs) {
+    return std::tie(lhs.bucket, lhs.cell, lhs.index) <
+           std::tie(rhs.bucket, rhs.cell, rhs.index);
+  });
+  auto order = std::vector<int64_t>(keys.size());
+  std::transform(keys.begin(), keys.end(), order.begin(),
+                 [](const Key& key) -> int64_t { return key.index; });
+  return order;
+}
+
+template <typename T>
+template <typename Point>
+auto Perth<T>::evaluate_points(
+    const int64_t size, const Point& point, const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads, VectorRef<double> tide,
+    VectorRef<double> tide_lp, VectorRef<int8_t> quality) const -> void {
+  // Counters of the evaluation, summed over the blocks.
+  auto total = EvaluationStats{};
+  auto total_mutex = std::mutex{};
+
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    // Reuse the tide table, accelerator, inference and active set of a
+    // previous block or evaluation.
+    auto context = acquire_context(time_tolerance, interpolation_type);
+    auto stats = EvaluationStats{};
+    const auto cell_hits = context->acc.cell_hits();
+    const auto cell_misses = context->acc.cell_misses();
+
+    for (auto jx = start; jx < end; ++jx) {
+      auto [ix, x, y, t] = point(static_cast<int64_t>(jx));
       // Evaluate the tide at the current position and time.
       auto [tide_value, tide_lp_value, quality_value] = evaluate_tide(
-          lon(ix), lat(ix), epoch_to_modified_julian_date(time(ix)), tide_table,
-          inference_ptr, &acc);
+          x, y, t, context->tide_table, context->inference,
+          context->active_set, &context->acc, stats);
 
       // Store the results in the output vectors.
       tide(ix) = tide_value;
       tide_lp(ix) = tide_lp_value;
       quality(ix) = static_cast<int8_t>(quality_value);
+      if constexpr (kProfiling) {
+        ++stats.quality[quality_value];
+      }
+    }
+    if constexpr (kProfiling) {
+      stats.points = static_cast<int64_t>(end - start);
+      stats.cell_hits = context->acc.cell_hits() - cell_hits;
+      stats.cell_misses = context->acc.cell_misses() - cell_misses;
+      auto lock = std::lock_guard<std::mutex>(total_mutex);
+      total += stats;
+    }
+    release_context(std::move(context));
+  };
+  parallel_for(worker, static_cast<size_t>(size), num_threads, 128);
+
+  if constexpr (kProfiling) {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    last_stats_ = total;
+  }
+}
+
+template <typename T>
+auto Perth<T>::fold_coefficients(const double time, Context& context,
+                                 double* coefficients) const -> void {
+  auto& table = context.tide_table;
+  if (context.acc.update_args(time, group_modulations_, table)) {
+    context.active_set.update(table, context.acc.nodal_corrections());
+  }
+  // The inference and the summation are linear in the constituents, except
+  // for the equilibrium node tide, proportional to P20(lat), used if the
+  // node is inferred. At the equator, P20 is 1/2.
+  auto summation = [&]() -> std::tuple<double, double> {
+    if (context.inference) {
+      (*context.inference)(table, 0);
+    }
+    return context.active_set.evaluate(table);
+  };
+  const auto& identifiers = context.plan->identifiers;
+  const auto n = identifiers.size();
+  for (const auto& ident : identifiers) {
+    table[ident].tide = Complex(0, 0);
+  }
+  const auto [node, node_lp] = summation();
+  coefficients[4 * n] = 2 * node;
+  coefficients[4 * n + 1] = 2 * node_lp;
+  for (size_t ix = 0; ix < n; ++ix) {
+    auto& item = table[identifiers[ix]];
+    item.tide = Complex(1, 0);
+    const auto [real, real_lp] = summation();
+    item.tide = Complex(0, 1);
+    const auto [imag, imag_lp] = summation();
+    item.tide = Complex(0, 0);
+    coefficients[ix] = real - node;
+    coefficients[n + ix] = imag - node;
+    coefficients[2 * n + ix] = real_lp - node_lp;
+    coefficients[3 * n + ix] = imag_lp - node_lp;
+  }
+}
+
+template <typename T>
+auto Perth<T>::time_buckets(
+    const ConstVectorRef<int64_t>& time, const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads) const -> TimeBuckets {
+  const auto size = static_cast<size_t>(time.size());
+  const auto stride = 4 * tidal_model_->size() + 2;
+
+  // The points are processed in ascending time order.
+  auto order = std::vector<int64_t>(size);
+  std::iota(order.begin(), order.end(), int64_t{0});
+  if (!std::is_sorted(time.data(), time.data() + time.size())) {
+    std::stable_sort(order.begin(), order.end(),
+                     [&time](const int64_t lhs, const int64_t rhs) {
+                       return time(lhs) < time(rhs);
+                     });
+  }
+
+  // Buckets of the points sharing the arguments kept by an accelerator
+  // processing the points in this order: the first position of each bucket
+  // in the order, and its time.
+  auto first = std::vector<size_t>{0};
+  auto epoch =
+      std::vector<double>{epoch_to_modified_julian_date(time(order[0]))};
+  for (size_t ix = 1; ix < size; ++ix) {
+    const auto t = epoch_to_modified_julian_date(time(order[ix]));
+    if (t != epoch.back() && !(std::abs(t - epoch.back()) < time_tolerance)) {
+      first.push_back(ix);
+      epoch.push_back(t);
+    }
+  }
+  first.push_back(size);
+
+  auto coefficients = std::vector<double>(epoch.size() * stride);
+  parallel_for(
+      [&](const size_t start, const size_t end) -> void {
+        auto context = acquire_context(0, interpolation_type);
+        for (auto ix = start; ix < end; ++ix) {
+          fold_coefficients(epoch[ix], *context,
+                            coefficients.data() + ix * stride);
+        }
+        release_context(std::move(context));
+      },
+      epoch.size(), num_threads, 1);
+  return {std::move(order), std::move(first), std::move(coefficients)};
+}
+
+template <typename T>
+template <typename Coordinate>
+auto Perth<T>::evaluate_batched(
+    const ConstVectorRef<Coordinate>& lon,
+    const ConstVectorRef<Coordinate>& lat, const ConstVectorRef<int64_t>& time,
+    VectorRef<double> tide, VectorRef<double> tide_lp,
+    VectorRef<int8_t> quality, const double time_tolerance,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads) const -> void {
+  const auto size = static_cast<size_t>(lon.size());
+  const auto n = tidal_model_->size();
+  const auto stride = 4 * n + 2;
+  const auto buckets =
+      time_buckets(time, time_tolerance, interpolation_type, num_threads);
+  const auto& order = buckets.order;
+  const auto& first = buckets.first;
+  const auto& coefficients = buckets.coefficients;
+
+  // Counters of the evaluation, summed over the blocks.
+  auto total = EvaluationStats{};
+  auto total_mutex = std::mutex{};
+
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    auto acc = tidal_model_->accelerator(0);
+    auto values = std::vector<Complex>(n);
+    auto stats = EvaluationStats{};
+    auto bucket = static_cast<size_t>(
+        std::upper_bound(first.begin(), first.end(), start) - first.begin() -
+        1);
+    for (auto jx = start; jx < end; ++jx) {
+      while (first[bucket + 1] <= jx) {
+        ++bucket;
+      }
+      const auto ix = order[jx];
+      const auto y = static_cast<double>(lat(ix));
+      auto quality_value = Quality::kUndefined;
+      {
+        auto timer = StageTimer(stats, kInterpolationStage);
+        quality_value = tidal_model_->interpolate(
+            static_cast<double>(lon(ix)), y, values.data(), acc.get());
+      }
+      quality(ix) = static_cast<int8_t>(quality_value);
+      if constexpr (kProfiling) {
+        ++stats.quality[quality_value];
+      }
+      if (quality_value == Quality::kUndefined) {
+        tide(ix) = std::numeric_limits<double>::quiet_NaN();
+        tide_lp(ix) = std::numeric_limits<double>::quiet_NaN();
+        continue;
+      }
+      auto timer = StageTimer(stats, kSummationStage);
+      const auto* c = coefficients.data() + bucket * stride;
+      const auto p20 = 0.5 - 1.5 * pow<2>(std::sin(radians(y)));
+      auto sp = c[4 * n] * p20;
+      auto lp = c[4 * n + 1] * p20;
+      for (size_t kx = 0; kx < n; ++kx) {
+        const auto& value = values[kx];
+        sp += c[kx] * value.real() + c[n + kx] * value.imag();
+        lp += c[2 * n + kx] * value.real() + c[3 * n + kx] * value.imag();
+      }
+      tide(ix) = sp;
+      tide_lp(ix) = lp;
+    }
+    if constexpr (kProfiling) {
+      stats.points = static_cast<int64_t>(end - start);
+      stats.cell_hits = acc->cell_hits();
+      stats.cell_misses = acc->cell_misses();
+      auto lock = std::lock_guard<std::mutex>(total_mutex);
+      total += stats;
     }
   };
   parallel_for(worker, size, num_threads, 128);
+
+  if constexpr (kProfiling) {
+    total.argument_updates = static_cast<int64_t>(first.size() - 1);
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    last_stats_ = total;
+  }
+}
+
+template <typename T>
+auto Perth<T>::evaluate_at_time(
+    const Eigen::Ref<const Eigen::VectorXd>& lon,
+    const Eigen::Ref<const Eigen::VectorXd>& lat, const int64_t time,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads) const
+    -> std::tuple<Eigen::VectorXd, Eigen::VectorXd, Eigen::Vector<int8_t, -1>> {
+  auto size = lon.size();
+  // Check that the input vectors have the same size.
+  if (size != lat.size()) {
+    throw std::invalid_argument("Input vectors must have the same size");
+  }
+  // Check for empty input
+  if (size == 0) {
+    throw std::invalid_argument("Input vectors cannot be empty");
+  }
+  Eigen::VectorXd tide(size);
+  Eigen::VectorXd tide_lp(size);
+  Eigen::Vector<int8_t, -1> quality(size);
+
+  // With a single time, the arguments are computed by the first point of
+  // each block and kept for the others.
+  const auto mjd = epoch_to_modified_julian_date(time);
+  evaluate_points(
+      size,
+      [&](const int64_t ix) -> std::tuple<int64_t, double, double, double> {
+        return {ix, lon(ix), lat(ix), mjd};
+      },
+      0, interpolation_type, num_threads, tide, tide_lp, quality);
+  return {tide, tide_lp, quality};
+}
+
+template <typename T>
+auto Perth<T>::evaluate_grid(
+    const Eigen::Ref<const Eigen::VectorXd>& lon,
+    const Eigen::Ref<const Eigen::VectorXd>& lat, const int64_t time,
+    const std::optional<InterpolationType>& interpolation_type,
+    const size_t num_threads) const
+    -> std::tuple<RowMajorMatrix<double>, RowMajorMatrix<double>,
+                  RowMajorMatrix<int8_t>> {
+  const auto nx = lon.size();
+  const auto ny = lat.size();
+  // Check for empty input
+  if (nx == 0 || ny == 0) {
+    throw std::invalid_argument("Input vectors cannot be empty");
+  }
+  RowMajorMatrix<double> tide(nx, ny);
+  RowMajorMatrix<double> tide_lp(nx, ny);
+  RowMajorMatrix<int8_t> quality(nx, ny);
+
+  // The nodes are processed along the latitudes first, so that consecutive
+  // points share the cells of the model.
+  const auto mjd = epoch_to_modified_julian_date(time);
+  evaluate_points(
+      nx * ny,
+      [&](const int64_t ix) -> std::tuple<int64_t, double, double, double> {
+        return {ix, lon(ix / ny), lat(ix % ny), mjd};
+      },
+      0, interpolation_type, num_threads, tide.reshaped<Eigen::RowMajor>(),
+      tide_lp.reshaped<Eigen::RowMajor>(), quality.reshaped<Eigen::RowMajor>());
+  return {tide, tide_lp, quality};
+}
+
+template <typename T>
+auto Perth<T>::predict_time_series(
+    const double lon, const double lat, const int64_t start,
+    const int64_t step, const int64_t size,
+    const std::optional<InterpolationType>& interpolation_type,
+    const std::optional<int64_t>& refresh_interval,
+    const size_t num_threads) const
+    -> std::tuple<Eigen::VectorXd, Eigen::VectorXd, Quality> {
+  if (size <= 0) {
+    throw std::invalid_argument("The number of samples must be positive");
+  }
+  const auto interval = refresh_interval.value_or(
+      group_modulations_ ? int64_t{10'800'000'000} : int64_t{86'400'000'000});
+  if (interval <= 0) {
+    throw std::invalid_argument("The refresh interval must be positive");
+  }
+  Eigen::VectorXd tide(size);
+  Eigen::VectorXd tide_lp(size);
+
+  // Interpolation, at the requested position, of the waves provided by the
+  // model used.
+  auto quality = Quality::kUndefined;
+  {
+    auto context = acquire_context(0, interpolation_type);
+    quality = tidal_model_->interpolate(lon, lat, context->tide_table,
+                                        &context->acc);
+    release_context(std::move(context));
+  }
+  if (quality == Quality::kUndefined) {
+    tide.setConstant(std::numeric_limits<double>::quiet_NaN());
+    tide_lp.setConstant(std::numeric_limits<double>::quiet_NaN());
+    return {tide, tide_lp, quality};
+  }
+
+  // Number of samples between two exact computations of the phasors. The
+  // series is split into segments of this length, processed independently.
+  const auto period =
+      step == 0 ? size
+                : std::max<int64_t>(interval / std::abs(step), 1);
+  const auto n_segments = (size + period - 1) / period;
+  auto epoch = [&](const int64_t ix) -> double {
+    return epoch_to_modified_julian_date(start + ix * step);
+  };
+
+  auto worker = [&](const size_t first_segment,
+                    const size_t last_segment) -> void {
+    auto context = acquire_context(0, interpolation_type);
+    auto& table = context->tide_table;
+    auto& acc = context->acc;
+    tidal_model_->interpolate(lon, lat, table, &acc);
+    if (context->inference) {
+      (*context->inference)(table, lat);
+    }
+    for (auto segment = first_segment; segment < last_segment; ++segment) {
+      const auto first = static_cast<int64_t>(segment) * period;
+      const auto last = std::min(first + period, size);
+      for (auto ix = first; ix < last; ++ix) {
+        if (ix == first) {
+          // The tidal arguments of the table are those of the last time
+          // given to the accelerator, which may already be this one.
+          acc.update_args(epoch(ix), group_modulations_, table);
+          context->active_set.update(table, acc.nodal_corrections());
+          if (ix + 1 < last) {
+            acc.update_args(epoch(ix + 1), group_modulations_, table);
+            context->active_set.prepare_recurrence(table,
+                                                   acc.nodal_corrections());
+          }
+        } else {
+          context->active_set.advance();
+        }
+        std::tie(tide(ix), tide_lp(ix)) = context->active_set.evaluate(table);
+      }
+    }
+    release_context(std::move(context));
+  };
+  parallel_for(worker, static_cast<size_t>(n_segments), num_threads, 1);
   return {tide, tide_lp, quality};
 }
 
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/storage.hpp"
+
+namespace perth {
+
+/// @brief Source of the waves of a tiled tidal model.
+///
+/// The grid of the model is split into tiles of nodes, read from the
+/// source the first time a point falls in them, e.g. from the files of the
+/// model. Only the tiles covering the region processed are then read.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+class TileLoader {
+ public:
+  /// Type of the values stored.
+  using value_type = typename WaveStorage<T>::value_type;
+
+  virtual ~TileLoader() = default;
+
+  /// @brief Get the constituents provided, in the order of the values of a
+  /// node.
+  [[nodiscard]] virtual auto identifiers() const
+      -> std::vector<Constituent> = 0;
+
+  /// @brief Get the scale factors of the constituents, if the storage type
+  /// is scaled, in the order of identifiers(). If empty, the factors are 1.
+  [[nodiscard]] virtual auto scales() const -> std::vector<double> {
+    return {};
+  }
+
+  /// @brief Read the values of a block of nodes.
+  ///
+  /// The method may be called concurrently by several threads.
+  /// @param[in] i0 Index of the first longitude of the block.
+  /// @param[in] nx Number of longitudes of the block.
+  /// @param[in] j0 Index of the first latitude of the block.
+  /// @param[in] ny Number of latitudes of the block.
+  /// @param[out] values The `nx * ny * identifiers().size()` values of the
+  /// block, encoded in the storage type of the model: the values of the
+  /// constituents of the node `(i0 + i, j0 + j)` start at
+  /// `values + (i * ny + j) * identifiers().size()`.
+  virtual auto read(int64_t i0, int64_t nx, int64_t j0, int64_t ny,
+                    value_type* values) const -> void = 0;
+};
+
+/// @brief Tiles of a tidal model loaded on demand, within a memory budget.
+///
+/// The tiles are read from a TileLoader the first time one of their nodes is
+/// used. If the memory used by the tiles exceeds the budget, the least
+/// recently used tiles are released. The cache may be used concurrently by
+/// several threads.
+/// @tparam T The type of the real values of the model.
+template <typename T>
+class TileCache {
+ public:
+  /// Type of the values stored.
+  using value_type = typename WaveStorage<T>::value_type;
+
+  /// @brief Block of nodes of the grid, holding the values of all the
+  /// constituents of its nodes.
+  struct Tile {
+    int64_t i0;                      ///< Index of the first longitude
+    int64_t nx;                      ///< Number of longitudes
+    int64_t j0;                      ///< Index of the first latitude
+    int64_t ny;                      ///< Number of latitudes
+    size_t n_constituents;           ///< Number of values per node
+    std::vector<value_type> values;  ///< Values, see TileLoader::read()
+
+    /// True if the tile holds the node (i, j).
+    [[nodiscard]] constexpr auto contains(const int64_t i,
+                                          const int64_t j) const noexcept
+        -> bool {
+      return i >= i0 && i < i0 + nx && j >= j0 && j < j0 + ny;
+    }
+
+    /// Get the values of the constituents of the node (i, j).
+    [[nodiscard]] auto node(const int64_t i, const int64_t j) const noexcept
+        -> const value_type* {
+      return values.data() +
+             static_cast<size_t>((i - i0) * ny + (j - j0)) * n_constituents;
+    }
+  };
+
+  /// @brief Build the cache of the tiles of a grid.
+  /// @param[in] loader Source of the values of the tiles.
+  /// @param[in] nx Number of longitudes of the grid.
+  /// @param[in] ny Number of latitudes of the grid.
+  /// @param[in] tile_size Number of nodes of a tile along each axis.
+  /// @param[in] memory_budget Maximum memory used by the tiles, in bytes. If
+  /// 0, the tiles are never released. The last tile read is always kept.
+  /// @throw std::invalid_argument If the loader is null or if the tile size
+  /// is zero.
+  TileCache(std::shared_ptr<const TileLoader<T>> loader, const int64_t nx,
+            const int64_t ny, const size_t tile_size,
+            const size_t memory_budget)
+      : loader_(std::move(loader)),
+        nx_(nx),
+        ny_(ny),
+        tile_size_(static_cast<int64_t>(tile_size)),
+        memory_budget_(memory_budget) {
+    if (loader_ == nullptr) {
+      throw std::invalid_argument("The tile loader must not be null");
+    }
+    if (tile_size == 0) {
+      throw std::invalid_argument("The tile size must be positive");
+    }
+    n_constituents_ = loader_->identifiers().size();
+    ntx_ = (nx_ + tile_size_ - 1) / tile_size_;
+    nty_ = (ny_ + tile_size_ - 1) / tile_size_;
+    tiles_.resize(static_cast<size_t>(ntx_ * nty_));
+    last_use_.resize(tiles_.size());
+  }
+
+  /// @brief Get the tile holding a node, reading it if necessary.
+  /// @param[in] i Index of the longitude of the node.
+  /// @param[in] j Index of the latitude of the node.
+  /// @return The tile. It remains valid as long as the pointer is held, even
+  /// if the cache releases it.
+  auto get(const int64_t i, const int64_t j) -> std::shared_ptr<const Tile>;
+
+  /// @brief Get the number of tiles of the grid.
+  [[nodiscard]] auto size() const noexcept -> size_t { return tiles_.size(); }
+
+  /// @brief Get the number of tiles held in memory.
+  [[nodiscard]] auto resident() const -> size_t {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return resident_;
+  }
+
+  /// @brief Get the memory used by the tiles held, in bytes.
+  [[nodiscard]] auto memory_usage() const -> size_t {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return memory_usage_;
+  }
+
+  /// @brief Get the number of tiles read from the loader since the creation
+  /// of the cache.
+  [[nodiscard]] auto reads() const -> int64_t {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    return reads_;
+  }
+
+  /// @brief Get the number of nodes of a tile along each axis.
+  [[nodiscard]] constexpr auto tile_size() const noexcept -> size_t {
+    return static_cast<size_t>(tile_size_);
+  }
+
+  /// @brief Get the maximum memory used by the tiles, in bytes, or 0.
+  [[nodiscard]] constexpr auto memory_budget() const noexcept -> size_t {
+    return memory_budget_;
+  }
+
+ private:
+  /// Source of the values of the tiles.
+  std::shared_ptr<const TileLoader<T>> loader_;
+  /// Number of longitudes of the grid.
+  int64_t nx_;
+  /// Number of latitudes of the grid.
+  int64_t ny_;
+  /// Number of nodes of a tile along each axis.
+  int64_t tile_size_;
+  /// Number of tiles along the longitudes.
+  int64_t ntx_{};
+  /// Number of tiles along the latitudes.
+  int64_t nty_{};
+  /// Number of constituents of a node.
+  size_t n_constituents_{};
+  /// Maximum memory used by the tiles, in bytes, or 0.
+  size_t memory_budget_;
+  /// Tiles held, indexed by `tx * nty_ + ty`, null if not held.
+  std::vector<std::shared_ptr<const Tile>> tiles_;
+  /// Value of `clock_` at the last use of each tile.
+  std::vector<uint64_t> last_use_;
+  /// Counter of the uses of the tiles.
+  uint64_t clock_{};
+  /// Number of tiles held.
+  size_t resident_{};
+  /// Memory used by the tiles held, in bytes.
+  size_t memory_usage_{};
+  /// Number of tiles read.
+  int64_t reads_{};
+  /// Protects the state of the cache.
+  mutable std::mutex mutex_;
+
+  /// @brief Release the least recently used tiles, other than `keep`, until
+  /// the memory used is within the budget.
+  auto evict(size_t keep) -> void;
+};
+
+template <typename T>
+auto TileCache<T>::get(const int64_t i, const int64_t j)
+    -> std::shared_ptr<const Tile> {
+  const auto tx = i / tile_size_;
+  const auto ty = j / tile_size_;
+  const auto slot = static_cast<size_t>(tx * nty_ + ty);
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    if (tiles_[slot] != nullptr) {
+      last_use_[slot] = ++clock_;
+      return tiles_[slot];
+    }
+  }
+  // The tile is read without holding the lock, so that the other threads
+  // keep on using the tiles already held.
+  auto tile = std::make_shared<Tile>();
+  tile->i0 = tx * tile_size_;
+  tile->nx = std::min(tile_size_, nx_ - tile->i0);
+  tile->j0 = ty * tile_size_;
+  tile->ny = std::min(tile_size_, ny_ - tile->j0);
+  tile->n_constituents = n_constituents_;
+  tile->values.resize(static_cast<size_t>(tile->nx * tile->ny) *
+                      n_constituents_);
+  loader_->read(tile->i0, tile->nx, tile->j0, tile->ny, tile->values.data());
+
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  ++reads_;
+  last_use_[slot] = ++clock_;
+  // Another thread may have read the same tile in the meantime.
+  if (tiles_[slot] != nullptr) {
+    return tiles_[slot];
+  }
+  tiles_[slot] = tile;
+  ++resident_;
+  memory_usage_ += tile->values.size() * sizeof(value_type);
+  evict(slot);
+  return tile;
+}
+
+template <typename T>
+auto TileCache<T>::evict(const size_t keep) -> void {
+  while (memory_budget_ != 0 && memory_usage_ > memory_budget_ &&
+         resident_ > 1) {
+    auto oldest = keep;
+    auto oldest_use = std::numeric_limits<uint64_t>::max();
+    for (size_t ix = 0; ix < tiles_.size(); ++ix) {
+      if (ix != keep && tiles_[ix] != nullptr && last_use_[ix] < oldest_use) {
+        oldest = ix;
+        oldest_use = last_use_[ix];
+      }
+    }
+    memory_usage_ -= tiles_[oldest]->values.size() * sizeof(value_type);
+    tiles_[oldest].reset();
+    --resident_;
+  }
+}
+
+}  // namespace perth
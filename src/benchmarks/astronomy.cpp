@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/doodson.hpp"
+#include "perth/nodal_corrections.hpp"
+#include "perth/tidal_model.hpp"
+#include "synthetic.hpp"
+
+namespace perth::benchmarks {
+
+// Modified Julian date of the first time of the synthetic data sets.
+static const double kFirstDay = epoch_to_modified_julian_date(kStart);
+
+static void BM_CelestialVector(benchmark::State& state) {
+  auto time = kFirstDay;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(calculate_celestial_vector(
+        time, calculate_delta_time(time + kModifiedJulianEpoch)));
+    time += 1.0 / 86400.0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CelestialVector);
+
+// The astronomical variables of one day sampled every second, in one call.
+static void BM_CelestialVectors(benchmark::State& state) {
+  const auto time = Eigen::VectorXd::LinSpaced(86400, kFirstDay, kFirstDay + 1);
+  const auto delta = Eigen::VectorXd::Constant(
+      time.size(), calculate_delta_time(kFirstDay + kModifiedJulianEpoch));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(calculate_celestial_vectors(time, delta));
+  }
+  state.SetItemsProcessed(state.iterations() * time.size());
+}
+BENCHMARK(BM_CelestialVectors);
+
+static void BM_NodalCorrections(benchmark::State& state) {
+  const auto keys =
+      assemble_constituent_table(synthetic_constituents()).keys_vector();
+  auto time = kFirstDay;
+  for (auto _ : state) {
+    const auto args = calculate_celestial_vector(time, 0);
+    benchmark::DoNotOptimize(
+        compute_nodal_corrections(-args(4), args(3), keys));
+    time += 1.0 / 86400.0;
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(keys.size()));
+}
+BENCHMARK(BM_NodalCorrections);
+
+static void BM_NodalCorrectionsGroupModulations(benchmark::State& state) {
+  const auto keys =
+      assemble_constituent_table(synthetic_constituents()).keys_vector();
+  auto time = kFirstDay;
+  for (auto _ : state) {
+    const auto args = calculate_celestial_vector(time, 0);
+    benchmark::DoNotOptimize(
+        compute_nodal_corrections(args(5), -args(4), args(3), args(2), keys));
+    time += 1.0 / 86400.0;
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(keys.size()));
+}
+BENCHMARK(BM_NodalCorrectionsGroupModulations);
+
+// The time changes at every iteration: the arguments are always updated.
+// Argument: whether the group modulations are applied.
+static void BM_UpdateArgs(benchmark::State& state) {
+  const auto group_modulations = static_cast<double>(state.range(0));
+  auto table = assemble_constituent_table(synthetic_constituents());
+  auto acc = Accelerator(0, synthetic_constituents().size());
+  auto time = kFirstDay;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(acc.update_args(time, group_modulations, table));
+    time += 1.0 / 86400.0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateArgs)->Arg(0)->Arg(1);
+
+// The time changes at every iteration, within a tolerance of one hour: the
+// arguments are extrapolated, and computed once per hour.
+static void BM_UpdateArgsExtrapolated(benchmark::State& state) {
+  auto table = assemble_constituent_table(synthetic_constituents());
+  auto acc = Accelerator(1.0 / 24.0, synthetic_constituents().size());
+  acc.argument_mode(ArgumentMode::kExtrapolated);
+  auto time = kFirstDay;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(acc.update_args(time, 0, table));
+    time += 1.0 / 86400.0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateArgsExtrapolated);
+
+}  // namespace perth::benchmarks
@@ -0,0 +1,50 @@
+#include "perth/ensemble.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "perth/inference.hpp"
+#include "perth/tide.hpp"
+#include "synthetic.hpp"
+
+namespace perth::benchmarks {
+
+/// Number of points of the evaluations.
+constexpr int64_t kSize = 1 << 16;
+
+/// Number of models of the ensemble. The ensemble holds the shared model
+/// several times, to keep the memory used by the benchmark bounded.
+constexpr size_t kModels = 3;
+
+// Along-track data set evaluated by an ensemble, in one pass.
+static void BM_EvaluateEnsemble(benchmark::State& state) {
+  const auto ensemble = Ensemble<float>(
+      std::vector<std::shared_ptr<TidalModel<float>>>(kModels,
+                                                      shared_model<float>()));
+  const auto [lon, lat, time] = along_track(kSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ensemble.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, 1));
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_EvaluateEnsemble);
+
+// Same evaluation, one model after the other.
+static void BM_EvaluateEnsembleSequentially(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat, time] = along_track(kSize);
+  for (auto _ : state) {
+    for (size_t ix = 0; ix < kModels; ++ix) {
+      benchmark::DoNotOptimize(perth.evaluate(
+          lon, lat, time, 0, InterpolationType::kLinearAdmittance, 1));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_EvaluateEnsembleSequentially);
+
+}  // namespace perth::benchmarks
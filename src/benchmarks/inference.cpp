@@ -0,0 +1,34 @@
+#include "perth/inference.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <complex>
+
+#include "perth/constituent.hpp"
+#include "synthetic.hpp"
+
+namespace perth::benchmarks {
+
+// Argument: the interpolation type.
+static void BM_Inference(benchmark::State& state) {
+  auto table = assemble_constituent_table(synthetic_constituents());
+  auto scale = 1.0;
+  for (auto ident : synthetic_constituents()) {
+    table[ident].tide = std::complex<double>(scale, -scale);
+    scale *= 0.8;
+  }
+  const auto inference =
+      Inference(table, static_cast<InterpolationType>(state.range(0)));
+  auto lat = -60.0;
+  for (auto _ : state) {
+    inference(table, lat);
+    benchmark::ClobberMemory();
+    lat = lat < 60 ? lat + 0.01 : -60.0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Inference)
+    ->Arg(static_cast<int64_t>(InterpolationType::kLinearAdmittance))
+    ->Arg(static_cast<int64_t>(InterpolationType::kFourierAdmittance));
+
+}  // namespace perth::benchmarks
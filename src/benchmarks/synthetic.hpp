@@ -0,0 +1,126 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+
+#include "test_models.hpp"
+
+namespace perth::benchmarks {
+
+/// Constituents of the synthetic model: the references of the inference and
+/// a few others, as provided by the usual global models.
+inline auto synthetic_constituents() -> const std::vector<Constituent>& {
+  static const auto constituents = std::vector<Constituent>{
+      kQ1, kO1, kP1, kK1, kN2, kM2, kS2, kK2, kMm, kMf, kM4, kMS4, kMN4, k2N2};
+  return constituents;
+}
+
+/// First time of the synthetic data sets: 2020-01-01, in microseconds since
+/// the epoch.
+constexpr int64_t kStart = 1577836800LL * kMicrosecondsPerSecond;
+
+/// @brief Build a synthetic global model on a grid of 1/4 degree.
+///
+/// The waves are smooth functions of the position, with a land mask
+/// covering about one third of the grid so that the interpolation meets
+/// undefined corners as it does on a real model.
+/// @param packed Whether the constituents are interleaved by grid node.
+template <typename T>
+auto make_model(const bool packed = true) -> std::shared_ptr<TidalModel<T>> {
+  auto lon = Axis(0, 359.75, 0.25, 1e-6, true);
+  auto lat = Axis(-90, 90, 0.25);
+  return tests::make_synthetic_model<T>(
+      lon, lat, synthetic_constituents(), packed,
+      [&](const int64_t ix, const int64_t jx) -> bool {
+        return std::sin(3 * radians(lon(ix))) * std::cos(2 * radians(lat(jx))) >
+               0.5;
+      });
+}
+
+/// @brief Get the synthetic model shared by the benchmarks.
+template <typename T>
+auto shared_model() -> const std::shared_ptr<TidalModel<T>>& {
+  static const auto model = make_model<T>();
+  return model;
+}
+
+/// @brief Positions and times of an along-track data set: the points follow
+/// a ground track of a satellite, one point per second.
+/// @param size Number of points.
+inline auto along_track(const int64_t size)
+    -> std::tuple<Eigen::VectorXd, Eigen::VectorXd,
+                  Eigen::Vector<int64_t, -1>> {
+  auto lon = Eigen::VectorXd(size);
+  auto lat = Eigen::VectorXd(size);
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    // An orbit of about 6745 seconds inclined at 66 degrees, drifting
+    // westward with the rotation of the Earth.
+    const auto phase = two_pi<double>() * static_cast<double>(ix) / 6745.0;
+    lat(ix) = degrees(std::asin(std::sin(radians(66.0)) * std::sin(phase)));
+    lon(ix) = normalize_angle(
+        degrees(std::atan2(std::cos(radians(66.0)) * std::sin(phase),
+                           std::cos(phase))) -
+            360.0 * static_cast<double>(ix) / 86164.0,
+        0.0);
+    time(ix) = kStart + ix * kMicrosecondsPerSecond;
+  }
+  return {std::move(lon), std::move(lat), std::move(time)};
+}
+
+/// @brief Positions of a swath: a regular block of points, observed at the
+/// same time, as the pixels of a wide-swath altimeter.
+/// @param size Number of points, rounded down to a multiple of the 64
+/// points across the swath.
+inline auto swath(const int64_t size)
+    -> std::tuple<Eigen::VectorXd, Eigen::VectorXd> {
+  constexpr int64_t kAcross = 64;
+  const auto along = size / kAcross;
+  auto lon = Eigen::VectorXd(along * kAcross);
+  auto lat = Eigen::VectorXd(along * kAcross);
+  for (int64_t ix = 0; ix < along; ++ix) {
+    for (int64_t jx = 0; jx < kAcross; ++jx) {
+      lon(ix * kAcross + jx) = 200.0 + 0.02 * static_cast<double>(jx);
+      lat(ix * kAcross + jx) = -60.0 + 0.02 * static_cast<double>(ix);
+    }
+  }
+  return {std::move(lon), std::move(lat)};
+}
+
+/// @brief Random positions over the globe, or over a box.
+/// @param size Number of points.
+/// @param lon_min Western bound of the positions.
+/// @param lon_max Eastern bound of the positions.
+/// @param lat_min Southern bound of the positions.
+/// @param lat_max Northern bound of the positions.
+inline auto random_positions(const int64_t size, const double lon_min = -180,
+                             const double lon_max = 180,
+                             const double lat_min = -80,
+                             const double lat_max = 80)
+    -> std::tuple<Eigen::VectorXd, Eigen::VectorXd> {
+  auto generator = std::mt19937_64(42);
+  auto lon_distribution =
+      std::uniform_real_distribution<double>(lon_min, lon_max);
+  auto lat_distribution =
+      std::uniform_real_distribution<double>(lat_min, lat_max);
+  auto lon = Eigen::VectorXd(size);
+  auto lat = Eigen::VectorXd(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    lon(ix) = lon_distribution(generator);
+    lat(ix) = lat_distribution(generator);
+  }
+  return {std::move(lon), std::move(lat)};
+}
+
+}  // namespace perth::benchmarks
@@ -0,0 +1,54 @@
+#include "perth/tidal_model.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "perth/constituent.hpp"
+#include "perth/storage.hpp"
+#include "synthetic.hpp"
+
+namespace perth::benchmarks {
+
+// Interpolation at random positions: every point falls in a new grid cell.
+template <typename T>
+static void BM_InterpolateRandom(benchmark::State& state) {
+  const auto& model = shared_model<T>();
+  const auto [lon, lat] = random_positions(1 << 16);
+  auto table = assemble_constituent_table(model->identifiers());
+  auto acc = model->accelerator(0);
+  int64_t ix = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        model->interpolate(lon(ix), lat(ix), table, acc.get()));
+    ix = (ix + 1) % lon.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_InterpolateRandom, float);
+BENCHMARK_TEMPLATE(BM_InterpolateRandom, double);
+BENCHMARK_TEMPLATE(BM_InterpolateRandom, Float16);
+BENCHMARK_TEMPLATE(BM_InterpolateRandom, Int16);
+
+// Interpolation along a ground track: consecutive points often share their
+// grid cell.
+template <typename T>
+static void BM_InterpolateAlongTrack(benchmark::State& state) {
+  const auto& model = shared_model<T>();
+  const auto [lon, lat, time] = along_track(1 << 16);
+  auto table = assemble_constituent_table(model->identifiers());
+  auto acc = model->accelerator(0);
+  int64_t ix = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        model->interpolate(lon(ix), lat(ix), table, acc.get()));
+    ix = (ix + 1) % lon.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_InterpolateAlongTrack, float);
+BENCHMARK_TEMPLATE(BM_InterpolateAlongTrack, double);
+BENCHMARK_TEMPLATE(BM_InterpolateAlongTrack, Float16);
+BENCHMARK_TEMPLATE(BM_InterpolateAlongTrack, Int16);
+
+}  // namespace perth::benchmarks
@@ -0,0 +1,204 @@
+#include "perth/tide.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#include "perth/datetime.hpp"
+#include "perth/inference.hpp"
+#include "synthetic.hpp"
+
+namespace perth::benchmarks {
+
+/// Number of points of the end-to-end evaluations.
+constexpr int64_t kSize = 1 << 18;
+
+// Sweep the number of threads by powers of two, up to the number of
+// hardware threads.
+static void thread_sweep(benchmark::internal::Benchmark* benchmark) {
+  const auto max_threads =
+      std::max<int64_t>(1, std::thread::hardware_concurrency());
+  for (int64_t threads = 1; threads < max_threads; threads *= 2) {
+    benchmark->Arg(threads);
+  }
+  benchmark->Arg(max_threads);
+  benchmark->UseRealTime();
+}
+
+// Along-track data set: one point per second.
+// Argument: the number of threads.
+template <typename T>
+static void BM_EvaluateAlongTrack(benchmark::State& state) {
+  const auto perth = Perth<T>(shared_model<T>());
+  const auto [lon, lat, time] = along_track(kSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+                       static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK_TEMPLATE(BM_EvaluateAlongTrack, float)->Apply(thread_sweep);
+BENCHMARK_TEMPLATE(BM_EvaluateAlongTrack, double)->Apply(thread_sweep);
+
+// Along-track data set evaluated within an error budget, against the exact
+// evaluation. The counters report the error bound guaranteed and the largest
+// error observed, in the unit of the model.
+// Argument: the error budget, in micrometers; 0 for the exact evaluation.
+static void BM_EvaluateApproximate(benchmark::State& state) {
+  auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat, time] = along_track(kSize);
+  const auto [expected, expected_lp, quality] =
+      perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance);
+  perth.set_error_budget(static_cast<double>(state.range(0)) * 1e-6);
+  const auto approximation =
+      perth.approximation(InterpolationType::kLinearAdmittance);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(perth.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, 1));
+  }
+  const auto [tide, tide_lp, approximate_quality] =
+      perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance);
+  auto error = 0.0;
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    if (quality(ix) != static_cast<int8_t>(Quality::kUndefined)) {
+      error = std::max({error, std::abs(tide(ix) - expected(ix)),
+                        std::abs(tide_lp(ix) - expected_lp(ix))});
+    }
+  }
+  state.counters["error_bound"] = approximation.error_bound;
+  state.counters["max_error"] = error;
+  state.counters["dropped"] =
+      static_cast<double>(approximation.dropped.size());
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_EvaluateApproximate)
+    ->Arg(0)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->UseRealTime();
+
+// Points of a merged multi-mission dataset over a region of 20 by 20
+// degrees: in time order, consecutive points are far apart. The arguments
+// are kept for one hour.
+// Argument: whether the points are processed in the order of the cells,
+// within each hour.
+static void BM_EvaluateScattered(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat] = random_positions(kSize, 200, 220, -50, -30);
+  auto time = Eigen::Vector<int64_t, -1>(kSize);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    time(ix) = kStart + ix * 10000;
+  }
+  const auto sort = state.range(0) != 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        perth.evaluate(lon, lat, time, 1.0 / 24.0,
+                       InterpolationType::kLinearAdmittance, 1, sort, sort));
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_EvaluateScattered)->Arg(0)->Arg(1)->UseRealTime();
+
+// Swath observed at one time, evaluated point by point.
+// Argument: the number of threads.
+static void BM_EvaluateSwath(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat] = swath(kSize);
+  const auto time = Eigen::Vector<int64_t, -1>::Constant(lon.size(), kStart);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+                       static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * lon.size());
+}
+BENCHMARK(BM_EvaluateSwath)->Apply(thread_sweep);
+
+// Swath observed at one time, evaluated by the batched backend.
+// Argument: the number of threads.
+static void BM_EvaluateSwathBatched(benchmark::State& state) {
+  auto perth = Perth<float>(shared_model<float>());
+  perth.set_backend(Backend::kBatched);
+  const auto [lon, lat] = swath(kSize);
+  const auto time = Eigen::Vector<int64_t, -1>::Constant(lon.size(), kStart);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+                       static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * lon.size());
+}
+BENCHMARK(BM_EvaluateSwathBatched)->Apply(thread_sweep);
+
+// Small batches of an along-track data set, evaluated with all the threads:
+// the number of threads used adapts to the work of a batch.
+// Argument: the number of points of a batch.
+static void BM_EvaluateSmallBatch(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat, time] = along_track(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(perth.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EvaluateSmallBatch)
+    ->Arg(256)
+    ->Arg(2048)
+    ->Arg(16384)
+    ->UseRealTime();
+
+// Swath observed at one time, evaluated by the single-time path.
+// Argument: the number of threads.
+static void BM_EvaluateSwathAtTime(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto [lon, lat] = swath(kSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(perth.evaluate_at_time(
+        lon, lat, kStart, InterpolationType::kLinearAdmittance,
+        static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * lon.size());
+}
+BENCHMARK(BM_EvaluateSwathAtTime)->Apply(thread_sweep);
+
+// Hourly time series at a fixed position, evaluated point by point.
+// Argument: the number of threads.
+static void BM_EvaluateTimeSeries(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  const auto lon = Eigen::VectorXd::Constant(kSize, 200.5);
+  const auto lat = Eigen::VectorXd::Constant(kSize, -45.25);
+  auto time = Eigen::Vector<int64_t, -1>(kSize);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    time(ix) = kStart + ix * 3600 * kMicrosecondsPerSecond;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+                       static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_EvaluateTimeSeries)->Apply(thread_sweep);
+
+// Hourly time series at a fixed position, predicted by the phasor
+// recurrence.
+// Argument: the number of threads.
+static void BM_PredictTimeSeries(benchmark::State& state) {
+  const auto perth = Perth<float>(shared_model<float>());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(perth.predict_time_series(
+        200.5, -45.25, kStart, 3600 * kMicrosecondsPerSecond, kSize,
+        InterpolationType::kLinearAdmittance, std::nullopt,
+        static_cast<size_t>(state.range(0))));
+  }
+  state.SetItemsProcessed(state.iterations() * kSize);
+}
+BENCHMARK(BM_PredictTimeSeries)->Apply(thread_sweep);
+
+}  // namespace perth::benchmarks
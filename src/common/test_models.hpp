@@ -0,0 +1,160 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+#include "perth/tiles.hpp"
+
+namespace perth::tests {
+
+/// @brief Build a model whose waves are smooth functions of the position.
+///
+/// The k-th constituent has the amplitude `a = 0.8^k` and the wave
+/// `a (cos(x + a + phase) cos(y), sin(x - a - phase) cos(y))`, where x and y
+/// are the longitude and latitude of the node, in radians.
+/// @param lon Longitude axis.
+/// @param lat Latitude axis.
+/// @param constituents The constituents of the model.
+/// @param packed Whether the constituents are interleaved by grid node, in
+/// which case the model is packed, as load_model() does.
+/// @param is_land Predicate called with the indices of a node in the
+/// longitude and latitude axes, true if the waves are undefined there.
+/// @param phase Phase added to the waves of all the constituents.
+template <typename T, typename Land>
+auto make_synthetic_model(const Axis& lon, const Axis& lat,
+                          const std::vector<Constituent>& constituents,
+                          const bool packed, const Land& is_land,
+                          const double phase = 0)
+    -> std::shared_ptr<TidalModel<T>> {
+  using Value = typename TidalModel<T>::input_type;
+  using Real = typename Value::value_type;
+  constexpr auto nan = std::numeric_limits<Real>::quiet_NaN();
+  auto model = std::make_shared<TidalModel<T>>(lon, lat, true, packed);
+  auto wave =
+      Eigen::Matrix<Value, -1, -1, Eigen::RowMajor>(lon.size(), lat.size());
+  auto scale = 1.0;
+  for (auto ident : constituents) {
+    for (int64_t ix = 0; ix < lon.size(); ++ix) {
+      const auto x = radians(lon(ix));
+      for (int64_t jx = 0; jx < lat.size(); ++jx) {
+        const auto y = radians(lat(jx));
+        wave(ix, jx) =
+            is_land(ix, jx)
+                ? Value(nan, nan)
+                : Value(static_cast<Real>(scale * std::cos(x + scale + phase) *
+                                          std::cos(y)),
+                        static_cast<Real>(scale * std::sin(x - scale - phase) *
+                                          std::cos(y)));
+      }
+    }
+    model->add_constituent(ident, wave);
+    scale *= 0.8;
+  }
+  model->pack();
+  return model;
+}
+
+/// @brief Predicate of make_synthetic_model() setting a square block of
+/// nodes on land.
+/// @param i0 Index of the first longitude of the block.
+/// @param j0 Index of the first latitude of the block.
+/// @param size Number of nodes along each side of the block.
+inline auto land_patch(const int64_t i0, const int64_t j0,
+                       const int64_t size = 5) {
+  return [=](const int64_t ix, const int64_t jx) -> bool {
+    return ix >= i0 && ix < i0 + size && jx >= j0 && jx < j0 + size;
+  };
+}
+
+/// @brief Predicate of make_synthetic_model() leaving every node at sea.
+inline auto no_land(const int64_t /*ix*/, const int64_t /*jx*/) -> bool {
+  return false;
+}
+
+/// @brief Build a global model of 2 degrees whose waves are the indices of
+/// the grid nodes, so that any mix-up in the storage layout is detected.
+///
+/// The model provides M2, S2, K1 and O1, each constituent scaled by half of
+/// the previous one. The node (5, 5) of the waves is undefined, as a land
+/// point.
+/// @param packed Whether the constituents are interleaved by grid node.
+/// @param row_major Whether the waves are stored in row-major order.
+inline auto make_index_model(const bool packed, const bool row_major = true)
+    -> std::shared_ptr<TidalModel<float>> {
+  using Wave = Eigen::Matrix<std::complex<float>, -1, -1, Eigen::RowMajor>;
+  auto lon = Axis(-180, 178, 2, 1e-6, true);
+  auto lat = Axis(-90, 90, 2);
+  auto model =
+      std::make_shared<TidalModel<float>>(lon, lat, row_major, packed);
+  auto nx = row_major ? lon.size() : lat.size();
+  auto ny = row_major ? lat.size() : lon.size();
+  auto scale = 1.0F;
+  for (auto ident : {kM2, kS2, kK1, kO1}) {
+    auto wave = Wave(nx, ny);
+    for (int64_t ix = 0; ix < nx; ++ix) {
+      for (int64_t jx = 0; jx < ny; ++jx) {
+        wave(ix, jx) = std::complex<float>(scale * static_cast<float>(ix),
+                                           scale * static_cast<float>(jx));
+      }
+    }
+    // Land point
+    wave(5, 5) = std::complex<float>(std::nanf(""), std::nanf(""));
+    model->add_constituent(ident, wave);
+    scale *= 0.5F;
+  }
+  model->pack();
+  return model;
+}
+
+/// Tile loader reading the waves of a model held in memory, stored in
+/// row-major order.
+template <typename T>
+class ModelTileLoader : public TileLoader<T> {
+ public:
+  using value_type = typename TileLoader<T>::value_type;
+
+  explicit ModelTileLoader(std::shared_ptr<const TidalModel<T>> model)
+      : model_(std::move(model)) {}
+
+  [[nodiscard]] auto identifiers() const -> std::vector<Constituent> override {
+    return model_->identifiers();
+  }
+
+  [[nodiscard]] auto scales() const -> std::vector<double> override {
+    auto result = std::vector<double>(model_->size());
+    for (size_t ix = 0; ix < result.size(); ++ix) {
+      result[ix] = model_->scale(ix);
+    }
+    return result;
+  }
+
+  auto read(const int64_t i0, const int64_t nx, const int64_t j0,
+            const int64_t ny, value_type* values) const -> void override {
+    const auto n = model_->size();
+    const auto n_lat = model_->lat().size();
+    for (int64_t ix = 0; ix < nx; ++ix) {
+      for (int64_t jx = 0; jx < ny; ++jx) {
+        const auto node = (i0 + ix) * n_lat + j0 + jx;
+        for (size_t kx = 0; kx < n; ++kx) {
+          *values++ = model_->wave(kx)(node);
+        }
+      }
+    }
+  }
+
+ private:
+  std::shared_ptr<const TidalModel<T>> model_;
+};
+
+}  // namespace perth::tests
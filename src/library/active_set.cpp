@@ -0,0 +1,130 @@
+#include "perth/active_set.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/math.hpp"
+#include "perth/sincos.hpp"
+
+namespace perth {
+
+auto ActiveSet::Components::push_back(const size_t ix) -> void {
+  index.push_back(ix);
+  f.push_back(1);
+  u.push_back(0);
+  argument.push_back(0);
+  f_cos.push_back(0);
+  f_sin.push_back(0);
+  rotation_cos.push_back(1);
+  rotation_sin.push_back(0);
+  phase.push_back(0);
+}
+
+auto ActiveSet::Components::update(
+    const ConstituentTable& table,
+    const std::vector<NodalCorrections>& nodal_corrections) -> void {
+  const auto& items = table.items();
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    const auto& nodal_correction = nodal_corrections[index[ix]];
+    f[ix] = nodal_correction.f;
+    u[ix] = nodal_correction.u;
+    argument[ix] = items[index[ix]].tidal_argument;
+  }
+  // The trigonometric functions are only evaluated when the arguments change,
+  // not for every point, and for all the constituents in one pass.
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    phase[ix] = radians(argument[ix] + u[ix]);
+  }
+  sincos(phase.data(), index.size(), f_sin.data(), f_cos.data());
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    f_cos[ix] *= f[ix];
+    f_sin[ix] *= f[ix];
+  }
+}
+
+auto ActiveSet::Components::evaluate(const ConstituentTable& table) -> double {
+  // The tides are read in place, in the table filled by the interpolation
+  // and the inference.
+  const auto& items = table.items();
+  auto result = 0.0;
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    const auto& tide = items[index[ix]].tide;
+    result += tide.real() * f_cos[ix] + tide.imag() * f_sin[ix];
+  }
+  return result;
+}
+
+auto ActiveSet::Components::prepare_recurrence(
+    const ConstituentTable& table,
+    const std::vector<NodalCorrections>& nodal_corrections) -> void {
+  const auto& items = table.items();
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    const auto& nodal_correction = nodal_corrections[index[ix]];
+    phase[ix] = radians(items[index[ix]].tidal_argument + nodal_correction.u -
+                        argument[ix] - u[ix]);
+  }
+  sincos(phase.data(), index.size(), rotation_sin.data(),
+         rotation_cos.data());
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    // Ratio of the phasor of the next step to the current one.
+    const auto scale =
+        f[ix] != 0 ? nodal_corrections[index[ix]].f / f[ix] : 0.0;
+    rotation_cos[ix] *= scale;
+    rotation_sin[ix] *= scale;
+  }
+}
+
+auto ActiveSet::Components::advance() noexcept -> void {
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    auto real = f_cos[ix] * rotation_cos[ix] - f_sin[ix] * rotation_sin[ix];
+    f_sin[ix] = f_cos[ix] * rotation_sin[ix] + f_sin[ix] * rotation_cos[ix];
+    f_cos[ix] = real;
+  }
+}
+
+ActiveSet::ActiveSet(const ConstituentTable& table,
+                     const Inference* inference) {
+  auto inferred = inference != nullptr ? inference->constituents()
+                                       : std::vector<Constituent>();
+  const auto& keys = table.keys();
+  for (size_t ix = 0; ix < table.size(); ++ix) {
+    const auto& item = table.items()[ix];
+    // Constituents neither provided by the model nor computed by the
+    // inference have a zero tide: they are skipped.
+    if (item.is_inferred && std::find(inferred.begin(), inferred.end(),
+                                      keys[ix]) == inferred.end()) {
+      continue;
+    }
+    (item.type == kLongPeriod ? long_period_ : short_period_).push_back(ix);
+  }
+}
+
+auto ActiveSet::update(const ConstituentTable& table,
+                       const std::vector<NodalCorrections>& nodal_corrections)
+    -> void {
+  short_period_.update(table, nodal_corrections);
+  long_period_.update(table, nodal_corrections);
+}
+
+auto ActiveSet::evaluate(const ConstituentTable& table)
+    -> std::tuple<double, double> {
+  return {short_period_.evaluate(table), long_period_.evaluate(table)};
+}
+
+auto ActiveSet::prepare_recurrence(
+    const ConstituentTable& table,
+    const std::vector<NodalCorrections>& nodal_corrections) -> void {
+  short_period_.prepare_recurrence(table, nodal_corrections);
+  long_period_.prepare_recurrence(table, nodal_corrections);
+}
+
+auto ActiveSet::advance() noexcept -> void {
+  short_period_.advance();
+  long_period_.advance();
+}
+
+}  // namespace perth
@@ -0,0 +1,93 @@
+#include "perth/approximation.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/inference.hpp"
+#include "perth/math.hpp"
+#include "perth/nodal_corrections.hpp"
+
+namespace perth {
+namespace {
+
+/// Error of the tidal arguments extrapolated over the largest tolerance, in
+/// degrees, with a margin of an order of magnitude.
+constexpr double kArgumentError = 1e-5;
+
+}  // namespace
+
+auto select_approximation(const ConstituentTable& table,
+                          const Inference* inference,
+                          const std::vector<Constituent>& identifiers,
+                          const std::vector<double>& amplitudes,
+                          const bool group_modulations, const double max_error)
+    -> Approximation {
+  if (!(max_error >= 0)) {
+    throw std::invalid_argument("The error budget must be non-negative");
+  }
+  if (amplitudes.size() != identifiers.size()) {
+    throw std::invalid_argument(
+        "The amplitudes do not match the constituents of the model");
+  }
+  const auto& nodal = nodal_correction_bounds(group_modulations);
+
+  // Bounds of the moduli of the tides of all the constituents contributing,
+  // indexed by constituent.
+  auto bounds = std::vector<double>(kNumConstituentItems, 0.0);
+  for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+    bounds[static_cast<size_t>(identifiers[ix])] = amplitudes[ix];
+  }
+
+  auto result = Approximation{};
+  auto dropped_error = 0.0;
+  if (inference != nullptr) {
+    const auto inferred = inference->constituents();
+    const auto inferred_bounds = inference->amplitude_bounds(table, bounds);
+    // Bound of the contribution of each constituent computed by the
+    // inference, i.e. not provided by the model.
+    auto candidates = std::vector<std::pair<double, Constituent>>();
+    for (size_t ix = 0; ix < inferred.size(); ++ix) {
+      const auto index = static_cast<size_t>(inferred[ix]);
+      if (table.items()[index].is_inferred) {
+        bounds[index] = inferred_bounds[ix];
+        candidates.emplace_back(nodal.f[index] * inferred_bounds[ix],
+                                inferred[ix]);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto& [error, ident] : candidates) {
+      if (dropped_error + error > 0.5 * max_error) {
+        break;
+      }
+      dropped_error += error;
+      bounds[static_cast<size_t>(ident)] = 0;
+      result.dropped.push_back(ident);
+    }
+  }
+
+  // Rate at which the error of the nodal corrections kept grows with the
+  // time elapsed, and error of the extrapolated arguments.
+  auto rate = 0.0;
+  auto argument_error = 0.0;
+  for (size_t ix = 0; ix < kNumConstituentItems; ++ix) {
+    rate += bounds[ix] * (nodal.f_rate[ix] + nodal.f[ix] * nodal.u_rate[ix]);
+    argument_error += bounds[ix] * nodal.f[ix] * radians(kArgumentError);
+  }
+  const auto remaining = max_error - dropped_error - argument_error;
+  if (remaining > 0) {
+    result.time_tolerance =
+        rate > 0 ? std::min(remaining / rate, kMaxApproximateTimeTolerance)
+                 : kMaxApproximateTimeTolerance;
+    result.error_bound =
+        dropped_error + argument_error + rate * result.time_tolerance;
+  } else {
+    result.error_bound = dropped_error;
+  }
+  return result;
+}
+
+}  // namespace perth
@@ -82,6 +82,7 @@ auto Axis::initialize(const Eigen::Ref<const Eigen::VectorXd> &values,
   step_ = size_ == 1 ? stop - start_
                      : (stop - start_) / static_cast<double>(size_ - 1);
 
+  inv_step_ = 1 / step_;
   is_ascending_ = size_ < 2 ? true : (*this)(0) < (*this)(1);
 
   if (is_periodic_) {
@@ -90,7 +91,7 @@ auto Axis::initialize(const Eigen::Ref<const Eigen::VectorXd> &values,
   }
 }
 
-auto Axis::find_indices(double coordinate) const
+auto Axis::search_indices(double coordinate) const
     -> std::optional<std::tuple<int64_t, int64_t>> {
   coordinate = normalize_coordinate(coordinate);
 
@@ -133,4 +134,53 @@ auto Axis::find_indices(double coordinate) const
   return std::nullopt;
 }
 
+auto Axis::find_indices(const Eigen::Ref<const Eigen::VectorXd> &coordinates)
+    const -> std::tuple<Eigen::Vector<int64_t, -1>, Eigen::Vector<int64_t, -1>,
+                        Eigen::VectorXd> {
+  const auto size = coordinates.size();
+  auto i0 = Eigen::Vector<int64_t, -1>(size);
+  auto i1 = Eigen::Vector<int64_t, -1>(size);
+  auto fraction = Eigen::VectorXd(size);
+
+  if (is_ascending_) {
+    // The distance to the first element of the cell is measured on the
+    // normalized coordinate: it is positive and less than one step, even
+    // for the cell wrapping around the circle.
+    for (int64_t ix = 0; ix < size; ++ix) {
+      const auto coordinate = wrap_coordinate(coordinates[ix]);
+      const auto index = locate(coordinate);
+      if (index == -1) {
+        i0[ix] = i1[ix] = -1;
+        fraction[ix] = std::numeric_limits<double>::quiet_NaN();
+        continue;
+      }
+      i0[ix] = index;
+      i1[ix] = index == size_ - 1 ? 0 : index + 1;
+      fraction[ix] = (coordinate - value(index)) * inv_step_;
+    }
+    return {std::move(i0), std::move(i1), std::move(fraction)};
+  }
+
+  for (int64_t ix = 0; ix < size; ++ix) {
+    const auto indices = search_indices(coordinates[ix]);
+    if (!indices) {
+      i0[ix] = i1[ix] = -1;
+      fraction[ix] = std::numeric_limits<double>::quiet_NaN();
+      continue;
+    }
+    const auto [first, second] = *indices;
+    auto x0 = value(first);
+    auto coordinate = coordinates[ix];
+    auto length = value(second) - x0;
+    if (is_periodic_) {
+      coordinate = normalize_angle(coordinate, x0, 360.0);
+      length = normalize_angle(value(second), x0, 360.0) - x0;
+    }
+    i0[ix] = first;
+    i1[ix] = second;
+    fraction[ix] = (coordinate - x0) / length;
+  }
+  return {std::move(i0), std::move(i1), std::move(fraction)};
+}
+
 }  // namespace perth
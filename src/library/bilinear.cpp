@@ -0,0 +1,262 @@
+#include "perth/bilinear.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "perth/storage.hpp"
+#include "target_clones.hpp"
+
+namespace perth {
+namespace {
+
+/// Words of the real and imaginary parts of the values stored, and their
+/// decoding in double precision. The words of the k-th value are at the
+/// positions 2k and 2k + 1 of a corner.
+template <typename T>
+struct Words {
+  using type = T;
+  static constexpr bool kScaled = false;
+
+  static PERTH_ALWAYS_INLINE auto is_undefined(const T word) noexcept -> bool {
+    return word != word;
+  }
+
+  static PERTH_ALWAYS_INLINE auto decode(const T word) noexcept -> double {
+    return static_cast<double>(word);
+  }
+};
+
+/// Half precision words.
+template <>
+struct Words<Float16> {
+  using type = uint16_t;
+  static constexpr bool kScaled = false;
+
+  static PERTH_ALWAYS_INLINE auto is_undefined(const uint16_t word) noexcept
+      -> bool {
+    return (word & 0x7fffU) > 0x7c00U;
+  }
+
+  static PERTH_ALWAYS_INLINE auto decode(const uint16_t word) noexcept
+      -> double {
+    return static_cast<double>(half_to_float(word));
+  }
+};
+
+/// Scaled 16-bit integer words. The words are interpolated as integers and
+/// the result of the k-th value is then multiplied by `scales[k]`: the
+/// scale factor is shared by the four corners, and applying it once keeps
+/// the interpolation loop free of the gather of the factors.
+template <>
+struct Words<Int16> {
+  using type = int16_t;
+  static constexpr bool kScaled = true;
+
+  const double* scales;
+
+  static PERTH_ALWAYS_INLINE auto is_undefined(const int16_t word) noexcept
+      -> bool {
+    return word == WaveStorage<Int16>::kUndefined;
+  }
+
+  static PERTH_ALWAYS_INLINE auto decode(const int16_t word) noexcept
+      -> double {
+    return static_cast<double>(word);
+  }
+};
+
+/// Count the undefined words among `n` contiguous words.
+template <typename T>
+PERTH_ALWAYS_INLINE auto count_undefined(const typename Words<T>::type* words,
+                                         const size_t n) noexcept -> size_t {
+  auto result = size_t{0};
+  for (size_t ix = 0; ix < n; ++ix) {
+    result += static_cast<size_t>(Words<T>::is_undefined(words[ix]));
+  }
+  return result;
+}
+
+/// Bilinear interpolation of a block of values whose defined corners are
+/// known: bit `k` of `defined` is set if the k-th corner is defined. The
+/// complex values are processed as a flat array of words, decoded on the
+/// fly, so that the loop is vectorized regardless of the instruction set;
+/// the scale factors of the scaled words are applied to the result.
+template <typename T, typename V>
+PERTH_ALWAYS_INLINE auto interpolate_defined(
+    const std::tuple<double, double, double, double>& wxy,
+    const uint8_t defined, const V* z11, const V* z12, const V* z21,
+    const V* z22, const size_t n, const Words<T>& words,
+    std::complex<double>* result) noexcept -> int64_t {
+  using W = typename Words<T>::type;
+  const auto [wx1, wx2, wy1, wy2] = wxy;
+  const W* corners[] = {
+      reinterpret_cast<const W*>(z11), reinterpret_cast<const W*>(z12),
+      reinterpret_cast<const W*>(z21), reinterpret_cast<const W*>(z22)};
+  const double weights[] = {wx1 * wy1, wx1 * wy2, wx2 * wy1, wx2 * wy2};
+  const auto size = 2 * n;
+
+  double w[4];
+  auto valid = int64_t{0};
+  auto sum_w = 0.0;
+  for (size_t ix = 0; ix < 4; ++ix) {
+    const auto is_defined = ((defined >> ix) & 1U) != 0;
+    w[ix] = is_defined ? weights[ix] : 0.0;
+    valid += is_defined ? 1 : 0;
+    sum_w += w[ix];
+  }
+  if (valid == 0 || sum_w == 0) {
+    return 0;
+  }
+  const W* a = corners[0];
+  const W* b = corners[1];
+  const W* c = corners[2];
+  const W* d = corners[3];
+  // Undefined corners have a zero weight but their NaN values must not
+  // propagate in the sum: redirect them to a defined corner.
+  const W* fallback = w[0] != 0 ? a : w[1] != 0 ? b : w[2] != 0 ? c : d;
+  a = w[0] != 0 ? a : fallback;
+  b = w[1] != 0 ? b : fallback;
+  c = w[2] != 0 ? c : fallback;
+  d = w[3] != 0 ? d : fallback;
+
+  auto* out = reinterpret_cast<double*>(result);
+  for (size_t ix = 0; ix < size; ++ix) {
+    out[ix] = (((Words<T>::decode(a[ix]) * w[0] +
+                 Words<T>::decode(b[ix]) * w[1]) +
+                Words<T>::decode(c[ix]) * w[2]) +
+               Words<T>::decode(d[ix]) * w[3]) /
+              sum_w;
+  }
+  if constexpr (Words<T>::kScaled) {
+    for (size_t ix = 0; ix < n; ++ix) {
+      result[ix] *= words.scales[ix];
+    }
+  }
+  return valid;
+}
+
+/// Bilinear interpolation of a block of values, the defined corners being
+/// found by inspecting the values.
+template <typename T, typename V>
+PERTH_ALWAYS_INLINE auto interpolate_stencil(
+    const std::tuple<double, double, double, double>& wxy, const V* z11,
+    const V* z12, const V* z21, const V* z22, const size_t n,
+    const Words<T>& words, std::complex<double>* result) noexcept
+    -> int64_t {
+  using W = typename Words<T>::type;
+  const V* corners[] = {z11, z12, z21, z22};
+  const auto size = 2 * n;
+
+  // Classify each corner: fully defined, fully undefined or mixed.
+  auto defined = uint8_t{0};
+  for (size_t ix = 0; ix < 4; ++ix) {
+    auto undefined =
+        count_undefined<T>(reinterpret_cast<const W*>(corners[ix]), size);
+    if (undefined != 0 && undefined != size) {
+      return -1;
+    }
+    defined |= static_cast<uint8_t>(undefined == 0 ? 1U << ix : 0U);
+  }
+  return interpolate_defined(wxy, defined, z11, z12, z21, z22, n, words,
+                             result);
+}
+
+}  // namespace
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const std::complex<float>* z11,
+                         const std::complex<float>* z12,
+                         const std::complex<float>* z21,
+                         const std::complex<float>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_stencil(wxy, z11, z12, z21, z22, n, Words<float>{},
+                             result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const std::complex<double>* z11,
+                         const std::complex<double>* z12,
+                         const std::complex<double>* z21,
+                         const std::complex<double>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_stencil(wxy, z11, z12, z21, z22, n, Words<double>{},
+                             result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const Complex16<uint16_t>* z11,
+                         const Complex16<uint16_t>* z12,
+                         const Complex16<uint16_t>* z21,
+                         const Complex16<uint16_t>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_stencil(wxy, z11, z12, z21, z22, n, Words<Float16>{},
+                             result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const Complex16<int16_t>* z11,
+                         const Complex16<int16_t>* z12,
+                         const Complex16<int16_t>* z21,
+                         const Complex16<int16_t>* z22, size_t n,
+                         const double* scales,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_stencil(wxy, z11, z12, z21, z22, n,
+                             Words<Int16>{scales}, result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const uint8_t defined,
+                         const std::complex<float>* z11,
+                         const std::complex<float>* z12,
+                         const std::complex<float>* z21,
+                         const std::complex<float>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_defined(wxy, defined, z11, z12, z21, z22, n,
+                             Words<float>{}, result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const uint8_t defined,
+                         const std::complex<double>* z11,
+                         const std::complex<double>* z12,
+                         const std::complex<double>* z21,
+                         const std::complex<double>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_defined(wxy, defined, z11, z12, z21, z22, n,
+                             Words<double>{}, result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const uint8_t defined,
+                         const Complex16<uint16_t>* z11,
+                         const Complex16<uint16_t>* z12,
+                         const Complex16<uint16_t>* z21,
+                         const Complex16<uint16_t>* z22, size_t n,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_defined(wxy, defined, z11, z12, z21, z22, n,
+                             Words<Float16>{}, result);
+}
+
+PERTH_TARGET_CLONES
+auto interpolate_stencil(const std::tuple<double, double, double, double>& wxy,
+                         const uint8_t defined,
+                         const Complex16<int16_t>* z11,
+                         const Complex16<int16_t>* z12,
+                         const Complex16<int16_t>* z21,
+                         const Complex16<int16_t>* z22, size_t n,
+                         const double* scales,
+                         std::complex<double>* result) noexcept -> int64_t {
+  return interpolate_defined(wxy, defined, z11, z12, z21, z22, n,
+                             Words<Int16>{scales}, result);
+}
+
+}  // namespace perth
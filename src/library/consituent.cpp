@@ -276,6 +276,18 @@ auto constituent_to_name(Constituent constituent) -> std::string {
   }
 }
 
+auto doodson_matrix() -> const DoodsonMatrix& {
+  static const DoodsonMatrix matrix = []() -> DoodsonMatrix {
+    auto result = DoodsonMatrix();
+    for (auto&& [key, item] : kConstituents) {
+      result.row(static_cast<Eigen::Index>(constituent_to_index(key))) =
+          item.doodson_number.cast<double>().transpose();
+    }
+    return result;
+  }();
+  return matrix;
+}
+
 auto assemble_constituent_table(const std::vector<Constituent>& constituents)
     -> ConstituentTable {
   ConstituentTable::Item items;
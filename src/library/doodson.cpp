@@ -1,10 +1,15 @@
 
 #include "perth/doodson.hpp"
 
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
 #include "perth/datetime.hpp"
 #include "perth/eigen.hpp"
 #include "perth/fundarg.hpp"
 #include "perth/math.hpp"
+#include "target_clones.hpp"
 
 namespace perth {
 auto calculate_celestial_vector(double time, double delta) noexcept
@@ -49,4 +54,86 @@ auto calculate_celestial_vector(double time, double delta) noexcept
         [](double x) { return normalize_angle(degrees<double>(x)); });
   }
 }
+
+namespace {
+
+/// Round to the nearest integer, for values less than 2^51 in magnitude,
+/// with additions that the compiler vectorizes.
+PERTH_ALWAYS_INLINE auto round_nearest(const double x) noexcept -> double {
+  constexpr auto shift = 6755399441055744.0;
+  return (x + shift) - shift;
+}
+
+/// Reduce an angle in arcseconds to a half circle around zero and convert
+/// it to radians, as std::remainder does in fundarg().
+PERTH_ALWAYS_INLINE auto reduce_arcseconds(const double x) noexcept
+    -> double {
+  constexpr auto circle = 1296000.0;
+  return arcseconds2radians(x - circle * round_nearest(x / circle));
+}
+
+/// Convert an angle from radians to degrees in [-180, 180), as
+/// normalize_angle() does.
+PERTH_ALWAYS_INLINE auto normalize_degrees(const double x) noexcept
+    -> double {
+  const auto y = degrees(x) + 180.0;
+  return y - 360.0 * std::floor(y / 360.0) - 180.0;
+}
+
+/// Evaluate the astronomical variables at `n` times, without branches, so
+/// that the loop is vectorized.
+PERTH_TARGET_CLONES
+auto celestial_vectors(const double* time, const double* delta, const size_t n,
+                       double* tau, double* s, double* h, double* p,
+                       double* fn, double* ps) noexcept -> void {
+  for (size_t ix = 0; ix < n; ++ix) {
+    const auto time_tt =
+        time[ix] + delta[ix] / static_cast<double>(kSecondsPerDay);
+    const auto tx = (time_tt + kModifiedJulianEpoch -
+                     static_cast<double>(kJ2000JulianDay)) /
+                    static_cast<double>(kDaysPerCentury);
+    // Fundamental arguments, see fundarg().
+    const auto l = reduce_arcseconds(horner(
+        tx, 485868.249036, 1717915923.2178, 31.8792, 0.051635, -0.00024470));
+    const auto lp = reduce_arcseconds(horner(
+        tx, 1287104.79305, 129596581.0481, -0.5532, 0.000136, -0.00001149));
+    const auto f = reduce_arcseconds(horner(
+        tx, 335779.526232, 1739527262.8478, -12.7512, -0.001037, 0.00000417));
+    const auto d = reduce_arcseconds(horner(
+        tx, 1072260.70369, 1602961601.2090, -6.3706, 0.006593, -0.00003169));
+    const auto om = reduce_arcseconds(horner(
+        tx, 450160.398036, -6962890.5431, 7.4722, 0.007702, -0.00005939));
+
+    const auto moon = f + om;
+    const auto sun = moon - d;
+    const auto tsolar = (time[ix] - std::trunc(time[ix])) * two_pi<double>();
+    tau[ix] = normalize_degrees(tsolar - moon + sun);
+    s[ix] = normalize_degrees(moon);
+    h[ix] = normalize_degrees(sun);
+    p[ix] = normalize_degrees(moon - l);
+    fn[ix] = normalize_degrees(-om);
+    ps[ix] = normalize_degrees(-lp + f - d + om);
+  }
+}
+
+}  // namespace
+
+auto calculate_celestial_vectors(const Eigen::Ref<const Eigen::VectorXd>& time,
+                                 const Eigen::Ref<const Eigen::VectorXd>& delta)
+    -> Eigen::Matrix<double, -1, 6> {
+  if (time.size() != delta.size()) {
+    throw std::invalid_argument("Input vectors must have the same size");
+  }
+  // The inputs may be strided: the kernel works on contiguous copies.
+  const Eigen::VectorXd times = time;
+  const Eigen::VectorXd deltas = delta;
+  auto result = Eigen::Matrix<double, -1, 6>(time.size(), 6);
+  celestial_vectors(times.data(), deltas.data(),
+                    static_cast<size_t>(time.size()), result.col(0).data(),
+                    result.col(1).data(), result.col(2).data(),
+                    result.col(3).data(), result.col(4).data(),
+                    result.col(5).data());
+  return result;
+}
+
 }  // namespace perth
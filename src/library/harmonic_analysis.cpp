@@ -0,0 +1,183 @@
+#include "perth/harmonic_analysis.hpp"
+
+#include <Eigen/Cholesky>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/math.hpp"
+#include "perth/parallel_for.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+namespace {
+
+/// Number of samples whose basis functions are added at once to the normal
+/// equations.
+constexpr Eigen::Index kBlockSize = 256;
+
+}  // namespace
+
+HarmonicAnalysis::HarmonicAnalysis(std::vector<Constituent> constituents,
+                                   const bool group_modulations,
+                                   const bool fit_mean,
+                                   const double time_tolerance)
+    : constituents_(std::move(constituents)),
+      group_modulations_(group_modulations),
+      fit_mean_(fit_mean),
+      time_tolerance_(time_tolerance) {
+  if (constituents_.empty()) {
+    throw std::invalid_argument("No constituent to estimate");
+  }
+  for (auto it = constituents_.begin(); it != constituents_.end(); ++it) {
+    if (std::find(std::next(it), constituents_.end(), *it) !=
+        constituents_.end()) {
+      throw std::invalid_argument("Duplicate constituent: " +
+                                  constituent_to_name(*it));
+    }
+  }
+  if (time_tolerance_ < 0) {
+    throw std::invalid_argument("Time tolerance must be non-negative");
+  }
+  normal_matrix_ = Eigen::MatrixXd::Zero(unknowns(), unknowns());
+  normal_vector_ = Eigen::VectorXd::Zero(unknowns());
+}
+
+auto HarmonicAnalysis::accumulate(
+    const Eigen::Ref<const Eigen::Vector<int64_t, -1>>& time,
+    const Eigen::Ref<const Eigen::VectorXd>& values, const size_t num_threads)
+    -> void {
+  if (time.size() != values.size()) {
+    throw std::invalid_argument("Input vectors must have the same size");
+  }
+  const auto n = static_cast<Eigen::Index>(constituents_.size());
+  const auto m = unknowns();
+  auto mutex = std::mutex();
+
+  auto worker = [&](const size_t start, const size_t end) -> void {
+    auto table = assemble_constituent_table();
+    auto acc = Accelerator(time_tolerance_, table.size());
+    acc.argument_mode(ArgumentMode::kExtrapolated);
+    acc.delta_time_series(delta_time_series_);
+    auto normal_matrix = Eigen::MatrixXd::Zero(m, m).eval();
+    auto normal_vector = Eigen::VectorXd::Zero(m).eval();
+    auto sum_squares = 0.0;
+    auto samples = int64_t{0};
+    // Basis functions of a block of samples, one column per sample.
+    auto basis = Eigen::MatrixXd(m, kBlockSize);
+    auto block = Eigen::VectorXd(kBlockSize);
+    auto size = Eigen::Index{0};
+    auto flush = [&]() -> void {
+      normal_matrix.selfadjointView<Eigen::Lower>().rankUpdate(
+          basis.leftCols(size));
+      normal_vector.noalias() += basis.leftCols(size) * block.head(size);
+      size = 0;
+    };
+    for (auto ix = static_cast<Eigen::Index>(start);
+         ix < static_cast<Eigen::Index>(end); ++ix) {
+      const auto value = values(ix);
+      if (std::isnan(value)) {
+        continue;
+      }
+      acc.update_args(epoch_to_modified_julian_date(time(ix)),
+                      static_cast<double>(group_modulations_), table);
+      const auto& nodal_corrections = acc.nodal_corrections();
+      for (Eigen::Index jx = 0; jx < n; ++jx) {
+        const auto index = static_cast<size_t>(constituents_[jx]);
+        const auto& [f, u] = nodal_corrections[index];
+        const auto phase = radians(table.items()[index].tidal_argument + u);
+        basis(2 * jx, size) = f * std::cos(phase);
+        basis(2 * jx + 1, size) = f * std::sin(phase);
+      }
+      if (fit_mean_) {
+        basis(m - 1, size) = 1;
+      }
+      block(size++) = value;
+      sum_squares += value * value;
+      ++samples;
+      if (size == kBlockSize) {
+        flush();
+      }
+    }
+    flush();
+    auto lock = std::lock_guard<std::mutex>(mutex);
+    normal_matrix_.triangularView<Eigen::Lower>() += normal_matrix;
+    normal_vector_ += normal_vector;
+    sum_squares_ += sum_squares;
+    samples_ += samples;
+  };
+  parallel_for(worker, static_cast<size_t>(time.size()), num_threads,
+               static_cast<size_t>(kBlockSize));
+}
+
+auto HarmonicAnalysis::merge(const HarmonicAnalysis& other) -> void {
+  if (other.constituents_ != constituents_ ||
+      other.fit_mean_ != fit_mean_ ||
+      other.group_modulations_ != group_modulations_) {
+    throw std::invalid_argument(
+        "The analyses do not estimate the same parameters");
+  }
+  normal_matrix_.triangularView<Eigen::Lower>() += other.normal_matrix_;
+  normal_vector_ += other.normal_vector_;
+  sum_squares_ += other.sum_squares_;
+  samples_ += other.samples_;
+}
+
+auto HarmonicAnalysis::solve() const -> HarmonicAnalysisResult {
+  const auto m = unknowns();
+  if (samples_ < m) {
+    throw std::runtime_error(
+        "Not enough samples to estimate the constituents: " +
+        std::to_string(samples_) + " samples for " + std::to_string(m) +
+        " unknowns");
+  }
+  // The unknowns are scaled so that the diagonal of the normal matrix is 1:
+  // the conditioning then reflects the separation of the constituents, not
+  // their nodal factors.
+  const auto scale = normal_matrix_.diagonal().cwiseSqrt().cwiseInverse();
+  const auto normal_matrix =
+      (scale.asDiagonal() *
+       normal_matrix_.selfadjointView<Eigen::Lower>().toDenseMatrix() *
+       scale.asDiagonal())
+          .eval();
+  const auto ldlt = normal_matrix.ldlt();
+  const auto& d = ldlt.vectorD();
+  // Loose enough to reject the constituents not separated by the series,
+  // whose normal equations are dependent to within rounding errors.
+  constexpr auto kEpsilon = 1e-10;
+  if (ldlt.info() != Eigen::Success || !scale.allFinite() ||
+      d.minCoeff() <= kEpsilon * d.maxCoeff()) {
+    throw std::runtime_error(
+        "The samples do not determine the constituents: the series is too "
+        "short or too sparse to separate them");
+  }
+  const auto solution =
+      (scale.asDiagonal() * ldlt.solve(scale.asDiagonal() * normal_vector_))
+          .eval();
+
+  auto result = HarmonicAnalysisResult{};
+  const auto n = static_cast<Eigen::Index>(constituents_.size());
+  result.constituents.resize(n);
+  for (Eigen::Index ix = 0; ix < n; ++ix) {
+    result.constituents(ix) = {solution(2 * ix), solution(2 * ix + 1)};
+  }
+  result.mean = fit_mean_ ? solution(m - 1) : 0.0;
+  // Sum of the squares of the residuals, at the minimum of the least
+  // squares.
+  const auto residuals = std::max(sum_squares_ - solution.dot(normal_vector_),
+                                  0.0);
+  result.residual_rms =
+      std::sqrt(residuals / static_cast<double>(samples_));
+  result.samples = samples_;
+  return result;
+}
+
+}  // namespace perth
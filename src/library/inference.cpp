@@ -70,43 +70,33 @@ std::unordered_map<Constituent, double>
         {Constituent::kMqm, 0.001687},
     }};
 
-/// @brief Computes linear admittance interpolation, based on 3 fundamental
-/// frequencies.
+/// @brief Weights of the linear admittance interpolation, based on 3
+/// fundamental frequencies.
 /// @param[in] x1 Frequency for the first component.
-/// @param[in] y1 Complex admittance for the first component.
 /// @param[in] x2 Frequency for the second component.
-/// @param[in] y2 Complex admittance for the second component.
 /// @param[in] x3 Frequency for the third component.
-/// @param[in] y3 Complex admittance for the third component.
 /// @param[in] x Frequency at which to evaluate the interpolation.
-/// @return The interpolated complex admittance at frequency `x`.
-constexpr Complex linear_interpolation(double x1, const Complex& y1, double x2,
-                                       const Complex& y2, double x3,
-                                       const Complex& y3, double x) {
+/// @return The weights applied to the admittances of the three components to
+/// obtain the admittance at frequency `x`.
+auto linear_weights(double x1, double x2, double x3, double x)
+    -> Vector3d {
   if (x <= x2) {
-    auto slp = (y2 - y1) / (x2 - x1);
-    return y1 + slp * (x - x1);
+    auto t = (x - x1) / (x2 - x1);
+    return {1 - t, t, 0};
   }
-  auto slp = (y3 - y2) / (x3 - x2);
-  return y2 + slp * (x - x2);
+  auto t = (x - x2) / (x3 - x2);
+  return {0, 1 - t, t};
 }
 
-/// @brief Computes admittance interpolation, based on 3 fundamental
+/// @brief Weights of the admittance interpolation, based on 3 fundamental
 /// frequencies, using approach of Munk-Cartwright (low order Fourier series).
 /// The 3 frequencies must be either (Q1,O1,K1) or (N2,M2,S2).
 /// @tparam N Species number (1=diurnal; 2=semid'l).
-/// @param[in] x1 Frequency for the first component.
-/// @param[in] z1 Complex admittance for the first component.
-/// @param[in] x2 Frequency for the second component.
-/// @param[in] z2 Complex admittance for the second component.
-/// @param[in] x3 Frequency for the third component.
-/// @param[in] z3 Complex admittance for the third component.
 /// @param[in] x Frequency at which to evaluate the interpolation.
-/// @return The interpolated complex admittance at frequency `x`.
+/// @return The weights applied to the admittances of the three components to
+/// obtain the admittance at frequency `x`.
 template <int N>
-Complex fourier_interpolation(double x1, const Complex& z1, double x2,
-                              const Complex& z2, double x3, const Complex& z3,
-                              double x) {
+auto fourier_weights(double x) -> Vector3d {
   static_assert(N == 1 || N == 2, "N must be either 1 or 2");
 
   // Precomputed inverse matrices
@@ -120,142 +110,208 @@ Complex fourier_interpolation(double x1, const Complex& z1, double x2,
   constexpr double p = radians(48.0);
 
   double f = x * p;
-  Vector3c admit(z1, z2, z3);
-
-  Vector3c c;
+  // The admittance is c(0) + c(1) cos(f) + c(2) sin(f), where c = ainv *
+  // admittances.
+  auto basis = Vector3d(1, std::cos(f), std::sin(f));
   if constexpr (N == 1) {
-    c = ainv1 * admit;
-  }
-  if constexpr (N == 2) {
-    c = ainv2 * admit;
+    return ainv1.transpose() * basis;
   }
+  return ainv2.transpose() * basis;
+}
 
-  return c(0) + c(1) * std::cos(f) + c(2) * std::sin(f);
+/// @brief Weights of the admittance interpolation of a species.
+/// @tparam Type Interpolation type.
+/// @tparam N Species number (1=diurnal; 2=semid'l).
+template <InterpolationType Type, int N>
+auto admittance_weights(double x1, double x2, double x3, double x)
+    -> Vector3d {
+  if constexpr (Type == InterpolationType::kFourierAdmittance) {
+    return fourier_weights<N>(x);
+  }
+  return linear_weights(x1, x2, x3, x);
 }
 
-auto populate_and_sort_inferred(
-    std::unordered_map<Constituent, std::pair<double, double>>&
-        mutable_inferred,
-    std::vector<Constituent>& keys,
-    const std::unordered_map<Constituent, double>& inferred,
-    const ConstituentTable& components) -> void {
+/// @brief Frequencies and amplitudes of the inferred constituents of a
+/// species, sorted by frequency.
+auto sorted_inferred(const std::unordered_map<Constituent, double>& inferred,
+                     const ConstituentTable& components)
+    -> std::vector<std::tuple<Constituent, double, double>> {
+  auto result = std::vector<std::tuple<Constituent, double, double>>();
+  result.reserve(inferred.size());
   for (auto [ident, ampl] : inferred) {
     auto doodson_number =
         components[ident].doodson_number.head(6).cast<double>();
-    mutable_inferred[ident] = {tidal_frequency(doodson_number), ampl};
-    keys.push_back(ident);
+    result.emplace_back(ident, tidal_frequency(doodson_number), ampl);
   }
+  std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+    return std::get<1>(a) < std::get<1>(b);
+  });
+  return result;
+}
 
-  // Sort the inferred constituents by frequency
-  std::sort(keys.begin(), keys.end(),
-            [&mutable_inferred](const Constituent& a, const Constituent& b) {
-              // Access the values through the map for comparison
-              const auto& inferred_value_a = mutable_inferred.at(a);
-              const auto& inferred_value_b = mutable_inferred.at(b);
-              return inferred_value_a.first < inferred_value_b.first;
-            });
+/// @brief Frequency and amplitude of a reference constituent.
+auto find_reference(
+    const std::vector<std::tuple<Constituent, double, double>>& inferred,
+    const Constituent ident) -> std::pair<double, double> {
+  auto it = std::find_if(inferred.begin(), inferred.end(),
+                         [&](const auto& item) {
+                           return std::get<0>(item) == ident;
+                         });
+  return {std::get<1>(*it), std::get<2>(*it)};
+}
+
+/// @brief Gravitational factor 1 + k - h applied to the diurnal admittances.
+auto diurnal_gamma(const double x) -> double {
+  auto [fk, fh, fl] = love_pmm95b(x);
+  return 1 + fk - fh;
 }
 
 Inference::Inference(const ConstituentTable& components,
                      const InterpolationType interpolation_type) {
-  populate_and_sort_inferred(inferred_diurnal_, diurnal_keys_,
-                             kInferredDiurnalConstituents_, components);
-  populate_and_sort_inferred(inferred_semidiurnal_, semidiurnal_keys_,
-                             kInferredSemidiurnalConstituents_, components);
-  populate_and_sort_inferred(inferred_long_period_, long_period_keys_,
-                             kInferredLongPeriodConstituents_, components);
-
-  auto& q1 = inferred_diurnal_[Constituent::kQ1];
-  auto& o1 = inferred_diurnal_[Constituent::kO1];
-  auto& k1 = inferred_diurnal_[Constituent::kK1];
-  auto& n2 = inferred_semidiurnal_[Constituent::kN2];
-  auto& m2 = inferred_semidiurnal_[Constituent::kM2];
-  auto& s2 = inferred_semidiurnal_[Constituent::kS2];
-  auto& node = inferred_long_period_[Constituent::kNode];
-  auto& mm = inferred_long_period_[Constituent::kMm];
-  auto& mf = inferred_long_period_[Constituent::kMf];
-
-  x1_ = q1.first;
-  x2_ = o1.first;
-  x3_ = k1.first;
-  x4_ = n2.first;
-  x5_ = m2.first;
-  x6_ = s2.first;
-  x7_ = node.first;
-  x8_ = mm.first;
-  x9_ = mf.first;
-
-  auto [fk, fh, fl] = love_pmm95b(x1_);
-  amp1_ = q1.second * (1 + fk - fh);
-  std::tie(fk, fh, fl) = love_pmm95b(x2_);
-  amp2_ = o1.second * (1 + fk - fh);
-  std::tie(fk, fh, fl) = love_pmm95b(x3_);
-  amp3_ = k1.second * (1 + fk - fh);
-
-  amp4_ = n2.second;
-  amp5_ = m2.second;
-  amp6_ = s2.second;
-  amp7_ = node.second;
-  amp8_ = mm.second;
-  amp9_ = mf.second;
-
   if (interpolation_type == InterpolationType::kLinearAdmittance) {
-    interpolation_1_ = linear_interpolation;
-    interpolation_2_ = linear_interpolation;
+    build<InterpolationType::kLinearAdmittance>(components);
   } else if (interpolation_type == InterpolationType::kFourierAdmittance) {
-    interpolation_1_ = fourier_interpolation<1>;
-    interpolation_2_ = fourier_interpolation<2>;
+    build<InterpolationType::kFourierAdmittance>(components);
   } else {
     throw std::invalid_argument("Unknown interpolation type");
   }
 }
 
-auto Inference::operator()(ConstituentTable& constituent_table,
-                           const double lat) const -> void {
-  auto y1 = constituent_table[Constituent::kQ1].tide / amp1_;
-  auto y2 = constituent_table[Constituent::kO1].tide / amp2_;
-  auto y3 = constituent_table[Constituent::kK1].tide / amp3_;
-  auto y4 = constituent_table[Constituent::kN2].tide / amp4_;
-  auto y5 = constituent_table[Constituent::kM2].tide / amp5_;
-  auto y6 = constituent_table[Constituent::kS2].tide / amp6_;
-  auto y8 = constituent_table[Constituent::kMm].tide / amp8_;
-  auto y9 = constituent_table[Constituent::kMf].tide / amp9_;
+template <InterpolationType Type>
+auto Inference::build(const ConstituentTable& components) -> void {
+  const auto diurnal =
+      sorted_inferred(kInferredDiurnalConstituents_, components);
+  const auto semidiurnal =
+      sorted_inferred(kInferredSemidiurnalConstituents_, components);
+  const auto long_period =
+      sorted_inferred(kInferredLongPeriodConstituents_, components);
 
-  auto y7 =
-      evaluate_node_tide(constituent_table[Constituent::kNode], lat) / amp7_;
+  auto [x1, amp1] = find_reference(diurnal, Constituent::kQ1);
+  auto [x2, amp2] = find_reference(diurnal, Constituent::kO1);
+  auto [x3, amp3] = find_reference(diurnal, Constituent::kK1);
+  auto [x4, amp4] = find_reference(semidiurnal, Constituent::kN2);
+  auto [x5, amp5] = find_reference(semidiurnal, Constituent::kM2);
+  auto [x6, amp6] = find_reference(semidiurnal, Constituent::kS2);
+  auto [x7, amp7] = find_reference(long_period, Constituent::kNode);
+  auto [x8, amp8] = find_reference(long_period, Constituent::kMm);
+  auto [x9, amp9] = find_reference(long_period, Constituent::kMf);
 
-  for (const auto& constituent : diurnal_keys_) {
-    auto& updated_item = constituent_table[constituent];
-    if (!updated_item.is_inferred || updated_item.type != kShortPeriod) {
-      continue;  // Skip if the constituent is not computed by inference
-    }
-    const auto& inferred_item = inferred_diurnal_.at(constituent);
+  // The admittances of the diurnal references are corrected by the Love
+  // numbers.
+  amp1 *= diurnal_gamma(x1);
+  amp2 *= diurnal_gamma(x2);
+  amp3 *= diurnal_gamma(x3);
 
-    auto x = inferred_item.first;
-    auto y = interpolation_1_(x1_, y1, x2_, y2, x3_, y3, x);
-    auto [fk, fh, fl] = love_pmm95b(x);
-    auto gam = 1 + fk - fh;
-    updated_item.tide = y * gam * inferred_item.second;
+  const auto n_inferred = diurnal.size() + semidiurnal.size() +
+                          long_period.size();
+  keys_.reserve(n_inferred);
+  types_.reserve(n_inferred);
+  coefficients_.setZero(static_cast<Eigen::Index>(n_inferred),
+                        kNumReferences);
+
+  // The tide of an inferred constituent is its admittance, interpolated from
+  // the admittances tide / amplitude of the references, multiplied by its
+  // amplitude: a linear combination of the tides of the references.
+  auto row = Eigen::Index{0};
+  for (const auto& [ident, x, amplitude] : diurnal) {
+    auto w = admittance_weights<Type, 1>(x1, x2, x3, x);
+    auto scale = diurnal_gamma(x) * amplitude;
+    coefficients_.row(row).segment<3>(0) =
+        w.cwiseProduct(Vector3d(scale / amp1, scale / amp2, scale / amp3));
+    keys_.push_back(ident);
+    types_.push_back(kShortPeriod);
+    ++row;
+  }
+  for (const auto& [ident, x, amplitude] : semidiurnal) {
+    auto w = admittance_weights<Type, 2>(x4, x5, x6, x);
+    coefficients_.row(row).segment<3>(3) = w.cwiseProduct(
+        Vector3d(amplitude / amp4, amplitude / amp5, amplitude / amp6));
+    keys_.push_back(ident);
+    types_.push_back(kShortPeriod);
+    ++row;
   }
+  // The long-period admittances are always interpolated linearly.
+  for (const auto& [ident, x, amplitude] : long_period) {
+    auto w = linear_weights(x7, x8, x9, x);
+    coefficients_.row(row).segment<3>(6) = w.cwiseProduct(
+        Vector3d(amplitude / amp7, amplitude / amp8, amplitude / amp9));
+    keys_.push_back(ident);
+    types_.push_back(kLongPeriod);
+    ++row;
+  }
+}
 
-  for (const auto& constituent : semidiurnal_keys_) {
-    auto& updated_item = constituent_table[constituent];
-    if (!updated_item.is_inferred || updated_item.type != kShortPeriod) {
-      continue;  // Skip if the constituent is not computed by inference
+auto Inference::constituents() const -> std::vector<Constituent> {
+  return keys_;
+}
+
+auto Inference::amplitude_bounds(const ConstituentTable& constituent_table,
+                                 const std::vector<double>& bounds) const
+    -> std::vector<double> {
+  auto bound = [&](const Constituent ident) -> double {
+    return bounds.at(static_cast<size_t>(ident));
+  };
+  // |P20(lat)| is at most 1, reached at the poles.
+  const auto node =
+      constituent_table[Constituent::kNode].is_inferred
+          ? kNodeGamma2 * std::sqrt(1.25 / pi<double>()) * kNodeAmplitude
+          : bound(Constituent::kNode);
+  const auto references = Eigen::Vector<double, kNumReferences>(
+      bound(Constituent::kQ1), bound(Constituent::kO1),
+      bound(Constituent::kK1), bound(Constituent::kN2),
+      bound(Constituent::kM2), bound(Constituent::kS2), node,
+      bound(Constituent::kMm), bound(Constituent::kMf));
+  const Eigen::VectorXd result = coefficients_.cwiseAbs() * references;
+  return {result.begin(), result.end()};
+}
+
+auto Inference::drop(const std::vector<Constituent>& constituents) -> void {
+  // The rows kept are moved up, in place.
+  auto size = size_t{0};
+  for (size_t ix = 0; ix < keys_.size(); ++ix) {
+    if (std::find(constituents.begin(), constituents.end(), keys_[ix]) !=
+        constituents.end()) {
+      continue;
     }
-    const auto& inferred_item = inferred_semidiurnal_.at(constituent);
-    auto y = interpolation_2_(x4_, y4, x5_, y5, x6_, y6, inferred_item.first);
-    updated_item.tide = y * inferred_item.second;
+    keys_[size] = keys_[ix];
+    types_[size] = types_[ix];
+    coefficients_.row(static_cast<Eigen::Index>(size)) =
+        coefficients_.row(static_cast<Eigen::Index>(ix));
+    ++size;
   }
-  for (const auto& constituent : long_period_keys_) {
-    auto& updated_item = constituent_table[constituent];
-    if (!updated_item.is_inferred || updated_item.type != kLongPeriod) {
+  keys_.resize(size);
+  types_.resize(size);
+  coefficients_.conservativeResize(static_cast<Eigen::Index>(size),
+                                   kNumReferences);
+}
+
+auto Inference::operator()(ConstituentTable& constituent_table,
+                           const double lat) const -> void {
+  // Real and imaginary parts of the tides of the references.
+  auto references = Eigen::Matrix<double, kNumReferences, 2>();
+  auto set_reference = [&](const Eigen::Index ix, const Complex& tide) {
+    references(ix, 0) = tide.real();
+    references(ix, 1) = tide.imag();
+  };
+  set_reference(0, constituent_table[Constituent::kQ1].tide);
+  set_reference(1, constituent_table[Constituent::kO1].tide);
+  set_reference(2, constituent_table[Constituent::kK1].tide);
+  set_reference(3, constituent_table[Constituent::kN2].tide);
+  set_reference(4, constituent_table[Constituent::kM2].tide);
+  set_reference(5, constituent_table[Constituent::kS2].tide);
+  set_reference(
+      6, evaluate_node_tide(constituent_table[Constituent::kNode], lat));
+  set_reference(7, constituent_table[Constituent::kMm].tide);
+  set_reference(8, constituent_table[Constituent::kMf].tide);
+
+  for (size_t ix = 0; ix < keys_.size(); ++ix) {
+    auto& updated_item = constituent_table[keys_[ix]];
+    if (!updated_item.is_inferred || updated_item.type != types_[ix]) {
       continue;  // Skip if the constituent is not computed by inference
     }
-    const auto& inferred_item = inferred_long_period_.at(constituent);
-    auto y =
-        linear_interpolation(x7_, y7, x8_, y8, x9_, y9, inferred_item.first);
-    updated_item.tide = y * inferred_item.second;
+    const Eigen::RowVector2d tide =
+        coefficients_.row(static_cast<Eigen::Index>(ix)) * references;
+    updated_item.tide = Complex(tide(0), tide(1));
   }
 }
 
@@ -0,0 +1,76 @@
+#include "perth/mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PERTH_HAVE_MMAP 1
+#endif
+
+namespace perth {
+
+#ifdef PERTH_HAVE_MMAP
+
+MappedFile::MappedFile(const std::string& path) {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::runtime_error("Unable to open " + path + ": " +
+                             std::strerror(errno));
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) == -1) {
+    auto error = errno;
+    ::close(fd);
+    throw std::runtime_error("Unable to stat " + path + ": " +
+                             std::strerror(error));
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ != 0) {
+    auto* address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd);
+      throw std::runtime_error("Unable to map " + path + ": " +
+                               std::strerror(error));
+    }
+    data_ = static_cast<const std::byte*>(address);
+  }
+  // The mapping remains valid once the descriptor is closed.
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::byte*>(data_), size_);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+  auto stream = std::ifstream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    throw std::runtime_error("Unable to open " + path);
+  }
+  size_ = static_cast<size_t>(stream.tellg());
+  content_.resize(size_);
+  stream.seekg(0);
+  if (!stream.read(reinterpret_cast<char*>(content_.data()),
+                   static_cast<std::streamsize>(size_))) {
+    throw std::runtime_error("Unable to read " + path);
+  }
+  data_ = content_.data();
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+}  // namespace perth
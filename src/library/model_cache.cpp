@@ -0,0 +1,244 @@
+#include "perth/model_cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <ostream>
+#include <streambuf>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace perth {
+
+/// Signature of the model cache files.
+constexpr char kMagic[8] = {'P', 'E', 'R', 'T', 'H', 'T', 'M', '\0'};
+
+/// Version of the model cache format.
+constexpr uint32_t kVersion = 1;
+
+/// Value used to detect a file written with another byte order.
+constexpr uint32_t kByteOrder = 0x01020304;
+
+/// Size of the identifiers and of the scale factors following the header.
+constexpr auto metadata_size(const uint64_t n_constituents, const bool scaled)
+    -> uint64_t {
+  return n_constituents * (1 + (scaled ? sizeof(double) : 0));
+}
+
+namespace {
+
+/// Stream buffer writing into a block of memory.
+class MemoryBuffer : public std::streambuf {
+ public:
+  MemoryBuffer(char* data, const size_t size) { setp(data, data + size); }
+
+ protected:
+  /// Only reports the current position, as required by tellp().
+  auto seekoff(const off_type offset, const std::ios_base::seekdir direction,
+               const std::ios_base::openmode which) -> pos_type override {
+    if (offset == 0 && direction == std::ios_base::cur &&
+        (which & std::ios_base::out) != 0) {
+      return {pptr() - pbase()};
+    }
+    return {off_type(-1)};
+  }
+};
+
+}  // namespace
+
+/// Round the offset up to the alignment of the waves
+constexpr auto align(const uint64_t offset) -> uint64_t {
+  return (offset + kModelCacheAlignment - 1) / kModelCacheAlignment *
+         kModelCacheAlignment;
+}
+
+auto make_model_cache_header(const Axis& lon, const Axis& lat,
+                             const bool row_major, const bool packed,
+                             const size_t value_size,
+                             const size_t n_constituents, const bool scaled)
+    -> ModelCacheHeader {
+  auto header = ModelCacheHeader{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byte_order = kByteOrder;
+  header.value_size = static_cast<uint32_t>(value_size);
+  header.scaled = scaled ? 1 : 0;
+  header.n_constituents = static_cast<uint32_t>(n_constituents);
+  header.row_major = row_major ? 1 : 0;
+  header.packed = packed ? 1 : 0;
+  header.lon_periodic = lon.is_periodic() ? 1 : 0;
+  header.lat_periodic = lat.is_periodic() ? 1 : 0;
+  header.lon_size = lon.size();
+  header.lon_start = lon.start();
+  header.lon_step = lon.step();
+  header.lat_size = lat.size();
+  header.lat_start = lat.start();
+  header.lat_step = lat.step();
+  header.data_offset = align(sizeof(ModelCacheHeader) +
+                             metadata_size(n_constituents, scaled));
+  auto wave_size = static_cast<uint64_t>(lon.size() * lat.size()) * 2 *
+                   value_size;
+  header.wave_stride = packed ? wave_size * n_constituents : align(wave_size);
+  return header;
+}
+
+auto model_cache_size(const ModelCacheHeader& header) -> uint64_t {
+  auto wave_size = static_cast<uint64_t>(header.lon_size * header.lat_size) *
+                   2 * header.value_size;
+  auto data_size =
+      header.packed != 0
+          ? wave_size * header.n_constituents
+          : (header.n_constituents == 0
+                 ? 0
+                 : header.wave_stride * (header.n_constituents - 1) +
+                       wave_size);
+  return header.data_offset + data_size;
+}
+
+auto read_model_cache_header(const std::byte* data, const size_t size)
+    -> ModelCacheHeader {
+  auto header = ModelCacheHeader{};
+  if (size < sizeof(ModelCacheHeader)) {
+    throw std::runtime_error("Invalid model cache: the file is truncated");
+  }
+  std::memcpy(&header, data, sizeof(ModelCacheHeader));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("Invalid model cache: bad signature");
+  }
+  if (header.version != kVersion) {
+    throw std::runtime_error("Unsupported model cache version: " +
+                             std::to_string(header.version));
+  }
+  if (header.byte_order != kByteOrder) {
+    throw std::runtime_error(
+        "The model cache was written with another byte order");
+  }
+  if ((header.value_size != sizeof(int16_t) &&
+       header.value_size != sizeof(float) &&
+       header.value_size != sizeof(double)) ||
+      header.scaled > 1 ||
+      (header.scaled != 0 && header.value_size != sizeof(int16_t))) {
+    throw std::runtime_error("Invalid model cache: bad value size");
+  }
+  if (header.lon_size < 2 || header.lat_size < 2 ||
+      header.data_offset % kModelCacheAlignment != 0 ||
+      header.data_offset <
+          sizeof(ModelCacheHeader) +
+              metadata_size(header.n_constituents, header.scaled != 0)) {
+    throw std::runtime_error("Invalid model cache: bad header");
+  }
+  for (size_t ix = 0; ix < header.n_constituents; ++ix) {
+    auto item = static_cast<uint8_t>(data[sizeof(header) + ix]);
+    if (item >= kNumConstituentItems) {
+      throw std::runtime_error("Invalid model cache: unknown constituent");
+    }
+  }
+  auto wave_size = static_cast<uint64_t>(header.lon_size * header.lat_size) *
+                   2 * header.value_size;
+  if ((header.packed == 0 && header.wave_stride < wave_size) ||
+      size < model_cache_size(header)) {
+    throw std::runtime_error("Invalid model cache: the file is truncated");
+  }
+  return header;
+}
+
+auto read_model_cache_header(const MappedFile& file) -> ModelCacheHeader {
+  return read_model_cache_header(file.data(), file.size());
+}
+
+auto model_cache_value_size(const std::string& path) -> size_t {
+  return read_model_cache_header(MappedFile(path)).value_size;
+}
+
+auto read_model_cache_scales(const std::byte* data,
+                             const ModelCacheHeader& header)
+    -> std::vector<double> {
+  if (header.scaled == 0) {
+    return {};
+  }
+  auto scales = std::vector<double>(header.n_constituents);
+  std::memcpy(scales.data(),
+              data + sizeof(ModelCacheHeader) + header.n_constituents,
+              scales.size() * sizeof(double));
+  return scales;
+}
+
+auto read_model_cache_scales(const MappedFile& file,
+                             const ModelCacheHeader& header)
+    -> std::vector<double> {
+  return read_model_cache_scales(file.data(), header);
+}
+
+auto write_model_cache(
+    std::ostream& stream, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void {
+  auto pad = [&stream](const uint64_t offset) {
+    auto size = static_cast<uint64_t>(stream.tellp());
+    auto padding = std::vector<char>(offset - size, 0);
+    stream.write(padding.data(),
+                 static_cast<std::streamsize>(padding.size()));
+  };
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (auto item : identifiers) {
+    auto value = static_cast<uint8_t>(item);
+    stream.write(reinterpret_cast<const char*>(&value), 1);
+  }
+  if (header.scaled != 0) {
+    stream.write(reinterpret_cast<const char*>(scales.data()),
+                 static_cast<std::streamsize>(scales.size() * sizeof(double)));
+  }
+  pad(header.data_offset);
+  if (header.packed != 0) {
+    write_wave(stream, 0);
+  } else {
+    for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+      pad(header.data_offset + ix * header.wave_stride);
+      write_wave(stream, ix);
+    }
+  }
+}
+
+auto write_model_cache(
+    const std::string& path, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void {
+  // Write the file under a temporary name so that a reader never sees a
+  // partially written cache.
+  auto temporary = path + ".tmp";
+  {
+    auto stream = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error("Unable to create " + temporary);
+    }
+    write_model_cache(stream, header, identifiers, scales, write_wave);
+    if (!stream) {
+      throw std::runtime_error("Unable to write " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw std::runtime_error("Unable to rename " + temporary + " to " + path);
+  }
+}
+
+auto write_model_cache(
+    std::byte* data, const size_t size, const ModelCacheHeader& header,
+    const std::vector<Constituent>& identifiers,
+    const std::vector<double>& scales,
+    const std::function<void(std::ostream&, size_t)>& write_wave) -> void {
+  auto buffer = MemoryBuffer(reinterpret_cast<char*>(data), size);
+  auto stream = std::ostream(&buffer);
+  write_model_cache(stream, header, identifiers, scales, write_wave);
+  if (!stream) {
+    throw std::runtime_error(
+        "The memory is too small to hold the model cache");
+  }
+}
+
+}  // namespace perth
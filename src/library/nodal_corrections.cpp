@@ -1,5 +1,15 @@
 #include "perth/nodal_corrections.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/doodson.hpp"
 #include "perth/math.hpp"
 
 namespace perth {
@@ -471,4 +481,137 @@ auto compute_nodal_corrections(double perihelion, double omega, double perigee,
   return corrections;
 }
 
+NodalCorrectionTable::NodalCorrectionTable(
+    const double start, const double end, const double step,
+    const bool group_modulations, std::vector<Constituent> constituents)
+    : start_(start),
+      end_(end),
+      step_(step),
+      group_modulations_(group_modulations),
+      constituents_(std::move(constituents)) {
+  if (!(step > 0)) {
+    throw std::invalid_argument("The step must be positive");
+  }
+  if (!(end >= start)) {
+    throw std::invalid_argument("The end of the span must follow its start");
+  }
+  // The grid starts one step before the span and ends at least two steps
+  // after its start, so that the four points of the cubic stencil are
+  // always tabulated.
+  size_ = static_cast<int64_t>(std::ceil((end - start) / step)) + 3;
+  values_.reserve(static_cast<size_t>(size_) * constituents_.size());
+  auto times = Eigen::VectorXd(size_);
+  auto deltas = Eigen::VectorXd(size_);
+  for (int64_t ix = 0; ix < size_; ++ix) {
+    times(ix) = start + static_cast<double>(ix - 1) * step;
+    deltas(ix) = calculate_delta_time(times(ix) + kModifiedJulianEpoch);
+  }
+  // The astronomical variables of all the nodes are computed in one pass.
+  const auto vectors = calculate_celestial_vectors(times, deltas);
+  for (int64_t ix = 0; ix < size_; ++ix) {
+    auto corrections = compute_nodal_corrections(
+        vectors.row(ix).transpose(), group_modulations, constituents_);
+    values_.insert(values_.end(), corrections.begin(), corrections.end());
+  }
+}
+
+/// Catmull-Rom interpolation between y1 and y2, t being in [0, 1].
+constexpr auto catmull_rom(const double y0, const double y1, const double y2,
+                           const double y3, const double t) noexcept
+    -> double {
+  return y1 + 0.5 * t *
+                  (y2 - y0 +
+                   t * (2 * y0 - 5 * y1 + 4 * y2 - y3 +
+                        t * (3 * (y1 - y2) + y3 - y0)));
+}
+
+auto NodalCorrectionTable::interpolate(
+    const double time, std::vector<NodalCorrections> &corrections) const
+    -> void {
+  const auto n = constituents_.size();
+  corrections.resize(n);
+  // Position of the time in the grid, which starts one step before the span.
+  const auto position = (time - start_) / step_ + 1;
+  const auto ix = std::clamp(static_cast<int64_t>(std::floor(position)),
+                             int64_t{1}, size_ - 3);
+  const auto t = position - static_cast<double>(ix);
+  const auto *p1 = values_.data() + ix * n;
+  const auto *p0 = p1 - n;
+  const auto *p2 = p1 + n;
+  const auto *p3 = p2 + n;
+  for (size_t jx = 0; jx < n; ++jx) {
+    corrections[jx].f = catmull_rom(p0[jx].f, p1[jx].f, p2[jx].f, p3[jx].f, t);
+    // The phases are unwrapped around the one at p1, in case they wrap
+    // around within the stencil.
+    const auto u1 = p1[jx].u;
+    corrections[jx].u = catmull_rom(u1 + normalize_angle(p0[jx].u - u1), u1,
+                                    u1 + normalize_angle(p2[jx].u - u1),
+                                    u1 + normalize_angle(p3[jx].u - u1), t);
+  }
+}
+
+namespace {
+
+/// Bounds of the nodal corrections, sampled over the cycles of the lunar
+/// node and perigee.
+auto sample_nodal_correction_bounds(const bool group_modulations)
+    -> NodalCorrectionBounds {
+  // Twenty years of daily samples centered on J2000.
+  constexpr auto kFirst = 51544.5 - 3652.5;
+  constexpr int64_t kSize = 7306;
+  // Margins covering the extrema reached between the samples, or for
+  // combinations of the cycles of the node, the perigee and the sun not
+  // sampled.
+  constexpr auto kFactorMargin = 1.01;
+  constexpr auto kRateMargin = 1.25;
+
+  const auto constituents = assemble_constituent_table().keys_vector();
+  const auto n = constituents.size();
+  auto times = Eigen::VectorXd(kSize);
+  auto deltas = Eigen::VectorXd(kSize);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    times(ix) = kFirst + static_cast<double>(ix);
+    deltas(ix) = calculate_delta_time(times(ix) + kModifiedJulianEpoch);
+  }
+  const auto vectors = calculate_celestial_vectors(times, deltas);
+  auto bounds = NodalCorrectionBounds{std::vector<double>(n, 0.0),
+                                      std::vector<double>(n, 0.0),
+                                      std::vector<double>(n, 0.0)};
+  auto previous = std::vector<NodalCorrections>();
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    auto corrections = compute_nodal_corrections(
+        vectors.row(ix).transpose(), group_modulations, constituents);
+    for (size_t jx = 0; jx < n; ++jx) {
+      const auto &[f, u] = corrections[jx];
+      bounds.f[jx] = std::max(bounds.f[jx], std::abs(f));
+      if (!previous.empty()) {
+        bounds.f_rate[jx] =
+            std::max(bounds.f_rate[jx], std::abs(f - previous[jx].f));
+        bounds.u_rate[jx] =
+            std::max(bounds.u_rate[jx],
+                     std::abs(radians(normalize_angle(u - previous[jx].u))));
+      }
+    }
+    previous = std::move(corrections);
+  }
+  for (size_t jx = 0; jx < n; ++jx) {
+    bounds.f[jx] *= kFactorMargin;
+    bounds.f_rate[jx] *= kRateMargin;
+    bounds.u_rate[jx] *= kRateMargin;
+  }
+  return bounds;
+}
+
+}  // namespace
+
+auto nodal_correction_bounds(const bool group_modulations)
+    -> const NodalCorrectionBounds & {
+  if (group_modulations) {
+    static const auto bounds = sample_nodal_correction_bounds(true);
+    return bounds;
+  }
+  static const auto bounds = sample_nodal_correction_bounds(false);
+  return bounds;
+}
+
 }  // namespace perth
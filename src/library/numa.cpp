@@ -0,0 +1,165 @@
+#include "perth/numa.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace perth {
+namespace {
+
+/// Node to which the current thread is pinned, if any.
+thread_local size_t pinned_node = std::numeric_limits<size_t>::max();
+
+/// Parse a CPU number of a list.
+auto parse_cpu(const std::string& list, const std::string& item) -> size_t {
+  if (item.empty() ||
+      item.find_first_not_of("0123456789") != std::string::npos) {
+    throw std::invalid_argument("Invalid CPU list: " + list);
+  }
+  return std::stoul(item);
+}
+
+/// Read the CPUs of the NUMA nodes of the machine.
+auto read_numa_nodes() -> std::vector<std::vector<size_t>> {
+  auto result = std::vector<std::vector<size_t>>();
+#ifdef __linux__
+  // The nodes are numbered from 0, possibly with gaps.
+  const auto root = std::filesystem::path("/sys/devices/system/node");
+  auto error = std::error_code{};
+  auto ids = std::vector<size_t>();
+  for (const auto& entry : std::filesystem::directory_iterator(root, error)) {
+    const auto name = entry.path().filename().string();
+    if (name.rfind("node", 0) == 0 && name.size() > 4 &&
+        name.find_first_not_of("0123456789", 4) == std::string::npos) {
+      ids.push_back(std::stoul(name.substr(4)));
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  for (const auto id : ids) {
+    auto stream =
+        std::ifstream(root / ("node" + std::to_string(id)) / "cpulist");
+    auto list = std::string();
+    if (!std::getline(stream, list)) {
+      continue;
+    }
+    try {
+      auto cpus = parse_cpu_list(list);
+      if (!cpus.empty()) {
+        result.emplace_back(std::move(cpus));
+      }
+    } catch (const std::invalid_argument&) {
+      continue;
+    }
+  }
+#endif
+  if (result.empty()) {
+    auto cpus = std::vector<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1U));
+    for (size_t ix = 0; ix < cpus.size(); ++ix) {
+      cpus[ix] = ix;
+    }
+    result.emplace_back(std::move(cpus));
+  }
+  return result;
+}
+
+}  // namespace
+
+auto parse_cpu_list(const std::string& list) -> std::vector<size_t> {
+  auto result = std::vector<size_t>();
+  auto text = list;
+  text.erase(std::remove_if(text.begin(), text.end(),
+                            [](const unsigned char c) -> bool {
+                              return std::isspace(c) != 0;
+                            }),
+             text.end());
+  auto start = size_t{0};
+  while (start < text.size()) {
+    auto end = text.find(',', start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    const auto item = text.substr(start, end - start);
+    const auto dash = item.find('-');
+    if (dash == std::string::npos) {
+      result.push_back(parse_cpu(list, item));
+    } else {
+      const auto first = parse_cpu(list, item.substr(0, dash));
+      const auto last = parse_cpu(list, item.substr(dash + 1));
+      if (last < first) {
+        throw std::invalid_argument("Invalid CPU list: " + list);
+      }
+      for (auto cpu = first; cpu <= last; ++cpu) {
+        result.push_back(cpu);
+      }
+    }
+    start = end + 1;
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+auto numa_nodes() -> const std::vector<std::vector<size_t>>& {
+  static const auto nodes = read_numa_nodes();
+  return nodes;
+}
+
+auto current_numa_node() -> size_t {
+  if (pinned_node != std::numeric_limits<size_t>::max()) {
+    return pinned_node;
+  }
+  const auto& nodes = numa_nodes();
+  if (nodes.size() == 1) {
+    return 0;
+  }
+#ifdef __linux__
+  const auto cpu = sched_getcpu();
+  if (cpu >= 0) {
+    for (size_t ix = 0; ix < nodes.size(); ++ix) {
+      if (std::binary_search(nodes[ix].begin(), nodes[ix].end(),
+                             static_cast<size_t>(cpu))) {
+        return ix;
+      }
+    }
+  }
+#endif
+  return 0;
+}
+
+auto pin_thread_to_numa_node(const size_t node) -> bool {
+  const auto& cpus = numa_nodes().at(node);
+#ifdef __linux__
+  auto set = cpu_set_t{};
+  CPU_ZERO(&set);
+  for (const auto cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    return false;
+  }
+  pinned_node = node;
+  return true;
+#else
+  static_cast<void>(cpus);
+  return false;
+#endif
+}
+
+}  // namespace perth
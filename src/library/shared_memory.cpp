@@ -0,0 +1,131 @@
+#include "perth/shared_memory.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PERTH_HAVE_SHM 1
+#endif
+
+namespace perth {
+namespace {
+
+/// Normalize the name of a segment: POSIX requires a leading slash and no
+/// other.
+auto normalize(const std::string& name) -> std::string {
+  auto result = name.empty() || name.front() != '/' ? "/" + name : name;
+  if (result.size() < 2 || result.find('/', 1) != std::string::npos) {
+    throw std::invalid_argument("Invalid shared memory name: " + name);
+  }
+  return result;
+}
+
+}  // namespace
+
+#ifdef PERTH_HAVE_SHM
+
+SharedMemory::SharedMemory(const std::string& name, const size_t size)
+    : name_(normalize(name)), size_(size), owner_(true) {
+  auto fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    throw std::runtime_error("Unable to create the shared memory " + name_ +
+                             ": " + std::strerror(errno));
+  }
+  auto fail = [&](const char* action) {
+    auto error = errno;
+    ::close(fd);
+    ::shm_unlink(name_.c_str());
+    throw std::runtime_error("Unable to " + std::string(action) +
+                             " the shared memory " + name_ + ": " +
+                             std::strerror(error));
+  };
+  if (::ftruncate(fd, static_cast<off_t>(size_)) == -1) {
+    fail("resize");
+  }
+  if (size_ != 0) {
+    auto* address =
+        ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      fail("map");
+    }
+    data_ = static_cast<std::byte*>(address);
+  }
+  // The mapping remains valid once the descriptor is closed.
+  ::close(fd);
+}
+
+SharedMemory::SharedMemory(const std::string& name) : name_(normalize(name)) {
+  auto fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    throw std::runtime_error("Unable to open the shared memory " + name_ +
+                             ": " + std::strerror(errno));
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) == -1) {
+    auto error = errno;
+    ::close(fd);
+    throw std::runtime_error("Unable to stat the shared memory " + name_ +
+                             ": " + std::strerror(error));
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ != 0) {
+    auto* address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd);
+      throw std::runtime_error("Unable to map the shared memory " + name_ +
+                               ": " + std::strerror(error));
+    }
+    data_ = static_cast<std::byte*>(address);
+  }
+  ::close(fd);
+}
+
+SharedMemory::~SharedMemory() {
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+  }
+  if (owner_) {
+    ::shm_unlink(name_.c_str());
+  }
+}
+
+auto SharedMemory::remove(const std::string& name) -> bool {
+  return ::shm_unlink(normalize(name).c_str()) == 0;
+}
+
+#else
+
+SharedMemory::SharedMemory(const std::string& name, const size_t /*size*/)
+    : name_(normalize(name)) {
+  throw std::runtime_error("Shared memory is not supported on this system");
+}
+
+SharedMemory::SharedMemory(const std::string& name) : name_(normalize(name)) {
+  throw std::runtime_error("Shared memory is not supported on this system");
+}
+
+SharedMemory::~SharedMemory() = default;
+
+auto SharedMemory::remove(const std::string& name) -> bool {
+  normalize(name);
+  return false;
+}
+
+#endif
+
+auto SharedMemory::mutable_data() -> std::byte* {
+  if (!owner_) {
+    throw std::logic_error("The shared memory " + name_ +
+                           " is attached read-only");
+  }
+  return data_;
+}
+
+}  // namespace perth
@@ -0,0 +1,58 @@
+#include "perth/sincos.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+#include "target_clones.hpp"
+
+namespace perth {
+
+PERTH_TARGET_CLONES
+auto sincos(const double* x, const size_t n, double* sin, double* cos) noexcept
+    -> void {
+  // 2/π, and π/2 split in three parts whose first two have 33 bits, so that
+  // their products by the quadrant are exact.
+  constexpr auto two_over_pi = 6.36619772367581382433e-01;
+  constexpr auto pio2_1 = 1.57079632673412561417e+00;
+  constexpr auto pio2_2 = 6.07710050630396597660e-11;
+  constexpr auto pio2_3 = 2.02226624871116645580e-21;
+  // Adding and subtracting 1.5 * 2^52 rounds to the nearest integer.
+  constexpr auto round = 6755399441055744.0;
+  // Minimax coefficients of sin(r) - r and cos(r) - 1 + r²/2 on [-π/4, π/4]
+  // (fdlibm).
+  constexpr auto s1 = -1.66666666666666324348e-01;
+  constexpr auto s2 = 8.33333333332248946124e-03;
+  constexpr auto s3 = -1.98412698298579493134e-04;
+  constexpr auto s4 = 2.75573137070700676789e-06;
+  constexpr auto s5 = -2.50507602534068634195e-08;
+  constexpr auto s6 = 1.58969099521155010221e-10;
+  constexpr auto c1 = 4.16666666666666019037e-02;
+  constexpr auto c2 = -1.38888888888741095749e-03;
+  constexpr auto c3 = 2.48015872894767294178e-05;
+  constexpr auto c4 = -2.75573143513906633035e-07;
+  constexpr auto c5 = 2.08757232129817482790e-09;
+  constexpr auto c6 = -1.13596475577881948265e-11;
+
+  for (size_t ix = 0; ix < n; ++ix) {
+    const auto quadrant = (x[ix] * two_over_pi + round) - round;
+    const auto r =
+        ((x[ix] - quadrant * pio2_1) - quadrant * pio2_2) - quadrant * pio2_3;
+    const auto z = r * r;
+    const auto sin_r =
+        r + r * z * (s1 + z * (s2 + z * (s3 + z * (s4 + z * (s5 + z * s6)))));
+    const auto cos_r =
+        1.0 - 0.5 * z +
+        z * z * (c1 + z * (c2 + z * (c3 + z * (c4 + z * (c5 + z * c6)))));
+    // Quadrant modulo 4, in [-2, 2]: -1 is the fourth quadrant, -2 and 2
+    // the third one.
+    const auto q = quadrant - 4.0 * ((quadrant * 0.25 + round) - round);
+    const auto odd = std::abs(q) == 1.0;
+    const auto half_turn = std::abs(q) == 2.0;
+    const auto sin_sign = (half_turn | (q == -1.0)) ? -1.0 : 1.0;
+    const auto cos_sign = (half_turn | (q == 1.0)) ? -1.0 : 1.0;
+    sin[ix] = sin_sign * (odd ? cos_r : sin_r);
+    cos[ix] = cos_sign * (odd ? sin_r : cos_r);
+  }
+}
+
+}  // namespace perth
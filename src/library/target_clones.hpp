@@ -0,0 +1,19 @@
+#pragma once
+
+// Function multi-versioning: the kernels are compiled for each instruction set
+// listed and the dynamic loader selects the best one for the host CPU. NEON is
+// part of the aarch64 baseline, so the default version is already vectorized
+// on this architecture.
+#if defined(__x86_64__) && defined(__linux__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define PERTH_TARGET_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define PERTH_TARGET_CLONES
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PERTH_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define PERTH_ALWAYS_INLINE inline
+#endif
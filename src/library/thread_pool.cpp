@@ -0,0 +1,259 @@
+#include "perth/thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "perth/numa.hpp"
+
+namespace perth {
+namespace {
+
+/// Index of the queue owned by the current thread, if it is a worker.
+thread_local size_t worker_index = std::numeric_limits<size_t>::max();
+
+/// Pool shared by the process.
+std::shared_ptr<ThreadPool> global_pool;
+
+/// Pools replaced by set_num_threads(), kept until no computation uses
+/// them: a pool must not be destroyed by one of its workers, e.g. at the
+/// end of a task started by ThreadPool::async() holding the last reference.
+std::vector<std::shared_ptr<ThreadPool>> retired_pools;
+
+/// Protects the pool shared by the process.
+std::mutex global_mutex;
+
+/// Number of workers of a pool using `num_threads` threads, including the
+/// calling thread.
+auto num_workers(size_t num_threads) -> size_t {
+  if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  return num_threads - 1;
+}
+
+/// State of a parallel loop shared by its lanes.
+///
+/// The lanes claim the blocks of items from a shared counter: the first
+/// blocks are large, to limit the number of claims, and their size decreases
+/// as the range is consumed, down to the grain, so that the lanes finish
+/// together even if the cost of the items is uneven.
+struct Loop {
+  Loop(const std::function<void(size_t, size_t)>& worker, const size_t size,
+       const size_t num_lanes, const size_t grain)
+      : worker(worker),
+        size(size),
+        num_lanes(num_lanes),
+        grain(grain),
+        remaining(size) {}
+
+  /// Claim the next block of items.
+  auto take(size_t& start, size_t& stop) -> bool {
+    start = next.load(std::memory_order_relaxed);
+    do {
+      if (start >= size) {
+        return false;
+      }
+      const auto chunk = std::max(grain, (size - start) / (2 * num_lanes));
+      stop = std::min(size, start + chunk);
+    } while (!next.compare_exchange_weak(start, stop,
+                                         std::memory_order_relaxed));
+    return true;
+  }
+
+  /// Process blocks of items until the range is exhausted.
+  auto run() -> void {
+    size_t start;
+    size_t stop;
+    while (take(start, stop)) {
+      try {
+        worker(start, stop);
+      } catch (...) {
+        // Keep the last exception encountered. It will be rethrown once the
+        // whole range has been processed.
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        exception = std::current_exception();
+      }
+      if (remaining.fetch_sub(stop - start) == stop - start) {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        condition.notify_all();
+      }
+    }
+  }
+
+  /// Wait for the whole range to be processed.
+  auto wait() -> void {
+    auto lock = std::unique_lock<std::mutex>(mutex);
+    condition.wait(lock, [this] { return remaining.load() == 0; });
+  }
+
+  const std::function<void(size_t, size_t)>& worker;
+  const size_t size;
+  const size_t num_lanes;
+  const size_t grain;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> remaining;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::exception_ptr exception{nullptr};
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(const size_t num_workers, const bool pin_threads)
+    : pinned_(pin_threads) {
+  queues_.reserve(num_workers);
+  for (size_t ix = 0; ix < num_workers; ++ix) {
+    queues_.emplace_back(std::make_unique<Queue>());
+  }
+  const auto num_nodes = numa_nodes().size();
+  threads_.reserve(num_workers);
+  for (size_t ix = 0; ix < num_workers; ++ix) {
+    // The calling thread counts as the first thread of the first node: the
+    // workers fill the nodes one after the other.
+    const auto node = (ix + 1) * num_nodes / (num_workers + 1);
+    threads_.emplace_back([this, ix, node] {
+      if (pinned_) {
+        pin_thread_to_numa_node(node);
+      }
+      run(ix);
+    });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+auto ThreadPool::submit(Task task) -> void {
+  if (threads_.empty()) {
+    task();
+    return;
+  }
+  // A task submitted by a worker goes to its own queue, the others are
+  // distributed over the queues.
+  auto ix = worker_index < queues_.size()
+                ? worker_index
+                : next_.fetch_add(1) % queues_.size();
+  {
+    auto lock = std::lock_guard<std::mutex>(queues_[ix]->mutex);
+    queues_[ix]->tasks.push_back(std::move(task));
+  }
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    pending_.fetch_add(1);
+  }
+  condition_.notify_one();
+}
+
+auto ThreadPool::pop(const size_t ix, Task& task) -> bool {
+  {
+    auto& queue = *queues_[ix];
+    auto lock = std::lock_guard<std::mutex>(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+  for (size_t jx = 1; jx < queues_.size(); ++jx) {
+    auto& queue = *queues_[(ix + jx) % queues_.size()];
+    auto lock = std::lock_guard<std::mutex>(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ThreadPool::run(const size_t ix) -> void {
+  worker_index = ix;
+  Task task;
+  while (true) {
+    if (pop(ix, task)) {
+      pending_.fetch_sub(1);
+      task();
+      task = nullptr;
+      continue;
+    }
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    condition_.wait(lock, [this] { return stop_ || pending_.load() != 0; });
+    if (stop_ && pending_.load() == 0) {
+      return;
+    }
+  }
+}
+
+auto ThreadPool::parallel_for(const std::function<void(size_t, size_t)>& worker,
+                              const size_t size, const size_t num_lanes,
+                              const size_t grain) -> void {
+  if (size == 0) {
+    return;
+  }
+  auto loop =
+      std::make_shared<Loop>(worker, size, std::max<size_t>(num_lanes, 1),
+                             std::max<size_t>(grain, 1));
+  // The queued lanes keep the loop alive: they may start after the other
+  // lanes have claimed all the items.
+  for (size_t ix = 1; ix < loop->num_lanes; ++ix) {
+    submit([loop] { loop->run(); });
+  }
+  loop->run();
+  loop->wait();
+  if (loop->exception) {
+    std::rethrow_exception(loop->exception);
+  }
+}
+
+auto ThreadPool::instance() -> std::shared_ptr<ThreadPool> {
+  auto lock = std::lock_guard<std::mutex>(global_mutex);
+  if (!global_pool) {
+    global_pool = std::make_shared<ThreadPool>(num_workers(0));
+  }
+  return global_pool;
+}
+
+auto ThreadPool::set_num_threads(const size_t num_threads,
+                                 const bool pin_threads) -> void {
+  auto pool =
+      std::make_shared<ThreadPool>(num_workers(num_threads), pin_threads);
+  // The pools no longer used are destroyed out of the lock, by this thread.
+  auto unused = std::vector<std::shared_ptr<ThreadPool>>();
+  {
+    auto lock = std::lock_guard<std::mutex>(global_mutex);
+    std::swap(global_pool, pool);
+    if (pool) {
+      retired_pools.emplace_back(std::move(pool));
+    }
+    // Only the list refers to a pool no longer used: no reference can be
+    // taken again, the pool being no longer shared.
+    auto it = std::partition(
+        retired_pools.begin(), retired_pools.end(),
+        [](const auto& item) -> bool { return item.use_count() > 1; });
+    std::move(it, retired_pools.end(), std::back_inserter(unused));
+    retired_pools.erase(it, retired_pools.end());
+  }
+}
+
+auto ThreadPool::num_threads() -> size_t { return instance()->size() + 1; }
+
+}  // namespace perth
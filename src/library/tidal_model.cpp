@@ -1,4 +1,6 @@
 #include "perth/tidal_model.hpp"
+
+#include <algorithm>
 #include <cstdlib>
 #include <utility>
 
@@ -6,36 +8,133 @@
 #include "perth/datetime.hpp"
 #include "perth/delta_t.hpp"
 #include "perth/doodson.hpp"
+#include "perth/math.hpp"
 #include "perth/nodal_corrections.hpp"
 
 namespace perth {
+namespace {
+
+using ArgumentRates = Eigen::Vector<double, kNumConstituentItems>;
+
+/// Rates of the tidal arguments of all the constituents, in degrees per day,
+/// derived from those of the astronomical variables as in tidal_frequency().
+auto argument_rates() -> const ArgumentRates& {
+  static const auto rates = []() -> ArgumentRates {
+    // Time interval in days, around J2000.
+    constexpr double del = 0.05;
+    const auto beta1 = calculate_celestial_vector(51545.0, 0.0);
+    const auto beta2 = calculate_celestial_vector(51545.0 + del, 0.0);
+    // The variables are normalized: the differences are wrapped to stay
+    // continuous.
+    Eigen::Vector<double, 7> beta_rates;
+    for (Eigen::Index ix = 0; ix < 6; ++ix) {
+      beta_rates(ix) = normalize_angle(beta2(ix) - beta1(ix)) / del;
+    }
+    beta_rates(6) = 0;
+    return doodson_matrix() * beta_rates;
+  }();
+  return rates;
+}
+
+}  // namespace
+
+auto Accelerator::find_block(const int64_t i1, const int64_t i2,
+                             const int64_t j1, const int64_t j2,
+                             const size_t size) noexcept -> const std::byte* {
+  auto it = std::find_if(cells_.begin(), cells_.end(), [&](const Cell& cell) {
+    return cell.i1 == i1 && cell.i2 == i2 && cell.j1 == j1 && cell.j2 == j2 &&
+           cell.corners.size() == size;
+  });
+  if (it == cells_.end()) {
+    if constexpr (kProfiling) {
+      ++cell_misses_;
+    }
+    return nullptr;
+  }
+  if constexpr (kProfiling) {
+    ++cell_hits_;
+  }
+  // Move the cell found to the front of the cache.
+  std::rotate(cells_.begin(), it, std::next(it));
+  return cells_.front().corners.data();
+}
+
+auto Accelerator::insert_block(const int64_t i1, const int64_t i2,
+                               const int64_t j1, const int64_t j2,
+                               const size_t size, const double x1,
+                               const double x2, const double y1,
+                               const double y2) -> std::byte* {
+  if (cells_.size() < cell_cache_size_) {
+    cells_.emplace_back();
+  }
+  // The last cell is the least recently used one, or the one just created:
+  // its storage is reused for the new cell, moved to the front.
+  std::rotate(cells_.begin(), std::prev(cells_.end()), cells_.end());
+  auto& cell = cells_.front();
+  cell.i1 = i1;
+  cell.i2 = i2;
+  cell.j1 = j1;
+  cell.j2 = j2;
+  cell.x1 = x1;
+  cell.x2 = x2;
+  cell.y1 = y1;
+  cell.y2 = y2;
+  cell.corners.resize(size);
+  return cell.corners.data();
+}
 
 auto Accelerator::update_args(const double time, const double group_modulations,
-                              ConstituentTable& table) -> void {
-  if (std::abs(time - time_) < time_tolerance_) {
-    return;
+                              ConstituentTable& table) -> bool {
+  // The arguments are kept for an identical time, even if the tolerance is
+  // zero.
+  if (time == time_) {
+    return false;
+  }
+  if (argument_mode_ == ArgumentMode::kFrozen) {
+    if (std::abs(time - time_) < time_tolerance_) {
+      return false;
+    }
+  } else if (std::abs(time - reference_time_) < time_tolerance_) {
+    const auto& rates = argument_rates();
+    const auto dt = time - reference_time_;
+    auto& items = table.items();
+    for (size_t ix = 0; ix < items.size(); ++ix) {
+      const auto jx = static_cast<Eigen::Index>(ix);
+      items[ix].tidal_argument =
+          normalize_angle(reference_arguments_(jx) + rates(jx) * dt);
+    }
+    time_ = time;
+    return true;
   }
 
   time_ = time;
-  delta_ = calculate_delta_time(time + kModifiedJulianEpoch);
+  reference_time_ = time;
+  delta_ = delta_time_series_
+               ? (*delta_time_series_)(time)
+               : calculate_delta_time(time + kModifiedJulianEpoch);
 
   auto args = calculate_celestial_vector(time, delta_);
-  const auto perigee = args(3);
-  const auto omega = -args(4);
-  if (group_modulations) {
-    const auto hsolar = args(2);
-    const auto psolar = args(5);
-    nodal_corrections_ = std::move(compute_nodal_corrections(
-        psolar, omega, perigee, hsolar, table.keys_vector()));
+  if (nodal_correction_table_ && nodal_correction_table_->contains(time) &&
+      nodal_correction_table_->group_modulations() ==
+          static_cast<bool>(group_modulations) &&
+      nodal_correction_table_->constituents() == table.keys_vector()) {
+    // The nodal corrections are interpolated in the table, in place.
+    nodal_correction_table_->interpolate(time, nodal_corrections_);
   } else {
-    nodal_corrections_ = std::move(
-        compute_nodal_corrections(omega, perigee, table.keys_vector()));
+    nodal_corrections_ = compute_nodal_corrections(
+        args, static_cast<bool>(group_modulations), table.keys_vector());
+  }
+  // The tidal arguments of all the constituents are obtained in one product
+  // of the Doodson numbers by the astronomical variables computed above.
+  const auto arguments = calculate_doodson_arguments(args, doodson_matrix());
+  auto& items = table.items();
+  for (size_t ix = 0; ix < items.size(); ++ix) {
+    items[ix].tidal_argument = arguments(static_cast<Eigen::Index>(ix));
   }
-  for (auto& key : table.keys()) {
-    auto& component = table[key];
-    component.tidal_argument = calculate_doodson_argument(
-        time_, delta_, component.doodson_number.cast<double>());
+  if (argument_mode_ == ArgumentMode::kExtrapolated) {
+    reference_arguments_ = arguments;
   }
+  return true;
 }
 
 }  // namespace perth
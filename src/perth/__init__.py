@@ -1,23 +1,58 @@
-from typing import Annotated, TypeAlias
+import asyncio
+import atexit
+import concurrent.futures
+from collections.abc import Callable, Generator, Iterable, Iterator
+from typing import Annotated, Any, TypeAlias
 from numpy.typing import NDArray
 import numpy
 
 from ._core import (
+    Approximation,
+    ArgumentMode,
+    AsyncEvaluation,
+    Backend,
     Constituent,
+    EvaluationStats,
     InterpolationType,
     Quality,
     Accelerator,
+    EnsembleFloat16,
+    EnsembleFloat32,
+    EnsembleFloat64,
+    EnsembleInt16,
+    HarmonicAnalysis as _HarmonicAnalysis,
+    HarmonicAnalysisResult,
+    PerthFloat16,
     PerthFloat32,
     PerthFloat64,
+    PerthInt16,
+    TidalModelFloat16,
     TidalModelFloat32,
     TidalModelFloat64,
+    TidalModelInt16,
+    convert_tidal_model,
+    get_num_threads,
+    numa_nodes,
+    profiling_enabled,
+    remove_shared_memory,
+    set_num_threads,
 )
 
-from .model import load_model
+from .model import (
+    TidalModel,
+    attach_model,
+    load_model,
+    load_model_cache,
+    save_model_cache,
+    share_model,
+)
 
 VectorDateTime64: TypeAlias = Annotated[NDArray[numpy.datetime64], "[m, 1]"]
+VectorFloat32: TypeAlias = Annotated[NDArray[numpy.float32], "[m, 1]"]
 VectorFloat64: TypeAlias = Annotated[NDArray[numpy.float64], "[m, 1]"]
 VectorInt8: TypeAlias = Annotated[NDArray[numpy.int8], "[m, 1]"]
+MatrixFloat64: TypeAlias = Annotated[NDArray[numpy.float64], "[m, n]"]
+MatrixInt8: TypeAlias = Annotated[NDArray[numpy.int8], "[m, n]"]
 
 LINEAR_ADMITTANCE: InterpolationType = InterpolationType.LINEAR_ADMITTANCE
 FOURIER_ADMITTANCE: InterpolationType = InterpolationType.FOURIER_ADMITTANCE
@@ -37,23 +72,75 @@ __all__ = [
     "LINEAR_ADMITTANCE",
     "UNDEFINED",
     "Accelerator",
+    "Approximation",
+    "ArgumentMode",
+    "Backend",
     "Constituent",
+    "Ensemble",
+    "EvaluationFuture",
+    "EvaluationStats",
+    "HarmonicAnalysis",
+    "HarmonicAnalysisResult",
     "InterpolationType",
     "Perth",
     "Quality",
+    "attach_model",
+    "convert_tidal_model",
+    "get_num_threads",
     "load_model",
+    "load_model_cache",
+    "numa_nodes",
+    "profiling_enabled",
+    "remove_shared_memory",
+    "save_model_cache",
+    "set_num_threads",
+    "share_model",
 ]
 
 
+#: Evaluations started by :meth:`Perth.evaluate_async` not yet completed.
+_PENDING: set["EvaluationFuture"] = set()
+
+
+@atexit.register
+def _wait_pending() -> None:
+    # The workers completing an evaluation need the interpreter to call the
+    # callbacks: it must not be finalized before.
+    concurrent.futures.wait(list(_PENDING))
+
+
+class EvaluationFuture(
+    concurrent.futures.Future[tuple[VectorFloat64, VectorFloat64, VectorInt8]]
+):
+    """Result of an evaluation started by :meth:`Perth.evaluate_async`.
+
+    A :class:`concurrent.futures.Future`, completed by the thread pool of
+    the library, which can also be awaited in a coroutine: ``await
+    perth.evaluate_async(...)`` does not block the event loop.
+    """
+
+    def __await__(self) -> Generator[Any, None, Any]:
+        return asyncio.wrap_future(self).__await__()
+
+    def _complete(self, evaluation: AsyncEvaluation) -> None:
+        try:
+            self.set_result(evaluation.result())
+        except Exception as error:
+            self.set_exception(error)
+        finally:
+            _PENDING.discard(self)
+
+
 class Perth:
     """A tidal analysis and prediction engine.
 
-    Perth provides high-performance tidal constituent evaluation using either
-    float32 or float64 precision tidal models.
+    Perth provides high-performance tidal constituent evaluation using
+    tidal models stored in float64, float32, float16 or scaled int16.
 
     Args:
-        model: A TidalModelFloat32 or TidalModelFloat64 instance containing
-            tidal harmonic data for predictions.
+        model: A TidalModelFloat64, TidalModelFloat32, TidalModelFloat16 or
+            TidalModelInt16 instance containing tidal harmonic data for
+            predictions.
         group_modulations: If True, applies nodal modulations to grouped
             constituents. Default is False. Only enable if you understand
             the tidal harmonic analysis implications.
@@ -61,10 +148,10 @@ class Perth:
 
     def __init__(
         self,
-        model: TidalModelFloat32 | TidalModelFloat64,
+        model: TidalModel,
         group_modulations: bool = False,
     ) -> None:
-        self._handler: PerthFloat32 | PerthFloat64
+        self._handler: PerthFloat32 | PerthFloat64 | PerthFloat16 | PerthInt16
         if isinstance(model, TidalModelFloat32):
             self._handler = PerthFloat32(
                 model,
@@ -75,16 +162,170 @@ class Perth:
                 model,
                 group_modulations,
             )
+        elif isinstance(model, TidalModelFloat16):
+            self._handler = PerthFloat16(
+                model,
+                group_modulations,
+            )
+        elif isinstance(model, TidalModelInt16):
+            self._handler = PerthInt16(
+                model,
+                group_modulations,
+            )
         else:
             raise TypeError(
-                "Model must be of type TidalModelFloat32 or TidalModelFloat64"
+                "Model must be of type TidalModelFloat32, TidalModelFloat64, "
+                "TidalModelFloat16 or TidalModelInt16"
             )
 
     @property
-    def tidal_model(self) -> TidalModelFloat32 | TidalModelFloat64:
+    def tidal_model(self) -> TidalModel:
         """Return the tidal model used by this Perth instance."""
         return self._handler.tidal_model
 
+    @property
+    def last_stats(self) -> EvaluationStats:
+        """Return the counters of the last evaluation completed.
+
+        The counters give the number of points per quality flag, the hits and
+        misses of the cache of grid cells, the number of updates of the
+        astronomical arguments and the time spent in each stage of the
+        evaluation. They are only updated if the library is built with the
+        ``PERTH_ENABLE_PROFILING`` CMake option (see
+        :func:`profiling_enabled`); otherwise they remain zero.
+        """
+        return self._handler.last_stats
+
+    @property
+    def backend(self) -> Backend:
+        """Return the strategy used by :meth:`evaluate` and
+        :meth:`evaluate_into`.
+
+        ``Backend.POINTWISE``, the default, interpolates, infers and sums the
+        constituents at each point. ``Backend.BATCHED`` groups the points by
+        time bucket and folds, once per bucket, the inference, the nodal
+        corrections and the harmonic sum into coefficients applied to the
+        interpolated constituents: it is faster when many points share a
+        bucket, e.g. for swaths, grids or a positive time tolerance. It
+        processes the points in ascending time order and ignores
+        ``sort_by_cell``. Its results match those of the pointwise backend,
+        processing the points in the same order, to within 1e-9 in the unit
+        of the model.
+        """
+        return self._handler.backend
+
+    @backend.setter
+    def backend(self, value: Backend) -> None:
+        self._handler.backend = value
+
+    @property
+    def argument_mode(self) -> ArgumentMode:
+        """Return how the astronomical arguments are provided within the time
+        tolerance given to the evaluations.
+
+        ``ArgumentMode.FROZEN``, the default, keeps the arguments constant
+        within the tolerance: a larger tolerance trades the accuracy of the
+        phases, e.g. 0.48 degree of M2 per minute, for speed.
+        ``ArgumentMode.EXTRAPOLATED`` computes them at the start of each
+        window and extrapolates them linearly with the rates of the
+        constituents inside it, allowing tolerances of hours (e.g. 1 / 24
+        day) without loss of accuracy; only the nodal corrections, slowly
+        varying, are kept constant.
+        """
+        return self._handler.argument_mode
+
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None:
+        self._handler.argument_mode = value
+
+    @property
+    def error_budget(self) -> float:
+        """Return the error allowed to the evaluations, in the unit of the
+        model; 0, the default, if they are exact.
+
+        With a positive budget, the inferred constituents whose contribution
+        is bounded by the smallest values are no longer computed, and
+        :meth:`evaluate` and :meth:`evaluate_into` keep the nodal corrections
+        within a time tolerance, extrapolating the astronomical arguments as
+        ``ArgumentMode.EXTRAPOLATED`` does. The shortcuts are selected from
+        the largest amplitudes of the waves of the model, which must not be
+        tiled; :meth:`approximation` returns them, with the error bound they
+        guarantee. A larger time tolerance given to the evaluations is not
+        covered by the bound. The batched backend only drops the
+        constituents.
+        """
+        return self._handler.error_budget
+
+    @error_budget.setter
+    def error_budget(self, value: float) -> None:
+        self._handler.error_budget = value
+
+    def approximation(
+        self,
+        interpolation_type: InterpolationType | None = None,
+    ) -> Approximation:
+        """Return the shortcuts taken by the evaluations within the error
+        budget, see :attr:`error_budget`.
+
+        Args:
+            interpolation_type: Interpolation of the admittances used to
+                infer the minor constituents, or None if no inference is
+                done.
+
+        Returns:
+            The shortcuts and the error bound they guarantee, in the unit of
+            the model; none if the budget is 0. The evaluations keep the
+            nodal corrections within the larger of the time tolerance
+            selected, in days, and the ``time_tolerance`` they are given:
+            the bound only covers the former.
+        """
+        return self._handler.approximation(interpolation_type)
+
+    def tabulate_nodal_corrections(
+        self,
+        start: numpy.datetime64,
+        end: numpy.datetime64,
+        *,
+        step: float | None = None,
+    ) -> None:
+        """Tabulate the nodal corrections over a time span.
+
+        The next evaluations interpolate the nodal corrections in the table
+        for the times within the span instead of computing them, which
+        speeds up the processing of long time series.
+
+        Args:
+            start: First time of the span.
+            end: Last time of the span.
+            step: Step between two tabulated times, in days. By default, one
+                day, or three hours if the group modulations are applied.
+        """
+        self._handler.tabulate_nodal_corrections(
+            int(numpy.datetime64(start, "us").astype("i8")),
+            int(numpy.datetime64(end, "us").astype("i8")),
+            step,
+        )
+
+    def set_delta_time_series(
+        self,
+        time: VectorDateTime64,
+        delta: VectorFloat64,
+    ) -> None:
+        """Use a series of Delta T (TT - UT) instead of the built-in model.
+
+        Within the span of the series, the next evaluations interpolate Delta
+        T linearly in it; outside, the polynomial model of Espenak and Meeus
+        is used. Useful to apply the values published by the IERS.
+
+        Args:
+            time: Times of the values, strictly increasing.
+            delta: Delta T at each time, in seconds.
+        """
+        self._handler.set_delta_time_series(
+            numpy.asarray(time).astype("M8[us]").astype("i8"),
+            numpy.asarray(delta, dtype=numpy.float64),
+        )
+
     def evaluate(  # noqa: PLR0913
         self,
         lon: VectorFloat64,
@@ -94,6 +335,8 @@ class Perth:
         time_tolerance: float = 0.0,
         interpolation_type: InterpolationType | None = None,
         num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
     ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]:
         """Evaluate tidal constituents at specified locations and times.
 
@@ -101,10 +344,11 @@ class Perth:
             lon: Longitudes in degrees, shape [m, 1].
             lat: Latitudes in degrees, shape [m, 1].
             time: Timestamps as numpy.datetime64, shape [m, 1].
-            time_tolerance: Maximum time difference in seconds before
-                recomputing lunisolar fundamental arguments and nodal
-                corrections. If 0, these values are recomputed for each call
-                unless the timestamp is identical to the previous call.
+            time_tolerance: Maximum time difference in days (e.g. 1 / 24
+                for one hour) before recomputing lunisolar fundamental
+                arguments and nodal corrections. If 0, these values are
+                recomputed for each call unless the timestamp is identical to
+                the previous call.
             interpolation_type: Method for constituent inference:
                 - None: No inference; only input constituents used for
                   prediction
@@ -116,7 +360,20 @@ class Perth:
                 for short period; Mf, Mm for long period; and 18.6-year node
                 tide.
             num_threads: Number of threads for parallel computation. If 0, uses
-            all available CPU cores.
+            all the threads of the pool shared by the computations (see
+            :func:`set_num_threads`).
+            sort_by_time: If True, the points are processed in ascending
+                time order, so that the astronomical arguments and nodal
+                corrections are computed once per distinct time (or per
+                bucket of ``time_tolerance`` days) even if the input is
+                not sorted, e.g. swath data where many pixels share a
+                timestamp. The results are returned in the input order.
+            sort_by_cell: If True, the points are processed along a Hilbert
+                curve over the cells of the model, so that neighboring
+                points reuse the same cells. Combined with ``sort_by_time``,
+                the points are sorted by time (or bucket) first. Useful for
+                dense, unordered data over a region; the results are
+                returned in the input order.
 
             .. note::
 
@@ -139,4 +396,527 @@ class Perth:
             time_tolerance,
             interpolation_type,
             num_threads,
+            sort_by_time,
+            sort_by_cell,
+        )
+
+    def evaluate_async(  # noqa: PLR0913
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorDateTime64,
+        *,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> EvaluationFuture:
+        """Start the evaluation of the tide without waiting for it.
+
+        As :meth:`evaluate`, the evaluation running in a worker of the
+        thread pool shared by the computations (see :func:`set_num_threads`)
+        instead of the calling thread: concurrent evaluations share the
+        threads of the pool instead of each using all of them. The inputs
+        are copied before returning.
+
+        Args:
+            lon: Longitudes in degrees, shape [m, 1].
+            lat: Latitudes in degrees, shape [m, 1].
+            time: Timestamps as numpy.datetime64, shape [m, 1].
+            time_tolerance: See :meth:`evaluate`.
+            interpolation_type: See :meth:`evaluate`.
+            num_threads: See :meth:`evaluate`.
+            sort_by_time: See :meth:`evaluate`.
+            sort_by_cell: See :meth:`evaluate`.
+
+        Returns:
+            The future of the tuple returned by :meth:`evaluate`, which can
+            be awaited.
+        """
+        future = EvaluationFuture()
+        future.set_running_or_notify_cancel()
+        _PENDING.add(future)
+        try:
+            self._handler.evaluate_async(
+                future._complete,
+                lon,
+                lat,
+                time.astype("M8[us]").astype("i8"),
+                time_tolerance,
+                interpolation_type,
+                num_threads,
+                sort_by_time,
+                sort_by_cell,
+            )
+        except BaseException:
+            _PENDING.discard(future)
+            raise
+        return future
+
+    def evaluate_into(  # noqa: PLR0913
+        self,
+        lon: VectorFloat32 | VectorFloat64,
+        lat: VectorFloat32 | VectorFloat64,
+        time: VectorDateTime64,
+        out_tide: VectorFloat64,
+        out_tide_lp: VectorFloat64,
+        out_quality: VectorInt8,
+        *,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None:
+        """Evaluate tidal constituents into arrays provided by the caller.
+
+        As :meth:`evaluate`, without allocating the results: the tides and
+        the quality flags are written into ``out_tide``, ``out_tide_lp`` and
+        ``out_quality``, which may be strided views of larger arrays, e.g.
+        a column of a chunk buffer reused from one call to the next. The
+        coordinates may be float32 or float64 arrays, strided or not: they
+        are read in place. The times are only converted if they are not
+        already in microseconds.
+
+        Args:
+            lon: Longitudes in degrees, shape [m, 1].
+            lat: Latitudes in degrees, shape [m, 1], of the same type as
+                ``lon``.
+            time: Timestamps as numpy.datetime64, shape [m, 1].
+            out_tide: Receives the ocean tide heights in meters: a writable
+                float64 array of shape [m, 1].
+            out_tide_lp: Receives the long period tide heights in meters: a
+                writable float64 array of shape [m, 1].
+            out_quality: Receives the quality flags: a writable int8 array
+                of shape [m, 1].
+            time_tolerance: See :meth:`evaluate`.
+            interpolation_type: See :meth:`evaluate`.
+            num_threads: See :meth:`evaluate`.
+            sort_by_time: See :meth:`evaluate`.
+            sort_by_cell: See :meth:`evaluate`.
+        """
+        epoch = time.astype("M8[us]", copy=False).view("i8")
+        self._handler.evaluate_into(
+            lon,
+            lat,
+            epoch,
+            out_tide,
+            out_tide_lp,
+            out_quality,
+            time_tolerance,
+            interpolation_type,
+            num_threads,
+            sort_by_time,
+            sort_by_cell,
+        )
+
+    def evaluate_stream(  # noqa: PLR0913
+        self,
+        chunks: Iterable[tuple[VectorFloat64, VectorFloat64, VectorDateTime64]],
+        sink: Callable[[int, VectorFloat64, VectorFloat64, VectorInt8], None],
+        *,
+        max_pending: int = 2,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> int:
+        """Evaluate the tide over a stream of chunks of points.
+
+        The chunks are read from ``chunks`` in a dedicated thread and
+        evaluated by :meth:`evaluate` on the thread pool, while the next
+        chunks are read and the results of the previous ones are handed to
+        ``sink`` in another thread: the processors keep working while a
+        granule is read or written. The reading waits when ``max_pending``
+        chunks are waiting to be evaluated, and the evaluation when
+        ``max_pending`` results are waiting to be written, so that the
+        memory used remains bounded. The iterator and the sink run with the
+        GIL held, one at a time.
+
+        Args:
+            chunks: Iterable yielding, for each chunk, a tuple holding the
+                longitudes and latitudes in degrees and the timestamps as
+                numpy.datetime64, e.g. read from the files of a granule.
+            sink: Called with the index of the chunk, in the order of
+                ``chunks``, the ocean tide, the long period tide and the
+                quality flags of its points.
+            max_pending: Maximum number of chunks waiting between two
+                stages of the pipeline.
+            time_tolerance: See :meth:`evaluate`.
+            interpolation_type: See :meth:`evaluate`.
+            num_threads: See :meth:`evaluate`.
+
+        Returns:
+            The number of chunks evaluated.
+
+        .. note::
+
+            If ``chunks`` or ``sink`` raises an exception, the pipeline
+            stops, the chunks pending are dropped and the exception is
+            raised to the caller.
+        """
+
+        def source() -> Iterator[
+            tuple[VectorFloat64, VectorFloat64, numpy.ndarray]
+        ]:
+            for lon, lat, time in chunks:
+                yield (
+                    numpy.asarray(lon, dtype=numpy.float64),
+                    numpy.asarray(lat, dtype=numpy.float64),
+                    numpy.asarray(time).astype("M8[us]").astype("i8"),
+                )
+
+        return self._handler.evaluate_stream(
+            source(),
+            sink,
+            max_pending,
+            time_tolerance,
+            interpolation_type,
+            num_threads,
+        )
+
+    def evaluate_at_time(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: numpy.datetime64,
+        *,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]:
+        """Evaluate tidal constituents at specified locations, at one time.
+
+        The astronomical arguments and nodal corrections are computed once
+        for all the locations.
+
+        Args:
+            lon: Longitudes in degrees, shape [m, 1].
+            lat: Latitudes in degrees, shape [m, 1].
+            time: Timestamp of the evaluation.
+            interpolation_type: Method for constituent inference, see
+                :meth:`evaluate`.
+            num_threads: Number of threads for parallel computation. If 0,
+                uses all the threads of the pool shared by the computations.
+
+        Returns:
+            A tuple containing the ocean tide heights, the long period tide
+            heights and the quality flags, shape [m, 1].
+        """
+        return self._handler.evaluate_at_time(
+            lon,
+            lat,
+            int(numpy.datetime64(time, "us").astype("i8")),
+            interpolation_type,
+            num_threads,
+        )
+
+    def evaluate_grid(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: numpy.datetime64,
+        *,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]:
+        """Evaluate tidal constituents on a grid, at one time.
+
+        Args:
+            lon: Longitudes of the grid in degrees, shape [m].
+            lat: Latitudes of the grid in degrees, shape [n].
+            time: Timestamp of the evaluation.
+            interpolation_type: Method for constituent inference, see
+                :meth:`evaluate`.
+            num_threads: Number of threads for parallel computation. If 0,
+                uses all the threads of the pool shared by the computations.
+
+        Returns:
+            A tuple containing the ocean tide heights, the long period tide
+            heights and the quality flags, shape [m, n].
+        """
+        return self._handler.evaluate_grid(
+            lon,
+            lat,
+            int(numpy.datetime64(time, "us").astype("i8")),
+            interpolation_type,
+            num_threads,
+        )
+
+    def predict_time_series(  # noqa: PLR0913
+        self,
+        lon: float,
+        lat: float,
+        start: numpy.datetime64,
+        step: numpy.timedelta64,
+        size: int,
+        *,
+        interpolation_type: InterpolationType | None = None,
+        refresh_interval: numpy.timedelta64 | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, Quality]:
+        """Predict the tide at a fixed position over a regular time series.
+
+        The constituents are interpolated and inferred once. Between two
+        refresh intervals, the phasors of the constituents are advanced from
+        one sample to the next by a constant rotation instead of evaluating
+        the astronomical arguments at each sample.
+
+        Args:
+            lon: Longitude in degrees.
+            lat: Latitude in degrees.
+            start: Time of the first sample.
+            step: Time step between two samples.
+            size: Number of samples.
+            interpolation_type: Method for constituent inference, see
+                :meth:`evaluate`.
+            refresh_interval: Interval at which the phasors are computed
+                exactly. By default, one day, or three hours if the group
+                modulations are applied.
+            num_threads: Number of threads for parallel computation. If 0,
+                uses all the threads of the pool shared by the computations.
+
+        Returns:
+            A tuple containing the ocean tide heights and the long period
+            tide heights, shape [size], and the quality flag of the position.
+        """
+        return self._handler.predict_time_series(
+            lon,
+            lat,
+            int(numpy.datetime64(start, "us").astype("i8")),
+            int(numpy.timedelta64(step, "us").astype("i8")),
+            size,
+            interpolation_type,
+            None
+            if refresh_interval is None
+            else int(numpy.timedelta64(refresh_interval, "us").astype("i8")),
+            num_threads,
+        )
+
+
+class Ensemble:
+    """Several tidal models evaluated at the same points, in one pass.
+
+    The astronomical arguments and nodal corrections, which do not depend on
+    the model, are computed once for all the models. If the models share the
+    same grid, the cell framing each point and its interpolation weights are
+    also computed once.
+
+    Args:
+        models: The tidal models to evaluate, all of the same type
+            (TidalModelFloat64, TidalModelFloat32, TidalModelFloat16 or
+            TidalModelInt16).
+        group_modulations: If True, applies nodal modulations to grouped
+            constituents. Default is False.
+    """
+
+    def __init__(
+        self,
+        models: list[TidalModel],
+        group_modulations: bool = False,
+    ) -> None:
+        self._handler: (
+            EnsembleFloat32 | EnsembleFloat64 | EnsembleFloat16 | EnsembleInt16
+        )
+        handlers = (
+            (TidalModelFloat32, EnsembleFloat32),
+            (TidalModelFloat64, EnsembleFloat64),
+            (TidalModelFloat16, EnsembleFloat16),
+            (TidalModelInt16, EnsembleInt16),
+        )
+        for model_type, handler in handlers:
+            if models and all(isinstance(item, model_type) for item in models):
+                self._handler = handler(list(models), group_modulations)
+                return
+        raise TypeError(
+            "Models must all be of type TidalModelFloat32, TidalModelFloat64, "
+            "TidalModelFloat16 or TidalModelInt16"
+        )
+
+    @property
+    def tidal_models(self) -> list[TidalModel]:
+        """Return the tidal models of the ensemble."""
+        return self._handler.tidal_models
+
+    @property
+    def shared_axes(self) -> bool:
+        """True if all the models share the same grid."""
+        return self._handler.shared_axes
+
+    @property
+    def argument_mode(self) -> ArgumentMode:
+        """Return how the astronomical arguments are provided within the time
+        tolerance, see :attr:`Perth.argument_mode`."""
+        return self._handler.argument_mode
+
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None:
+        self._handler.argument_mode = value
+
+    def tabulate_nodal_corrections(
+        self,
+        start: numpy.datetime64,
+        end: numpy.datetime64,
+        *,
+        step: float | None = None,
+    ) -> None:
+        """Tabulate the nodal corrections over a time span.
+
+        See :meth:`Perth.tabulate_nodal_corrections`.
+        """
+        self._handler.tabulate_nodal_corrections(
+            int(numpy.datetime64(start, "us").astype("i8")),
+            int(numpy.datetime64(end, "us").astype("i8")),
+            step,
+        )
+
+    def set_delta_time_series(
+        self,
+        time: VectorDateTime64,
+        delta: VectorFloat64,
+    ) -> None:
+        """Use a series of Delta T (TT - UT) instead of the built-in model.
+
+        See :meth:`Perth.set_delta_time_series`.
+        """
+        self._handler.set_delta_time_series(
+            numpy.asarray(time).astype("M8[us]").astype("i8"),
+            numpy.asarray(delta, dtype=numpy.float64),
+        )
+
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorDateTime64,
+        *,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]:
+        """Evaluate the tide of each model at specified locations and times.
+
+        Args:
+            lon: Longitudes in degrees, shape [m, 1].
+            lat: Latitudes in degrees, shape [m, 1].
+            time: Timestamps as numpy.datetime64, shape [m, 1].
+            time_tolerance: See :meth:`Perth.evaluate`.
+            interpolation_type: See :meth:`Perth.evaluate`.
+            num_threads: See :meth:`Perth.evaluate`.
+
+        Returns:
+            A tuple containing the ocean tide heights, the long period tide
+            heights and the quality flags, shape [m, k] where k is the number
+            of models: the j-th column holds the results of the j-th model.
+        """
+        epoch = time.astype("M8[us]").astype("i8")
+        return self._handler.evaluate(
+            lon,
+            lat,
+            epoch,
+            time_tolerance,
+            interpolation_type,
+            num_threads,
+        )
+
+
+class HarmonicAnalysis:
+    """Least-squares harmonic analysis of a time series, consistent with the
+    prediction of :class:`Perth`.
+
+    The samples are fitted by the sum, over the constituents analyzed, of
+    ``f * (Re(H) cos(V + u) + Im(H) sin(V + u))``, with the tidal arguments
+    V and the nodal corrections f, u computed as for the prediction. The
+    complex constituents H estimated can therefore be given, node by node,
+    to the ``add_constituent`` method of a tidal model. The normal equations
+    are formed incrementally: the series can be given by chunks, processed
+    in parallel, and the analyses of disjoint parts of a series can be
+    merged.
+
+    Args:
+        constituents: The constituents to estimate.
+        group_modulations: If True, applies the group modulations to the
+            nodal corrections, as :class:`Perth` does. Default is False.
+        fit_mean: If True, the default, estimates the mean of the samples
+            along with the constituents.
+        time_tolerance: Time tolerance, in days, within which the tidal
+            arguments are extrapolated linearly instead of computed. Default
+            is 0.
+    """
+
+    def __init__(
+        self,
+        constituents: list[Constituent],
+        group_modulations: bool = False,
+        fit_mean: bool = True,
+        time_tolerance: float = 0.0,
+    ) -> None:
+        self._handler = _HarmonicAnalysis(
+            list(constituents),
+            group_modulations,
+            fit_mean,
+            time_tolerance,
+        )
+
+    @property
+    def constituents(self) -> list[Constituent]:
+        """Return the constituents estimated."""
+        return self._handler.constituents
+
+    @property
+    def samples(self) -> int:
+        """Return the number of samples added."""
+        return self._handler.samples
+
+    def accumulate(
+        self,
+        time: VectorDateTime64,
+        values: VectorFloat64,
+        *,
+        num_threads: int = 0,
+    ) -> None:
+        """Add samples of the series to the normal equations.
+
+        Args:
+            time: Timestamps of the samples as numpy.datetime64, shape
+                [m, 1].
+            values: Values of the samples, shape [m, 1]. The NaN values are
+                ignored.
+            num_threads: Number of threads to use. If 0, all the threads of
+                the pool may be used.
+        """
+        self._handler.accumulate(
+            numpy.asarray(time).astype("M8[us]").astype("i8"),
+            numpy.asarray(values, dtype=numpy.float64),
+            num_threads,
+        )
+
+    def merge(self, other: "HarmonicAnalysis") -> None:
+        """Add the normal equations of another analysis of the same
+        constituents, e.g. of another part of the series."""
+        self._handler.merge(other._handler)
+
+    def solve(self) -> HarmonicAnalysisResult:
+        """Solve the normal equations formed.
+
+        Returns:
+            The complex constituents estimated, in the order of
+            :attr:`constituents`, the mean, the root mean square of the
+            residuals and the number of samples used.
+
+        Raises:
+            RuntimeError: If the samples do not determine the constituents,
+                e.g. if the series is too short to separate them.
+        """
+        return self._handler.solve()
+
+    def set_delta_time_series(
+        self,
+        time: VectorDateTime64,
+        delta: VectorFloat64,
+    ) -> None:
+        """Use a series of Delta T (TT - UT) instead of the built-in model,
+        see :meth:`Perth.set_delta_time_series`."""
+        self._handler.set_delta_time_series(
+            numpy.asarray(time).astype("M8[us]").astype("i8"),
+            numpy.asarray(delta, dtype=numpy.float64),
         )
@@ -1,30 +1,41 @@
 import enum
 from typing import Annotated, Iterator, TypeAlias, overload
-from collections.abc import Sequence
+from collections.abc import Callable, Sequence
 from numpy.typing import NDArray
 import numpy
 
 MatrixComplex64: TypeAlias = Annotated[NDArray[numpy.complex64], "[m, n]"]
 MatrixComplex128: TypeAlias = Annotated[NDArray[numpy.complex128], "[m, n]"]
+VectorComplex128: TypeAlias = Annotated[NDArray[numpy.complex128], "[m, 1]"]
+VectorFloat32: TypeAlias = Annotated[NDArray[numpy.float32], "[m, 1]"]
 VectorFloat64: TypeAlias = Annotated[NDArray[numpy.float64], "[m, 1]"]
 VectorInt64: TypeAlias = Annotated[NDArray[numpy.int64], "[m, 1]"]
 VectorInt8: TypeAlias = Annotated[NDArray[numpy.int8], "[m, 1]"]
+MatrixFloat32: TypeAlias = Annotated[NDArray[numpy.float32], "[m, n]"]
+MatrixFloat64: TypeAlias = Annotated[NDArray[numpy.float64], "[m, n]"]
+MatrixInt8: TypeAlias = Annotated[NDArray[numpy.int8], "[m, n]"]
 Vector6Int8: TypeAlias = Annotated[NDArray[numpy.int8], "[6, 1]"]
 Vector7Int8: TypeAlias = Annotated[NDArray[numpy.int8], "[7, 1]"]
 
 def assemble_constituent_table(
     constituents: Sequence[Constituent] | None = None,
 ) -> ConstituentTable: ...
+def get_num_threads() -> int: ...
+def numa_nodes() -> list[list[int]]: ...
+def profiling_enabled() -> bool: ...
+def set_num_threads(num_threads: int, pin_threads: bool = ...) -> None: ...
 def tidal_frequency(doodson_number: Vector6Int8) -> float: ...
 def constituent_to_name(
     constituent: Constituent,
 ) -> str: ...
 
 class Accelerator:
-    def __init__(self, time_tolerance: float, n_constituents: int) -> None: ...
-    def clear(self) -> None: ...
-    @property
-    def values(self) -> list[tuple[Constituent, complex]]: ...
+    def __init__(
+        self,
+        time_tolerance: float,
+        n_constituents: int,
+        cell_cache_size: int = 4,
+    ) -> None: ...
     @property
     def x1(self) -> float: ...
     @property
@@ -150,6 +161,49 @@ class Inference:
         self, constituent_table: ConstituentTable, lat: float = ...
     ) -> None: ...
 
+class AsyncEvaluation:
+    def result(self) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+
+class EvaluationStats:
+    @property
+    def points(self) -> int: ...
+    @property
+    def quality(self) -> list[int]: ...
+    @property
+    def cell_hits(self) -> int: ...
+    @property
+    def cell_misses(self) -> int: ...
+    @property
+    def argument_updates(self) -> int: ...
+    @property
+    def interpolation_time(self) -> float: ...
+    @property
+    def inference_time(self) -> float: ...
+    @property
+    def arguments_time(self) -> float: ...
+    @property
+    def summation_time(self) -> float: ...
+
+class Approximation:
+    @property
+    def error_bound(self) -> float:
+        """Upper bound of the error of the tides evaluated, in the unit of
+        the model, within the time tolerance selected."""
+    @property
+    def time_tolerance(self) -> float:
+        """Time tolerance, in days, within which the nodal corrections are
+        kept."""
+    @property
+    def dropped(self) -> list[Constituent]: ...
+
+class ArgumentMode(enum.Enum):
+    EXTRAPOLATED = ...
+    FROZEN = ...
+
+class Backend(enum.Enum):
+    BATCHED = ...
+    POINTWISE = ...
+
 class InterpolationType(enum.Enum):
     FOURIER_ADMITTANCE = ...
     LINEAR_ADMITTANCE = ...
@@ -168,7 +222,115 @@ class PerthFloat32:
         time_tolerance: float = 0.0,
         interpolation_type: InterpolationType | None = None,
         num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
     ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat32,
+        lat: VectorFloat32,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_async(
+        self,
+        callback: Callable[[AsyncEvaluation], None],
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_stream(
+        self,
+        chunks: Iterator[tuple[VectorFloat64, VectorFloat64, VectorInt64]],
+        sink: Callable[[int, VectorFloat64, VectorFloat64, VectorInt8], None],
+        max_pending: int = 2,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> int: ...
+    def evaluate_at_time(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    def evaluate_grid(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def predict_time_series(
+        self,
+        lon: float,
+        lat: float,
+        start: int,
+        step: int,
+        size: int,
+        interpolation_type: InterpolationType | None = None,
+        refresh_interval: int | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, Quality]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def last_stats(self) -> EvaluationStats: ...
+    @property
+    def backend(self) -> Backend: ...
+    @backend.setter
+    def backend(self, value: Backend) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def error_budget(self) -> float: ...
+    @error_budget.setter
+    def error_budget(self, value: float) -> None: ...
+    def approximation(
+        self, interpolation_type: InterpolationType | None = ...
+    ) -> Approximation: ...
     @property
     def tidal_model(self) -> TidalModelFloat32: ...
 
@@ -186,10 +348,510 @@ class PerthFloat64:
         time_tolerance: float = 0.0,
         interpolation_type: InterpolationType | None = None,
         num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
     ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat32,
+        lat: VectorFloat32,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_async(
+        self,
+        callback: Callable[[AsyncEvaluation], None],
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_stream(
+        self,
+        chunks: Iterator[tuple[VectorFloat64, VectorFloat64, VectorInt64]],
+        sink: Callable[[int, VectorFloat64, VectorFloat64, VectorInt8], None],
+        max_pending: int = 2,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> int: ...
+    def evaluate_at_time(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    def evaluate_grid(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def predict_time_series(
+        self,
+        lon: float,
+        lat: float,
+        start: int,
+        step: int,
+        size: int,
+        interpolation_type: InterpolationType | None = None,
+        refresh_interval: int | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, Quality]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def last_stats(self) -> EvaluationStats: ...
+    @property
+    def backend(self) -> Backend: ...
+    @backend.setter
+    def backend(self, value: Backend) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def error_budget(self) -> float: ...
+    @error_budget.setter
+    def error_budget(self, value: float) -> None: ...
+    def approximation(
+        self, interpolation_type: InterpolationType | None = ...
+    ) -> Approximation: ...
     @property
     def tidal_model(self) -> TidalModelFloat64: ...
 
+class PerthFloat16:
+    def __init__(
+        self,
+        model: TidalModelFloat16,
+        group_modulations: bool,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat32,
+        lat: VectorFloat32,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_async(
+        self,
+        callback: Callable[[AsyncEvaluation], None],
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_stream(
+        self,
+        chunks: Iterator[tuple[VectorFloat64, VectorFloat64, VectorInt64]],
+        sink: Callable[[int, VectorFloat64, VectorFloat64, VectorInt8], None],
+        max_pending: int = 2,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> int: ...
+    def evaluate_at_time(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    def evaluate_grid(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def predict_time_series(
+        self,
+        lon: float,
+        lat: float,
+        start: int,
+        step: int,
+        size: int,
+        interpolation_type: InterpolationType | None = None,
+        refresh_interval: int | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, Quality]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def last_stats(self) -> EvaluationStats: ...
+    @property
+    def backend(self) -> Backend: ...
+    @backend.setter
+    def backend(self, value: Backend) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def error_budget(self) -> float: ...
+    @error_budget.setter
+    def error_budget(self, value: float) -> None: ...
+    def approximation(
+        self, interpolation_type: InterpolationType | None = ...
+    ) -> Approximation: ...
+    @property
+    def tidal_model(self) -> TidalModelFloat16: ...
+
+class PerthInt16:
+    def __init__(
+        self,
+        model: TidalModelInt16,
+        group_modulations: bool,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    @overload
+    def evaluate_into(
+        self,
+        lon: VectorFloat32,
+        lat: VectorFloat32,
+        time: VectorInt64,
+        tide: VectorFloat64,
+        tide_lp: VectorFloat64,
+        quality: VectorInt8,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_async(
+        self,
+        callback: Callable[[AsyncEvaluation], None],
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+        sort_by_time: bool = False,
+        sort_by_cell: bool = False,
+    ) -> None: ...
+    def evaluate_stream(
+        self,
+        chunks: Iterator[tuple[VectorFloat64, VectorFloat64, VectorInt64]],
+        sink: Callable[[int, VectorFloat64, VectorFloat64, VectorInt8], None],
+        max_pending: int = 2,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> int: ...
+    def evaluate_at_time(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, VectorInt8]: ...
+    def evaluate_grid(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: int,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def predict_time_series(
+        self,
+        lon: float,
+        lat: float,
+        start: int,
+        step: int,
+        size: int,
+        interpolation_type: InterpolationType | None = None,
+        refresh_interval: int | None = None,
+        num_threads: int = 0,
+    ) -> tuple[VectorFloat64, VectorFloat64, Quality]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def last_stats(self) -> EvaluationStats: ...
+    @property
+    def backend(self) -> Backend: ...
+    @backend.setter
+    def backend(self, value: Backend) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def error_budget(self) -> float: ...
+    @error_budget.setter
+    def error_budget(self, value: float) -> None: ...
+    def approximation(
+        self, interpolation_type: InterpolationType | None = ...
+    ) -> Approximation: ...
+    @property
+    def tidal_model(self) -> TidalModelInt16: ...
+
+class EnsembleFloat32:
+    def __init__(
+        self,
+        models: Sequence[TidalModelFloat32],
+        group_modulations: bool = False,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def shared_axes(self) -> bool: ...
+    @property
+    def tidal_models(self) -> list[TidalModelFloat32]: ...
+
+class EnsembleFloat64:
+    def __init__(
+        self,
+        models: Sequence[TidalModelFloat64],
+        group_modulations: bool = False,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def shared_axes(self) -> bool: ...
+    @property
+    def tidal_models(self) -> list[TidalModelFloat64]: ...
+
+class EnsembleFloat16:
+    def __init__(
+        self,
+        models: Sequence[TidalModelFloat16],
+        group_modulations: bool = False,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def shared_axes(self) -> bool: ...
+    @property
+    def tidal_models(self) -> list[TidalModelFloat16]: ...
+
+class EnsembleInt16:
+    def __init__(
+        self,
+        models: Sequence[TidalModelInt16],
+        group_modulations: bool = False,
+    ) -> None: ...
+    def evaluate(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        time: VectorInt64,
+        time_tolerance: float = 0.0,
+        interpolation_type: InterpolationType | None = None,
+        num_threads: int = 0,
+    ) -> tuple[MatrixFloat64, MatrixFloat64, MatrixInt8]: ...
+    def tabulate_nodal_corrections(
+        self,
+        start: int,
+        end: int,
+        step: float | None = None,
+    ) -> None: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def argument_mode(self) -> ArgumentMode: ...
+    @argument_mode.setter
+    def argument_mode(self, value: ArgumentMode) -> None: ...
+    @property
+    def shared_axes(self) -> bool: ...
+    @property
+    def tidal_models(self) -> list[TidalModelInt16]: ...
+
 class Quality(enum.Enum):
     EXTRAPOLATED_1 = ...
     EXTRAPOLATED_2 = ...
@@ -197,13 +859,135 @@ class Quality(enum.Enum):
     INTERPOLATED = ...
     UNDEFINED = ...
 
+def convert_tidal_model(
+    model: TidalModelFloat32
+    | TidalModelFloat64
+    | TidalModelFloat16
+    | TidalModelInt16,
+    storage: str,
+) -> TidalModelFloat32 | TidalModelFloat64 | TidalModelFloat16 | TidalModelInt16: ...
+def load_model_cache(
+    path: str,
+) -> TidalModelFloat32 | TidalModelFloat64 | TidalModelFloat16 | TidalModelInt16: ...
+@overload
+def save_model_cache(
+    model: TidalModelFloat32, path: str, packed: bool | None = None
+) -> None: ...
+@overload
+def save_model_cache(
+    model: TidalModelFloat64, path: str, packed: bool | None = None
+) -> None: ...
+@overload
+def save_model_cache(
+    model: TidalModelFloat16, path: str, packed: bool | None = None
+) -> None: ...
+@overload
+def save_model_cache(
+    model: TidalModelInt16, path: str, packed: bool | None = None
+) -> None: ...
+@overload
+def share_model(
+    model: TidalModelFloat32, name: str, packed: bool | None = None
+) -> TidalModelFloat32: ...
+@overload
+def share_model(
+    model: TidalModelFloat64, name: str, packed: bool | None = None
+) -> TidalModelFloat64: ...
+@overload
+def share_model(
+    model: TidalModelFloat16, name: str, packed: bool | None = None
+) -> TidalModelFloat16: ...
+@overload
+def share_model(
+    model: TidalModelInt16, name: str, packed: bool | None = None
+) -> TidalModelInt16: ...
+def attach_model(
+    name: str,
+) -> TidalModelFloat32 | TidalModelFloat64 | TidalModelFloat16 | TidalModelInt16: ...
+def remove_shared_memory(name: str) -> bool: ...
 def render_constituent_table(
     table: ConstituentTable,
 ) -> str: ...
 
+class ModelBuilderFloat32:
+    def __init__(
+        self,
+        model: TidalModelFloat32,
+        identifiers: Sequence[Constituent],
+        amplitude_factor: float = 1.0,
+        phase_factor: float = 1.0,
+    ) -> None: ...
+    @property
+    def rows(self) -> int: ...
+    @property
+    def cols(self) -> int: ...
+    @property
+    def identifiers(self) -> list[Constituent]: ...
+    @overload
+    def decode(
+        self,
+        index: int,
+        first_row: int,
+        amplitude: MatrixFloat32,
+        phase: MatrixFloat32,
+    ) -> None: ...
+    @overload
+    def decode(
+        self,
+        index: int,
+        first_row: int,
+        amplitude: MatrixFloat64,
+        phase: MatrixFloat64,
+    ) -> None: ...
+    def build(self) -> TidalModelFloat32: ...
+
+class ModelBuilderFloat64:
+    def __init__(
+        self,
+        model: TidalModelFloat64,
+        identifiers: Sequence[Constituent],
+        amplitude_factor: float = 1.0,
+        phase_factor: float = 1.0,
+    ) -> None: ...
+    @property
+    def rows(self) -> int: ...
+    @property
+    def cols(self) -> int: ...
+    @property
+    def identifiers(self) -> list[Constituent]: ...
+    @overload
+    def decode(
+        self,
+        index: int,
+        first_row: int,
+        amplitude: MatrixFloat32,
+        phase: MatrixFloat32,
+    ) -> None: ...
+    @overload
+    def decode(
+        self,
+        index: int,
+        first_row: int,
+        amplitude: MatrixFloat64,
+        phase: MatrixFloat64,
+    ) -> None: ...
+    def build(self) -> TidalModelFloat64: ...
+
+class TileLoaderFloat32:
+    def __init__(self) -> None: ...
+    def identifiers(self) -> list[Constituent]: ...
+
+class TileLoaderFloat64:
+    def __init__(self) -> None: ...
+    def identifiers(self) -> list[Constituent]: ...
+
 class TidalModelFloat32:
     def __init__(
-        self, lon: Axis, lat: Axis, row_major: bool = ...
+        self,
+        lon: Axis,
+        lat: Axis,
+        row_major: bool = ...,
+        packed: bool = ...,
     ) -> None: ...
     def accelerator(self, time_tolerance: float) -> Accelerator: ...
     def add_constituent(
@@ -211,6 +995,21 @@ class TidalModelFloat32:
         constituent: Constituent,
         wave: MatrixComplex64,
     ) -> None: ...
+    def bake_inference(
+        self,
+        interpolation_type: InterpolationType,
+        num_threads: int = 0,
+    ) -> list[Constituent]: ...
+    def wrap_constituent(
+        self,
+        constituent: Constituent,
+        wave: MatrixComplex64,
+    ) -> None: ...
+    def wrap_packed(
+        self,
+        constituents: Sequence[Constituent],
+        data: NDArray[numpy.complex64],
+    ) -> None: ...
     def empty(self) -> bool: ...
     def identifiers(self) -> list[Constituent]: ...
     def interpolate(
@@ -220,11 +1019,41 @@ class TidalModelFloat32:
         constituent_table: ConstituentTable,
         acc: Accelerator,
     ) -> Quality: ...
+    def interpolate_many(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        num_threads: int = ...,
+    ) -> tuple[NDArray[numpy.complex128], VectorInt8]: ...
+    def pack(self) -> None: ...
+    @property
+    def packed(self) -> bool: ...
     def size(self) -> int: ...
+    def replicate(self, num_replicas: int = ...) -> None: ...
+    @property
+    def replicas(self) -> int: ...
+    @property
+    def shared_memory(self) -> str: ...
+    @property
+    def tiled(self) -> bool: ...
+    @property
+    def resident_tiles(self) -> int: ...
+    @property
+    def tile_memory_usage(self) -> int: ...
+    def use_tiles(
+        self,
+        loader: TileLoaderFloat32,
+        tile_size: int = ...,
+        memory_budget: int = ...,
+    ) -> None: ...
 
 class TidalModelFloat64:
     def __init__(
-        self, lon: Axis, lat: Axis, row_major: bool = ...
+        self,
+        lon: Axis,
+        lat: Axis,
+        row_major: bool = ...,
+        packed: bool = ...,
     ) -> None: ...
     def accelerator(self, time_tolerance: float) -> Accelerator: ...
     def add_constituent(
@@ -232,6 +1061,127 @@ class TidalModelFloat64:
         constituent: Constituent,
         wave: MatrixComplex128,
     ) -> None: ...
+    def bake_inference(
+        self,
+        interpolation_type: InterpolationType,
+        num_threads: int = 0,
+    ) -> list[Constituent]: ...
+    def wrap_constituent(
+        self,
+        constituent: Constituent,
+        wave: MatrixComplex128,
+    ) -> None: ...
+    def wrap_packed(
+        self,
+        constituents: Sequence[Constituent],
+        data: NDArray[numpy.complex128],
+    ) -> None: ...
+    def empty(self) -> bool: ...
+    def identifiers(self) -> list[Constituent]: ...
+    def interpolate(
+        self,
+        lon: float,
+        lat: float,
+        constituent_table: ConstituentTable,
+        acc: Accelerator,
+    ) -> Quality: ...
+    def interpolate_many(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        num_threads: int = ...,
+    ) -> tuple[NDArray[numpy.complex128], VectorInt8]: ...
+    def pack(self) -> None: ...
+    @property
+    def packed(self) -> bool: ...
+    def size(self) -> int: ...
+    def replicate(self, num_replicas: int = ...) -> None: ...
+    @property
+    def replicas(self) -> int: ...
+    @property
+    def shared_memory(self) -> str: ...
+    @property
+    def tiled(self) -> bool: ...
+    @property
+    def resident_tiles(self) -> int: ...
+    @property
+    def tile_memory_usage(self) -> int: ...
+    def use_tiles(
+        self,
+        loader: TileLoaderFloat64,
+        tile_size: int = ...,
+        memory_budget: int = ...,
+    ) -> None: ...
+
+class TidalModelFloat16:
+    def __init__(
+        self,
+        lon: Axis,
+        lat: Axis,
+        row_major: bool = ...,
+        packed: bool = ...,
+    ) -> None: ...
+    def accelerator(self, time_tolerance: float) -> Accelerator: ...
+    def add_constituent(
+        self,
+        constituent: Constituent,
+        wave: MatrixComplex64,
+    ) -> None: ...
+    def bake_inference(
+        self,
+        interpolation_type: InterpolationType,
+        num_threads: int = 0,
+    ) -> list[Constituent]: ...
+    def empty(self) -> bool: ...
+    def identifiers(self) -> list[Constituent]: ...
+    def interpolate(
+        self,
+        lon: float,
+        lat: float,
+        constituent_table: ConstituentTable,
+        acc: Accelerator,
+    ) -> Quality: ...
+    def interpolate_many(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        num_threads: int = ...,
+    ) -> tuple[NDArray[numpy.complex128], VectorInt8]: ...
+    def pack(self) -> None: ...
+    @property
+    def packed(self) -> bool: ...
+    def size(self) -> int: ...
+    def replicate(self, num_replicas: int = ...) -> None: ...
+    @property
+    def replicas(self) -> int: ...
+    @property
+    def shared_memory(self) -> str: ...
+    @property
+    def tiled(self) -> bool: ...
+    @property
+    def resident_tiles(self) -> int: ...
+    @property
+    def tile_memory_usage(self) -> int: ...
+
+class TidalModelInt16:
+    def __init__(
+        self,
+        lon: Axis,
+        lat: Axis,
+        row_major: bool = ...,
+        packed: bool = ...,
+    ) -> None: ...
+    def accelerator(self, time_tolerance: float) -> Accelerator: ...
+    def add_constituent(
+        self,
+        constituent: Constituent,
+        wave: MatrixComplex64,
+    ) -> None: ...
+    def bake_inference(
+        self,
+        interpolation_type: InterpolationType,
+        num_threads: int = 0,
+    ) -> list[Constituent]: ...
     def empty(self) -> bool: ...
     def identifiers(self) -> list[Constituent]: ...
     def interpolate(
@@ -241,7 +1191,27 @@ class TidalModelFloat64:
         constituent_table: ConstituentTable,
         acc: Accelerator,
     ) -> Quality: ...
+    def interpolate_many(
+        self,
+        lon: VectorFloat64,
+        lat: VectorFloat64,
+        num_threads: int = ...,
+    ) -> tuple[NDArray[numpy.complex128], VectorInt8]: ...
+    def pack(self) -> None: ...
+    @property
+    def packed(self) -> bool: ...
     def size(self) -> int: ...
+    def replicate(self, num_replicas: int = ...) -> None: ...
+    @property
+    def replicas(self) -> int: ...
+    @property
+    def shared_memory(self) -> str: ...
+    @property
+    def tiled(self) -> bool: ...
+    @property
+    def resident_tiles(self) -> int: ...
+    @property
+    def tile_memory_usage(self) -> int: ...
 
 class TideComponent:
     @property
@@ -254,3 +1224,43 @@ class TideComponent:
     def tide(self): ...
     @property
     def type(self) -> ConstituentType: ...
+
+class HarmonicAnalysisResult:
+    @property
+    def constituents(self) -> VectorComplex128: ...
+    @property
+    def mean(self) -> float: ...
+    @property
+    def residual_rms(self) -> float: ...
+    @property
+    def samples(self) -> int: ...
+
+class HarmonicAnalysis:
+    def __init__(
+        self,
+        constituents: Sequence[Constituent],
+        group_modulations: bool = False,
+        fit_mean: bool = True,
+        time_tolerance: float = 0.0,
+    ) -> None: ...
+    def accumulate(
+        self,
+        time: VectorInt64,
+        values: VectorFloat64,
+        num_threads: int = 0,
+    ) -> None: ...
+    def merge(self, other: HarmonicAnalysis) -> None: ...
+    def solve(self) -> HarmonicAnalysisResult: ...
+    def set_delta_time_series(
+        self,
+        time: VectorInt64,
+        delta: VectorFloat64,
+    ) -> None: ...
+    @property
+    def constituents(self) -> list[Constituent]: ...
+    @property
+    def samples(self) -> int: ...
+    @property
+    def normal_matrix(self) -> MatrixFloat64: ...
+    @property
+    def normal_vector(self) -> VectorFloat64: ...
@@ -1,6 +1,9 @@
 from collections.abc import Callable
+import concurrent.futures
 import os
-from typing import NamedTuple
+import secrets
+import threading
+from typing import NamedTuple, TypeAlias
 import netCDF4
 import numpy
 import dataclasses
@@ -8,6 +11,14 @@ import dataclasses
 
 from . import _core
 
+#: Tidal models, whatever the storage of their waves
+TidalModel: TypeAlias = (
+    _core.TidalModelFloat32
+    | _core.TidalModelFloat64
+    | _core.TidalModelFloat16
+    | _core.TidalModelInt16
+)
+
 #: Conversion factors for metric units
 METRIC = {"m": 1.0, "km": 1000.0, "cm": 0.01, "mm": 0.001}
 
@@ -217,7 +228,7 @@ def _create_axis(
 
 
 def _create_tidal_model(
-    metadata: ModelMetadata, dtype: numpy.dtype
+    metadata: ModelMetadata, dtype: numpy.dtype, packed: bool
 ) -> _core.TidalModelFloat32 | _core.TidalModelFloat64:
     """Create the appropriate tidal model based on the data type."""
     x_axis = _create_axis(
@@ -234,12 +245,14 @@ def _create_tidal_model(
             x_axis,
             y_axis,
             row_major=metadata.row_major,
+            packed=packed,
         )
     elif dtype == numpy.float64:
         return _core.TidalModelFloat64(
             x_axis,
             y_axis,
             row_major=metadata.row_major,
+            packed=packed,
         )
     else:
         raise ValueError(
@@ -249,15 +262,19 @@ def _create_tidal_model(
 
 
 def _process_constituent_data(
-    dataset: netCDF4.Dataset, var_names: VariableNames, metadata: ModelMetadata
+    dataset: netCDF4.Dataset,
+    var_names: VariableNames,
+    metadata: ModelMetadata,
+    index: tuple[slice, slice] = (slice(None), slice(None)),
 ) -> numpy.ndarray:
-    """Process amplitude and phase data for a single constituent."""
+    """Process amplitude and phase data for a single constituent, or for the
+    block of its grid selected by index."""
     amp_raw = numpy.ma.filled(
-        dataset.variables[var_names.amplitude][:],
+        dataset.variables[var_names.amplitude][index],
         fill_value=numpy.nan,
     )
     ph_raw = numpy.ma.filled(
-        dataset.variables[var_names.phase][:],
+        dataset.variables[var_names.phase][index],
         fill_value=numpy.nan,
     )
 
@@ -269,6 +286,143 @@ def _process_constituent_data(
     return amp * numpy.cos(ph) + 1j * amp * numpy.sin(ph)
 
 
+#: Number of values of the blocks of amplitudes and phases read at once
+BLOCK_SIZE = 1 << 20
+
+
+def _decode_constituent(
+    builder: _core.ModelBuilderFloat32 | _core.ModelBuilderFloat64,
+    index: int,
+    path: str,
+    var_names: VariableNames,
+    dtype: numpy.dtype,
+    lock: threading.Lock,
+) -> None:
+    """Decode the wave of a constituent, block of rows by block of rows,
+    into the storage of the model."""
+    # The netCDF library is not thread-safe: only the reads are serialized,
+    # the decoding of the blocks read, done without the GIL, overlaps them.
+    with lock:
+        dataset = netCDF4.Dataset(path, "r")
+    try:
+        amp = dataset.variables[var_names.amplitude]
+        ph = dataset.variables[var_names.phase]
+        rows = max(1, BLOCK_SIZE // max(1, builder.cols))
+        for first_row in range(0, builder.rows, rows):
+            index_ = slice(first_row, first_row + rows)
+            with lock:
+                amp_raw = numpy.ma.filled(amp[index_], fill_value=numpy.nan)
+                ph_raw = numpy.ma.filled(ph[index_], fill_value=numpy.nan)
+            builder.decode(
+                index,
+                first_row,
+                numpy.ascontiguousarray(amp_raw, dtype=dtype),
+                numpy.ascontiguousarray(ph_raw, dtype=dtype),
+            )
+    finally:
+        with lock:
+            dataset.close()
+
+
+def _load_waves(
+    model: _core.TidalModelFloat32 | _core.TidalModelFloat64,
+    files: dict[_core.Constituent, str],
+    var_names: VariableNames,
+    metadata: ModelMetadata,
+) -> None:
+    """Load the waves of the constituents into an empty model, one thread
+    per constituent."""
+    if isinstance(model, _core.TidalModelFloat32):
+        builder_type = _core.ModelBuilderFloat32
+        dtype = numpy.dtype(numpy.float32)
+    else:
+        builder_type = _core.ModelBuilderFloat64
+        dtype = numpy.dtype(numpy.float64)
+    # The conversions of units are linear: they reduce to factors.
+    builder = builder_type(
+        model,
+        list(files),
+        float(_convert_to_meters(numpy.float64(1), metadata.amplitude_units)),
+        float(_convert_to_radians(numpy.float64(1), metadata.phase_units)),
+    )
+    lock = threading.Lock()
+    num_threads = max(1, min(len(files), _core.get_num_threads()))
+    with concurrent.futures.ThreadPoolExecutor(num_threads) as executor:
+        futures = [
+            executor.submit(
+                _decode_constituent,
+                builder,
+                index,
+                path,
+                var_names,
+                dtype,
+                lock,
+            )
+            for index, path in enumerate(files.values())
+        ]
+        for future in futures:
+            future.result()
+    builder.build()
+
+
+class _NetCDFTiles:
+    """Read the tiles of a tidal model from its netCDF files."""
+
+    def __init__(
+        self,
+        files: dict[_core.Constituent, str],
+        var_names: VariableNames,
+        metadata: ModelMetadata,
+        complex_dtype: numpy.dtype,
+    ) -> None:
+        self.files = dict(files)
+        self.var_names = var_names
+        self.metadata = metadata
+        self.complex_dtype = complex_dtype
+
+    def identifiers(self) -> list[_core.Constituent]:
+        """Get the constituents read, in the order of the values of a
+        node."""
+        return list(self.files)
+
+    def read(self, i0: int, nx: int, j0: int, ny: int) -> numpy.ndarray:
+        """Read the waves of the nodes [i0, i0 + nx) x [j0, j0 + ny)."""
+        x_index = slice(i0, i0 + nx)
+        y_index = slice(j0, j0 + ny)
+        row_major = self.metadata.row_major
+        tile = numpy.empty((nx, ny, len(self.files)), dtype=self.complex_dtype)
+        for ix, path in enumerate(self.files.values()):
+            with netCDF4.Dataset(path, "r") as dataset:
+                wave = _process_constituent_data(
+                    dataset,
+                    self.var_names,
+                    self.metadata,
+                    (x_index, y_index) if row_major else (y_index, x_index),
+                )
+            tile[:, :, ix] = wave if row_major else wave.T
+        return tile
+
+
+def _create_tile_loader(
+    tiles: _NetCDFTiles,
+) -> _core.TileLoaderFloat32 | _core.TileLoaderFloat64:
+    """Create the loader reading the tiles of a model in the C++ library."""
+    base = (
+        _core.TileLoaderFloat32
+        if tiles.complex_dtype == numpy.complex64
+        else _core.TileLoaderFloat64
+    )
+
+    class NetCDFTileLoader(base):  # type: ignore[valid-type,misc]
+        def identifiers(self) -> list[_core.Constituent]:
+            return tiles.identifiers()
+
+        def read(self, i0: int, nx: int, j0: int, ny: int) -> numpy.ndarray:
+            return tiles.read(i0, nx, j0, ny)
+
+    return NetCDFTileLoader()
+
+
 def load_model(
     files: dict[_core.Constituent, str],
     *,
@@ -276,7 +430,11 @@ def load_model(
     longitude: str | None = None,
     amplitude: str | None = None,
     phase: str | None = None,
-) -> _core.TidalModelFloat32 | _core.TidalModelFloat64:
+    packed: bool = False,
+    storage: str | None = None,
+    tile_size: int | None = None,
+    memory_budget: int | None = None,
+) -> TidalModel:
     """
     Load a tidal model from netCDF files.
 
@@ -286,16 +444,36 @@ def load_model(
         longitude: Name of longitude variable (default: 'longitude')
         amplitude: Name of amplitude variable (default: 'amplitude')
         phase: Name of phase variable (default: 'phase')
+        packed: If True, the constituents are stored interleaved by grid
+            node, which speeds up the interpolation of models with many
+            constituents (default: False)
+        storage: Type used to store the waves: 'float64', 'float32',
+            'float16' or 'int16'. The 16-bit types halve the memory used by
+            a float32 model, for a resolution of about 0.1 mm. By default,
+            the precision of the data is used.
+        tile_size: If set, the waves are not loaded: they are read from the
+            files by tiles of tile_size x tile_size nodes, the first time a
+            point falls in them. Only the tiles covering the region
+            processed are then read.
+        memory_budget: Maximum memory used by the tiles of a tiled model, in
+            bytes. Beyond, the least recently used tiles are released. By
+            default, the tiles read are kept.
 
     Returns:
-        Tidal model instance (Float32 or Float64 based on data precision)
+        Tidal model instance (Float32 or Float64 based on data precision,
+        unless another storage is requested)
 
     Raises:
-        ValueError: If no files provided or unsupported data type
+        ValueError: If no files provided, unsupported data type, or if a
+            storage is requested for a tiled model
         RuntimeError: If datasets are inconsistent
     """
     if len(files) == 0:
         raise ValueError("No files provided for loading the model.")
+    if tile_size is not None and storage is not None:
+        raise ValueError("The storage of a tiled model cannot be changed.")
+    if tile_size is None and memory_budget is not None:
+        raise ValueError("A memory budget requires a tile size.")
 
     var_names = VariableNames(
         latitude=latitude or "latitude",
@@ -348,20 +526,131 @@ def load_model(
     assert metadata is not None
     assert dtype is not None
 
+    complex_dtype = numpy.result_type(dtype, numpy.complex64)
+
     # Create the tidal model
     model = _create_tidal_model(
         metadata,
         dtype,
+        packed or tile_size is not None,
     )
 
-    # Second pass: load and add constituent data
-    for constituent, path in files.items():
-        with netCDF4.Dataset(path, "r") as dataset:
-            wave = _process_constituent_data(
-                dataset,
-                var_names,
-                metadata,
-            )
-            model.add_constituent(constituent, wave)
+    # The waves of a tiled model are read from the files on demand.
+    if tile_size is not None:
+        model.use_tiles(
+            _create_tile_loader(
+                _NetCDFTiles(files, var_names, metadata, complex_dtype)
+            ),
+            tile_size,
+            memory_budget or 0,
+        )
+        return model
 
+    # Second pass: decode the waves, in parallel and by blocks, directly
+    # into the storage of the model.
+    _load_waves(model, files, var_names, metadata)
+    if storage is not None:
+        return _core.convert_tidal_model(model, storage)
     return model
+
+
+def save_model_cache(
+    model: TidalModel,
+    path: str | os.PathLike[str],
+    *,
+    packed: bool | None = None,
+) -> None:
+    """
+    Save a tidal model in the native binary cache format.
+
+    The cache holds the axes, the constituents and their waves, aligned so
+    that :func:`load_model_cache` can use them in place.
+
+    Args:
+        model: Tidal model to save
+        path: Path to the cache file
+        packed: If True, the constituents are stored interleaved by grid
+            node; if False, one grid per constituent. By default, the layout
+            of the model is used.
+    """
+    _core.save_model_cache(model, os.fspath(path), packed)
+
+
+def load_model_cache(
+    path: str | os.PathLike[str],
+) -> TidalModel:
+    """
+    Load a tidal model written by :func:`save_model_cache`.
+
+    The file is memory-mapped: loading takes a few milliseconds whatever the
+    size of the model, and the pages of the file are shared by all the
+    processes using the same cache.
+
+    Args:
+        path: Path to the cache file
+
+    Returns:
+        Tidal model instance, of the storage type saved
+
+    Raises:
+        RuntimeError: If the file is not a valid model cache
+    """
+    return _core.load_model_cache(os.fspath(path))
+
+
+def share_model(
+    model: TidalModel,
+    name: str | None = None,
+    *,
+    packed: bool | None = None,
+) -> TidalModel:
+    """
+    Place the waves of a tidal model in a segment of POSIX shared memory.
+
+    The waves are copied once into the segment, in the format of
+    :func:`save_model_cache`, and the model returned uses them in place.
+    Pickling this model, e.g. to send it to the workers of a
+    ``multiprocessing`` pool or of a Dask cluster running on the same
+    machine, only sends the name of the segment: the workers attach it with
+    :func:`attach_model` and all share one physical copy of the waves.
+
+    The segment is removed from the system once the model returned, and its
+    copies, are released by this process: keep it alive as long as workers
+    may attach it. The workers already attached keep their mapping.
+
+    Args:
+        model: Tidal model to share
+        name: Name of the segment. By default, a unique name is generated.
+        packed: If True, the constituents are stored interleaved by grid
+            node; if False, one grid per constituent. By default, the layout
+            of the model is used.
+
+    Returns:
+        Tidal model using the waves of the segment
+
+    Raises:
+        RuntimeError: If the segment cannot be created, e.g. if the name is
+            taken
+    """
+    if name is None:
+        name = f"perth-{os.getpid()}-{secrets.token_hex(8)}"
+    return _core.share_model(model, name, packed)
+
+
+def attach_model(name: str) -> TidalModel:
+    """
+    Build a tidal model from a segment created by :func:`share_model`.
+
+    The segment is mapped read-only and the waves are used in place, without
+    copy.
+
+    Args:
+        name: Name of the segment, see ``TidalModel.shared_memory``
+
+    Returns:
+        Tidal model instance, of the storage type shared
+
+    Raises:
+        RuntimeError: If the segment does not exist or does not hold a model
+    """
+    return _core.attach_model(name)
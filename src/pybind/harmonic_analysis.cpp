@@ -0,0 +1,57 @@
+#include "harmonic_analysis.hpp"
+
+#include <nanobind/eigen/dense.h>
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/complex.h>
+#include <nanobind/stl/vector.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/harmonic_analysis.hpp"
+
+namespace nb = nanobind;
+
+auto instantiate_harmonic_analysis(nanobind::module_& m) -> void {
+  nb::class_<perth::HarmonicAnalysisResult>(m, "HarmonicAnalysisResult",
+                                            "Result of a harmonic analysis")
+      .def_ro("constituents", &perth::HarmonicAnalysisResult::constituents,
+              "Complex constituents estimated, in the order of the "
+              "constituents analyzed")
+      .def_ro("mean", &perth::HarmonicAnalysisResult::mean,
+              "Mean of the samples not explained by the constituents")
+      .def_ro("residual_rms", &perth::HarmonicAnalysisResult::residual_rms,
+              "Root mean square of the residuals of the fit")
+      .def_ro("samples", &perth::HarmonicAnalysisResult::samples,
+              "Number of samples used");
+
+  nb::class_<perth::HarmonicAnalysis>(m, "HarmonicAnalysis")
+      .def(nb::init<std::vector<perth::Constituent>, bool, bool, double>(),
+           nb::arg("constituents"), nb::arg("group_modulations") = false,
+           nb::arg("fit_mean") = true, nb::arg("time_tolerance") = 0.0,
+           "Prepare the least-squares harmonic analysis of a series")
+      .def("accumulate", &perth::HarmonicAnalysis::accumulate,
+           nb::arg("time"), nb::arg("values"), nb::arg("num_threads") = 0,
+           "Add samples, at times given in microseconds since the epoch, to "
+           "the normal equations",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("merge", &perth::HarmonicAnalysis::merge, nb::arg("other"),
+           "Add the normal equations of another analysis")
+      .def("solve", &perth::HarmonicAnalysis::solve,
+           "Solve the normal equations formed",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("set_delta_time_series",
+           &perth::HarmonicAnalysis::set_delta_time_series, nb::arg("time"),
+           nb::arg("delta"),
+           "Use a series of Delta T (TT - UT), in seconds, at times given in "
+           "microseconds since the epoch, instead of the model")
+      .def_prop_ro("constituents", &perth::HarmonicAnalysis::constituents,
+                   "Constituents estimated")
+      .def_prop_ro("samples", &perth::HarmonicAnalysis::samples,
+                   "Number of samples added")
+      .def_prop_ro("normal_matrix", &perth::HarmonicAnalysis::normal_matrix,
+                   "Normal matrix formed, whose lower triangle is set")
+      .def_prop_ro("normal_vector", &perth::HarmonicAnalysis::normal_vector,
+                   "Right-hand side of the normal equations");
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+
+auto instantiate_harmonic_analysis(nanobind::module_ &m) -> void;
@@ -2,14 +2,22 @@
 
 #include "axis.hpp"
 #include "constituent.hpp"
+#include "harmonic_analysis.hpp"
 #include "inference.hpp"
+#include "model_builder.hpp"
+#include "model_cache.hpp"
+#include "thread_pool.hpp"
 #include "tidal_model.hpp"
 #include "tide.hpp"
 
 NB_MODULE(_core, m) {
   instantiate_axis(m);
   instantiate_constituent(m);
+  instantiate_harmonic_analysis(m);
   instantiate_inference(m);
+  instantiate_model_builder(m);
+  instantiate_model_cache(m);
+  instantiate_thread_pool(m);
   instantiate_tidal_model(m);
   instantiate_tide(m);
 }
@@ -0,0 +1,58 @@
+#include "model_builder.hpp"
+
+#include <nanobind/eigen/dense.h>
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/vector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/model_builder.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace nb = nanobind;
+
+/// Block of amplitudes or phases read from the files of a model.
+template <typename U>
+using Block = Eigen::Ref<const Eigen::Matrix<U, -1, -1, Eigen::RowMajor>>;
+
+template <typename T>
+auto bind_model_builder(nanobind::module_& m, const char* name) -> void {
+  nb::class_<perth::ModelBuilder<T>>(m, name)
+      .def(nb::init<std::shared_ptr<perth::TidalModel<T>>,
+                    std::vector<perth::Constituent>, double, double>(),
+           nb::arg("model"), nb::arg("identifiers"),
+           nb::arg("amplitude_factor") = 1.0, nb::arg("phase_factor") = 1.0,
+           "Prepare the loading of the waves of an empty tidal model from "
+           "the amplitudes and phases of its constituents")
+      .def_prop_ro("rows", &perth::ModelBuilder<T>::rows,
+                   "Number of rows of the grids of the waves")
+      .def_prop_ro("cols", &perth::ModelBuilder<T>::cols,
+                   "Number of columns of the grids of the waves")
+      .def_prop_ro("identifiers", &perth::ModelBuilder<T>::identifiers,
+                   "Constituents loaded")
+      .def("decode", &perth::ModelBuilder<T>::template decode<float>,
+           nb::arg("index"), nb::arg("first_row"),
+           nb::arg("amplitude").noconvert(), nb::arg("phase").noconvert(),
+           "Decode a block of rows of the wave of a constituent into the "
+           "storage of the model",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("decode", &perth::ModelBuilder<T>::template decode<double>,
+           nb::arg("index"), nb::arg("first_row"), nb::arg("amplitude"),
+           nb::arg("phase"),
+           "Decode a block of rows of the wave of a constituent into the "
+           "storage of the model",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("build", &perth::ModelBuilder<T>::build,
+           "Hand the waves decoded to the model and return it",
+           nb::call_guard<nb::gil_scoped_release>());
+}
+
+auto instantiate_model_builder(nanobind::module_& m) -> void {
+  bind_model_builder<float>(m, "ModelBuilderFloat32");
+  bind_model_builder<double>(m, "ModelBuilderFloat64");
+}
@@ -0,0 +1,116 @@
+#include "model_cache.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/string.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "perth/mapped_file.hpp"
+#include "perth/model_cache.hpp"
+#include "perth/shared_memory.hpp"
+#include "perth/storage.hpp"
+
+namespace nb = nanobind;
+
+template <typename T>
+auto bind_save_model_cache(nanobind::module_& m) -> void {
+  m.def(
+      "save_model_cache",
+      [](const perth::TidalModel<T>& model, const std::string& path,
+         const std::optional<bool>& packed) -> void {
+        perth::save_model_cache(model, path, packed);
+      },
+      nb::arg("model"), nb::arg("path"), nb::arg("packed") = nb::none(),
+      "Save a tidal model in the binary model cache format",
+      nb::call_guard<nb::gil_scoped_release>());
+}
+
+template <typename T>
+auto bind_share_model(nanobind::module_& m) -> void {
+  m.def(
+      "share_model",
+      [](const perth::TidalModel<T>& model, const std::string& name,
+         const std::optional<bool>& packed)
+          -> std::shared_ptr<perth::TidalModel<T>> {
+        return perth::share_model(model, name, packed);
+      },
+      nb::arg("model"), nb::arg("name"), nb::arg("packed") = nb::none(),
+      "Copy the waves of a tidal model into a new segment of shared memory "
+      "and return the model using them in place",
+      nb::call_guard<nb::gil_scoped_release>());
+}
+
+/// Attach a segment of shared memory storing values of type T.
+template <typename T>
+auto attach(std::shared_ptr<const perth::SharedMemory> segment)
+    -> nb::object {
+  return nb::cast(perth::attach_model<T>(std::move(segment)));
+}
+
+/// Load a model cache storing values of type T.
+template <typename T>
+auto load(const std::string& path) -> nb::object {
+  auto model = std::shared_ptr<perth::TidalModel<T>>{};
+  {
+    nb::gil_scoped_release release;
+    model = perth::load_model_cache<T>(path);
+  }
+  return nb::cast(std::move(model));
+}
+
+auto instantiate_model_cache(nanobind::module_& m) -> void {
+  bind_save_model_cache<float>(m);
+  bind_save_model_cache<double>(m);
+  bind_save_model_cache<perth::Float16>(m);
+  bind_save_model_cache<perth::Int16>(m);
+  m.def(
+      "load_model_cache",
+      [](const std::string& path) -> nb::object {
+        const auto header =
+            perth::read_model_cache_header(perth::MappedFile(path));
+        switch (header.value_size) {
+          case sizeof(float):
+            return load<float>(path);
+          case sizeof(double):
+            return load<double>(path);
+          default:
+            return header.scaled != 0 ? load<perth::Int16>(path)
+                                      : load<perth::Float16>(path);
+        }
+      },
+      nb::arg("path"),
+      "Load a tidal model from a binary model cache, memory-mapping the file");
+  bind_share_model<float>(m);
+  bind_share_model<double>(m);
+  bind_share_model<perth::Float16>(m);
+  bind_share_model<perth::Int16>(m);
+  m.def(
+      "attach_model",
+      [](const std::string& name) -> nb::object {
+        auto segment = std::make_shared<const perth::SharedMemory>(name);
+        const auto header =
+            perth::read_model_cache_header(segment->data(), segment->size());
+        switch (header.value_size) {
+          case sizeof(float):
+            return attach<float>(std::move(segment));
+          case sizeof(double):
+            return attach<double>(std::move(segment));
+          default:
+            return header.scaled != 0
+                       ? attach<perth::Int16>(std::move(segment))
+                       : attach<perth::Float16>(std::move(segment));
+        }
+      },
+      nb::arg("name"),
+      "Build a tidal model from the waves of a segment of shared memory "
+      "created by share_model(), without copying them");
+  m.def("remove_shared_memory", &perth::SharedMemory::remove,
+        nb::arg("name"),
+        "Remove a segment of shared memory, e.g. left behind by a process "
+        "that crashed. Returns True if the segment existed.");
+}
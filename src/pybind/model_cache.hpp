@@ -0,0 +1,5 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+
+auto instantiate_model_cache(nanobind::module_ &m) -> void;
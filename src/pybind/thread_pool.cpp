@@ -0,0 +1,26 @@
+#include "thread_pool.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/vector.h>
+
+#include "perth/numa.hpp"
+#include "perth/thread_pool.hpp"
+
+namespace nb = nanobind;
+
+auto instantiate_thread_pool(nanobind::module_& m) -> void {
+  m.def("set_num_threads", &perth::ThreadPool::set_num_threads,
+        nb::arg("num_threads"), nb::arg("pin_threads") = false,
+        "Set the number of threads used by the thread pool shared by all "
+        "computations, including the calling thread. If 0, all CPUs are used. "
+        "If pin_threads is True, the threads are pinned to the NUMA nodes of "
+        "the machine, spread evenly over them.",
+        nb::call_guard<nb::gil_scoped_release>());
+  m.def(
+      "numa_nodes",
+      []() -> std::vector<std::vector<size_t>> { return perth::numa_nodes(); },
+      "Get the CPUs of each NUMA node of the machine.");
+  m.def("get_num_threads", &perth::ThreadPool::num_threads,
+        "Get the number of threads used by the thread pool shared by all "
+        "computations, including the calling thread.");
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+
+auto instantiate_thread_pool(nanobind::module_ &m) -> void;
@@ -1,30 +1,118 @@
 #include "tidal_model.hpp"
 
 #include <nanobind/eigen/dense.h>
+#include <nanobind/ndarray.h>
 #include <nanobind/stl/complex.h>
 #include <nanobind/stl/pair.h>
 #include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/string.h>
 #include <nanobind/stl/unique_ptr.h>
 #include <nanobind/stl/vector.h>
+#include <nanobind/trampoline.h>
+
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "nanobind/nanobind.h"
 #include "perth/axis.hpp"
 #include "perth/constituent.hpp"
+#include "perth/inference.hpp"
+#include "perth/storage.hpp"
 #include "perth/tidal_model.hpp"
+#include "perth/tiles.hpp"
 
 namespace nb = nanobind;
 
+/// Read-only array of complex values shared with NumPy.
+template <typename T>
+using SharedArray =
+    nb::ndarray<const std::complex<T>, nb::c_contig, nb::device::cpu>;
+
+/// Wave given to add_constituent.
+template <typename T>
+using Wave =
+    Eigen::Matrix<typename perth::TidalModel<T>::input_type, -1, -1,
+                  Eigen::RowMajor>;
+
+template <typename T>
+auto bind_shared_waves(nb::class_<perth::TidalModel<T>>& cls) -> void;
+
+/// Tile loader implemented in Python: the subclasses define the methods
+/// `identifiers()`, returning the constituents provided, and
+/// `read(i0, nx, j0, ny)`, returning the values of the block of nodes as an
+/// array of shape (nx, ny, len(identifiers())).
+template <typename T>
+class PyTileLoader : public perth::TileLoader<T> {
+ public:
+  NB_TRAMPOLINE(perth::TileLoader<T>, 2);
+
+  [[nodiscard]] auto identifiers() const
+      -> std::vector<perth::Constituent> override {
+    NB_OVERRIDE_PURE(identifiers);
+  }
+
+  auto read(const int64_t i0, const int64_t nx, const int64_t j0,
+            const int64_t ny,
+            typename perth::TileLoader<T>::value_type* values) const
+      -> void override {
+    // Called by the threads interpolating the model, which do not hold the
+    // GIL.
+    nb::gil_scoped_acquire acquire;
+    auto n_constituents = identifiers().size();
+    auto tile = nb::cast<SharedArray<T>>(
+        nb_trampoline.base().attr("read")(i0, nx, j0, ny));
+    if (tile.ndim() != 3 || tile.shape(0) != static_cast<size_t>(nx) ||
+        tile.shape(1) != static_cast<size_t>(ny) ||
+        tile.shape(2) != n_constituents) {
+      throw std::invalid_argument(
+          "The tile read does not match the block requested: expected (" +
+          std::to_string(nx) + "x" + std::to_string(ny) + "x" +
+          std::to_string(n_constituents) + ")");
+    }
+    std::copy(tile.data(), tile.data() + tile.size(), values);
+  }
+};
+
+template <typename T>
+auto bind_tile_loader(nanobind::module_& m, const char* name) -> void {
+  nb::class_<perth::TileLoader<T>, PyTileLoader<T>>(
+      m, name,
+      "Source of the waves of a tiled model. Subclasses define "
+      "identifiers(), returning the constituents provided, and read(i0, nx, "
+      "j0, ny), returning the values of the nodes [i0, i0 + nx) x [j0, j0 + "
+      "ny) as an array of shape (nx, ny, len(identifiers())).")
+      .def(nb::init<>())
+      .def("identifiers", &perth::TileLoader<T>::identifiers,
+           "Get the constituents provided, in the order of the values of a "
+           "node");
+}
+
 template <typename T>
 auto bind_tidal_model(nanobind::module_& m, const char* name) -> void {
-  nb::class_<perth::TidalModel<T>>(m, name)
-      .def(nb::init<perth::Axis, perth::Axis, bool>(), nb::arg("lon"),
-           nb::arg("lat"), nb::arg("row_major") = true,
-           "Initialize a tidal model with longitude and latitude axes")
-      .def("add_constituent", &perth::TidalModel<T>::add_constituent,
-           nb::arg("constituent"), nb::arg("wave"),
-           "Add a tidal constituent with its corresponding wave data")
+  auto cls = nb::class_<perth::TidalModel<T>>(m, name);
+  cls.def(nb::init<perth::Axis, perth::Axis, bool, bool>(), nb::arg("lon"),
+          nb::arg("lat"), nb::arg("row_major") = true,
+          nb::arg("packed") = false,
+          "Initialize a tidal model with longitude and latitude axes")
+      .def(
+          "add_constituent",
+          [](perth::TidalModel<T>& self, const perth::Constituent constituent,
+             const Eigen::Ref<const Wave<T>>& wave) -> void {
+            self.add_constituent(constituent, wave);
+          },
+          nb::arg("constituent"), nb::arg("wave"),
+          "Add a tidal constituent with its corresponding wave data")
+      .def("pack", &perth::TidalModel<T>::pack,
+           "Interleave the constituents added since the last call into the "
+           "packed storage")
+      .def_prop_ro("packed", &perth::TidalModel<T>::packed,
+                   "True if the constituents are interleaved by grid node")
       .def(
           "interpolate",
           [](const perth::TidalModel<T>& self, const double lon,
@@ -39,6 +127,18 @@ auto bind_tidal_model(nanobind::module_& m, const char* name) -> void {
           },
           nb::arg("lon"), nb::arg("lat"), nb::arg("table"), nb::arg("acc"),
           "Interpolate tidal values into a tide table")
+      .def("interpolate_many", &perth::TidalModel<T>::interpolate_many,
+           nb::arg("lon"), nb::arg("lat"), nb::arg("num_threads") = 0,
+           "Interpolate the constituents at a set of points. Returns an array "
+           "of shape (len(lon), size()), one row per point in the order of "
+           "identifiers(), NaN where undefined, and the quality of each "
+           "point.",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("bake_inference", &perth::TidalModel<T>::bake_inference,
+           nb::arg("interpolation_type"), nb::arg("num_threads") = 0,
+           "Evaluate the inference at every grid node and store the inferred "
+           "constituents in the model. Returns the constituents added.",
+           nb::call_guard<nb::gil_scoped_release>())
       .def("empty", &perth::TidalModel<T>::empty,
            "Check if the model contains any constituents")
       .def("size", &perth::TidalModel<T>::size,
@@ -47,7 +147,144 @@ auto bind_tidal_model(nanobind::module_& m, const char* name) -> void {
            "Get the list of constituent identifiers")
       .def("accelerator", &perth::TidalModel<T>::accelerator,
            nb::arg("time_tolerance"),
-           "Create an accelerator for efficient repeated interpolations");
+           "Create an accelerator for efficient repeated interpolations")
+      .def("replicate", &perth::TidalModel<T>::replicate,
+           nb::arg("num_replicas") = 0,
+           "Keep a copy of the waves on each NUMA node of the machine, read by "
+           "the threads running on this node. If num_replicas is 0, one copy "
+           "per node, none if the machine has a single node.",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def_prop_ro("replicas", &perth::TidalModel<T>::replicas,
+                   "Number of copies of the waves, see replicate()")
+      .def_prop_ro("shared_memory", &perth::TidalModel<T>::shared_memory,
+                   "Name of the segment of shared memory holding the waves, "
+                   "or an empty string if they are not shared")
+      .def(
+          "__reduce__",
+          [](const perth::TidalModel<T>& self) -> nb::tuple {
+            // Only the name of the segment is sent: the process unpickling
+            // the model attaches the same waves.
+            if (self.shared_memory().empty()) {
+              throw nb::type_error(
+                  "Only a model placed in shared memory with share_model() "
+                  "can be pickled");
+            }
+            return nb::make_tuple(
+                nb::module_::import_("perth._core").attr("attach_model"),
+                nb::make_tuple(self.shared_memory()));
+          },
+          "Pickle the model as the name of its segment of shared memory")
+      .def_prop_ro("tiled", &perth::TidalModel<T>::tiled,
+                   "True if the waves are read by tiles, on demand")
+      .def_prop_ro(
+          "resident_tiles",
+          [](const perth::TidalModel<T>& self) -> size_t {
+            return self.tiled() ? self.tiles()->resident() : 0;
+          },
+          "Number of tiles held in memory, 0 if the model is not tiled")
+      .def_prop_ro(
+          "tile_memory_usage",
+          [](const perth::TidalModel<T>& self) -> size_t {
+            return self.tiled() ? self.tiles()->memory_usage() : 0;
+          },
+          "Memory used by the tiles held, in bytes, 0 if the model is not "
+          "tiled");
+  if constexpr (std::is_floating_point_v<T>) {
+    bind_shared_waves<T>(cls);
+  }
+}
+
+/// The waves stored on 16 bits are encoded by the model: they cannot be
+/// shared with NumPy.
+template <typename T>
+auto bind_shared_waves(nb::class_<perth::TidalModel<T>>& cls) -> void {
+  cls.def(
+          "wrap_constituent",
+          [](perth::TidalModel<T>& self, const perth::Constituent constituent,
+             const SharedArray<T>& wave) -> void {
+            auto nx = static_cast<size_t>(self.row_major() ? self.lon().size()
+                                                           : self.lat().size());
+            auto ny = static_cast<size_t>(self.row_major() ? self.lat().size()
+                                                           : self.lon().size());
+            if (wave.ndim() != 2 || wave.shape(0) != nx ||
+                wave.shape(1) != ny) {
+              throw std::invalid_argument(
+                  "The data size does not match the axes size: expected (" +
+                  std::to_string(nx) + "x" + std::to_string(ny) + ")");
+            }
+            // The array holds a reference on its owner: keeping a copy alive
+            // keeps the memory alive.
+            self.add_constituent(constituent, wave.data(),
+                                 std::make_shared<SharedArray<T>>(wave));
+          },
+          nb::arg("constituent"), nb::arg("wave"),
+          "Add a tidal constituent whose wave is shared with the given array, "
+          "without copying it. The array must not be modified while the "
+          "model uses it.")
+      .def(
+          "wrap_packed",
+          [](perth::TidalModel<T>& self,
+             const std::vector<perth::Constituent>& constituents,
+             const SharedArray<T>& data) -> void {
+            auto expected = static_cast<size_t>(self.lon().size() *
+                                                self.lat().size()) *
+                            constituents.size();
+            if (data.size() != expected) {
+              throw std::invalid_argument(
+                  "The data size does not match the axes size: expected " +
+                  std::to_string(expected) + " values, got " +
+                  std::to_string(data.size()));
+            }
+            self.assign_packed(constituents, data.data(),
+                               std::make_shared<SharedArray<T>>(data));
+          },
+          nb::arg("constituents"), nb::arg("data"),
+          "Use constituents already interleaved by grid node, shared with "
+          "the given array, without copying them. The array must not be "
+          "modified while the model uses it.")
+      .def(
+          "use_tiles",
+          [](perth::TidalModel<T>& self,
+             std::shared_ptr<perth::TileLoader<T>> loader,
+             const size_t tile_size, const size_t memory_budget) -> void {
+            self.use_tiles(std::move(loader), tile_size, memory_budget);
+          },
+          nb::arg("loader"), nb::arg("tile_size") = 256,
+          nb::arg("memory_budget") = 0,
+          "Read the waves by tiles of tile_size x tile_size nodes, from the "
+          "loader, the first time a point falls in them. Beyond "
+          "memory_budget bytes, if not 0, the least recently used tiles are "
+          "released.");
+}
+
+/// Convert a tidal model to the storage type U.
+template <typename U, typename T>
+auto convert_model(const perth::TidalModel<T>& model) -> nb::object {
+  auto result = std::shared_ptr<perth::TidalModel<U>>{};
+  {
+    nb::gil_scoped_release release;
+    result = perth::convert_tidal_model<U>(model);
+  }
+  return nb::cast(std::move(result));
+}
+
+/// Convert a tidal model to the storage type named.
+template <typename T>
+auto convert_model(const perth::TidalModel<T>& model,
+                   const std::string& storage) -> nb::object {
+  if (storage == "float32") {
+    return convert_model<float>(model);
+  }
+  if (storage == "float64") {
+    return convert_model<double>(model);
+  }
+  if (storage == "float16") {
+    return convert_model<perth::Float16>(model);
+  }
+  if (storage == "int16") {
+    return convert_model<perth::Int16>(model);
+  }
+  throw std::invalid_argument("Unknown storage type: " + storage);
 }
 
 auto instantiate_tidal_model(nanobind::module_& m) -> void {
@@ -61,20 +298,47 @@ auto instantiate_tidal_model(nanobind::module_& m) -> void {
 
   // Bind the Accelerator class
   nb::class_<perth::Accelerator>(m, "Accelerator")
-      .def(nb::init<double, size_t>(), nb::arg("time_tolerance"),
+      .def(nb::init<double, size_t, size_t>(), nb::arg("time_tolerance"),
            nb::arg("n_constituents"),
-           "Initialize an accelerator with a time tolerance and number of "
-           "constituents")
-      .def("clear", &perth::Accelerator::clear,
-           "Clear the cached interpolated values")
+           nb::arg("cell_cache_size") =
+               perth::Accelerator::kDefaultCellCacheSize,
+           "Initialize an accelerator with a time tolerance in days, a "
+           "number of constituents and the number of grid cells cached")
       .def_prop_ro("x1", &perth::Accelerator::x1, "Get the x1 coordinate")
       .def_prop_ro("x2", &perth::Accelerator::x2, "Get the x2 coordinate")
       .def_prop_ro("y1", &perth::Accelerator::y1, "Get the y1 coordinate")
-      .def_prop_ro("y2", &perth::Accelerator::y2, "Get the y2 coordinate")
-      .def_prop_ro("values", &perth::Accelerator::values,
-                   "Get the cached interpolated values");
+      .def_prop_ro("y2", &perth::Accelerator::y2, "Get the y2 coordinate");
 
-  // Bind both float and double versions of TidalModel
+  // Bind the sources of the tiles of the models
+  bind_tile_loader<float>(m, "TileLoaderFloat32");
+  bind_tile_loader<double>(m, "TileLoaderFloat64");
+
+  // Bind the storage types of TidalModel
   bind_tidal_model<float>(m, "TidalModelFloat32");
   bind_tidal_model<double>(m, "TidalModelFloat64");
+  bind_tidal_model<perth::Float16>(m, "TidalModelFloat16");
+  bind_tidal_model<perth::Int16>(m, "TidalModelInt16");
+
+  m.def(
+      "convert_tidal_model",
+      [](const nb::object& model, const std::string& storage) -> nb::object {
+        if (nb::isinstance<perth::TidalModel<float>>(model)) {
+          return convert_model(nb::cast<const perth::TidalModel<float>&>(model),
+                               storage);
+        }
+        if (nb::isinstance<perth::TidalModel<double>>(model)) {
+          return convert_model(
+              nb::cast<const perth::TidalModel<double>&>(model), storage);
+        }
+        if (nb::isinstance<perth::TidalModel<perth::Float16>>(model)) {
+          return convert_model(
+              nb::cast<const perth::TidalModel<perth::Float16>&>(model),
+              storage);
+        }
+        return convert_model(
+            nb::cast<const perth::TidalModel<perth::Int16>&>(model), storage);
+      },
+      nb::arg("model"), nb::arg("storage"),
+      "Convert a tidal model to another storage type: 'float32', 'float64', "
+      "'float16' or 'int16'");
 };
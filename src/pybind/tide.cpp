@@ -2,14 +2,106 @@
 
 #include <nanobind/eigen/dense.h>
 #include <nanobind/nanobind.h>
+#include <nanobind/stl/array.h>
 #include <nanobind/stl/optional.h>
 #include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/string.h>
 #include <nanobind/stl/tuple.h>
+#include <nanobind/stl/vector.h>
 
+#include <future>
+#include <memory>
+#include <string>
+
+#include "perth/approximation.hpp"
+#include "perth/ensemble.hpp"
+#include "perth/profiling.hpp"
+#include "perth/stream.hpp"
 #include "perth/tide.hpp"
 
 namespace nb = nanobind;
 
+/// Evaluate the tide over the chunks (lon, lat, time) yielded by a Python
+/// iterator, handing the results to a Python callable. The GIL is only held
+/// while the iterator or the callable run.
+template <typename T>
+static auto evaluate_stream(
+    const perth::Perth<T>& self, const nb::handle& chunks,
+    const nb::callable& sink, const size_t max_pending,
+    const double time_tolerance,
+    const std::optional<perth::InterpolationType>& interpolation_type,
+    const size_t num_threads) -> size_t {
+  auto iterator = nb::iter(chunks);
+  auto source = [&]() -> std::optional<perth::Chunk> {
+    nb::gil_scoped_acquire acquire;
+    if (iterator == nb::iterator::sentinel()) {
+      return std::nullopt;
+    }
+    auto [lon, lat, time] = nb::cast<std::tuple<
+        Eigen::VectorXd, Eigen::VectorXd, Eigen::Vector<int64_t, -1>>>(
+        *iterator);
+    ++iterator;
+    return perth::Chunk{std::move(lon), std::move(lat), std::move(time)};
+  };
+  auto write = [&](const size_t index, perth::Chunk&& /*chunk*/,
+                   perth::ChunkTides&& tides) -> void {
+    nb::gil_scoped_acquire acquire;
+    sink(index, std::move(tides.tide), std::move(tides.tide_lp),
+         std::move(tides.quality));
+  };
+  nb::gil_scoped_release release;
+  return perth::evaluate_stream(self, source, write, max_pending,
+                                time_tolerance, interpolation_type,
+                                num_threads);
+}
+
+/// Results of an evaluation.
+using EvaluationResult = perth::Perth<double>::EvaluationResult;
+
+/// Evaluation started by evaluate_async(), handed, once completed, to the
+/// Python callback.
+struct AsyncEvaluation {
+  std::future<EvaluationResult> future;
+
+  /// Get the result of the evaluation, or raise its error.
+  auto result() -> EvaluationResult { return future.get(); }
+};
+
+/// Start the evaluation of the tide in the thread pool, then call a Python
+/// callable with the AsyncEvaluation completed. The callable is called by
+/// the worker of the pool, with the GIL held.
+template <typename T>
+static auto evaluate_async(
+    const perth::Perth<T>& self, const nb::callable& callback,
+    Eigen::VectorXd lon, Eigen::VectorXd lat, Eigen::Vector<int64_t, -1> time,
+    const double time_tolerance,
+    const std::optional<perth::InterpolationType>& interpolation_type,
+    const size_t num_threads, const bool sort_by_time,
+    const bool sort_by_cell) -> void {
+  // Python objects kept until the evaluation completes: the object
+  // evaluated, which must outlive it, and the callback. They are only
+  // released with the GIL held.
+  struct Owners {
+    nb::object self;
+    nb::object callback;
+  };
+  auto owners = std::make_shared<Owners>(Owners{nb::find(self), callback});
+  auto then = [owners](std::future<EvaluationResult> future) -> void {
+    nb::gil_scoped_acquire acquire;
+    try {
+      owners->callback(nb::cast(AsyncEvaluation{std::move(future)},
+                                nb::rv_policy::move));
+    } catch (nb::python_error& error) {
+      error.discard_as_unraisable("perth.evaluate_async");
+    }
+    *owners = Owners{};
+  };
+  nb::gil_scoped_release release;
+  self.evaluate_async(std::move(then), std::move(lon), std::move(lat),
+                      std::move(time), time_tolerance, interpolation_type,
+                      num_threads, sort_by_time, sort_by_cell);
+}
+
 template <typename T>
 auto bind_perth(nanobind::module_& m, const char* name) -> void {
   nb::class_<perth::Perth<T>>(m, name)
@@ -19,14 +111,230 @@ auto bind_perth(nanobind::module_& m, const char* name) -> void {
       .def("evaluate", &perth::Perth<T>::evaluate, nb::arg("lon"),
            nb::arg("lat"), nb::arg("time"), nb::arg("time_tolerance") = 0.0,
            nb::arg("interpolation_type") = std::nullopt,
-           nb::arg("num_threads") = 0,
+           nb::arg("num_threads") = 0, nb::arg("sort_by_time") = false,
+           nb::arg("sort_by_cell") = false,
            "Evaluate tidal values at a given longitude, latitude, and time",
            nb::call_guard<nb::gil_scoped_release>())
+      .def("evaluate_into",
+           &perth::Perth<T>::template evaluate_into<double>, nb::arg("lon"),
+           nb::arg("lat"), nb::arg("time"), nb::arg("tide").noconvert(),
+           nb::arg("tide_lp").noconvert(), nb::arg("quality").noconvert(),
+           nb::arg("time_tolerance") = 0.0,
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0, nb::arg("sort_by_time") = false,
+           nb::arg("sort_by_cell") = false,
+           "Evaluate tidal values into the given arrays, possibly strided "
+           "views of larger arrays",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("evaluate_into", &perth::Perth<T>::template evaluate_into<float>,
+           nb::arg("lon"), nb::arg("lat"), nb::arg("time"),
+           nb::arg("tide").noconvert(), nb::arg("tide_lp").noconvert(),
+           nb::arg("quality").noconvert(), nb::arg("time_tolerance") = 0.0,
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0, nb::arg("sort_by_time") = false,
+           nb::arg("sort_by_cell") = false,
+           "Evaluate tidal values into the given arrays, with coordinates in "
+           "single precision",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("evaluate_async", &evaluate_async<T>, nb::arg("callback"),
+           nb::arg("lon"), nb::arg("lat"), nb::arg("time"),
+           nb::arg("time_tolerance") = 0.0,
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0, nb::arg("sort_by_time") = false,
+           nb::arg("sort_by_cell") = false,
+           "Start the evaluation of the tide in the thread pool, then call "
+           "the callback with the AsyncEvaluation completed")
+      .def("evaluate_stream", &evaluate_stream<T>, nb::arg("chunks"),
+           nb::arg("sink"), nb::arg("max_pending") = 2,
+           nb::arg("time_tolerance") = 0.0,
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0,
+           "Evaluate the tide over a stream of chunks, reading the next "
+           "chunks and writing the previous results while a chunk is "
+           "evaluated")
+      .def("evaluate_at_time", &perth::Perth<T>::evaluate_at_time,
+           nb::arg("lon"), nb::arg("lat"), nb::arg("time"),
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0,
+           "Evaluate tidal values at the given positions, at a single time",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("evaluate_grid", &perth::Perth<T>::evaluate_grid, nb::arg("lon"),
+           nb::arg("lat"), nb::arg("time"),
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0,
+           "Evaluate tidal values on the grid defined by the given "
+           "longitudes and latitudes, at a single time",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("predict_time_series", &perth::Perth<T>::predict_time_series,
+           nb::arg("lon"), nb::arg("lat"), nb::arg("start"), nb::arg("step"),
+           nb::arg("size"), nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("refresh_interval") = std::nullopt,
+           nb::arg("num_threads") = 0,
+           "Predict the tide at a fixed position over a regular time series",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("tabulate_nodal_corrections",
+           &perth::Perth<T>::tabulate_nodal_corrections, nb::arg("start"),
+           nb::arg("end"), nb::arg("step") = std::nullopt,
+           "Tabulate the nodal corrections over a time span, given in "
+           "microseconds since the epoch, to interpolate them in the next "
+           "evaluations")
+      .def("set_delta_time_series", &perth::Perth<T>::set_delta_time_series,
+           nb::arg("time"), nb::arg("delta"),
+           "Use a series of Delta T (TT - UT), in seconds, at times given in "
+           "microseconds since the epoch, instead of the model")
+      .def_prop_ro("last_stats", &perth::Perth<T>::last_stats,
+                   "Get the counters of the last evaluation completed")
+      .def_prop_rw("backend", &perth::Perth<T>::backend,
+                   &perth::Perth<T>::set_backend,
+                   "Strategy used to evaluate a set of points")
+      .def_prop_rw("argument_mode", &perth::Perth<T>::argument_mode,
+                   &perth::Perth<T>::set_argument_mode,
+                   "How the astronomical arguments are provided within the "
+                   "time tolerance")
+      .def_prop_rw("error_budget", &perth::Perth<T>::error_budget,
+                   &perth::Perth<T>::set_error_budget,
+                   "Error allowed to the evaluations, in the unit of the "
+                   "model, 0 if they are exact")
+      .def("approximation", &perth::Perth<T>::approximation,
+           nb::arg("interpolation_type") = std::nullopt,
+           "Get the shortcuts taken by the evaluations within the error "
+           "budget, and the error bound they guarantee",
+           nb::call_guard<nb::gil_scoped_release>())
       .def_prop_ro("tidal_model", &perth::Perth<T>::tidal_model,
                    "Get the tidal model associated with this Perth instance");
 }
 
+template <typename T>
+auto bind_ensemble(nanobind::module_& m, const char* name) -> void {
+  nb::class_<perth::Ensemble<T>>(m, name)
+      .def(nb::init<std::vector<std::shared_ptr<perth::TidalModel<T>>>,
+                    bool>(),
+           nb::arg("models"), nb::arg("group_modulations") = false,
+           "Initialize an ensemble of tidal models evaluated in one pass")
+      .def("evaluate", &perth::Ensemble<T>::evaluate, nb::arg("lon"),
+           nb::arg("lat"), nb::arg("time"), nb::arg("time_tolerance") = 0.0,
+           nb::arg("interpolation_type") = std::nullopt,
+           nb::arg("num_threads") = 0,
+           "Evaluate the tide of each model at a given longitude, latitude, "
+           "and time",
+           nb::call_guard<nb::gil_scoped_release>())
+      .def("tabulate_nodal_corrections",
+           &perth::Ensemble<T>::tabulate_nodal_corrections, nb::arg("start"),
+           nb::arg("end"), nb::arg("step") = std::nullopt,
+           "Tabulate the nodal corrections over a time span, given in "
+           "microseconds since the epoch, to interpolate them in the next "
+           "evaluations")
+      .def("set_delta_time_series",
+           &perth::Ensemble<T>::set_delta_time_series, nb::arg("time"),
+           nb::arg("delta"),
+           "Use a series of Delta T (TT - UT), in seconds, at times given in "
+           "microseconds since the epoch, instead of the model")
+      .def_prop_rw("argument_mode", &perth::Ensemble<T>::argument_mode,
+                   &perth::Ensemble<T>::set_argument_mode,
+                   "How the astronomical arguments are provided within the "
+                   "time tolerance")
+      .def_prop_ro("shared_axes", &perth::Ensemble<T>::shared_axes,
+                   "True if all the models share the same axes")
+      .def_prop_ro("tidal_models", &perth::Ensemble<T>::tidal_models,
+                   "Get the tidal models of the ensemble");
+}
+
+/// Time spent in a stage, in seconds.
+static auto elapsed(const perth::EvaluationStats& self,
+                    const perth::Stage stage) -> double {
+  return static_cast<double>(self.elapsed[stage]) * 1e-9;
+}
+
+static auto bind_evaluation_stats(nanobind::module_& m) -> void {
+  nb::class_<perth::EvaluationStats>(
+      m, "EvaluationStats",
+      "Counters describing an evaluation of the tide, only updated if the "
+      "library is built with PERTH_ENABLE_PROFILING")
+      .def_ro("points", &perth::EvaluationStats::points,
+              "Number of points evaluated")
+      .def_ro("quality", &perth::EvaluationStats::quality,
+              "Number of points per quality flag, indexed by the value of "
+              "the flag")
+      .def_ro("cell_hits", &perth::EvaluationStats::cell_hits,
+              "Number of interpolations whose grid cell was cached")
+      .def_ro("cell_misses", &perth::EvaluationStats::cell_misses,
+              "Number of interpolations whose grid cell was read from the "
+              "model")
+      .def_ro("argument_updates", &perth::EvaluationStats::argument_updates,
+              "Number of updates of the astronomical arguments")
+      .def_prop_ro(
+          "interpolation_time",
+          [](const perth::EvaluationStats& self) -> double {
+            return elapsed(self, perth::kInterpolationStage);
+          },
+          "Time spent interpolating the model, in seconds, summed over the "
+          "threads")
+      .def_prop_ro(
+          "inference_time",
+          [](const perth::EvaluationStats& self) -> double {
+            return elapsed(self, perth::kInferenceStage);
+          },
+          "Time spent inferring the minor constituents, in seconds, summed "
+          "over the threads")
+      .def_prop_ro(
+          "arguments_time",
+          [](const perth::EvaluationStats& self) -> double {
+            return elapsed(self, perth::kArgumentsStage);
+          },
+          "Time spent computing the astronomical arguments and the nodal "
+          "corrections, in seconds, summed over the threads")
+      .def_prop_ro(
+          "summation_time",
+          [](const perth::EvaluationStats& self) -> double {
+            return elapsed(self, perth::kSummationStage);
+          },
+          "Time spent in the harmonic summation, in seconds, summed over the "
+          "threads")
+      .def("__repr__", [](const perth::EvaluationStats& self) -> std::string {
+        return "EvaluationStats(points: " + std::to_string(self.points) +
+               ", cell_hits: " + std::to_string(self.cell_hits) +
+               ", cell_misses: " + std::to_string(self.cell_misses) +
+               ", argument_updates: " +
+               std::to_string(self.argument_updates) + ")";
+      });
+  m.def(
+      "profiling_enabled", []() -> bool { return perth::kProfiling; },
+      "True if the library is built with the profiling counters");
+}
+
 auto instantiate_tide(nanobind::module_& m) -> void {
+  nb::enum_<perth::Backend>(m, "Backend")
+      .value("POINTWISE", perth::Backend::kPointwise,
+             "Interpolate, infer and sum the constituents at each point")
+      .value("BATCHED", perth::Backend::kBatched,
+             "Fold the inference and the harmonic sum per time bucket");
+  nb::enum_<perth::ArgumentMode>(m, "ArgumentMode")
+      .value("FROZEN", perth::ArgumentMode::kFrozen,
+             "Keep the arguments constant within the time tolerance")
+      .value("EXTRAPOLATED", perth::ArgumentMode::kExtrapolated,
+             "Extrapolate the arguments linearly within the time tolerance");
+  bind_evaluation_stats(m);
+  nb::class_<perth::Approximation>(
+      m, "Approximation",
+      "Shortcuts taken by an evaluation within an error budget")
+      .def_ro("error_bound", &perth::Approximation::error_bound,
+              "Upper bound of the error of the tides evaluated, in the unit "
+              "of the model, within the time tolerance selected")
+      .def_ro("time_tolerance", &perth::Approximation::time_tolerance,
+              "Time tolerance, in days, within which the nodal corrections "
+              "are kept")
+      .def_ro("dropped", &perth::Approximation::dropped,
+              "Inferred constituents no longer computed");
+  nb::class_<AsyncEvaluation>(m, "AsyncEvaluation",
+                              "Evaluation completed in the thread pool")
+      .def("result", &AsyncEvaluation::result,
+           "Get the result of the evaluation, or raise its error");
   bind_perth<float>(m, "PerthFloat32");
   bind_perth<double>(m, "PerthFloat64");
+  bind_perth<perth::Float16>(m, "PerthFloat16");
+  bind_perth<perth::Int16>(m, "PerthInt16");
+  bind_ensemble<float>(m, "EnsembleFloat32");
+  bind_ensemble<double>(m, "EnsembleFloat64");
+  bind_ensemble<perth::Float16>(m, "EnsembleFloat16");
+  bind_ensemble<perth::Int16>(m, "EnsembleInt16");
 }
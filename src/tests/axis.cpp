@@ -0,0 +1,81 @@
+#include "perth/axis.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <tuple>
+
+namespace perth {
+
+using Indices = std::optional<std::tuple<int64_t, int64_t>>;
+
+TEST(AxisTest, FindIndicesAscending) {
+  auto axis = Axis(-90, 90, 0.5);
+  EXPECT_EQ(axis.find_indices(-90), Indices({0, 1}));
+  EXPECT_EQ(axis.find_indices(-89.75), Indices({0, 1}));
+  EXPECT_EQ(axis.find_indices(0), Indices({180, 181}));
+  EXPECT_EQ(axis.find_indices(std::nextafter(0.0, -1.0)),
+            Indices({179, 180}));
+  // The last element belongs to the last cell.
+  EXPECT_EQ(axis.find_indices(90), Indices({359, 360}));
+  EXPECT_EQ(axis.find_indices(90.1), std::nullopt);
+  EXPECT_EQ(axis.find_indices(-90.1), std::nullopt);
+  EXPECT_EQ(axis.find_indices(std::numeric_limits<double>::quiet_NaN()),
+            std::nullopt);
+}
+
+TEST(AxisTest, FindIndicesPeriodic) {
+  auto axis = Axis(0, 359, 1, 1e-6, true);
+  EXPECT_EQ(axis.find_indices(10.5), Indices({10, 11}));
+  EXPECT_EQ(axis.find_indices(370.5), Indices({10, 11}));
+  EXPECT_EQ(axis.find_indices(-349.5), Indices({10, 11}));
+  EXPECT_EQ(axis.find_indices(359), Indices({358, 359}));
+  // The cell wrapping around the circle.
+  EXPECT_EQ(axis.find_indices(359.5), Indices({359, 0}));
+  EXPECT_EQ(axis.find_indices(-0.5), Indices({359, 0}));
+  // The normalization of this value is rounded to 360.
+  EXPECT_EQ(axis.find_indices(-std::numeric_limits<double>::denorm_min()),
+            Indices({0, 1}));
+}
+
+TEST(AxisTest, FindIndicesDescending) {
+  auto axis = Axis(10, -10, -0.5);
+  EXPECT_EQ(axis.find_indices(9.75), Indices({1, 0}));
+  EXPECT_EQ(axis.find_indices(-9.75), Indices({40, 39}));
+  EXPECT_EQ(axis.find_indices(10.5), std::nullopt);
+}
+
+TEST(AxisTest, FindIndicesVector) {
+  for (const auto& axis :
+       {Axis(-180, 179.75, 0.25, 1e-6, true), Axis(-90, 90, 0.25),
+        Axis(10, -10, -0.5), Axis(359, 0, -1, 1e-6, true)}) {
+    auto coordinates = Eigen::VectorXd::LinSpaced(10001, -540, 540).eval();
+    auto [i0, i1, fraction] = axis.find_indices(coordinates);
+    ASSERT_EQ(i0.size(), coordinates.size());
+    for (int64_t ix = 0; ix < coordinates.size(); ++ix) {
+      auto indices = axis.find_indices(coordinates[ix]);
+      if (!indices) {
+        EXPECT_EQ(i0[ix], -1);
+        EXPECT_EQ(i1[ix], -1);
+        EXPECT_TRUE(std::isnan(fraction[ix]));
+        continue;
+      }
+      EXPECT_EQ(i0[ix], std::get<0>(*indices));
+      EXPECT_EQ(i1[ix], std::get<1>(*indices));
+      // The coordinate is found again, modulo 360 degrees, by a linear
+      // interpolation of the elements around it.
+      auto x0 = axis(i0[ix]);
+      auto x1 = axis(i1[ix]);
+      if (axis.is_periodic()) {
+        x1 = normalize_angle(x1, x0, 360.0);
+      }
+      auto coordinate = x0 + fraction[ix] * (x1 - x0);
+      EXPECT_NEAR(std::remainder(coordinate - coordinates[ix], 360.0), 0,
+                  1e-9);
+    }
+  }
+}
+
+}  // namespace perth
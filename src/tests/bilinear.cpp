@@ -0,0 +1,104 @@
+#include "perth/bilinear.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include "perth/math.hpp"
+
+namespace perth {
+
+template <typename T>
+static auto check_against_scalar(const std::vector<std::complex<T>>& z11,
+                                 const std::vector<std::complex<T>>& z12,
+                                 const std::vector<std::complex<T>>& z21,
+                                 const std::vector<std::complex<T>>& z22,
+                                 const int64_t expected) -> void {
+  const auto wxy = bilinear_weights(0.3, 0.6, 0.0, 0.0, 1.0, 1.0);
+  auto result = std::vector<std::complex<double>>(z11.size());
+  auto n = interpolate_stencil(wxy, z11.data(), z12.data(), z21.data(),
+                               z22.data(), z11.size(), result.data());
+  ASSERT_EQ(n, expected);
+  for (size_t ix = 0; ix < z11.size(); ++ix) {
+    auto m = int64_t{0};
+    auto value = bilinear_interpolation<std::complex<double>>(
+        std::get<0>(wxy), std::get<1>(wxy), std::get<2>(wxy), std::get<3>(wxy),
+        z11[ix], z12[ix], z21[ix], z22[ix], m);
+    EXPECT_EQ(m, n);
+    EXPECT_NEAR(std::abs(value - result[ix]), 0, 1e-12);
+  }
+}
+
+TEST(BilinearTest, AllCornersDefined) {
+  auto z11 = std::vector<std::complex<double>>{{1, 2}, {3, 4}, {5, 6}};
+  auto z12 = std::vector<std::complex<double>>{{-1, 2}, {3, -4}, {0, 6}};
+  auto z21 = std::vector<std::complex<double>>{{7, 2}, {1, 4}, {5, 1}};
+  auto z22 = std::vector<std::complex<double>>{{2, 2}, {3, 9}, {8, 6}};
+  check_against_scalar(z11, z12, z21, z22, 4);
+
+  auto f11 = std::vector<std::complex<float>>(z11.begin(), z11.end());
+  auto f12 = std::vector<std::complex<float>>(z12.begin(), z12.end());
+  auto f21 = std::vector<std::complex<float>>(z21.begin(), z21.end());
+  auto f22 = std::vector<std::complex<float>>(z22.begin(), z22.end());
+  check_against_scalar(f11, f12, f21, f22, 4);
+}
+
+TEST(BilinearTest, UndefinedCorners) {
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  auto z11 = std::vector<std::complex<double>>{{1, 2}, {3, 4}};
+  auto z12 = std::vector<std::complex<double>>{{nan, nan}, {nan, nan}};
+  auto z21 = std::vector<std::complex<double>>{{7, 2}, {1, 4}};
+  auto z22 = std::vector<std::complex<double>>{{nan, nan}, {nan, nan}};
+  check_against_scalar(z11, z12, z21, z22, 2);
+
+  // All corners undefined.
+  auto result = std::vector<std::complex<double>>(2);
+  EXPECT_EQ(interpolate_stencil(bilinear_weights(0.3, 0.6, 0.0, 0.0, 1.0, 1.0),
+                                z12.data(), z12.data(), z22.data(), z22.data(),
+                                2, result.data()),
+            0);
+
+  // A corner mixing defined and undefined values must be handled by the
+  // caller.
+  z12[0] = {1, 1};
+  EXPECT_EQ(interpolate_stencil(bilinear_weights(0.3, 0.6, 0.0, 0.0, 1.0, 1.0),
+                                z11.data(), z12.data(), z21.data(), z22.data(),
+                                2, result.data()),
+            -1);
+}
+
+TEST(BilinearTest, KnownCorners) {
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  const auto wxy = bilinear_weights(0.3, 0.6, 0.0, 0.0, 1.0, 1.0);
+  auto z11 = std::vector<std::complex<double>>{{1, 2}, {3, 4}};
+  auto z12 = std::vector<std::complex<double>>{{nan, nan}, {nan, nan}};
+  auto z21 = std::vector<std::complex<double>>{{7, 2}, {1, 4}};
+  auto z22 = std::vector<std::complex<double>>{{2, 5}, {-1, 3}};
+  auto expected = std::vector<std::complex<double>>(2);
+  auto result = std::vector<std::complex<double>>(2);
+  // The mask gives the same result as the inspection of the values, to
+  // within the rounding of the kernels: each overload is compiled, and may
+  // contract its operations, on its own.
+  EXPECT_EQ(interpolate_stencil(wxy, z11.data(), z12.data(), z21.data(),
+                                z22.data(), 2, expected.data()),
+            3);
+  EXPECT_EQ(interpolate_stencil(wxy, 0b1101, z11.data(), z12.data(),
+                                z21.data(), z22.data(), 2, result.data()),
+            3);
+  for (size_t ix = 0; ix < result.size(); ++ix) {
+    constexpr auto ulp = 4 * std::numeric_limits<double>::epsilon();
+    EXPECT_NEAR(result[ix].real(), expected[ix].real(),
+                ulp * std::abs(expected[ix].real()));
+    EXPECT_NEAR(result[ix].imag(), expected[ix].imag(),
+                ulp * std::abs(expected[ix].imag()));
+  }
+
+  EXPECT_EQ(interpolate_stencil(wxy, 0, z12.data(), z12.data(), z12.data(),
+                                z12.data(), 2, result.data()),
+            0);
+}
+
+}  // namespace perth
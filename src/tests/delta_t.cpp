@@ -360,4 +360,37 @@ TEST_F(DeltaTTest, ComputationalStability) {
   }
 }
 
+// The table holds the polynomials evaluated for each year.
+TEST_F(DeltaTTest, Table) {
+  static_assert(kDeltaTimeTable.size() == 451);
+  static_assert(kDeltaTimeTable.front() == delta_time_polynomial(1700));
+  for (int year = kDeltaTimeFirstYear; year <= kDeltaTimeLastYear; ++year) {
+    EXPECT_EQ(calculate_delta_time(year_to_julian_date(year)),
+              delta_time_polynomial(year));
+  }
+  EXPECT_TRUE(std::isnan(calculate_delta_time(std::nan(""))));
+}
+
+TEST_F(DeltaTTest, Series) {
+  const auto start = year_to_modified_julian_date(2000);
+  auto series = DeltaTimeSeries({start, start + 10, start + 30},
+                                {63.8, 63.9, 64.3});
+  EXPECT_TRUE(series.contains(start));
+  EXPECT_TRUE(series.contains(start + 30));
+  EXPECT_FALSE(series.contains(start + 31));
+  EXPECT_DOUBLE_EQ(series(start), 63.8);
+  EXPECT_DOUBLE_EQ(series(start + 5), 63.85);
+  EXPECT_DOUBLE_EQ(series(start + 20), 64.1);
+  EXPECT_DOUBLE_EQ(series(start + 30), 64.3);
+  // Outside the series, the model is used.
+  EXPECT_EQ(series(start - 365),
+            calculate_delta_time(start - 365 + kModifiedJulianEpoch));
+
+  EXPECT_THROW(DeltaTimeSeries({start}, {63.8}), std::invalid_argument);
+  EXPECT_THROW(DeltaTimeSeries({start, start + 1}, {63.8}),
+               std::invalid_argument);
+  EXPECT_THROW(DeltaTimeSeries({start, start}, {63.8, 63.9}),
+               std::invalid_argument);
+}
+
 }  // namespace perth
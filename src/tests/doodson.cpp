@@ -1,7 +1,13 @@
 #include "perth/doodson.hpp"
 
 #include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "perth/constituent.hpp"
 #include "perth/eigen.hpp"
+#include "perth/math.hpp"
 
 namespace perth {
 
@@ -41,4 +47,39 @@ TEST(DoodsonTest, CalculateDoodsonArgument) {
   EXPECT_NEAR(result, 86.139014533657019, 1e-10);
 }
 
+TEST(DoodsonTest, CalculateDoodsonArguments) {
+  constexpr double time = 45335.0;
+  constexpr double delta = 53.026754231840584;
+
+  const auto table = assemble_constituent_table();
+  const auto celestial_vector = calculate_celestial_vector(time, delta);
+  const auto arguments =
+      calculate_doodson_arguments(celestial_vector, doodson_matrix());
+  for (auto&& key : table.keys()) {
+    const auto expected = calculate_doodson_argument(
+        time, delta, table[key].doodson_number.cast<double>());
+    EXPECT_NEAR(arguments(static_cast<Eigen::Index>(key)), expected, 1e-10);
+  }
+  EXPECT_NEAR(arguments(kNode), 86.139014533657019, 1e-10);
+}
+
+TEST(DoodsonTest, CalculateCelestialVectors) {
+  // Times spanning two centuries, on both sides of the Modified Julian
+  // epoch, with fractional days.
+  auto time = Eigen::VectorXd::LinSpaced(1001, -20000.25, 80000.75);
+  auto delta = Eigen::VectorXd::LinSpaced(1001, -5.0, 75.0);
+  auto result = calculate_celestial_vectors(time, delta);
+  ASSERT_EQ(result.rows(), time.size());
+  for (Eigen::Index ix = 0; ix < time.size(); ++ix) {
+    Vector6d expected = calculate_celestial_vector(time(ix), delta(ix));
+    for (Eigen::Index jx = 0; jx < 6; ++jx) {
+      // The angles are compared modulo 360 degrees, in case one of them is
+      // rounded to the other end of the circle.
+      EXPECT_NEAR(normalize_angle(result(ix, jx) - expected(jx)), 0, 1e-9);
+    }
+  }
+  EXPECT_THROW(calculate_celestial_vectors(time, delta.head(10)),
+               std::invalid_argument);
+}
+
 }  // namespace perth
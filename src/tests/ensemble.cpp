@@ -0,0 +1,139 @@
+#include "perth/ensemble.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/inference.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+#include "perth/tide.hpp"
+
+#include "test_models.hpp"
+
+namespace perth {
+
+// Synthetic model whose waves depend on a phase, with a land patch at a
+// position depending on the phase.
+static auto make_model(const Axis& lon, const Axis& lat, const float phase,
+                       const bool packed)
+    -> std::shared_ptr<TidalModel<float>> {
+  return tests::make_synthetic_model<float>(
+      lon, lat, {kQ1, kO1, kP1, kK1, kN2, kM2, kS2, kK2, kMm, kMf}, packed,
+      tests::land_patch(10 + static_cast<int64_t>(phase), 10), phase);
+}
+
+class EnsembleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    lon_ = Eigen::VectorXd::LinSpaced(256, -180, 179);
+    lat_ = Eigen::VectorXd::LinSpaced(256, -70, 70);
+    time_ = Eigen::Vector<int64_t, -1>(256);
+    for (int64_t ix = 0; ix < time_.size(); ++ix) {
+      // 2020-01-01 + ix * 37 minutes
+      time_(ix) = (1577836800LL + ix * 2220) * kMicrosecondsPerSecond;
+    }
+    // Point inside the land patch of the first model
+    lon_(3) = 23;
+    lat_(3) = -65;
+  }
+
+  // Check each column of the ensemble against the evaluation of its model.
+  auto check(const std::vector<std::shared_ptr<TidalModel<float>>>& models,
+             const std::optional<InterpolationType>& interpolation_type,
+             const size_t num_threads) const -> void {
+    auto ensemble = Ensemble<float>(models);
+    auto [tide, tide_lp, quality] = ensemble.evaluate(
+        lon_, lat_, time_, 60, interpolation_type, num_threads);
+    ASSERT_EQ(tide.rows(), lon_.size());
+    ASSERT_EQ(tide.cols(), static_cast<Eigen::Index>(models.size()));
+    for (size_t kx = 0; kx < models.size(); ++kx) {
+      auto col = static_cast<Eigen::Index>(kx);
+      auto [expected, expected_lp, expected_quality] =
+          Perth<float>(models[kx]).evaluate(lon_, lat_, time_, 60,
+                                            interpolation_type, 1);
+      for (int64_t ix = 0; ix < lon_.size(); ++ix) {
+        ASSERT_EQ(quality(ix, col), expected_quality(ix));
+        if (expected_quality(ix) == kUndefined) {
+          EXPECT_TRUE(std::isnan(tide(ix, col)));
+          EXPECT_TRUE(std::isnan(tide_lp(ix, col)));
+        } else {
+          EXPECT_NEAR(tide(ix, col), expected(ix), 1e-12);
+          EXPECT_NEAR(tide_lp(ix, col), expected_lp(ix), 1e-12);
+        }
+      }
+    }
+  }
+
+  Eigen::VectorXd lon_;
+  Eigen::VectorXd lat_;
+  Eigen::Vector<int64_t, -1> time_;
+};
+
+TEST_F(EnsembleTest, SharedAxes) {
+  auto lon = Axis(0, 358, 2, 1e-6, true);
+  auto lat = Axis(-90, 90, 2);
+  auto models = std::vector<std::shared_ptr<TidalModel<float>>>{
+      make_model(lon, lat, 0, false), make_model(lon, lat, 1, true),
+      make_model(lon, lat, 2, false)};
+  EXPECT_TRUE(Ensemble<float>(models).shared_axes());
+  for (auto num_threads : {size_t{1}, size_t{0}}) {
+    check(models, std::nullopt, num_threads);
+    check(models, InterpolationType::kLinearAdmittance, num_threads);
+  }
+}
+
+TEST_F(EnsembleTest, DistinctAxes) {
+  auto lat = Axis(-90, 90, 2);
+  auto models = std::vector<std::shared_ptr<TidalModel<float>>>{
+      make_model(Axis(0, 358, 2, 1e-6, true), lat, 0, true),
+      make_model(Axis(-180, 179, 1, 1e-6, true), Axis(-90, 90, 1), 2, false)};
+  EXPECT_FALSE(Ensemble<float>(models).shared_axes());
+  check(models, InterpolationType::kFourierAdmittance, 0);
+}
+
+TEST_F(EnsembleTest, InvalidArguments) {
+  EXPECT_THROW(Ensemble<float>({}), std::invalid_argument);
+  EXPECT_THROW(Ensemble<float>({nullptr}), std::invalid_argument);
+  auto ensemble = Ensemble<float>({make_model(
+      Axis(0, 358, 2, 1e-6, true), Axis(-90, 90, 2), 0, false)});
+  EXPECT_THROW(ensemble.evaluate(lon_, lat_.head(3), time_),
+               std::invalid_argument);
+  EXPECT_THROW(ensemble.evaluate(lon_, lat_, time_, -1),
+               std::invalid_argument);
+}
+
+TEST(StencilTest, SameAsPoint) {
+  auto model = make_model(Axis(0, 358, 2, 1e-6, true), Axis(-90, 90, 2), 0,
+                          true);
+  auto acc = model->accelerator(0);
+  auto expected = std::vector<std::complex<double>>(model->size());
+  auto actual = std::vector<std::complex<double>>(model->size());
+  for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{-0.5, -45.2},
+                             std::pair{23.0, -65.0}, std::pair{359.5, 89.9}}) {
+    auto stencil = model->stencil(x, y);
+    ASSERT_TRUE(stencil.has_value());
+    EXPECT_EQ(model->interpolate(*stencil, actual.data(), acc.get()),
+              model->interpolate(x, y, expected.data(), acc.get()));
+    for (size_t ix = 0; ix < expected.size(); ++ix) {
+      if (std::isnan(expected[ix].real())) {
+        EXPECT_TRUE(std::isnan(actual[ix].real()));
+      } else {
+        EXPECT_EQ(actual[ix], expected[ix]);
+      }
+    }
+  }
+  // Point outside the grid
+  EXPECT_FALSE(model->stencil(0, 90.5).has_value());
+}
+
+}  // namespace perth
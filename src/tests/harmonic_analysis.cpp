@@ -0,0 +1,168 @@
+#include "perth/harmonic_analysis.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+// Constituents of the synthetic series and their complex values.
+static const auto kConstituents =
+    std::vector<Constituent>{kM2, kS2, kN2, kK1, kO1};
+static const auto kWaves = std::vector<std::complex<double>>{
+    {0.8, -0.3}, {0.25, 0.1}, {-0.12, 0.15}, {0.2, 0.05}, {-0.1, 0.14}};
+constexpr auto kMean = 0.07;
+
+// Hourly samples over 60 days from 2020-01-01.
+static auto make_time() -> Eigen::Vector<int64_t, -1> {
+  constexpr auto kStart = int64_t{1577836800} * 1'000'000;
+  constexpr auto kHour = int64_t{3600} * 1'000'000;
+  auto time = Eigen::Vector<int64_t, -1>(60 * 24);
+  for (Eigen::Index ix = 0; ix < time.size(); ++ix) {
+    time(ix) = kStart + ix * kHour;
+  }
+  return time;
+}
+
+// Tide predicted as Perth does, with the group modulations or not.
+static auto make_series(const Eigen::Vector<int64_t, -1>& time,
+                        const bool group_modulations) -> Eigen::VectorXd {
+  auto table = assemble_constituent_table(kConstituents);
+  auto acc = Accelerator(0, table.size());
+  auto values = Eigen::VectorXd(time.size());
+  for (Eigen::Index ix = 0; ix < time.size(); ++ix) {
+    acc.update_args(epoch_to_modified_julian_date(time(ix)),
+                    static_cast<double>(group_modulations), table);
+    auto tide = kMean;
+    for (size_t jx = 0; jx < kConstituents.size(); ++jx) {
+      const auto index = static_cast<size_t>(kConstituents[jx]);
+      const auto& [f, u] = acc.nodal_corrections()[index];
+      const auto phase = radians(table.items()[index].tidal_argument + u);
+      tide += f * (kWaves[jx].real() * std::cos(phase) +
+                   kWaves[jx].imag() * std::sin(phase));
+    }
+    values(ix) = tide;
+  }
+  return values;
+}
+
+static auto expect_recovered(const HarmonicAnalysisResult& result,
+                             const double tolerance) -> void {
+  ASSERT_EQ(result.constituents.size(),
+            static_cast<Eigen::Index>(kWaves.size()));
+  for (size_t ix = 0; ix < kWaves.size(); ++ix) {
+    const auto& value = result.constituents(static_cast<Eigen::Index>(ix));
+    EXPECT_NEAR(value.real(), kWaves[ix].real(), tolerance);
+    EXPECT_NEAR(value.imag(), kWaves[ix].imag(), tolerance);
+  }
+  EXPECT_NEAR(result.mean, kMean, tolerance);
+}
+
+TEST(HarmonicAnalysis, Recover) {
+  const auto time = make_time();
+  for (auto group_modulations : {false, true}) {
+    const auto values = make_series(time, group_modulations);
+    auto analysis = HarmonicAnalysis(kConstituents, group_modulations);
+    analysis.accumulate(time, values, 1);
+    EXPECT_EQ(analysis.samples(), time.size());
+    const auto result = analysis.solve();
+    EXPECT_EQ(result.samples, time.size());
+    expect_recovered(result, 1e-9);
+    EXPECT_LT(result.residual_rms, 1e-6);
+  }
+}
+
+TEST(HarmonicAnalysis, ChunksAndThreads) {
+  const auto time = make_time();
+  const auto values = make_series(time, false);
+  auto expected = HarmonicAnalysis(kConstituents);
+  expected.accumulate(time, values, 1);
+
+  // The series given by chunks to one analysis, in parallel.
+  auto chunked = HarmonicAnalysis(kConstituents);
+  const auto half = time.size() / 2;
+  chunked.accumulate(time.tail(time.size() - half),
+                     values.tail(values.size() - half), 4);
+  chunked.accumulate(time.head(half), values.head(half), 4);
+
+  // The chunks analyzed separately, then merged.
+  auto merged = HarmonicAnalysis(kConstituents);
+  merged.accumulate(time.head(half), values.head(half));
+  auto other = HarmonicAnalysis(kConstituents);
+  other.accumulate(time.tail(time.size() - half),
+                   values.tail(values.size() - half));
+  merged.merge(other);
+
+  for (const auto* analysis : {&chunked, &merged}) {
+    EXPECT_EQ(analysis->samples(), expected.samples());
+    const auto& lhs = expected.normal_matrix();
+    const auto& rhs = analysis->normal_matrix();
+    EXPECT_LT((lhs.triangularView<Eigen::Lower>().toDenseMatrix() -
+               rhs.triangularView<Eigen::Lower>().toDenseMatrix())
+                  .cwiseAbs()
+                  .maxCoeff(),
+              1e-9);
+    EXPECT_TRUE(
+        expected.normal_vector().isApprox(analysis->normal_vector(), 1e-12));
+    expect_recovered(analysis->solve(), 1e-9);
+  }
+}
+
+TEST(HarmonicAnalysis, UndefinedSamples) {
+  const auto time = make_time();
+  auto values = make_series(time, false);
+  for (Eigen::Index ix = 0; ix < values.size(); ix += 7) {
+    values(ix) = std::numeric_limits<double>::quiet_NaN();
+  }
+  auto analysis = HarmonicAnalysis(kConstituents);
+  analysis.accumulate(time, values);
+  EXPECT_EQ(analysis.samples(), time.size() - (time.size() + 6) / 7);
+  expect_recovered(analysis.solve(), 1e-9);
+}
+
+TEST(HarmonicAnalysis, TimeTolerance) {
+  // The arguments extrapolated within one hour match the exact ones.
+  const auto time = make_time();
+  const auto values = make_series(time, false);
+  auto analysis = HarmonicAnalysis(kConstituents, false, true, 1.0 / 24);
+  analysis.accumulate(time, values);
+  expect_recovered(analysis.solve(), 1e-4);
+}
+
+TEST(HarmonicAnalysis, Errors) {
+  EXPECT_THROW(HarmonicAnalysis({}), std::invalid_argument);
+  EXPECT_THROW(HarmonicAnalysis({kM2, kS2, kM2}), std::invalid_argument);
+  EXPECT_THROW(HarmonicAnalysis({kM2}, false, true, -1),
+               std::invalid_argument);
+
+  auto analysis = HarmonicAnalysis(kConstituents);
+  const auto time = make_time();
+  const auto values = make_series(time, false);
+  EXPECT_THROW(analysis.accumulate(time, values.head(10)),
+               std::invalid_argument);
+  // Not enough samples.
+  analysis.accumulate(time.head(5), values.head(5));
+  EXPECT_THROW(static_cast<void>(analysis.solve()), std::runtime_error);
+
+  // Samples repeated at the same time do not separate the constituents.
+  auto degenerate = HarmonicAnalysis({kK1, kP1});
+  degenerate.accumulate(Eigen::Vector<int64_t, -1>::Constant(24, time(0)),
+                        values.head(24));
+  EXPECT_THROW(static_cast<void>(degenerate.solve()), std::runtime_error);
+
+  EXPECT_THROW(analysis.merge(HarmonicAnalysis(kConstituents, true)),
+               std::invalid_argument);
+  EXPECT_THROW(analysis.merge(HarmonicAnalysis({kM2})), std::invalid_argument);
+}
+
+}  // namespace perth
@@ -2,8 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
+#include <vector>
 
 #include "perth/constituent.hpp"
 
@@ -287,4 +289,53 @@ TEST(InferenceOceanTide, RealCase) {
   }
 }
 
+TEST(InferenceBounds, AmplitudeBoundsAndDrop) {
+  const auto identifiers =
+      std::vector<Constituent>{kQ1, kO1, kK1, kN2, kM2, kS2, kMm, kMf};
+  auto table = assemble_constituent_table(identifiers);
+  auto inference = Inference(table, InterpolationType::kFourierAdmittance);
+  auto bounds = std::vector<double>(kNumConstituentItems, 0.0);
+  auto scale = 1.0;
+  for (auto ident : identifiers) {
+    table[ident].tide = Complex(0.6 * scale, -0.8 * scale);
+    bounds[static_cast<size_t>(ident)] = scale;
+    scale *= 0.7;
+  }
+  const auto constituents = inference.constituents();
+  const auto result = inference.amplitude_bounds(table, bounds);
+  ASSERT_EQ(result.size(), constituents.size());
+
+  // The bounds hold at all the latitudes, for the node tide too.
+  for (auto lat : {-90.0, -35.0, 0.0, 50.0, 90.0}) {
+    auto inferred = table;
+    inference(inferred, lat);
+    for (size_t ix = 0; ix < constituents.size(); ++ix) {
+      if (inferred[constituents[ix]].is_inferred) {
+        EXPECT_LE(std::abs(inferred[constituents[ix]].tide),
+                  result[ix] * (1 + 1e-12));
+      }
+    }
+  }
+  auto expected = table;
+  inference(expected, 20);
+
+  // The constituents dropped are no longer inferred; the others are
+  // unchanged, even those inferred from a reference dropped.
+  inference.drop({k2Q1, kQ1, kMSqm});
+  const auto remaining = inference.constituents();
+  EXPECT_EQ(remaining.size(), constituents.size() - 3);
+  EXPECT_EQ(std::count(remaining.begin(), remaining.end(), k2Q1), 0);
+  EXPECT_EQ(std::count(remaining.begin(), remaining.end(), kMSqm), 0);
+  EXPECT_EQ(std::count(remaining.begin(), remaining.end(), kQ1), 0);
+  auto actual = table;
+  actual[k2Q1].tide = Complex(7, 7);
+  inference(actual, 20);
+  EXPECT_EQ(actual[k2Q1].tide, Complex(7, 7));
+  for (auto ident : remaining) {
+    EXPECT_EQ(actual[ident].tide, expected[ident].tide);
+  }
+  const auto dropped = inference.amplitude_bounds(table, bounds);
+  ASSERT_EQ(dropped.size(), remaining.size());
+}
+
 }  // namespace perth
@@ -0,0 +1,152 @@
+#include "perth/model_builder.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+
+namespace perth {
+
+using Block = Eigen::Matrix<double, -1, -1, Eigen::RowMajor>;
+
+// Amplitudes, in centimeters, and phases, in degrees, of a constituent.
+static auto make_grids(const int64_t rows, const int64_t cols,
+                       const double scale) -> std::pair<Block, Block> {
+  auto amplitude = Block(rows, cols);
+  auto phase = Block(rows, cols);
+  for (int64_t ix = 0; ix < rows; ++ix) {
+    for (int64_t jx = 0; jx < cols; ++jx) {
+      amplitude(ix, jx) = scale * static_cast<double>(ix + jx + 1);
+      phase(ix, jx) = std::fmod(scale * static_cast<double>(7 * ix + jx), 360);
+    }
+  }
+  // Land points
+  amplitude(3, 4) = std::nan("");
+  phase(5, 2) = std::nan("");
+  return {amplitude, phase};
+}
+
+TEST(ModelBuilder, Decode) {
+  const auto idents = std::vector<Constituent>{kM2, kS2, kK1};
+  for (auto packed : {false, true}) {
+    for (auto row_major : {true, false}) {
+      auto lon = Axis(0, 358, 2, 1e-6, true);
+      auto lat = Axis(-90, 90, 2);
+      auto model =
+          std::make_shared<TidalModel<float>>(lon, lat, row_major, packed);
+      auto expected = TidalModel<float>(lon, lat, row_major, packed);
+      auto builder =
+          ModelBuilder<float>(model, idents, 0.01, pi<double>() / 180);
+      EXPECT_EQ(builder.rows(), row_major ? lon.size() : lat.size());
+      EXPECT_EQ(builder.cols(), row_major ? lat.size() : lon.size());
+
+      auto grids = std::vector<std::pair<Block, Block>>();
+      for (size_t ix = 0; ix < idents.size(); ++ix) {
+        grids.push_back(make_grids(builder.rows(), builder.cols(),
+                                   static_cast<double>(ix + 1)));
+        const auto& [amplitude, phase] = grids.back();
+        auto wave = Eigen::Matrix<std::complex<float>, -1, -1,
+                                  Eigen::RowMajor>(amplitude.rows(),
+                                                   amplitude.cols());
+        for (int64_t jx = 0; jx < wave.rows(); ++jx) {
+          for (int64_t kx = 0; kx < wave.cols(); ++kx) {
+            auto a = amplitude(jx, kx) * 0.01;
+            auto p = radians(phase(jx, kx));
+            wave(jx, kx) =
+                std::complex<float>(static_cast<float>(a * std::cos(p)),
+                                    static_cast<float>(a * std::sin(p)));
+          }
+        }
+        expected.add_constituent(idents[ix], wave);
+      }
+      expected.pack();
+
+      // One thread per constituent, decoding blocks of 7 rows.
+      auto threads = std::vector<std::thread>();
+      for (size_t ix = 0; ix < idents.size(); ++ix) {
+        threads.emplace_back([&, ix]() -> void {
+          const auto& [amplitude, phase] = grids[ix];
+          for (int64_t first = 0; first < builder.rows(); first += 7) {
+            auto rows = std::min<int64_t>(7, builder.rows() - first);
+            builder.decode<double>(ix, first,
+                                   amplitude.middleRows(first, rows),
+                                   phase.middleRows(first, rows));
+          }
+        });
+      }
+      for (auto& item : threads) {
+        item.join();
+      }
+      auto result = builder.build();
+      ASSERT_EQ(result, model);
+      EXPECT_EQ(model->identifiers(), idents);
+      EXPECT_EQ(model->packed(), packed);
+      for (size_t ix = 0; ix < idents.size(); ++ix) {
+        auto actual = model->wave(ix);
+        auto reference = expected.wave(ix);
+        ASSERT_EQ(actual.size(), reference.size());
+        for (int64_t jx = 0; jx < actual.size(); ++jx) {
+          if (std::isnan(reference(jx).real())) {
+            EXPECT_TRUE(std::isnan(actual(jx).real()));
+            EXPECT_TRUE(std::isnan(actual(jx).imag()));
+          } else {
+            EXPECT_NEAR(actual(jx).real(), reference(jx).real(), 1e-6);
+            EXPECT_NEAR(actual(jx).imag(), reference(jx).imag(), 1e-6);
+          }
+        }
+      }
+      auto table = assemble_constituent_table(idents);
+      auto acc = model->accelerator(0);
+      auto expected_table = assemble_constituent_table(idents);
+      auto expected_acc = expected.accelerator(0);
+      EXPECT_EQ(model->interpolate(10.3, 20.7, table, acc.get()),
+                expected.interpolate(10.3, 20.7, expected_table,
+                                     expected_acc.get()));
+      EXPECT_THROW(builder.build(), std::runtime_error);
+    }
+  }
+}
+
+TEST(ModelBuilder, Errors) {
+  auto lon = Axis(0, 358, 2, 1e-6, true);
+  auto lat = Axis(-90, 90, 2);
+  auto make = [&]() -> std::shared_ptr<TidalModel<double>> {
+    return std::make_shared<TidalModel<double>>(lon, lat);
+  };
+  EXPECT_THROW(ModelBuilder<double>(nullptr, {kM2}), std::invalid_argument);
+  EXPECT_THROW(ModelBuilder<double>(make(), {}), std::invalid_argument);
+  EXPECT_THROW(ModelBuilder<double>(make(), {kM2, kM2}),
+               std::invalid_argument);
+
+  auto builder = ModelBuilder<double>(make(), {kM2, kS2});
+  auto block = Block::Zero(4, builder.cols()).eval();
+  EXPECT_THROW(builder.decode<double>(2, 0, block, block),
+               std::invalid_argument);
+  EXPECT_THROW(builder.decode<double>(0, builder.rows() - 2, block, block),
+               std::invalid_argument);
+  EXPECT_THROW(
+      builder.decode<double>(0, 0, block, Block::Zero(4, 3).eval()),
+      std::invalid_argument);
+  // The waves are not entirely decoded.
+  builder.decode<double>(0, 0, block, block);
+  EXPECT_THROW(builder.build(), std::runtime_error);
+
+  auto model = make();
+  model->add_constituent(kM2, Eigen::Matrix<std::complex<double>, -1, -1,
+                                            Eigen::RowMajor>::Zero(
+                                  lon.size(), lat.size()));
+  EXPECT_THROW(ModelBuilder<double>(model, {kS2}), std::invalid_argument);
+}
+
+}  // namespace perth
@@ -0,0 +1,130 @@
+#include "perth/model_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/storage.hpp"
+#include "perth/tidal_model.hpp"
+
+#include "test_models.hpp"
+
+namespace perth {
+
+template <typename T>
+static auto expect_same_model(const TidalModel<T>& expected,
+                              const TidalModel<T>& actual) -> void {
+  ASSERT_EQ(expected.identifiers(), actual.identifiers());
+  EXPECT_EQ(expected.row_major(), actual.row_major());
+  EXPECT_EQ(expected.lon().size(), actual.lon().size());
+  EXPECT_EQ(expected.lat().size(), actual.lat().size());
+  EXPECT_DOUBLE_EQ(expected.lon().start(), actual.lon().start());
+  EXPECT_DOUBLE_EQ(expected.lon().step(), actual.lon().step());
+  EXPECT_EQ(expected.lon().is_periodic(), actual.lon().is_periodic());
+  EXPECT_EQ(expected.lat().is_periodic(), actual.lat().is_periodic());
+  for (size_t ix = 0; ix < expected.size(); ++ix) {
+    auto lhs = expected.wave(ix);
+    auto rhs = actual.wave(ix);
+    ASSERT_EQ(lhs.size(), rhs.size());
+    ASSERT_EQ(expected.scale(ix), actual.scale(ix));
+    for (int64_t jx = 0; jx < lhs.size(); ++jx) {
+      auto lhs_value = WaveStorage<T>::decode(lhs(jx), expected.scale(ix));
+      auto rhs_value = WaveStorage<T>::decode(rhs(jx), actual.scale(ix));
+      if (std::isnan(lhs_value.real())) {
+        ASSERT_TRUE(std::isnan(rhs_value.real()));
+      } else {
+        ASSERT_EQ(lhs_value, rhs_value);
+      }
+    }
+  }
+  auto lhs_table = assemble_constituent_table(expected.identifiers());
+  auto rhs_table = assemble_constituent_table(actual.identifiers());
+  auto lhs_acc = expected.accelerator(0);
+  auto rhs_acc = actual.accelerator(0);
+  for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{179.8, -45.2},
+                             std::pair{-174.8, -84.8}}) {
+    EXPECT_EQ(expected.interpolate(x, y, lhs_table, lhs_acc.get()),
+              actual.interpolate(x, y, rhs_table, rhs_acc.get()));
+    for (auto ident : expected.identifiers()) {
+      EXPECT_EQ(lhs_table[ident].tide, rhs_table[ident].tide);
+    }
+  }
+}
+
+TEST(ModelCache, RoundTrip) {
+  auto path = ::testing::TempDir() + "model_cache.bin";
+  for (auto row_major : {true, false}) {
+    for (auto packed : {false, true}) {
+      auto model = tests::make_index_model(packed, row_major);
+      for (auto layout : {false, true}) {
+        save_model_cache(*model, path, layout);
+        EXPECT_EQ(model_cache_value_size(path), sizeof(float));
+        auto loaded = load_model_cache<float>(path);
+        EXPECT_EQ(loaded->packed(), layout);
+        expect_same_model(*model, *loaded);
+      }
+    }
+  }
+  // The layout of the model is used by default.
+  save_model_cache(*tests::make_index_model(true, true), path);
+  EXPECT_TRUE(load_model_cache<float>(path)->packed());
+  std::remove(path.c_str());
+}
+
+TEST(ModelCache, RoundTripStorage) {
+  auto path = ::testing::TempDir() + "model_cache_storage.bin";
+  for (auto packed : {false, true}) {
+    auto model = tests::make_index_model(packed, true);
+    auto int16 = convert_tidal_model<Int16>(*model);
+    save_model_cache(*int16, path);
+    EXPECT_EQ(model_cache_value_size(path), sizeof(int16_t));
+    EXPECT_THROW(load_model_cache<Float16>(path), std::invalid_argument);
+    expect_same_model(*int16, *load_model_cache<Int16>(path));
+
+    auto float16 = convert_tidal_model<Float16>(*model);
+    save_model_cache(*float16, path);
+    EXPECT_THROW(load_model_cache<Int16>(path), std::invalid_argument);
+    expect_same_model(*float16, *load_model_cache<Float16>(path));
+  }
+  std::remove(path.c_str());
+}
+
+TEST(ModelCache, InvalidFile) {
+  auto path = ::testing::TempDir() + "model_cache_invalid.bin";
+  EXPECT_THROW(load_model_cache<float>(path), std::runtime_error);
+
+  save_model_cache(*tests::make_index_model(false, true), path);
+  EXPECT_THROW(load_model_cache<double>(path), std::invalid_argument);
+
+  // Truncate the waves.
+  auto file = std::make_unique<MappedFile>(path);
+  auto size = file->size();
+  file.reset();
+  {
+    auto content = std::string(size / 2, '\0');
+    auto input = std::ifstream(path, std::ios::binary);
+    input.read(content.data(), static_cast<std::streamsize>(content.size()));
+    input.close();
+    auto output = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), static_cast<std::streamsize>(content.size()));
+  }
+  EXPECT_THROW(load_model_cache<float>(path), std::runtime_error);
+
+  {
+    auto output = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    output << "not a model cache, but long enough to hold a header........"
+              "...............................................................";
+  }
+  EXPECT_THROW(load_model_cache<float>(path), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+}  // namespace perth
@@ -4,6 +4,15 @@
 
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/doodson.hpp"
+#include "perth/math.hpp"
 
 namespace perth {
 
@@ -191,4 +200,73 @@ TEST(NodalCorrectionsTest, ComputeGroupNodalCorrections) {
   }
 }
 
+TEST(NodalCorrectionsTest, NodalCorrectionTable) {
+  auto constituents =
+      assemble_constituent_table(std::vector<Constituent>{}).keys_vector();
+  // 2020-01-01 to 2021-01-01
+  const auto start = 58849.0;
+  const auto end = 59215.0;
+  for (auto group_modulations : {false, true}) {
+    // The group modulations vary within a day.
+    auto table = NodalCorrectionTable(start, end,
+                                      group_modulations ? 0.125 : 1.0,
+                                      group_modulations, constituents);
+    auto f_tolerance = group_modulations ? 1e-6 : 1e-7;
+    auto u_tolerance = group_modulations ? 1e-3 : 1e-5;
+    EXPECT_TRUE(table.contains(start));
+    EXPECT_TRUE(table.contains(end));
+    EXPECT_FALSE(table.contains(end + 1));
+    auto corrections = std::vector<NodalCorrections>();
+    for (auto time = start; time <= end; time += 0.37) {
+      table.interpolate(time, corrections);
+      auto delta = calculate_delta_time(time + kModifiedJulianEpoch);
+      auto expected = compute_nodal_corrections(
+          calculate_celestial_vector(time, delta), group_modulations,
+          constituents);
+      ASSERT_EQ(corrections.size(), expected.size());
+      for (size_t ix = 0; ix < expected.size(); ++ix) {
+        EXPECT_NEAR(corrections[ix].f, expected[ix].f, f_tolerance);
+        EXPECT_NEAR(normalize_angle(corrections[ix].u - expected[ix].u), 0,
+                    u_tolerance);
+      }
+    }
+  }
+  EXPECT_THROW(NodalCorrectionTable(start, end, 0, false, constituents),
+               std::invalid_argument);
+  EXPECT_THROW(NodalCorrectionTable(end, start, 1, false, constituents),
+               std::invalid_argument);
+}
+
+TEST(NodalCorrectionsTest, NodalCorrectionBounds) {
+  auto constituents = assemble_constituent_table().keys_vector();
+  for (auto group_modulations : {false, true}) {
+    const auto& bounds = nodal_correction_bounds(group_modulations);
+    EXPECT_EQ(&bounds, &nodal_correction_bounds(group_modulations));
+    ASSERT_EQ(bounds.f.size(), constituents.size());
+    ASSERT_EQ(bounds.f_rate.size(), constituents.size());
+    ASSERT_EQ(bounds.u_rate.size(), constituents.size());
+    // Outside the span sampled: six hours steps over four years from 2035.
+    constexpr auto kStep = 0.25;
+    auto previous = std::vector<NodalCorrections>();
+    for (auto time = 64328.0; time < 64328.0 + 4 * 365.25; time += kStep) {
+      auto delta = calculate_delta_time(time + kModifiedJulianEpoch);
+      auto corrections = compute_nodal_corrections(
+          calculate_celestial_vector(time, delta), group_modulations,
+          constituents);
+      for (size_t ix = 0; ix < constituents.size(); ++ix) {
+        EXPECT_LE(std::abs(corrections[ix].f), bounds.f[ix]);
+        if (!previous.empty()) {
+          EXPECT_LE(std::abs(corrections[ix].f - previous[ix].f) / kStep,
+                    bounds.f_rate[ix]);
+          EXPECT_LE(std::abs(radians(normalize_angle(corrections[ix].u -
+                                                     previous[ix].u))) /
+                        kStep,
+                    bounds.u_rate[ix]);
+        }
+      }
+      previous = std::move(corrections);
+    }
+  }
+}
+
 }  // namespace perth
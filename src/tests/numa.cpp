@@ -0,0 +1,48 @@
+#include "perth/numa.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace perth {
+
+TEST(Numa, ParseCpuList) {
+  EXPECT_EQ(parse_cpu_list("0-3,8,10-11"),
+            (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(parse_cpu_list("5\n"), std::vector<size_t>{5});
+  EXPECT_EQ(parse_cpu_list("4,2-3,3"), (std::vector<size_t>{2, 3, 4}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+  EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("0-a"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("1,,2"), std::invalid_argument);
+}
+
+TEST(Numa, Topology) {
+  const auto& nodes = numa_nodes();
+  ASSERT_FALSE(nodes.empty());
+  for (const auto& cpus : nodes) {
+    EXPECT_FALSE(cpus.empty());
+  }
+  EXPECT_LT(current_numa_node(), nodes.size());
+  EXPECT_THROW(pin_thread_to_numa_node(nodes.size()), std::out_of_range);
+
+  // A thread pinned to a node reports it.
+  for (size_t ix = 0; ix < nodes.size(); ++ix) {
+    auto node = nodes.size();
+    auto pinned = false;
+    run_on_numa_node(ix, [&]() -> void {
+      node = current_numa_node();
+      pinned = true;
+    });
+    EXPECT_TRUE(pinned);
+    EXPECT_EQ(node, ix);
+  }
+  EXPECT_THROW(run_on_numa_node(0, []() -> void {
+                 throw std::runtime_error("error");
+               }),
+               std::runtime_error);
+}
+
+}  // namespace perth
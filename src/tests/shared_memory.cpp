@@ -0,0 +1,130 @@
+#include "perth/shared_memory.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/storage.hpp"
+#include "perth/tidal_model.hpp"
+
+#include "test_models.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace perth {
+
+using Wave = Eigen::Matrix<std::complex<float>, -1, -1, Eigen::RowMajor>;
+
+// Name of a segment unique to the process.
+static auto segment_name(const std::string& suffix) -> std::string {
+  return "perth-test-" + std::to_string(::getpid()) + "-" + suffix;
+}
+
+// True if the two models interpolate the same values.
+static auto same_values(const TidalModel<float>& expected,
+                        const TidalModel<float>& actual) -> bool {
+  auto lhs_table = assemble_constituent_table(expected.identifiers());
+  auto rhs_table = assemble_constituent_table(actual.identifiers());
+  auto lhs_acc = expected.accelerator(0);
+  auto rhs_acc = actual.accelerator(0);
+  for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{179.8, -45.2},
+                             std::pair{-174.8, -84.8}}) {
+    if (expected.interpolate(x, y, lhs_table, lhs_acc.get()) !=
+        actual.interpolate(x, y, rhs_table, rhs_acc.get())) {
+      return false;
+    }
+    for (const auto ident : expected.identifiers()) {
+      if (lhs_table[ident].tide != rhs_table[ident].tide) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(SharedMemory, CreateAttach) {
+  const auto name = segment_name("raw");
+  {
+    auto segment = SharedMemory(name, 4096);
+    EXPECT_EQ(segment.name(), "/" + name);
+    EXPECT_TRUE(segment.owner());
+    EXPECT_EQ(segment.size(), 4096);
+    std::memcpy(segment.mutable_data(), "perth", 6);
+
+    // The name is taken.
+    EXPECT_THROW(SharedMemory(name, 4096), std::runtime_error);
+
+    auto attached = SharedMemory("/" + name);
+    EXPECT_FALSE(attached.owner());
+    EXPECT_EQ(attached.size(), 4096);
+    EXPECT_STREQ(reinterpret_cast<const char*>(attached.data()), "perth");
+    EXPECT_THROW(static_cast<void>(attached.mutable_data()),
+                 std::logic_error);
+  }
+  // The segment is removed with the object that created it.
+  EXPECT_THROW(SharedMemory{name}, std::runtime_error);
+  EXPECT_FALSE(SharedMemory::remove(name));
+  EXPECT_THROW(SharedMemory{"a/b"}, std::invalid_argument);
+  EXPECT_THROW(SharedMemory{"/"}, std::invalid_argument);
+}
+
+TEST(SharedMemory, ShareModel) {
+  for (auto packed : {true, false}) {
+    const auto name = segment_name(packed ? "packed" : "planar");
+    auto model = tests::make_index_model(true);
+    auto shared = share_model(*model, name, packed);
+    EXPECT_EQ(shared->shared_memory(), "/" + name);
+    EXPECT_EQ(shared->packed(), packed);
+    EXPECT_TRUE(model->shared_memory().empty());
+    EXPECT_TRUE(same_values(*model, *shared));
+
+    auto attached = attach_model<float>(name);
+    EXPECT_EQ(attached->shared_memory(), "/" + name);
+    EXPECT_TRUE(same_values(*model, *attached));
+    EXPECT_THROW(attach_model<double>(name), std::invalid_argument);
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Another process maps the same waves.
+    auto pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+      auto ok = false;
+      try {
+        ok = same_values(*model, *attach_model<float>(name));
+      } catch (...) {
+      }
+      ::_exit(ok ? 0 : 1);
+    }
+    auto status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+#endif
+
+    // The attached model keeps its mapping once the segment is removed.
+    shared.reset();
+    EXPECT_THROW(attach_model<float>(name), std::runtime_error);
+    EXPECT_TRUE(same_values(*model, *attached));
+  }
+}
+
+TEST(SharedMemory, ForgetSegment) {
+  const auto name = segment_name("modified");
+  auto shared = share_model(*tests::make_index_model(false), name);
+  ASSERT_FALSE(shared->shared_memory().empty());
+  // A model modified no longer matches the segment.
+  auto wave = Wave::Zero(shared->lon().size(), shared->lat().size()).eval();
+  shared->add_constituent(kN2, wave);
+  EXPECT_TRUE(shared->shared_memory().empty());
+}
+
+}  // namespace perth
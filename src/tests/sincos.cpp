@@ -0,0 +1,49 @@
+#include "perth/sincos.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "perth/math.hpp"
+
+namespace perth {
+
+TEST(SinCosTest, MatchesStandardLibrary) {
+  auto generator = std::mt19937_64(42);
+  for (auto range : {1.0, 10.0, 1e3, 1e6}) {
+    auto distribution = std::uniform_real_distribution<double>(-range, range);
+    auto x = std::vector<double>(1001);
+    for (auto& item : x) {
+      item = distribution(generator);
+    }
+    auto sin = std::vector<double>(x.size());
+    auto cos = std::vector<double>(x.size());
+    sincos(x.data(), x.size(), sin.data(), cos.data());
+    for (size_t ix = 0; ix < x.size(); ++ix) {
+      EXPECT_NEAR(sin[ix], std::sin(x[ix]), 1e-15);
+      EXPECT_NEAR(cos[ix], std::cos(x[ix]), 1e-15);
+    }
+  }
+}
+
+TEST(SinCosTest, Quadrants) {
+  // Multiples of π/4, on both sides of zero, where the quadrant changes.
+  auto x = std::vector<double>();
+  for (int ix = -16; ix <= 16; ++ix) {
+    x.push_back(ix * pi<double>() / 4);
+  }
+  auto sin = std::vector<double>(x.size());
+  auto cos = std::vector<double>(x.size());
+  sincos(x.data(), x.size(), sin.data(), cos.data());
+  for (size_t ix = 0; ix < x.size(); ++ix) {
+    EXPECT_NEAR(sin[ix], std::sin(x[ix]), 1e-15);
+    EXPECT_NEAR(cos[ix], std::cos(x[ix]), 1e-15);
+  }
+  // Nothing is written for an empty array.
+  sincos(x.data(), 0, nullptr, nullptr);
+}
+
+}  // namespace perth
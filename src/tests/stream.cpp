@@ -0,0 +1,175 @@
+#include "perth/stream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/inference.hpp"
+#include "perth/math.hpp"
+#include "perth/tidal_model.hpp"
+#include "perth/tide.hpp"
+
+#include "test_models.hpp"
+
+namespace perth {
+
+// Synthetic model providing the main constituents required by the inference.
+static auto make_model() -> std::shared_ptr<TidalModel<float>> {
+  return tests::make_synthetic_model<float>(
+      Axis(0, 358, 2, 1e-6, true), Axis(-90, 90, 2),
+      {kQ1, kO1, kK1, kN2, kM2, kS2, kMm, kMf}, true, tests::no_land);
+}
+
+// Chunk of an along-track pass.
+static auto make_chunk(const int64_t index, const int64_t size) -> Chunk {
+  auto chunk = Chunk{};
+  chunk.lon = Eigen::VectorXd::LinSpaced(size, -180, 179).array() +
+              static_cast<double>(index);
+  chunk.lat = Eigen::VectorXd::LinSpaced(size, -66, 66);
+  chunk.time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    // 2020-01-01 + one second per point
+    chunk.time(ix) =
+        (1577836800LL + index * size + ix) * kMicrosecondsPerSecond;
+  }
+  return chunk;
+}
+
+TEST(BoundedQueue, PushPop) {
+  auto queue = BoundedQueue<int>(2);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_EQ(queue.size(), 2);
+
+  // A producer waits while the queue is full.
+  auto pushed = std::atomic<bool>{false};
+  auto producer = std::thread([&]() -> void {
+    queue.push(3);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(pushed);
+  EXPECT_EQ(queue.pop(), 1);
+  producer.join();
+  EXPECT_TRUE(pushed);
+
+  // The items queued remain to be popped once the queue is closed.
+  queue.close();
+  EXPECT_FALSE(queue.push(4));
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), 3);
+  EXPECT_EQ(queue.pop(), std::nullopt);
+
+  auto cancelled = BoundedQueue<int>(2);
+  cancelled.push(1);
+  cancelled.cancel();
+  EXPECT_EQ(cancelled.pop(), std::nullopt);
+
+  EXPECT_THROW(BoundedQueue<int>(0), std::invalid_argument);
+}
+
+TEST(Stream, Evaluate) {
+  auto perth = Perth<float>(make_model());
+  constexpr int64_t kChunks = 12;
+  constexpr int64_t kSize = 500;
+  constexpr size_t kMaxPending = 2;
+
+  auto read = std::atomic<int64_t>{0};
+  auto written = std::atomic<int64_t>{0};
+  auto max_in_flight = std::atomic<int64_t>{0};
+  auto source = [&]() -> std::optional<Chunk> {
+    if (read == kChunks) {
+      return std::nullopt;
+    }
+    // Chunks read but not written yet.
+    auto in_flight = read - written;
+    if (in_flight > max_in_flight) {
+      max_in_flight = in_flight;
+    }
+    return make_chunk(read++, kSize);
+  };
+  auto indices = std::vector<size_t>();
+  auto sink = [&](const size_t index, Chunk&& chunk,
+                  ChunkTides&& tides) -> void {
+    // A slow writer: the reader must not run ahead unboundedly.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto [tide, tide_lp, quality] =
+        perth.evaluate(chunk.lon, chunk.lat, chunk.time, 0,
+                       InterpolationType::kLinearAdmittance, 1);
+    for (int64_t ix = 0; ix < kSize; ++ix) {
+      ASSERT_EQ(tides.quality(ix), quality(ix));
+      EXPECT_DOUBLE_EQ(tides.tide(ix), tide(ix));
+      EXPECT_DOUBLE_EQ(tides.tide_lp(ix), tide_lp(ix));
+    }
+    indices.push_back(index);
+    ++written;
+  };
+  auto count = evaluate_stream(perth, source, sink, kMaxPending, 0,
+                               InterpolationType::kLinearAdmittance);
+  EXPECT_EQ(count, static_cast<size_t>(kChunks));
+  // The results are handed to the sink in the order of the source.
+  ASSERT_EQ(indices.size(), static_cast<size_t>(kChunks));
+  for (size_t ix = 0; ix < indices.size(); ++ix) {
+    EXPECT_EQ(indices[ix], ix);
+  }
+  EXPECT_LE(max_in_flight, static_cast<int64_t>(2 * kMaxPending + 3));
+
+  // Empty stream.
+  EXPECT_EQ(evaluate_stream(
+                perth, []() -> std::optional<Chunk> { return std::nullopt; },
+                sink),
+            0);
+  EXPECT_THROW(evaluate_stream(perth, source, sink, 0), std::invalid_argument);
+}
+
+TEST(Stream, Errors) {
+  auto perth = Perth<float>(make_model());
+  auto read = int64_t{0};
+  auto source = [&]() -> std::optional<Chunk> {
+    return make_chunk(read++, 100);
+  };
+  auto sink = [](size_t, Chunk&&, ChunkTides&&) -> void {};
+
+  // The exceptions of the source, of the evaluation and of the sink stop the
+  // pipeline and are rethrown to the caller.
+  auto failing_source = [&]() -> std::optional<Chunk> {
+    if (read == 3) {
+      throw std::runtime_error("read error");
+    }
+    return source();
+  };
+  EXPECT_THROW(evaluate_stream(perth, failing_source, sink),
+               std::runtime_error);
+
+  read = 0;
+  auto invalid_source = [&]() -> std::optional<Chunk> {
+    auto chunk = source();
+    chunk->lat.resize(10);
+    return chunk;
+  };
+  EXPECT_THROW(evaluate_stream(perth, invalid_source, sink),
+               std::invalid_argument);
+
+  read = 0;
+  auto failing_sink = [](const size_t index, Chunk&&, ChunkTides&&) -> void {
+    if (index == 2) {
+      throw std::runtime_error("write error");
+    }
+  };
+  EXPECT_THROW(evaluate_stream(perth, source, failing_sink),
+               std::runtime_error);
+}
+
+}  // namespace perth
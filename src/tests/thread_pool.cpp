@@ -0,0 +1,252 @@
+#include "perth/thread_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/numa.hpp"
+#include "perth/parallel_for.hpp"
+
+namespace perth {
+
+TEST(ThreadPool, Submit) {
+  auto pool = ThreadPool(4);
+  EXPECT_EQ(pool.size(), 4);
+  auto counter = std::atomic<size_t>(0);
+  {
+    auto other = ThreadPool(2);
+    for (size_t ix = 0; ix < 100; ++ix) {
+      other.submit([&counter] { counter.fetch_add(1); });
+    }
+    // The destructor waits for the queued tasks.
+  }
+  EXPECT_EQ(counter.load(), 100);
+
+  // A pool without workers runs the tasks in the calling thread.
+  auto inline_pool = ThreadPool(0);
+  inline_pool.submit([&counter] { counter.fetch_add(1); });
+  EXPECT_EQ(counter.load(), 101);
+}
+
+TEST(ThreadPool, ParallelFor) {
+  auto pool = ThreadPool(3);
+  for (auto num_lanes : {1, 2, 4, 16}) {
+    for (auto grain : {1, 7, 1000}) {
+      auto visits = std::vector<std::atomic<int>>(10'000);
+      pool.parallel_for(
+          [&visits](size_t start, size_t end) {
+            for (auto ix = start; ix < end; ++ix) {
+              visits[ix].fetch_add(1);
+            }
+          },
+          visits.size(), num_lanes, grain);
+      for (const auto& item : visits) {
+        ASSERT_EQ(item.load(), 1);
+      }
+    }
+  }
+}
+
+TEST(ThreadPool, Exception) {
+  auto pool = ThreadPool(3);
+  auto processed = std::atomic<size_t>(0);
+  EXPECT_THROW(pool.parallel_for(
+                   [&processed](size_t start, size_t end) {
+                     processed.fetch_add(end - start);
+                     if (start == 0) {
+                       throw std::runtime_error("error");
+                     }
+                   },
+                   1000, 4, 10),
+               std::runtime_error);
+  // The whole range is processed before the exception is rethrown.
+  EXPECT_EQ(processed.load(), 1000);
+}
+
+TEST(ThreadPool, Nested) {
+  auto pool = ThreadPool(2);
+  auto counter = std::atomic<size_t>(0);
+  // The inner loops must complete even if all the workers are busy with the
+  // outer loop.
+  pool.parallel_for(
+      [&](size_t start, size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          pool.parallel_for(
+              [&counter](size_t start, size_t end) {
+                counter.fetch_add(end - start);
+              },
+              100, 4, 10);
+        }
+      },
+      16, 4, 1);
+  EXPECT_EQ(counter.load(), 1600);
+}
+
+TEST(ThreadPool, Async) {
+  auto pool = ThreadPool(2);
+  auto future = pool.async([] { return 42; });
+  EXPECT_EQ(future.get(), 42);
+  auto failed = pool.async([]() -> int { throw std::runtime_error("error"); });
+  EXPECT_THROW(failed.get(), std::runtime_error);
+
+  // The tasks started asynchronously share the workers with their loops.
+  auto counter = std::atomic<size_t>(0);
+  auto futures = std::vector<std::future<void>>();
+  for (size_t ix = 0; ix < 8; ++ix) {
+    futures.emplace_back(pool.async([&] {
+      pool.parallel_for(
+          [&counter](size_t start, size_t end) {
+            counter.fetch_add(end - start);
+          },
+          100, 4, 10);
+    }));
+  }
+  for (auto& item : futures) {
+    item.get();
+  }
+  EXPECT_EQ(counter.load(), 800);
+
+  // The continuation receives the future ready.
+  auto promise = std::promise<int>();
+  pool.async([] { return 7; },
+             [&promise](std::future<int> result) {
+               promise.set_value(result.wait_for(std::chrono::seconds(0)) ==
+                                         std::future_status::ready
+                                     ? result.get()
+                                     : -1);
+             });
+  EXPECT_EQ(promise.get_future().get(), 7);
+
+  // A pool without workers runs the function before returning.
+  auto inline_pool = ThreadPool(0);
+  auto ready = inline_pool.async([] { return 1; });
+  EXPECT_EQ(ready.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+}
+
+TEST(ThreadPool, GuidedBlocks) {
+  auto pool = ThreadPool(3);
+  // The blocks claimed are contiguous and shrink as the range is consumed.
+  auto blocks = std::vector<std::pair<size_t, size_t>>();
+  auto mutex = std::mutex();
+  auto visits = std::vector<std::atomic<int>>(4096);
+  pool.parallel_for(
+      [&](size_t start, size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          visits[ix].fetch_add(1);
+        }
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        blocks.emplace_back(start, end);
+      },
+      visits.size(), 4, 16);
+  for (const auto& item : visits) {
+    ASSERT_EQ(item.load(), 1);
+  }
+  std::sort(blocks.begin(), blocks.end());
+  EXPECT_EQ(blocks.front().second - blocks.front().first, 4096 / 8);
+  for (size_t ix = 1; ix < blocks.size(); ++ix) {
+    EXPECT_EQ(blocks[ix].first, blocks[ix - 1].second);
+    EXPECT_LE(blocks[ix].second - blocks[ix].first,
+              blocks[ix - 1].second - blocks[ix - 1].first);
+  }
+  EXPECT_EQ(blocks.back().second, 4096);
+  EXPECT_LE(blocks.back().second - blocks.back().first, 16);
+}
+
+TEST(LoopCost, Schedule) {
+  auto cost = LoopCost();
+  EXPECT_EQ(cost.get(), 0);
+  // Not measured: the number of lanes is limited by the minimum size of a
+  // block, and the range is over-decomposed.
+  EXPECT_EQ(cost.schedule(1000, 16, 128), (std::pair<size_t, size_t>{8, 128}));
+  EXPECT_EQ(cost.schedule(100'000, 4, 128),
+            (std::pair<size_t, size_t>{4, 3125}));
+
+  // Cheap items: the blocks hold the work of kTargetBlockTime, and a small
+  // range is processed by a single lane.
+  cost.update(10 * 1000, 1000);
+  EXPECT_DOUBLE_EQ(cost.get(), 10);
+  EXPECT_EQ(cost.schedule(1000, 16, 128), (std::pair<size_t, size_t>{1, 5000}));
+  EXPECT_EQ(cost.schedule(1'000'000, 16, 128),
+            (std::pair<size_t, size_t>{16, 5000}));
+
+  // Expensive items: the minimum size of a block prevails.
+  cost.update(1e6 * 1000, 1000);
+  EXPECT_DOUBLE_EQ(cost.get(), 0.75 * 10 + 0.25 * 1e6);
+  EXPECT_EQ(cost.schedule(1000, 16, 1), (std::pair<size_t, size_t>{16, 1}));
+}
+
+TEST(ThreadPool, PinnedThreads) {
+  auto pool = ThreadPool(3, true);
+  EXPECT_TRUE(pool.pinned());
+  EXPECT_FALSE(ThreadPool(3).pinned());
+  // The workers know the node they are pinned to.
+  auto nodes = std::vector<std::atomic<size_t>>(numa_nodes().size());
+  pool.parallel_for(
+      [&nodes](size_t start, size_t end) {
+        nodes.at(current_numa_node()).fetch_add(end - start);
+      },
+      1000, 4, 1);
+  auto total = size_t{0};
+  for (const auto& item : nodes) {
+    total += item.load();
+  }
+  EXPECT_EQ(total, 1000);
+
+  ThreadPool::set_num_threads(3, true);
+  EXPECT_TRUE(ThreadPool::instance()->pinned());
+  ThreadPool::set_num_threads(0);
+  EXPECT_FALSE(ThreadPool::instance()->pinned());
+}
+
+TEST(ThreadPool, NumThreads) {
+  ThreadPool::set_num_threads(3);
+  EXPECT_EQ(ThreadPool::num_threads(), 3);
+  EXPECT_EQ(ThreadPool::instance()->size(), 2);
+
+  auto visits = std::vector<std::atomic<int>>(1000);
+  parallel_for(
+      [&visits](size_t start, size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          visits[ix].fetch_add(1);
+        }
+      },
+      visits.size(), 0, 10);
+  for (const auto& item : visits) {
+    ASSERT_EQ(item.load(), 1);
+  }
+
+  // A pool replaced during a loop started by one of its tasks, which holds
+  // it, is not destroyed by its worker at the end of the loop, but by the
+  // next replacement.
+  auto started = std::promise<void>();
+  auto resume = std::promise<void>();
+  auto future = ThreadPool::instance()->async(
+      [&started, gate = resume.get_future().share()] {
+        parallel_for(
+            [&](size_t /*start*/, size_t /*end*/) {
+              started.set_value();
+              gate.wait();
+            },
+            100, 1);
+      });
+  started.get_future().wait();
+  ThreadPool::set_num_threads(2);
+  resume.set_value();
+  future.get();
+
+  ThreadPool::set_num_threads(1);
+  EXPECT_EQ(ThreadPool::num_threads(), 1);
+  ThreadPool::set_num_threads(0);
+  EXPECT_GE(ThreadPool::num_threads(), 1);
+}
+
+}  // namespace perth
@@ -0,0 +1,568 @@
+#include "perth/tidal_model.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/math.hpp"
+#include "perth/numa.hpp"
+#include "perth/storage.hpp"
+#include "perth/tiles.hpp"
+
+#include "test_models.hpp"
+
+namespace perth {
+
+using Wave = Eigen::Matrix<std::complex<double>, -1, -1, Eigen::RowMajor>;
+
+// Build a synthetic wave whose values depend on the grid node and on the
+// constituent, so that any mix-up in the storage layout is detected.
+static auto make_wave(const Axis& lon, const Axis& lat, const double scale)
+    -> Wave {
+  auto wave = Wave(lon.size(), lat.size());
+  for (int64_t ix = 0; ix < lon.size(); ++ix) {
+    for (int64_t jx = 0; jx < lat.size(); ++jx) {
+      wave(ix, jx) = std::complex<double>(scale * (lon(ix) + 2 * lat(jx)),
+                                          scale * (lat(jx) - lon(ix)));
+    }
+  }
+  return wave;
+}
+
+static auto make_model(const bool packed)
+    -> std::shared_ptr<TidalModel<double>> {
+  auto lon = Axis(0, 359, 1, 1e-6, true);
+  auto lat = Axis(-90, 90, 1);
+  auto model = std::make_shared<TidalModel<double>>(lon, lat, true, packed);
+  model->add_constituent(kM2, make_wave(lon, lat, 1.0));
+  model->add_constituent(kS2, make_wave(lon, lat, 0.5));
+  model->add_constituent(kK1, make_wave(lon, lat, 0.25));
+  return model;
+}
+
+TEST(TidalModelTest, PackedLayoutMatchesPlanarLayout) {
+  auto planar = make_model(false);
+  auto packed = make_model(true);
+  EXPECT_FALSE(planar->packed());
+  EXPECT_TRUE(packed->packed());
+
+  // The staged constituents must be usable before packing.
+  auto acc_planar = planar->accelerator(0);
+  auto acc_packed = packed->accelerator(0);
+  auto table_planar = assemble_constituent_table(planar->identifiers());
+  auto table_packed = assemble_constituent_table(packed->identifiers());
+  EXPECT_EQ(packed->interpolate(10.3, 20.7, table_packed, acc_packed.get()),
+            Quality::kInterpolated);
+
+  packed->pack();
+  // Adding a constituent after packing stages it again.
+  packed->add_constituent(kO1,
+                          make_wave(Axis(0, 359, 1, 1e-6, true),
+                                    Axis(-90, 90, 1), 2.0));
+  planar->add_constituent(kO1,
+                          make_wave(Axis(0, 359, 1, 1e-6, true),
+                                    Axis(-90, 90, 1), 2.0));
+  EXPECT_EQ(packed->identifiers(), planar->identifiers());
+
+  for (auto step = 0; step < 2; ++step) {
+    for (const auto& [lon, lat] :
+         {std::pair{10.3, 20.7}, std::pair{359.5, -45.2},
+          std::pair{-170.25, 89.5}}) {
+      acc_planar = planar->accelerator(0);
+      acc_packed = packed->accelerator(0);
+      auto q1 = planar->interpolate(lon, lat, table_planar, acc_planar.get());
+      auto q2 = packed->interpolate(lon, lat, table_packed, acc_packed.get());
+      EXPECT_EQ(q1, q2);
+      for (auto ident : planar->identifiers()) {
+        EXPECT_NEAR(std::abs(table_planar[ident].tide -
+                             table_packed[ident].tide),
+                    0, 1e-12);
+      }
+    }
+    packed->pack();
+  }
+}
+
+TEST(TidalModelTest, GridOrder) {
+  auto lon = Axis(0, 359, 1, 1e-6, true);
+  auto lat = Axis(-90, 90, 1);
+  auto row_major = std::make_shared<TidalModel<double>>(lon, lat, true);
+  auto column_major = std::make_shared<TidalModel<double>>(lon, lat, false);
+  auto scale = 1.0;
+  for (auto ident : {kM2, kS2, kN2, kK1, kO1, kQ1}) {
+    auto wave = make_wave(lon, lat, scale);
+    row_major->add_constituent(ident, wave);
+    column_major->add_constituent(ident, Wave(wave.transpose()));
+    scale *= 0.5;
+  }
+  // The inference evaluated at the grid nodes must use the same latitudes.
+  const auto type = InterpolationType::kFourierAdmittance;
+  EXPECT_EQ(row_major->bake_inference(type),
+            column_major->bake_inference(type));
+
+  auto lhs_table = assemble_constituent_table(row_major->identifiers());
+  auto rhs_table = assemble_constituent_table(column_major->identifiers());
+  auto lhs_acc = row_major->accelerator(0);
+  auto rhs_acc = column_major->accelerator(0);
+  for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{359.5, -45.2},
+                             std::pair{-170.25, 89.5}}) {
+    EXPECT_EQ(row_major->interpolate(x, y, lhs_table, lhs_acc.get()),
+              column_major->interpolate(x, y, rhs_table, rhs_acc.get()));
+    for (auto ident : row_major->identifiers()) {
+      EXPECT_EQ(lhs_table[ident].tide, rhs_table[ident].tide);
+    }
+  }
+}
+
+TEST(TidalModelTest, UndefinedValues) {
+  auto lon = Axis(0, 9, 1);
+  auto lat = Axis(0, 9, 1);
+  for (auto packed : {false, true}) {
+    auto model = TidalModel<double>(lon, lat, true, packed);
+    auto wave = make_wave(lon, lat, 1.0);
+    wave(2, 2) = std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
+                                      std::numeric_limits<double>::quiet_NaN());
+    model.add_constituent(kM2, wave);
+    model.pack();
+    auto table = assemble_constituent_table(model.identifiers());
+    auto acc = model.accelerator(0);
+
+    // Outside the grid
+    EXPECT_EQ(model.interpolate(20, 20, table, acc.get()), Quality::kUndefined);
+    EXPECT_TRUE(std::isnan(table[kM2].tide.real()));
+
+    // One corner undefined
+    EXPECT_EQ(model.interpolate(2.5, 2.5, table, acc.get()),
+              Quality::kExtrapolated3);
+    EXPECT_FALSE(std::isnan(table[kM2].tide.real()));
+  }
+}
+
+TEST(TidalModelTest, MaxAmplitudes) {
+  for (auto packed : {false, true}) {
+    auto model = make_model(packed);
+    auto wave = make_wave(model->lon(), model->lat(), 1.0);
+    // The undefined values are ignored.
+    wave(359, 180) = std::complex<double>(
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::quiet_NaN());
+    model->add_constituent(kO1, wave);
+    model->pack();
+    const auto amplitudes = model->max_amplitudes(2);
+    ASSERT_EQ(amplitudes.size(), model->size());
+    // The largest modulus is reached at the corner undefined for O1.
+    const auto corner = std::abs(std::complex<double>(359 + 180, 90 - 359));
+    auto expected = 0.0;
+    for (const auto& value : wave.reshaped()) {
+      if (!std::isnan(value.real())) {
+        expected = std::max(expected, std::abs(value));
+      }
+    }
+    EXPECT_LT(expected, corner);
+    EXPECT_DOUBLE_EQ(amplitudes[0], corner);
+    EXPECT_DOUBLE_EQ(amplitudes[1], 0.5 * corner);
+    EXPECT_DOUBLE_EQ(amplitudes[2], 0.25 * corner);
+    EXPECT_DOUBLE_EQ(amplitudes[3], expected);
+  }
+}
+
+TEST(TidalModelTest, ValidityMap) {
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  auto lon = Axis(0, 9, 1);
+  auto lat = Axis(0, 9, 1);
+  auto m2 = make_wave(lon, lat, 1.0);
+  auto s2 = make_wave(lon, lat, 0.5);
+  // Land cell: all the constituents are undefined.
+  for (auto [ix, jx] : {std::pair{5, 5}, std::pair{5, 6}, std::pair{6, 5},
+                        std::pair{6, 6}}) {
+    m2(ix, jx) = s2(ix, jx) = std::complex<double>(nan, nan);
+  }
+  // Node where only one constituent is undefined.
+  s2(2, 2) = std::complex<double>(nan, nan);
+
+  for (auto packed : {false, true}) {
+    auto model = std::make_shared<TidalModel<double>>(lon, lat, true, packed);
+    model->add_constituent(kM2, m2);
+    model->add_constituent(kS2, s2);
+    model->pack();
+    auto int16 = convert_tidal_model<Int16>(*model);
+    auto table = assemble_constituent_table(model->identifiers());
+    auto acc = model->accelerator(0);
+
+    EXPECT_EQ(model->interpolate(5.5, 5.5, table, acc.get()),
+              Quality::kUndefined);
+    EXPECT_TRUE(std::isnan(table[kM2].tide.real()));
+    EXPECT_TRUE(std::isnan(table[kS2].tide.real()));
+    EXPECT_EQ(int16->interpolate(5.5, 5.5, table, acc.get()),
+              Quality::kUndefined);
+
+    EXPECT_EQ(model->interpolate(4.5, 4.5, table, acc.get()),
+              Quality::kExtrapolated3);
+    EXPECT_EQ(int16->interpolate(4.5, 4.5, table, acc.get()),
+              Quality::kExtrapolated3);
+
+    // The mixed node is handled constituent by constituent: M2 uses the
+    // four corners, S2 only three.
+    auto quality = model->interpolate(2.25, 2.5, table, acc.get());
+    EXPECT_EQ(quality, Quality::kExtrapolated3);
+    auto n = int64_t{0};
+    auto wxy = bilinear_weights(2.25, 2.5, 2.0, 2.0, 3.0, 3.0);
+    auto expected = bilinear_interpolation<std::complex<double>>(
+        std::get<0>(wxy), std::get<1>(wxy), std::get<2>(wxy),
+        std::get<3>(wxy), m2(2, 2), m2(2, 3), m2(3, 2), m2(3, 3), n);
+    EXPECT_EQ(n, 4);
+    EXPECT_NEAR(std::abs(table[kM2].tide - expected), 0, 1e-12);
+    expected = bilinear_interpolation<std::complex<double>>(
+        std::get<0>(wxy), std::get<1>(wxy), std::get<2>(wxy),
+        std::get<3>(wxy), s2(2, 2), s2(2, 3), s2(3, 2), s2(3, 3), n);
+    EXPECT_EQ(n, 3);
+    EXPECT_NEAR(std::abs(table[kS2].tide - expected), 0, 1e-12);
+  }
+}
+
+TEST(TidalModelTest, DenseOutput) {
+  auto model = make_model(true);
+  model->pack();
+  auto table = assemble_constituent_table(model->identifiers());
+  auto acc = model->accelerator(0);
+  auto values = std::vector<std::complex<double>>(model->size());
+  for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{359.5, -0.5},
+                             std::pair{10.0, 95.0}}) {
+    auto quality = model->interpolate(x, y, values.data(), acc.get());
+    EXPECT_EQ(model->interpolate(x, y, table, acc.get()), quality);
+    auto identifiers = model->identifiers();
+    for (size_t ix = 0; ix < identifiers.size(); ++ix) {
+      if (quality == Quality::kUndefined) {
+        EXPECT_TRUE(std::isnan(values[ix].real()));
+        EXPECT_TRUE(std::isnan(table[identifiers[ix]].tide.real()));
+      } else {
+        EXPECT_EQ(values[ix], table[identifiers[ix]].tide);
+      }
+    }
+  }
+}
+
+TEST(TidalModelTest, CellCache) {
+  for (auto packed : {false, true}) {
+    auto model = make_model(packed);
+    model->pack();
+    auto table = assemble_constituent_table(model->identifiers());
+    auto expected = assemble_constituent_table(model->identifiers());
+    auto acc = Accelerator(0, model->size(), 2);
+
+    // Points inside the same cell, then alternating between three cells,
+    // more than the cache holds.
+    for (const auto& [x, y] :
+         {std::pair{10.1, 20.1}, std::pair{10.9, 20.4}, std::pair{10.5, 20.9},
+          std::pair{11.5, 20.5}, std::pair{10.5, 20.5}, std::pair{11.2, 20.2},
+          std::pair{12.5, 20.5}, std::pair{10.7, 20.1}, std::pair{359.5, 0.5},
+          std::pair{-0.2, 0.8}}) {
+      auto reference = model->accelerator(0);
+      auto quality = model->interpolate(x, y, expected, reference.get());
+      EXPECT_EQ(model->interpolate(x, y, table, &acc), quality);
+      EXPECT_EQ(acc.x1(), reference->x1());
+      EXPECT_EQ(acc.y2(), reference->y2());
+      for (auto ident : model->identifiers()) {
+        EXPECT_NEAR(std::abs(table[ident].tide - expected[ident].tide), 0,
+                    1e-12);
+      }
+    }
+  }
+}
+
+TEST(TidalModelTest, Storage) {
+  // Conversions to half precision
+  EXPECT_EQ(float_to_half(1.0F), 0x3c00);
+  EXPECT_EQ(float_to_half(-2.5F), 0xc100);
+  EXPECT_EQ(float_to_half(65536.0F), 0x7c00);
+  EXPECT_EQ(half_to_float(0x3555), 0.333251953125F);
+  EXPECT_EQ(half_to_float(0x0001), 5.9604644775390625e-08F);
+  EXPECT_TRUE(std::isnan(half_to_float(float_to_half(std::nanf("")))));
+  for (uint32_t bits = 0; bits < 0x7c00; ++bits) {
+    ASSERT_EQ(float_to_half(half_to_float(static_cast<uint16_t>(bits))),
+              bits);
+  }
+
+  auto lon = Axis(0, 9, 1);
+  auto lat = Axis(0, 9, 1);
+  auto wave = make_wave(lon, lat, 1.0);
+  wave(2, 2) = std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
+                                    std::numeric_limits<double>::quiet_NaN());
+  for (auto packed : {false, true}) {
+    auto model = TidalModel<double>(lon, lat, true, packed);
+    model.add_constituent(kM2, wave);
+    model.add_constituent(kS2, make_wave(lon, lat, 1e-3));
+    model.pack();
+    auto float16 = convert_tidal_model<Float16>(model);
+    auto int16 = convert_tidal_model<Int16>(model);
+    EXPECT_EQ(float16->identifiers(), model.identifiers());
+    EXPECT_EQ(int16->packed(), packed);
+    // The largest value of M2 is 27: its resolution is 27 / 32767.
+    EXPECT_DOUBLE_EQ(int16->scale(0), 27.0 / 32767);
+
+    auto expected = assemble_constituent_table(model.identifiers());
+    auto table = assemble_constituent_table(model.identifiers());
+    for (const auto& [x, y] : {std::pair{2.5, 2.5}, std::pair{5.3, 7.1},
+                               std::pair{8.9, 0.2}, std::pair{20.0, 2.0}}) {
+      auto quality =
+          model.interpolate(x, y, expected, model.accelerator(0).get());
+      EXPECT_EQ(float16->interpolate(x, y, table,
+                                     float16->accelerator(0).get()),
+                quality);
+      for (auto ident : model.identifiers()) {
+        auto value = expected[ident].tide;
+        if (quality == kUndefined) {
+          EXPECT_TRUE(std::isnan(table[ident].tide.real()));
+          continue;
+        }
+        EXPECT_LE(std::abs(table[ident].tide - value),
+                  std::abs(value) * 1e-3);
+      }
+      EXPECT_EQ(int16->interpolate(x, y, table, int16->accelerator(0).get()),
+                quality);
+      for (size_t ix = 0; ix < model.size() && quality != kUndefined; ++ix) {
+        auto ident = model.identifiers()[ix];
+        EXPECT_LE(std::abs(table[ident].tide - expected[ident].tide),
+                  int16->scale(ix));
+      }
+    }
+  }
+}
+
+TEST(TidalModelTest, ExternalBuffers) {
+  auto lon = Axis(0, 359, 1, 1e-6, true);
+  auto lat = Axis(-90, 90, 1);
+  auto reference = make_model(false);
+  auto m2 = std::make_shared<Wave>(make_wave(lon, lat, 1.0));
+  auto s2 = std::make_shared<Wave>(make_wave(lon, lat, 0.5));
+  auto k1 = std::make_shared<Wave>(make_wave(lon, lat, 0.25));
+
+  // Interleave the waves as the packed layout expects them.
+  auto interleaved = std::make_shared<std::vector<std::complex<double>>>();
+  for (int64_t ix = 0; ix < m2->size(); ++ix) {
+    for (const auto& wave : {m2, s2, k1}) {
+      interleaved->push_back(wave->data()[ix]);
+    }
+  }
+
+  auto keeper = std::weak_ptr<const void>(m2);
+  auto packed_keeper = std::weak_ptr<const void>(interleaved);
+  {
+    auto planar = std::make_shared<TidalModel<double>>(lon, lat, true, false);
+    planar->add_constituent(kM2, m2->data(), m2);
+    planar->add_constituent(kS2, s2->data(), s2);
+    planar->add_constituent(kK1, k1->data(), k1);
+    // Duplicates are ignored.
+    planar->add_constituent(kK1, m2->data(), m2);
+
+    auto packed = std::make_shared<TidalModel<double>>(lon, lat, true, true);
+    packed->assign_packed({kM2, kS2, kK1}, interleaved->data(), interleaved);
+    EXPECT_THROW(packed->assign_packed({kM2}, interleaved->data(), nullptr),
+                 std::invalid_argument);
+    EXPECT_THROW(planar->assign_packed({kO1}, interleaved->data(), nullptr),
+                 std::invalid_argument);
+    EXPECT_EQ(packed->identifiers(), reference->identifiers());
+    EXPECT_EQ(planar->identifiers(), reference->identifiers());
+
+    // The models now hold the only references on the waves.
+    m2.reset();
+    s2.reset();
+    k1.reset();
+    interleaved.reset();
+    EXPECT_FALSE(keeper.expired());
+    EXPECT_FALSE(packed_keeper.expired());
+
+    auto table = assemble_constituent_table(reference->identifiers());
+    auto expected = assemble_constituent_table(reference->identifiers());
+    for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{359.5, -45.2},
+                               std::pair{-170.25, 89.5}}) {
+      auto acc = reference->accelerator(0);
+      auto quality = reference->interpolate(x, y, expected, acc.get());
+      for (const auto& model : {planar, packed}) {
+        acc = model->accelerator(0);
+        EXPECT_EQ(model->interpolate(x, y, table, acc.get()), quality);
+        for (auto ident : reference->identifiers()) {
+          EXPECT_NEAR(std::abs(table[ident].tide - expected[ident].tide), 0,
+                      1e-12);
+        }
+      }
+    }
+  }
+  // The references are released with the models.
+  EXPECT_TRUE(keeper.expired());
+  EXPECT_TRUE(packed_keeper.expired());
+}
+
+TEST(TidalModelTest, Tiles) {
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  auto lon = Axis(0, 359, 1, 1e-6, true);
+  auto lat = Axis(-90, 90, 1);
+  auto m2 = make_wave(lon, lat, 1.0);
+  auto s2 = make_wave(lon, lat, 0.5);
+  // Land patch, and a node where only one constituent is undefined.
+  m2.block(40, 100, 5, 5).setConstant(std::complex<double>(nan, nan));
+  s2.block(40, 100, 5, 5).setConstant(std::complex<double>(nan, nan));
+  s2(200, 50) = std::complex<double>(nan, nan);
+  auto reference = std::make_shared<TidalModel<double>>(lon, lat, true, true);
+  reference->add_constituent(kM2, m2);
+  reference->add_constituent(kS2, s2);
+  reference->pack();
+
+  // Tiles of 16 by 16 nodes, at most 6 held in memory.
+  auto loader = std::make_shared<tests::ModelTileLoader<double>>(reference);
+  const auto tile_bytes = 16 * 16 * 2 * sizeof(std::complex<double>);
+  auto model = std::make_shared<TidalModel<double>>(lon, lat, true, true);
+  model->use_tiles(loader, 16, 6 * tile_bytes);
+  ASSERT_TRUE(model->tiled());
+  EXPECT_FALSE(reference->tiled());
+  EXPECT_EQ(model->identifiers(), reference->identifiers());
+  EXPECT_EQ(model->tiles()->size(), 23 * 12);
+  EXPECT_EQ(model->tiles()->resident(), 0);
+
+  auto expected = std::vector<std::complex<double>>(model->size());
+  auto actual = std::vector<std::complex<double>>(model->size());
+  auto reference_acc = reference->accelerator(0);
+  auto acc = model->accelerator(0);
+  // Points within a cell straddling four tiles, near the land patch, the
+  // mixed node and the periodic boundary, then spread over the grid.
+  auto points = std::vector<std::pair<double, double>>{
+      {15.5, -74.5}, {41.5, 11.5}, {39.5, 9.5},   {200.5, -40.5},
+      {199.5, -39.5}, {359.5, 0.5}, {-0.25, 89.5}, {10.0, 95.0}};
+  for (int ix = 0; ix < 200; ++ix) {
+    points.emplace_back(ix * 7.3, -85 + ix * 0.85);
+  }
+  for (const auto& [x, y] : points) {
+    auto quality = reference->interpolate(x, y, expected.data(),
+                                          reference_acc.get());
+    EXPECT_EQ(model->interpolate(x, y, actual.data(), acc.get()), quality);
+    for (size_t ix = 0; ix < expected.size(); ++ix) {
+      if (quality == Quality::kUndefined) {
+        EXPECT_TRUE(std::isnan(actual[ix].real()));
+      } else {
+        EXPECT_NEAR(std::abs(actual[ix] - expected[ix]), 0, 1e-12);
+      }
+    }
+    EXPECT_LE(model->tiles()->memory_usage(), 6 * tile_bytes);
+  }
+  EXPECT_EQ(model->tiles()->resident(), 6);
+  EXPECT_GT(model->tiles()->reads(), 6);
+
+  // Without budget, only the tiles touched are read, once.
+  model = std::make_shared<TidalModel<double>>(lon, lat, true, true);
+  model->use_tiles(loader, 16);
+  acc = model->accelerator(0);
+  for (const auto& [x, y] : {std::pair{10.5, 18.5}, std::pair{11.5, 18.5},
+                             std::pair{12.5, 19.5}, std::pair{10.5, 18.5}}) {
+    model->interpolate(x, y, actual.data(), acc.get());
+  }
+  EXPECT_EQ(model->tiles()->reads(), 1);
+  EXPECT_EQ(model->tiles()->memory_usage(), tile_bytes);
+
+  // The waves of a tiled model are only read by tiles.
+  EXPECT_THROW(model->add_constituent(kK1, m2), std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(model->wave(0)), std::invalid_argument);
+  EXPECT_THROW(model->use_tiles(loader), std::invalid_argument);
+  EXPECT_THROW(reference->use_tiles(loader), std::invalid_argument);
+  auto empty = std::make_shared<TidalModel<double>>(lon, lat, true, true);
+  EXPECT_THROW(empty->use_tiles(nullptr), std::invalid_argument);
+  EXPECT_THROW(empty->use_tiles(loader, 0), std::invalid_argument);
+  EXPECT_FALSE(empty->tiled());
+}
+
+TEST(TidalModelTest, Replicas) {
+  for (const auto packed : {false, true}) {
+    auto reference = make_model(packed);
+    auto model = make_model(packed);
+    // Part of the constituents staged, the others packed.
+    model->pack();
+    reference->pack();
+    model->add_constituent(kO1, make_wave(model->lon(), model->lat(), 2.0));
+    reference->add_constituent(kO1,
+                               make_wave(model->lon(), model->lat(), 2.0));
+
+    // One copy per node, none on a machine with a single node.
+    model->replicate();
+    EXPECT_EQ(model->replicas(),
+              numa_nodes().size() > 1 ? numa_nodes().size() : 0);
+    model->replicate(3);
+    EXPECT_EQ(model->replicas(), 3);
+
+    auto expected = std::vector<std::complex<double>>(model->size());
+    auto actual = std::vector<std::complex<double>>(model->size());
+    auto reference_acc = reference->accelerator(0);
+    auto acc = model->accelerator(0);
+    for (const auto& [x, y] : {std::pair{10.3, 20.7}, std::pair{359.5, -45.2},
+                               std::pair{-170.25, 89.5}}) {
+      EXPECT_EQ(model->interpolate(x, y, actual.data(), acc.get()),
+                reference->interpolate(x, y, expected.data(),
+                                       reference_acc.get()));
+      for (size_t ix = 0; ix < expected.size(); ++ix) {
+        EXPECT_EQ(actual[ix], expected[ix]);
+      }
+    }
+
+    // Modifying the waves releases the copies.
+    model->add_constituent(kK2, make_wave(model->lon(), model->lat(), 3.0));
+    EXPECT_EQ(model->replicas(), 0);
+  }
+}
+
+TEST(TidalModelTest, InterpolateMany) {
+  auto model = make_model(true);
+  model->pack();
+  // Points inside the grid, outside it, and in a cell with undefined nodes.
+  auto wave = make_wave(model->lon(), model->lat(), 0.1);
+  wave(20, 30) = std::complex<double>(std::numeric_limits<double>::quiet_NaN(),
+                                      std::numeric_limits<double>::quiet_NaN());
+  model->add_constituent(kO1, wave);
+  model->pack();
+  auto lon = Eigen::VectorXd(1000);
+  auto lat = Eigen::VectorXd(1000);
+  for (Eigen::Index ix = 0; ix < lon.size(); ++ix) {
+    lon(ix) = ix * 0.37;
+    lat(ix) = -95 + ix * 0.19;
+  }
+  lon(0) = 20.5;
+  lat(0) = -59.5;
+
+  for (const auto num_threads : {1, 0}) {
+    const auto [values, quality] =
+        model->interpolate_many(lon, lat, static_cast<size_t>(num_threads));
+    ASSERT_EQ(values.rows(), lon.size());
+    ASSERT_EQ(values.cols(), 4);
+    ASSERT_EQ(quality.size(), lon.size());
+    EXPECT_EQ(quality(0), Quality::kExtrapolated3);
+
+    auto acc = model->accelerator(0);
+    auto expected = std::vector<std::complex<double>>(model->size());
+    auto undefined = 0;
+    for (Eigen::Index ix = 0; ix < lon.size(); ++ix) {
+      const auto q = model->interpolate(lon(ix), lat(ix), expected.data(),
+                                        acc.get());
+      ASSERT_EQ(quality(ix), q);
+      undefined += static_cast<int>(q == Quality::kUndefined);
+      for (size_t jx = 0; jx < expected.size(); ++jx) {
+        const auto value = values(ix, static_cast<Eigen::Index>(jx));
+        if (std::isnan(expected[jx].real())) {
+          EXPECT_TRUE(std::isnan(value.real()));
+        } else {
+          EXPECT_EQ(value, expected[jx]);
+        }
+      }
+    }
+    EXPECT_GT(undefined, 0);
+  }
+  EXPECT_THROW(model->interpolate_many(lon, lat.head(10)),
+               std::invalid_argument);
+}
+
+}  // namespace perth
@@ -0,0 +1,816 @@
+#include "perth/tide.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "perth/axis.hpp"
+#include "perth/constituent.hpp"
+#include "perth/datetime.hpp"
+#include "perth/delta_t.hpp"
+#include "perth/doodson.hpp"
+#include "perth/hilbert.hpp"
+#include "perth/inference.hpp"
+#include "perth/nodal_corrections.hpp"
+#include "perth/tidal_model.hpp"
+#include "perth/tiles.hpp"
+
+#include "test_models.hpp"
+
+namespace perth {
+
+using Wave = Eigen::Matrix<std::complex<float>, -1, -1, Eigen::RowMajor>;
+
+// Synthetic model providing the main constituents required by the inference.
+static auto make_model(const bool packed = false)
+    -> std::shared_ptr<TidalModel<float>> {
+  return tests::make_synthetic_model<float>(
+      Axis(0, 358, 2, 1e-6, true), Axis(-90, 90, 2),
+      {kQ1, kO1, kP1, kK1, kN2, kM2, kS2, kK2, kMm, kMf, kM4}, packed,
+      tests::land_patch(10, 10));
+}
+
+// Reference implementation of the harmonic summation, over all the
+// constituents of the table.
+static auto reference(const TidalModel<float>& model, const double lon,
+                      const double lat, const int64_t epoch,
+                      const std::optional<InterpolationType>& inference_type,
+                      const bool group_modulations)
+    -> std::tuple<double, double, Quality> {
+  auto table = assemble_constituent_table(model.identifiers());
+  auto acc = model.accelerator(0);
+  auto quality = model.interpolate(lon, lat, table, acc.get());
+  if (quality == kUndefined) {
+    return {std::nan(""), std::nan(""), quality};
+  }
+  if (inference_type) {
+    Inference(table, *inference_type)(table, lat);
+  }
+  auto time = epoch_to_modified_julian_date(epoch);
+  auto delta = calculate_delta_time(time + kModifiedJulianEpoch);
+  auto args = calculate_celestial_vector(time, delta);
+  auto corrections =
+      group_modulations
+          ? compute_nodal_corrections(args(5), -args(4), args(3), args(2),
+                                      table.keys_vector())
+          : compute_nodal_corrections(-args(4), args(3), table.keys_vector());
+  auto tide = 0.0;
+  auto tide_lp = 0.0;
+  for (size_t ix = 0; ix < table.size(); ++ix) {
+    const auto& item = table.items()[ix];
+    auto v = calculate_doodson_argument(time, delta,
+                                        item.doodson_number.cast<double>());
+    auto x = radians(v + corrections[ix].u);
+    auto h = corrections[ix].f *
+             (item.tide.real() * std::cos(x) + item.tide.imag() * std::sin(x));
+    (item.type == kLongPeriod ? tide_lp : tide) += h;
+  }
+  return {tide, tide_lp, quality};
+}
+
+class PerthTest : public ::testing::TestWithParam<std::tuple<bool, bool>> {
+ protected:
+  void SetUp() override {
+    lon_ = Eigen::VectorXd::LinSpaced(64, -180, 179);
+    lat_ = Eigen::VectorXd::LinSpaced(64, -70, 70);
+    time_ = Eigen::Vector<int64_t, -1>(64);
+    for (int64_t ix = 0; ix < time_.size(); ++ix) {
+      // 2020-01-01 + ix * 37 minutes
+      time_(ix) = (1577836800LL + ix * 2220) * kMicrosecondsPerSecond;
+    }
+    // Point inside the land patch
+    lon_(3) = 23;
+    lat_(3) = -65;
+  }
+
+  Eigen::VectorXd lon_;
+  Eigen::VectorXd lat_;
+  Eigen::Vector<int64_t, -1> time_;
+};
+
+TEST_P(PerthTest, Evaluate) {
+  auto [packed, group_modulations] = GetParam();
+  auto model = make_model(packed);
+  auto perth = Perth<float>(model, group_modulations);
+  for (auto inference_type :
+       {std::optional<InterpolationType>{},
+        std::optional<InterpolationType>{InterpolationType::kLinearAdmittance},
+        std::optional<InterpolationType>{
+            InterpolationType::kFourierAdmittance}}) {
+    auto [tide, tide_lp, quality] =
+        perth.evaluate(lon_, lat_, time_, 0, inference_type, 2);
+    for (int64_t ix = 0; ix < lon_.size(); ++ix) {
+      auto [expected, expected_lp, expected_quality] =
+          reference(*model, lon_(ix), lat_(ix), time_(ix), inference_type,
+                    group_modulations);
+      ASSERT_EQ(quality(ix), static_cast<int8_t>(expected_quality));
+      if (expected_quality == kUndefined) {
+        EXPECT_TRUE(std::isnan(tide(ix)));
+        EXPECT_TRUE(std::isnan(tide_lp(ix)));
+        continue;
+      }
+      EXPECT_NEAR(tide(ix), expected, 1e-9);
+      EXPECT_NEAR(tide_lp(ix), expected_lp, 1e-9);
+    }
+  }
+}
+
+TEST_F(PerthTest, Undefined) {
+  auto perth = Perth<float>(make_model());
+  auto [tide, tide_lp, quality] = perth.evaluate(lon_, lat_, time_);
+  EXPECT_EQ(quality(3), static_cast<int8_t>(kUndefined));
+  EXPECT_TRUE(std::isnan(tide(3)));
+  EXPECT_EQ(quality(4), static_cast<int8_t>(kInterpolated));
+}
+
+TEST_F(PerthTest, StagedConstituents) {
+  // The predictor does not pack the shared model: the staged constituents
+  // are interpolated from their own arrays.
+  auto model = make_model(true);
+  auto packed = make_model(true);
+  auto wave = Wave(model->lon().size(), model->lat().size());
+  wave.setConstant(std::complex<float>(0.01F, -0.02F));
+  model->add_constituent(k2N2, wave);
+  packed->add_constituent(k2N2, wave);
+  packed->pack();
+  auto [expected, expected_lp, expected_quality] =
+      Perth<float>(packed).evaluate(lon_, lat_, time_);
+  auto [tide, tide_lp, quality] =
+      Perth<float>(model).evaluate(lon_, lat_, time_);
+  EXPECT_EQ(quality, expected_quality);
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) != static_cast<int8_t>(kUndefined)) {
+      EXPECT_DOUBLE_EQ(tide(ix), expected(ix));
+      EXPECT_DOUBLE_EQ(tide_lp(ix), expected_lp(ix));
+    }
+  }
+}
+
+TEST_F(PerthTest, Threads) {
+  auto perth = Perth<float>(make_model(true));
+  // Large enough to be split over the threads of the pool.
+  auto lon = Eigen::VectorXd(lon_.replicate(40, 1));
+  auto lat = Eigen::VectorXd(lat_.replicate(40, 1));
+  auto time = Eigen::Vector<int64_t, -1>(time_.replicate(40, 1));
+  auto [expected, expected_lp, expected_quality] =
+      perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance, 1);
+  // The evaluation contexts are reused between the calls and must be set up
+  // again when the inference changes.
+  for (auto inference_type :
+       {std::optional<InterpolationType>{InterpolationType::kLinearAdmittance},
+        std::optional<InterpolationType>{},
+        std::optional<InterpolationType>{InterpolationType::kLinearAdmittance}}) {
+    auto [tide, tide_lp, quality] =
+        perth.evaluate(lon, lat, time, 0, inference_type, 4);
+    ASSERT_EQ(quality, expected_quality);
+    if (inference_type) {
+      for (int64_t ix = 0; ix < tide.size(); ++ix) {
+        if (quality(ix) == static_cast<int8_t>(kUndefined)) {
+          continue;
+        }
+        ASSERT_NEAR(tide(ix), expected(ix), 1e-12);
+        ASSERT_NEAR(tide_lp(ix), expected_lp(ix), 1e-12);
+      }
+    }
+  }
+}
+
+TEST_F(PerthTest, Tiles) {
+  auto reference = make_model(true);
+  reference->pack();
+  auto tiled = std::make_shared<TidalModel<float>>(
+      reference->lon(), reference->lat(), true, true);
+  // Tiles of 8 by 8 nodes, within a budget of 4 tiles, shared by the
+  // threads.
+  tiled->use_tiles(
+      std::make_shared<tests::ModelTileLoader<float>>(reference), 8,
+      4 * 8 * 8 * reference->size() * sizeof(std::complex<float>));
+  auto lon = Eigen::VectorXd(lon_.replicate(40, 1));
+  auto lat = Eigen::VectorXd(lat_.replicate(40, 1));
+  auto time = Eigen::Vector<int64_t, -1>(time_.replicate(40, 1));
+  auto [expected, expected_lp, expected_quality] =
+      Perth<float>(reference).evaluate(lon, lat, time, 0,
+                                       InterpolationType::kLinearAdmittance, 1);
+  auto [tide, tide_lp, quality] = Perth<float>(tiled).evaluate(
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance, 4);
+  ASSERT_EQ(quality, expected_quality);
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) == static_cast<int8_t>(kUndefined)) {
+      continue;
+    }
+    ASSERT_NEAR(tide(ix), expected(ix), 1e-12);
+    ASSERT_NEAR(tide_lp(ix), expected_lp(ix), 1e-12);
+  }
+  EXPECT_LE(tiled->tiles()->resident(), 4);
+}
+
+TEST_F(PerthTest, Stats) {
+  auto perth = Perth<float>(make_model(true));
+  auto lon = Eigen::VectorXd(lon_.replicate(10, 1));
+  auto lat = Eigen::VectorXd(lat_.replicate(10, 1));
+  auto time = Eigen::Vector<int64_t, -1>(time_.replicate(10, 1));
+  auto [tide, tide_lp, quality] = perth.evaluate(
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance, 2);
+  auto stats = perth.last_stats();
+  if constexpr (!kProfiling) {
+    EXPECT_EQ(stats.points, 0);
+    EXPECT_EQ(stats.cell_hits + stats.cell_misses, 0);
+    EXPECT_EQ(stats.argument_updates, 0);
+    return;
+  }
+  EXPECT_EQ(stats.points, lon.size());
+  for (int8_t flag = 0; flag < 5; ++flag) {
+    EXPECT_EQ(stats.quality[flag], (quality.array() == flag).count());
+  }
+  // The cells without any defined corner are rejected before the cache.
+  EXPECT_EQ(stats.cell_hits + stats.cell_misses,
+            lon.size() - stats.quality[kUndefined]);
+  // Each point has a time different from the time of its predecessor: the
+  // arguments are updated for every point, except for the undefined ones.
+  EXPECT_EQ(stats.argument_updates, lon.size() - stats.quality[kUndefined]);
+  EXPECT_GT(stats.elapsed[kInterpolationStage], 0);
+  EXPECT_GT(stats.elapsed[kInferenceStage], 0);
+  EXPECT_GT(stats.elapsed[kArgumentsStage], 0);
+  EXPECT_GT(stats.elapsed[kSummationStage], 0);
+
+  // The counters describe the last evaluation only.
+  perth.evaluate_at_time(lon_, lat_, time_(0));
+  stats = perth.last_stats();
+  EXPECT_EQ(stats.points, lon_.size());
+  EXPECT_EQ(stats.elapsed[kInferenceStage], 0);
+}
+
+TEST_F(PerthTest, DeltaTimeSeries) {
+  auto perth = Perth<float>(make_model(true));
+  EXPECT_EQ(perth.delta_time_series(), nullptr);
+  auto [expected, expected_lp, expected_quality] =
+      perth.evaluate(lon_, lat_, time_);
+
+  // A series reproducing the model gives the same tides.
+  auto time = Eigen::Vector<int64_t, -1>(2);
+  time << time_(0), time_(time_.size() - 1);
+  auto delta = Eigen::VectorXd(2);
+  for (int64_t ix = 0; ix < time.size(); ++ix) {
+    delta(ix) = calculate_delta_time(
+        epoch_to_modified_julian_date(time(ix)) + kModifiedJulianEpoch);
+  }
+  perth.set_delta_time_series(time, delta);
+  ASSERT_NE(perth.delta_time_series(), nullptr);
+  auto [tide, tide_lp, quality] = perth.evaluate(lon_, lat_, time_);
+  EXPECT_EQ(quality, expected_quality);
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) != kUndefined) {
+      EXPECT_NEAR(tide(ix), expected(ix), 1e-12);
+    }
+  }
+
+  // A different Delta T shifts the arguments.
+  delta.array() += 3600;
+  perth.set_delta_time_series(time, delta);
+  std::tie(tide, tide_lp, quality) = perth.evaluate(lon_, lat_, time_);
+  auto difference = 0.0;
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) != kUndefined) {
+      difference = std::max(difference, std::abs(tide(ix) - expected(ix)));
+    }
+  }
+  EXPECT_GT(difference, 1e-3);
+
+  EXPECT_THROW(perth.set_delta_time_series(time.head(1), delta.head(1)),
+               std::invalid_argument);
+}
+
+TEST_P(PerthTest, NodalCorrectionTable) {
+  auto [packed, group_modulations] = GetParam();
+  auto perth = Perth<float>(make_model(packed), group_modulations);
+  auto [expected, expected_lp, expected_quality] =
+      perth.evaluate(lon_, lat_, time_);
+  EXPECT_EQ(perth.nodal_correction_table(), nullptr);
+  perth.tabulate_nodal_corrections(time_(0), time_(time_.size() - 1));
+  ASSERT_NE(perth.nodal_correction_table(), nullptr);
+  auto [tide, tide_lp, quality] = perth.evaluate(lon_, lat_, time_);
+  ASSERT_EQ(quality, expected_quality);
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) == static_cast<int8_t>(kUndefined)) {
+      continue;
+    }
+    EXPECT_NEAR(tide(ix), expected(ix), 1e-4);
+    EXPECT_NEAR(tide_lp(ix), expected_lp(ix), 1e-4);
+  }
+
+  // A table tabulating other constituents is not used.
+  auto table = assemble_constituent_table(perth.tidal_model()->identifiers());
+  auto keys = table.keys_vector();
+  std::reverse(keys.begin(), keys.end());
+  const auto t0 = epoch_to_modified_julian_date(time_(0));
+  auto acc = Accelerator(0, table.size());
+  acc.nodal_correction_table(std::make_shared<const NodalCorrectionTable>(
+      t0 - 1, t0 + 1, 1.0, group_modulations, keys));
+  ASSERT_TRUE(acc.update_args(t0, group_modulations ? 1 : 0, table));
+  auto delta = calculate_delta_time(t0 + kModifiedJulianEpoch);
+  auto corrections = compute_nodal_corrections(
+      calculate_celestial_vector(t0, delta), group_modulations,
+      table.keys_vector());
+  ASSERT_EQ(acc.nodal_corrections().size(), corrections.size());
+  for (size_t ix = 0; ix < corrections.size(); ++ix) {
+    EXPECT_DOUBLE_EQ(acc.nodal_corrections()[ix].f, corrections[ix].f);
+    EXPECT_DOUBLE_EQ(acc.nodal_corrections()[ix].u, corrections[ix].u);
+  }
+}
+
+TEST_F(PerthTest, SortByTime) {
+  auto perth = Perth<float>(make_model(true));
+  // Swath-like input: several points share each timestamp, interleaved.
+  auto size = lon_.size() * 8;
+  auto lon = Eigen::VectorXd(size);
+  auto lat = Eigen::VectorXd(size);
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    lon(ix) = lon_(ix % lon_.size());
+    lat(ix) = lat_((ix * 7) % lat_.size());
+    time(ix) = time_((ix * 13) % 5);
+  }
+  for (auto num_threads : {1, 4}) {
+    auto [expected, expected_lp, expected_quality] = perth.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, num_threads);
+    auto [tide, tide_lp, quality] =
+        perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+                       num_threads, true);
+    ASSERT_EQ(quality, expected_quality);
+    for (int64_t ix = 0; ix < size; ++ix) {
+      if (quality(ix) == static_cast<int8_t>(kUndefined)) {
+        EXPECT_TRUE(std::isnan(tide(ix)));
+        continue;
+      }
+      EXPECT_DOUBLE_EQ(tide(ix), expected(ix));
+      EXPECT_DOUBLE_EQ(tide_lp(ix), expected_lp(ix));
+    }
+  }
+}
+
+TEST_F(PerthTest, SortByCell) {
+  auto perth = Perth<float>(make_model(true));
+  // Points scattered over the globe, as in a merged multi-mission dataset.
+  auto size = lon_.size() * 8;
+  auto lon = Eigen::VectorXd(size);
+  auto lat = Eigen::VectorXd(size);
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    lon(ix) =
+        lon_((ix * 29) % lon_.size()) + 0.1 * static_cast<double>(ix % 3);
+    lat(ix) = lat_((ix * 7) % lat_.size());
+    time(ix) = time_((ix * 13) % 5);
+  }
+  for (auto num_threads : {1, 4}) {
+    auto [expected, expected_lp, expected_quality] = perth.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, num_threads);
+    for (auto sort_by_time : {false, true}) {
+      auto [tide, tide_lp, quality] = perth.evaluate(
+          lon, lat, time, 0, InterpolationType::kLinearAdmittance,
+          num_threads, sort_by_time, true);
+      ASSERT_EQ(quality, expected_quality);
+      for (int64_t ix = 0; ix < size; ++ix) {
+        if (quality(ix) == static_cast<int8_t>(kUndefined)) {
+          EXPECT_TRUE(std::isnan(tide(ix)));
+          continue;
+        }
+        EXPECT_DOUBLE_EQ(tide(ix), expected(ix));
+        EXPECT_DOUBLE_EQ(tide_lp(ix), expected_lp(ix));
+      }
+    }
+  }
+}
+
+TEST_P(PerthTest, BatchedBackend) {
+  auto [packed, group_modulations] = GetParam();
+  auto pointwise = Perth<float>(make_model(packed), group_modulations);
+  auto batched = Perth<float>(make_model(packed), group_modulations);
+  batched.set_backend(Backend::kBatched);
+  EXPECT_EQ(pointwise.backend(), Backend::kPointwise);
+  EXPECT_EQ(batched.backend(), Backend::kBatched);
+
+  // Swaths of points sharing a few times, given in descending order.
+  auto size = lon_.size() * 4;
+  auto lon = Eigen::VectorXd(size);
+  auto lat = Eigen::VectorXd(size);
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    lon(ix) = lon_(ix % lon_.size());
+    lat(ix) = lat_((ix * 7) % lat_.size());
+    time(ix) = time_(time_.size() - 1 - (ix / lon_.size()) * 3);
+  }
+  for (auto inference_type :
+       {std::optional<InterpolationType>{},
+        std::optional<InterpolationType>{InterpolationType::kLinearAdmittance},
+        std::optional<InterpolationType>{
+            InterpolationType::kFourierAdmittance}}) {
+    // With a tolerance, the times of a bucket depend on the order of the
+    // points: the pointwise backend processes them in the same order.
+    for (auto time_tolerance : {0.0, 0.1}) {
+      auto [expected, expected_lp, expected_quality] = pointwise.evaluate(
+          lon, lat, time, time_tolerance, inference_type, 1, true);
+      auto [tide, tide_lp, quality] =
+          batched.evaluate(lon, lat, time, time_tolerance, inference_type, 2);
+      for (int64_t ix = 0; ix < size; ++ix) {
+        ASSERT_EQ(quality(ix), expected_quality(ix));
+        if (expected_quality(ix) == static_cast<int8_t>(kUndefined)) {
+          EXPECT_TRUE(std::isnan(tide(ix)));
+          EXPECT_TRUE(std::isnan(tide_lp(ix)));
+          continue;
+        }
+        EXPECT_NEAR(tide(ix), expected(ix), 1e-9);
+        EXPECT_NEAR(tide_lp(ix), expected_lp(ix), 1e-9);
+      }
+    }
+  }
+}
+
+TEST_F(PerthTest, ExtrapolatedArguments) {
+  auto perth = Perth<float>(make_model());
+  EXPECT_EQ(perth.argument_mode(), ArgumentMode::kFrozen);
+
+  // A point sampled every ten seconds over six hours.
+  constexpr int64_t kSize = 2160;
+  auto lon = Eigen::VectorXd::Constant(kSize, 10.5).eval();
+  auto lat = Eigen::VectorXd::Constant(kSize, 20.5).eval();
+  auto time = Eigen::Vector<int64_t, -1>(kSize);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    time(ix) = (1577836800LL + 10 * ix) * kMicrosecondsPerSecond;
+  }
+  // The accelerator compares the tolerance with modified Julian days: the
+  // arguments are computed once per hour.
+  constexpr double kTolerance = 1.0 / 24.0;
+  auto [expected, expected_lp, expected_quality] = perth.evaluate(
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance, 1);
+  auto [frozen, frozen_lp, frozen_quality] = perth.evaluate(
+      lon, lat, time, kTolerance, InterpolationType::kLinearAdmittance, 1);
+
+  perth.set_argument_mode(ArgumentMode::kExtrapolated);
+  EXPECT_EQ(perth.argument_mode(), ArgumentMode::kExtrapolated);
+  auto [tide, tide_lp, quality] = perth.evaluate(
+      lon, lat, time, kTolerance, InterpolationType::kLinearAdmittance, 1);
+
+  auto frozen_error = 0.0;
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    ASSERT_EQ(quality(ix), expected_quality(ix));
+    frozen_error = std::max(frozen_error, std::abs(frozen(ix) - expected(ix)));
+    // Only the nodal corrections are frozen over the hour.
+    EXPECT_NEAR(tide(ix), expected(ix), 1e-5);
+    EXPECT_NEAR(tide_lp(ix), expected_lp(ix), 1e-5);
+  }
+  EXPECT_GT(frozen_error, 1e-2);
+
+  // The accelerator restarts from computed arguments when the mode changes.
+  auto table = assemble_constituent_table(perth.tidal_model()->identifiers());
+  auto acc = Accelerator(kTolerance, table.size());
+  const auto t0 = epoch_to_modified_julian_date(time(0));
+  EXPECT_TRUE(acc.update_args(t0, 0, table));
+  EXPECT_FALSE(acc.update_args(t0 + 0.01, 0, table));
+  acc.argument_mode(ArgumentMode::kExtrapolated);
+  EXPECT_TRUE(acc.update_args(t0 + 0.01, 0, table));
+  auto expected_m2 = table[kM2].tidal_argument;
+  EXPECT_TRUE(acc.update_args(t0, 0, table));
+  EXPECT_TRUE(acc.update_args(t0 + 0.01, 0, table));
+  EXPECT_NEAR(table[kM2].tidal_argument, expected_m2, 1e-9);
+}
+
+TEST_F(PerthTest, ConstituentsAdded) {
+  // The contexts of the evaluations follow the constituents of the model.
+  auto model = make_model();
+  auto perth = Perth<float>(model);
+  auto before = perth.evaluate(lon_, lat_, time_, 0,
+                               InterpolationType::kLinearAdmittance);
+  auto wave = Wave::Constant(model->lon().size(), model->lat().size(),
+                             std::complex<float>(0.1F, -0.2F))
+                  .eval();
+  model->add_constituent(k2N2, wave);
+  auto [tide, tide_lp, quality] = perth.evaluate(
+      lon_, lat_, time_, 0, InterpolationType::kLinearAdmittance);
+  auto [expected, expected_lp, expected_quality] =
+      Perth<float>(model).evaluate(lon_, lat_, time_, 0,
+                                   InterpolationType::kLinearAdmittance);
+  auto changed = false;
+  for (int64_t ix = 0; ix < lon_.size(); ++ix) {
+    ASSERT_EQ(quality(ix), expected_quality(ix));
+    if (expected_quality(ix) == static_cast<int8_t>(kUndefined)) {
+      continue;
+    }
+    EXPECT_EQ(tide(ix), expected(ix));
+    EXPECT_EQ(tide_lp(ix), expected_lp(ix));
+    changed = changed || tide(ix) != std::get<0>(before)(ix);
+  }
+  EXPECT_TRUE(changed);
+}
+
+TEST_F(PerthTest, EvaluateInto) {
+  auto perth = Perth<float>(make_model(true));
+  auto size = lon_.size();
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    time(ix) = time_(ix % time_.size());
+  }
+  // Coordinates in float, as stored in many products.
+  Eigen::VectorXf lon = lon_.cast<float>();
+  Eigen::VectorXf lat = lat_.cast<float>();
+  auto [expected, expected_lp, expected_quality] = perth.evaluate(
+      lon.cast<double>(), lat.cast<double>(), time, 0,
+      InterpolationType::kLinearAdmittance);
+
+  // The results are written into every other element of larger buffers, and
+  // the inputs are read from strided views.
+  auto tide = Eigen::VectorXd::Constant(2 * size, -1.0).eval();
+  auto tide_lp = Eigen::VectorXd::Constant(2 * size, -1.0).eval();
+  auto quality = Eigen::Vector<int8_t, -1>::Constant(2 * size, -1).eval();
+  auto times = Eigen::Matrix<int64_t, -1, 2, Eigen::RowMajor>(size, 2);
+  times.col(0) = time;
+  auto stride = Eigen::InnerStride<>(2);
+  for (auto sort_by_cell : {false, true}) {
+    perth.evaluate_into<float>(
+        lon, lat, times.col(0),
+        Eigen::Map<Eigen::VectorXd, 0, Eigen::InnerStride<>>(tide.data(),
+                                                              size, stride),
+        Eigen::Map<Eigen::VectorXd, 0, Eigen::InnerStride<>>(tide_lp.data(),
+                                                              size, stride),
+        Eigen::Map<Eigen::Vector<int8_t, -1>, 0, Eigen::InnerStride<>>(
+            quality.data(), size, stride),
+        0, InterpolationType::kLinearAdmittance, 0, false, sort_by_cell);
+    for (int64_t ix = 0; ix < size; ++ix) {
+      ASSERT_EQ(quality(2 * ix), expected_quality(ix));
+      if (expected_quality(ix) == static_cast<int8_t>(kUndefined)) {
+        EXPECT_TRUE(std::isnan(tide(2 * ix)));
+      } else {
+        EXPECT_DOUBLE_EQ(tide(2 * ix), expected(ix));
+        EXPECT_DOUBLE_EQ(tide_lp(2 * ix), expected_lp(ix));
+      }
+      // The other elements are left untouched.
+      EXPECT_EQ(tide(2 * ix + 1), -1.0);
+      EXPECT_EQ(tide_lp(2 * ix + 1), -1.0);
+      EXPECT_EQ(quality(2 * ix + 1), -1);
+    }
+  }
+
+  // The outputs must match the inputs.
+  EXPECT_THROW(perth.evaluate_into<float>(lon, lat, time, tide, tide_lp,
+                                          quality),
+               std::invalid_argument);
+}
+
+TEST_F(PerthTest, EvaluateAsync) {
+  auto perth = Perth<float>(make_model(true));
+  auto lon = Eigen::VectorXd(lon_.replicate(40, 1));
+  auto lat = Eigen::VectorXd(lat_.replicate(40, 1));
+  auto time = Eigen::Vector<int64_t, -1>(time_.replicate(40, 1));
+  auto [expected, expected_lp, expected_quality] =
+      perth.evaluate(lon, lat, time, 0, InterpolationType::kLinearAdmittance);
+  auto check = [&](const Perth<float>::EvaluationResult& result) -> void {
+    const auto& [tide, tide_lp, quality] = result;
+    ASSERT_EQ(quality, expected_quality);
+    for (int64_t ix = 0; ix < tide.size(); ++ix) {
+      if (quality(ix) != static_cast<int8_t>(kUndefined)) {
+        ASSERT_DOUBLE_EQ(tide(ix), expected(ix));
+        ASSERT_DOUBLE_EQ(tide_lp(ix), expected_lp(ix));
+      }
+    }
+  };
+
+  // Concurrent evaluations interleave on the pool.
+  auto futures = std::vector<std::future<Perth<float>::EvaluationResult>>();
+  for (size_t ix = 0; ix < 8; ++ix) {
+    futures.emplace_back(perth.evaluate_async(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance));
+  }
+  for (auto& future : futures) {
+    check(future.get());
+  }
+
+  auto promise = std::promise<Perth<float>::EvaluationResult>();
+  perth.evaluate_async(
+      [&promise](std::future<Perth<float>::EvaluationResult> result) {
+        try {
+          promise.set_value(result.get());
+        } catch (...) {
+          promise.set_exception(std::current_exception());
+        }
+      },
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance);
+  check(promise.get_future().get());
+
+  // The errors are reported by the future.
+  auto failed = perth.evaluate_async(lon, lat.head(10), time);
+  EXPECT_THROW(failed.get(), std::invalid_argument);
+}
+
+TEST(HilbertTest, Neighbors) {
+  // The cells of a grid visited in the order of the curve are neighbors.
+  for (auto size : {1, 2, 5, 16}) {
+    auto order = hilbert_order(static_cast<uint64_t>(size));
+    auto cells = std::vector<std::tuple<uint64_t, int64_t, int64_t>>();
+    for (int64_t x = 0; x < (int64_t{1} << order); ++x) {
+      for (int64_t y = 0; y < (int64_t{1} << order); ++y) {
+        cells.emplace_back(hilbert_index(order, static_cast<uint32_t>(x),
+                                         static_cast<uint32_t>(y)),
+                           x, y);
+      }
+    }
+    std::sort(cells.begin(), cells.end());
+    for (size_t ix = 0; ix < cells.size(); ++ix) {
+      ASSERT_EQ(std::get<0>(cells[ix]), ix);
+      if (ix != 0) {
+        auto [index, x, y] = cells[ix];
+        auto [previous, px, py] = cells[ix - 1];
+        EXPECT_EQ(std::abs(x - px) + std::abs(y - py), 1);
+      }
+    }
+  }
+}
+
+TEST_P(PerthTest, SingleTime) {
+  auto [packed, group_modulations] = GetParam();
+  auto perth = Perth<float>(make_model(packed), group_modulations);
+  auto lon = Eigen::VectorXd(Eigen::VectorXd::LinSpaced(37, -180, 180));
+  auto lat = Eigen::VectorXd(Eigen::VectorXd::LinSpaced(19, -80, 80));
+  const auto epoch = time_(7);
+
+  // Scattered positions
+  auto time = Eigen::Vector<int64_t, -1>::Constant(lon_.size(), epoch);
+  auto [expected, expected_lp, expected_quality] =
+      perth.evaluate(lon_, lat_, time, 0, InterpolationType::kLinearAdmittance);
+  auto [tide, tide_lp, quality] = perth.evaluate_at_time(
+      lon_, lat_, epoch, InterpolationType::kLinearAdmittance);
+  ASSERT_EQ(quality, expected_quality);
+  for (int64_t ix = 0; ix < tide.size(); ++ix) {
+    if (quality(ix) != static_cast<int8_t>(kUndefined)) {
+      EXPECT_DOUBLE_EQ(tide(ix), expected(ix));
+      EXPECT_DOUBLE_EQ(tide_lp(ix), expected_lp(ix));
+    }
+  }
+
+  // Grid
+  auto [grid, grid_lp, grid_quality] =
+      perth.evaluate_grid(lon, lat, epoch, std::nullopt, 4);
+  ASSERT_EQ(grid.rows(), lon.size());
+  ASSERT_EQ(grid.cols(), lat.size());
+  for (int64_t ix = 0; ix < lon.size(); ++ix) {
+    auto [column, column_lp, column_quality] = perth.evaluate_at_time(
+        Eigen::VectorXd::Constant(lat.size(), lon(ix)), lat, epoch);
+    for (int64_t jx = 0; jx < lat.size(); ++jx) {
+      ASSERT_EQ(grid_quality(ix, jx), column_quality(jx));
+      if (column_quality(jx) == static_cast<int8_t>(kUndefined)) {
+        EXPECT_TRUE(std::isnan(grid(ix, jx)));
+        continue;
+      }
+      EXPECT_DOUBLE_EQ(grid(ix, jx), column(jx));
+      EXPECT_DOUBLE_EQ(grid_lp(ix, jx), column_lp(jx));
+    }
+  }
+  EXPECT_THROW(perth.evaluate_at_time(lon, lat, epoch), std::invalid_argument);
+}
+
+TEST_P(PerthTest, PredictTimeSeries) {
+  auto [packed, group_modulations] = GetParam();
+  auto perth = Perth<float>(make_model(packed), group_modulations);
+  // Five days of hourly samples, refreshed at the default interval.
+  const auto start = time_(0);
+  const auto step = int64_t{3600} * kMicrosecondsPerSecond;
+  const auto size = int64_t{120};
+  auto [tide, tide_lp, quality] = perth.predict_time_series(
+      -12.5, 43.2, start, step, size, InterpolationType::kFourierAdmittance,
+      std::nullopt, 2);
+  ASSERT_EQ(quality, kInterpolated);
+  auto time = Eigen::Vector<int64_t, -1>(size);
+  for (int64_t ix = 0; ix < size; ++ix) {
+    time(ix) = start + ix * step;
+  }
+  auto [expected, expected_lp, expected_quality] = perth.evaluate(
+      Eigen::VectorXd::Constant(size, -12.5),
+      Eigen::VectorXd::Constant(size, 43.2), time, 0,
+      InterpolationType::kFourierAdmittance);
+  // The rotation is computed from two consecutive samples: the curvature of
+  // the tidal arguments, and of the group modulations, is neglected over the
+  // refresh interval.
+  for (int64_t ix = 0; ix < size; ++ix) {
+    EXPECT_NEAR(tide(ix), expected(ix), 1e-5);
+    EXPECT_NEAR(tide_lp(ix), expected_lp(ix), 1e-5);
+  }
+
+  // Undefined position
+  std::tie(tide, tide_lp, quality) =
+      perth.predict_time_series(23, -65, start, step, size);
+  EXPECT_EQ(quality, kUndefined);
+  EXPECT_TRUE(std::isnan(tide(0)));
+  EXPECT_THROW(perth.predict_time_series(0, 0, start, step, 0),
+               std::invalid_argument);
+}
+
+TEST_P(PerthTest, BakeInference) {
+  auto [packed, group_modulations] = GetParam();
+  auto model = make_model(packed);
+  model->pack();
+  auto perth = Perth<float>(model, group_modulations);
+  auto [expected, expected_lp, expected_quality] = perth.evaluate(
+      lon_, lat_, time_, 0, InterpolationType::kFourierAdmittance, 2);
+
+  auto baked = make_model(packed);
+  baked->pack();
+  auto inferred = baked->bake_inference(InterpolationType::kFourierAdmittance);
+  EXPECT_EQ(baked->size(), model->size() + inferred.size());
+  EXPECT_EQ(baked->packed(), packed);
+  // The inferred constituents are now provided by the model.
+  EXPECT_TRUE(baked->bake_inference(InterpolationType::kFourierAdmittance)
+                  .empty());
+
+  auto [tide, tide_lp, quality] =
+      Perth<float>(baked, group_modulations)
+          .evaluate(lon_, lat_, time_, 0, std::nullopt, 2);
+  for (int64_t ix = 0; ix < lon_.size(); ++ix) {
+    EXPECT_EQ(quality(ix), expected_quality(ix));
+    if (quality(ix) == kUndefined) {
+      EXPECT_TRUE(std::isnan(tide(ix)));
+      continue;
+    }
+    // The node tide is evaluated at the latitude of the grid nodes, and the
+    // inferred waves are stored in single precision.
+    EXPECT_NEAR(tide(ix), expected(ix), 1e-5);
+    EXPECT_NEAR(tide_lp(ix), expected_lp(ix), 1e-5);
+  }
+}
+
+TEST_P(PerthTest, ErrorBudget) {
+  auto [packed, group_modulations] = GetParam();
+  auto perth = Perth<float>(make_model(packed), group_modulations);
+  EXPECT_EQ(perth.error_budget(), 0);
+  EXPECT_TRUE(perth.approximation(InterpolationType::kLinearAdmittance)
+                  .dropped.empty());
+
+  // Scattered points, one every three minutes over three days.
+  constexpr int64_t kSize = 1440;
+  auto lon = Eigen::VectorXd(kSize);
+  auto lat = Eigen::VectorXd(kSize);
+  auto time = Eigen::Vector<int64_t, -1>(kSize);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    lon(ix) = std::fmod(static_cast<double>(ix) * 37.7, 360.0);
+    lat(ix) = 80 * std::sin(static_cast<double>(ix) * 0.11);
+    time(ix) = (1577836800LL + 180 * ix) * kMicrosecondsPerSecond;
+  }
+  auto [expected, expected_lp, expected_quality] = perth.evaluate(
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance, 2);
+
+  // The amplitudes of the model reach one meter.
+  constexpr auto kBudget = 0.05;
+  perth.set_error_budget(kBudget);
+  EXPECT_EQ(perth.error_budget(), kBudget);
+  const auto approximation =
+      perth.approximation(InterpolationType::kLinearAdmittance);
+  EXPECT_FALSE(approximation.dropped.empty());
+  EXPECT_GT(approximation.time_tolerance, 0);
+  EXPECT_LE(approximation.error_bound, kBudget);
+  // Without inference, only the nodal corrections are kept.
+  EXPECT_TRUE(perth.approximation().dropped.empty());
+
+  for (auto backend : {Backend::kPointwise, Backend::kBatched}) {
+    perth.set_backend(backend);
+    auto [tide, tide_lp, quality] = perth.evaluate(
+        lon, lat, time, 0, InterpolationType::kLinearAdmittance, 2);
+    auto error = 0.0;
+    for (int64_t ix = 0; ix < kSize; ++ix) {
+      ASSERT_EQ(quality(ix), expected_quality(ix));
+      if (quality(ix) == kUndefined) {
+        continue;
+      }
+      error = std::max({error, std::abs(tide(ix) - expected(ix)),
+                        std::abs(tide_lp(ix) - expected_lp(ix))});
+    }
+    EXPECT_GT(error, 0);
+    EXPECT_LE(error, approximation.error_bound);
+  }
+
+  // Without budget, the evaluations are exact again.
+  perth.set_backend(Backend::kPointwise);
+  perth.set_error_budget(0);
+  EXPECT_TRUE(perth.approximation(InterpolationType::kLinearAdmittance)
+                  .dropped.empty());
+  auto [tide, tide_lp, quality] = perth.evaluate(
+      lon, lat, time, 0, InterpolationType::kLinearAdmittance, 2);
+  for (int64_t ix = 0; ix < kSize; ++ix) {
+    if (quality(ix) != kUndefined) {
+      EXPECT_EQ(tide(ix), expected(ix));
+      EXPECT_EQ(tide_lp(ix), expected_lp(ix));
+    }
+  }
+  EXPECT_THROW(perth.set_error_budget(-1), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Layouts, PerthTest,
+                         ::testing::Combine(::testing::Bool(),
+                                            ::testing::Bool()));
+
+}  // namespace perth
@@ -0,0 +1,61 @@
+import numpy
+import pytest
+import perth
+import perth._core
+
+WAVES = {
+    perth.Constituent.M2: 0.8 - 0.3j,
+    perth.Constituent.S2: 0.25 + 0.1j,
+    perth.Constituent.N2: -0.12 + 0.15j,
+    perth.Constituent.K1: 0.2 + 0.05j,
+    perth.Constituent.O1: -0.1 + 0.14j,
+}
+
+
+def make_series(group_modulations: bool):
+    """Tide predicted by Perth, over 60 days, from a uniform model."""
+    lon = perth._core.Axis(-180, 179, 1, is_periodic=True)
+    lat = perth._core.Axis(-90, 90, 1)
+    model = perth._core.TidalModelFloat64(lon, lat)
+    for constituent, wave in WAVES.items():
+        model.add_constituent(
+            constituent,
+            numpy.full((360, 181), wave, dtype=numpy.complex128),
+        )
+    time = numpy.arange(
+        numpy.datetime64("2020-01-01"),
+        numpy.datetime64("2020-03-01"),
+        numpy.timedelta64(1, "h"),
+    )
+    lons = numpy.full(time.shape, 10.5)
+    lats = numpy.full(time.shape, 45.5)
+    tide, _, _ = perth.Perth(model, group_modulations).evaluate(
+        lons, lats, time
+    )
+    return time, tide
+
+
+@pytest.mark.parametrize("group_modulations", [False, True])
+def test_harmonic_analysis(group_modulations: bool):
+    time, values = make_series(group_modulations)
+    constituents = list(WAVES)
+    analysis = perth.HarmonicAnalysis(constituents, group_modulations)
+    half = len(time) // 2
+    analysis.accumulate(time[:half], values[:half])
+    other = perth.HarmonicAnalysis(constituents, group_modulations)
+    other.accumulate(time[half:], values[half:], num_threads=2)
+    analysis.merge(other)
+    assert analysis.samples == len(time)
+
+    result = analysis.solve()
+    assert result.samples == len(time)
+    numpy.testing.assert_allclose(
+        result.constituents, list(WAVES.values()), atol=1e-6
+    )
+    assert abs(result.mean) < 1e-6
+    assert result.residual_rms < 1e-6
+
+    with pytest.raises(RuntimeError):
+        short = perth.HarmonicAnalysis(constituents)
+        short.accumulate(time[:3], values[:3])
+        short.solve()
@@ -1,3 +1,8 @@
+import multiprocessing
+import pickle
+
+import numpy
+import pytest
 import perth
 import perth._core
 
@@ -45,9 +50,84 @@ def test_model(sad: str):
         perth.Constituent.SIGMA1: complex(2.93300748e-02, -0.700001657),
         perth.Constituent.OO1: complex(-0.218446687, -0.177276790),
     }
-    for constituent, value in acc.values:
+    for constituent in model.identifiers():
         assert constituent in expected
+        value = constituent_table[constituent].tide
         expected_value = expected[constituent] * 1e-2  # cm to m
         assert abs(value - expected_value) < TOLERANCE, (
             f"Value for {constituent} does not match expected value."
         )
+
+
+def test_load_model_packed(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    model = perth.load_model(tide_model_files)
+    packed = perth.load_model(tide_model_files, packed=True)
+    assert packed.packed
+    assert packed.identifiers() == model.identifiers()
+    lon = numpy.linspace(-180, 180, 1000)
+    lat = numpy.linspace(-80, 80, 1000)
+    expected, expected_quality = model.interpolate_many(lon, lat)
+    values, quality = packed.interpolate_many(lon, lat)
+    numpy.testing.assert_array_equal(quality, expected_quality)
+    numpy.testing.assert_array_equal(values, expected)
+
+
+def test_interpolate_many(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    model = perth.load_model(tide_model_files)
+    lon = numpy.array([-7.6880002021789551, 0.0, 180.0])
+    lat = numpy.array([59.194999694824219, 95.0, -89.9])
+    values, quality = model.interpolate_many(lon, lat)
+    assert values.shape == (3, model.size())
+    assert quality.shape == (3,)
+    assert quality[1] == perth.Quality.UNDEFINED.value
+    assert numpy.all(numpy.isnan(values[1]))
+
+    acc = model.accelerator(0)
+    constituent_table = perth._core.assemble_constituent_table(
+        model.identifiers()
+    )
+    assert (
+        quality[0]
+        == model.interpolate(lon[0], lat[0], constituent_table, acc).value
+    )
+    for ix, constituent in enumerate(model.identifiers()):
+        assert values[0, ix] == constituent_table[constituent].tide
+
+
+def _interpolate(model, lon, lat):
+    return model.interpolate_many(lon, lat, 1)[0]
+
+
+def test_share_model(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    model = perth.load_model(tide_model_files)
+    lon = numpy.linspace(-10, 10, 20)
+    lat = numpy.linspace(40, 60, 20)
+    expected = model.interpolate_many(lon, lat)[0]
+
+    shared = perth.share_model(model)
+    assert shared.shared_memory.startswith("/perth-")
+    assert model.shared_memory == ""
+    numpy.testing.assert_array_equal(
+        shared.interpolate_many(lon, lat)[0], expected
+    )
+
+    # Only the name of the segment is pickled.
+    payload = pickle.dumps(shared)
+    assert len(payload) < 1024
+    attached = pickle.loads(payload)
+    assert attached.shared_memory == shared.shared_memory
+    numpy.testing.assert_array_equal(
+        attached.interpolate_many(lon, lat)[0], expected
+    )
+
+    # The workers attach the same waves.
+    with multiprocessing.get_context("spawn").Pool(2) as pool:
+        for values in pool.starmap(_interpolate, [(shared, lon, lat)] * 2):
+            numpy.testing.assert_array_equal(values, expected)
+
+    # A model whose waves are private cannot be pickled.
+    with pytest.raises(TypeError):
+        pickle.dumps(model)
@@ -1,3 +1,4 @@
+import asyncio
 import numpy
 import pytest
 import perth
@@ -54,3 +55,204 @@ def test_re14_ocean_tide(sad: str):
     assert pytest.approx(result[1], abs=1e-6) == expected_values[1]
     assert result[0] == expected_values[0]
     assert result[2] == expected_values[2]
+
+
+def test_tiled_ocean_tide(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    model = perth.load_model(tide_model_files)
+    tiled = perth.load_model(
+        tide_model_files, tile_size=64, memory_budget=1 << 20
+    )
+    assert tiled.tiled
+    assert tiled.resident_tiles == 0
+
+    lon = numpy.linspace(-10, 10, 101)
+    lat = numpy.linspace(50, 60, 101)
+    time = numpy.full(lon.shape, "1983-01-01T00:00:00", dtype="datetime64[ns]")
+
+    expected = perth.Perth(model).evaluate(lon, lat, time)
+    result = perth.Perth(tiled).evaluate(lon, lat, time)
+    numpy.testing.assert_allclose(result[0], expected[0], atol=1e-6)
+    numpy.testing.assert_allclose(result[1], expected[1], atol=1e-6)
+    numpy.testing.assert_array_equal(result[2], expected[2])
+    assert 0 < tiled.tile_memory_usage <= 1 << 20
+
+
+def test_evaluate_into(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+
+    lon = numpy.linspace(-10, 10, 50)
+    lat = numpy.linspace(50, 60, 50)
+    time = numpy.full(lon.shape, "1983-01-01T00:00:00", dtype="datetime64[us]")
+    expected = handler.evaluate(lon, lat, time)
+
+    # Strided views of a chunk buffer, float32 coordinates.
+    buffer = numpy.full((50, 3), -1.0)
+    quality = numpy.full((50, 2), -1, dtype=numpy.int8)
+    coordinates = numpy.stack([lon, lat], axis=1).astype(numpy.float32)
+    handler.evaluate_into(
+        coordinates[:, 0],
+        coordinates[:, 1],
+        time,
+        buffer[:, 0],
+        buffer[:, 2],
+        quality[:, 1],
+    )
+    numpy.testing.assert_allclose(buffer[:, 0], expected[0], atol=1e-4)
+    numpy.testing.assert_allclose(buffer[:, 2], expected[1], atol=1e-4)
+    numpy.testing.assert_array_equal(quality[:, 1], expected[2])
+    assert numpy.all(buffer[:, 1] == -1.0)
+    assert numpy.all(quality[:, 0] == -1)
+
+
+def test_evaluate_async(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+
+    lon = numpy.linspace(-10, 10, 50)
+    lat = numpy.linspace(50, 60, 50)
+    time = numpy.full(lon.shape, "1983-01-01T00:00:00", dtype="datetime64[us]")
+    expected = handler.evaluate(lon, lat, time)
+
+    future = handler.evaluate_async(lon, lat, time)
+    assert isinstance(future, perth.EvaluationFuture)
+    tide, tide_lp, quality = future.result(timeout=60)
+    numpy.testing.assert_array_equal(tide, expected[0])
+    numpy.testing.assert_array_equal(tide_lp, expected[1])
+    numpy.testing.assert_array_equal(quality, expected[2])
+
+    # Concurrent requests of a coroutine interleave on the pool.
+    async def main():
+        return await asyncio.gather(
+            *(handler.evaluate_async(lon, lat, time) for _ in range(8))
+        )
+
+    for tide, _, _ in asyncio.run(main()):
+        numpy.testing.assert_array_equal(tide, expected[0])
+
+    # The errors are raised by the future.
+    with pytest.raises(ValueError):
+        handler.evaluate_async(lon, lat[:10], time).result(timeout=60)
+
+
+def test_batched_backend(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+    assert handler.backend == perth.Backend.POINTWISE
+
+    lon = numpy.linspace(-10, 10, 50)
+    lat = numpy.linspace(50, 60, 50)
+    time = numpy.full(lon.shape, "1983-01-01T00:00:00", dtype="datetime64[us]")
+    time[25:] += numpy.timedelta64(1, "h")
+    expected = handler.evaluate(
+        lon, lat, time, interpolation_type=perth.LINEAR_ADMITTANCE
+    )
+
+    handler.backend = perth.Backend.BATCHED
+    assert handler.backend == perth.Backend.BATCHED
+    tide, tide_lp, quality = handler.evaluate(
+        lon, lat, time, interpolation_type=perth.LINEAR_ADMITTANCE
+    )
+    numpy.testing.assert_allclose(tide, expected[0], atol=1e-9)
+    numpy.testing.assert_allclose(tide_lp, expected[1], atol=1e-9)
+    numpy.testing.assert_array_equal(quality, expected[2])
+
+
+def test_extrapolated_arguments(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+    assert handler.argument_mode == perth.ArgumentMode.FROZEN
+
+    # One point sampled every minute over three hours.
+    time = numpy.datetime64("1983-01-01T00:00:00", "us") + numpy.arange(
+        180
+    ).astype("m8[m]")
+    lon = numpy.full(time.shape, 5.0)
+    lat = numpy.full(time.shape, 55.0)
+    expected = handler.evaluate(
+        lon, lat, time, interpolation_type=perth.LINEAR_ADMITTANCE
+    )
+
+    handler.argument_mode = perth.ArgumentMode.EXTRAPOLATED
+    assert handler.argument_mode == perth.ArgumentMode.EXTRAPOLATED
+    tide, tide_lp, quality = handler.evaluate(
+        lon,
+        lat,
+        time,
+        time_tolerance=1 / 24,
+        interpolation_type=perth.LINEAR_ADMITTANCE,
+    )
+    numpy.testing.assert_allclose(tide, expected[0], atol=1e-4)
+    numpy.testing.assert_allclose(tide_lp, expected[1], atol=1e-4)
+    numpy.testing.assert_array_equal(quality, expected[2])
+
+
+def test_error_budget(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+    assert handler.error_budget == 0
+    assert handler.approximation(perth.LINEAR_ADMITTANCE).dropped == []
+
+    # Points scattered along a track, one every ten seconds over a day.
+    time = numpy.datetime64("1983-01-01T00:00:00", "us") + numpy.arange(
+        8640
+    ).astype("m8[s]") * 10
+    lon = numpy.linspace(-10, 10, time.size)
+    lat = 55.0 + 5.0 * numpy.sin(numpy.linspace(0, 20, time.size))
+    expected = handler.evaluate(
+        lon, lat, time, interpolation_type=perth.LINEAR_ADMITTANCE
+    )
+
+    # One centimeter, the waves being loaded in meters.
+    handler.error_budget = 0.01
+    assert handler.error_budget == 0.01
+    approximation = handler.approximation(perth.LINEAR_ADMITTANCE)
+    assert isinstance(approximation, perth.Approximation)
+    assert 0 < approximation.error_bound <= 0.01
+    assert approximation.time_tolerance > 0
+    tide, tide_lp, quality = handler.evaluate(
+        lon, lat, time, interpolation_type=perth.LINEAR_ADMITTANCE
+    )
+    numpy.testing.assert_array_equal(quality, expected[2])
+    defined = quality != perth.UNDEFINED
+    assert numpy.all(
+        numpy.abs(tide - expected[0])[defined] <= approximation.error_bound
+    )
+    assert numpy.all(
+        numpy.abs(tide_lp - expected[1])[defined] <= approximation.error_bound
+    )
+
+    with pytest.raises(ValueError):
+        handler.error_budget = -1.0
+
+
+def test_evaluate_stream(sad: str):
+    tide_model_files = fetch_got_files(sad)
+    handler = perth.Perth(perth.load_model(tide_model_files))
+
+    chunks = []
+    for ix in range(5):
+        lon = numpy.linspace(-10, 10, 50) + ix
+        lat = numpy.linspace(50, 60, 50)
+        time = numpy.full(lon.shape, "1983-01-01T00:00:00", dtype="M8[us]")
+        chunks.append((lon, lat, time + numpy.timedelta64(ix, "h")))
+
+    results = {}
+
+    def sink(index, tide, tide_lp, quality):
+        results[index] = (tide, tide_lp, quality)
+
+    assert handler.evaluate_stream(iter(chunks), sink, max_pending=1) == 5
+    assert sorted(results) == list(range(5))
+    for index, (lon, lat, time) in enumerate(chunks):
+        expected = handler.evaluate(lon, lat, time)
+        numpy.testing.assert_array_equal(results[index][0], expected[0])
+        numpy.testing.assert_array_equal(results[index][1], expected[1])
+        numpy.testing.assert_array_equal(results[index][2], expected[2])
+
+    def failing_sink(index, tide, tide_lp, quality):
+        raise RuntimeError("write error")
+
+    with pytest.raises(RuntimeError):
+        handler.evaluate_stream(chunks, failing_sink)